@@ -7,6 +7,7 @@
 
 #include <assert.h>
 #include <string.h>
+#include <algorithm>
 
 #include <compat/cpuid.h>
 
@@ -22,11 +23,13 @@ void Transform(uint32_t* s, const unsigned char* chunk, size_t blocks);
 namespace sha256d64_sse41
 {
 void Transform_4way(unsigned char* out, const unsigned char* in);
+void TransformMulti_4way(unsigned char* out, const unsigned char* in, size_t blocks);
 }
 
 namespace sha256d64_avx2
 {
 void Transform_8way(unsigned char* out, const unsigned char* in);
+void TransformMulti_8way(unsigned char* out, const unsigned char* in, size_t blocks);
 }
 
 namespace sha256d64_shani
@@ -416,6 +419,7 @@ void TransformD64(unsigned char* out, const unsigned char* in)
 
 typedef void (*TransformType)(uint32_t*, const unsigned char*, size_t);
 typedef void (*TransformD64Type)(unsigned char*, const unsigned char*);
+typedef void (*TransformMultiType)(unsigned char*, const unsigned char*, size_t);
 
 template<TransformType tr>
 void TransformD64Wrapper(unsigned char* out, const unsigned char* in)
@@ -461,6 +465,8 @@ TransformD64Type TransformD64 = sha256::TransformD64;
 TransformD64Type TransformD64_2way = nullptr;
 TransformD64Type TransformD64_4way = nullptr;
 TransformD64Type TransformD64_8way = nullptr;
+TransformMultiType TransformMulti_4way = nullptr;
+TransformMultiType TransformMulti_8way = nullptr;
 
 [[maybe_unused]]
 bool SelfTest() {
@@ -545,9 +551,62 @@ bool SelfTest() {
         if (!std::equal(out_8way, out_8way + 256, result_d64)) return false;
     }
 
+    // Test the multi-buffer transforms, if available. The input is
+    // interleaved by block, so with 4 lanes and 2 blocks lane i processes
+    // 64-byte chunks i and i + 4.
+    if (TransformMulti_4way || TransformMulti_8way) {
+        unsigned char expected_4way[128];
+        unsigned char expected_8way[256];
+        for (size_t i = 0; i < 8; ++i) {
+            uint32_t state[8];
+            std::copy(init, init + 8, state);
+            Transform(state, data + 1 + 64 * i, 1);
+            for (size_t j = 0; j < 8; ++j) WriteBE32(expected_8way + 32 * i + 4 * j, state[j]);
+            if (i < 4) {
+                Transform(state, data + 1 + 64 * (i + 4), 1);
+                for (size_t j = 0; j < 8; ++j) WriteBE32(expected_4way + 32 * i + 4 * j, state[j]);
+            }
+        }
+        if (TransformMulti_4way) {
+            unsigned char out_4way[128];
+            TransformMulti_4way(out_4way, data + 1, 2);
+            if (!std::equal(out_4way, out_4way + 128, expected_4way)) return false;
+        }
+        if (TransformMulti_8way) {
+            unsigned char out_8way[256];
+            TransformMulti_8way(out_8way, data + 1, 1);
+            if (!std::equal(out_8way, out_8way + 256, expected_8way)) return false;
+        }
+    }
+
     return true;
 }
 
+/** Maximum number of blocks per message hashed by the multi-buffer transforms. */
+const size_t MULTI_MAX_BLOCKS = 8;
+
+/** Pads lanes consecutive len-byte messages into whole blocks and interleaves
+ *  them by block, as expected by the multi-buffer transforms: block b of
+ *  message i is written to buf + (b * lanes + i) * 64.
+ */
+void PadInterleaved(unsigned char* buf, const unsigned char* in, size_t len, size_t blocks, size_t lanes)
+{
+    unsigned char sizedesc[8];
+    WriteBE64(sizedesc, (uint64_t)len << 3);
+    for (size_t lane = 0; lane < lanes; ++lane) {
+        const unsigned char* msg = in + lane * len;
+        for (size_t blk = 0; blk < blocks; ++blk) {
+            unsigned char* dst = buf + (blk * lanes + lane) * 64;
+            const size_t pos = blk * 64;
+            const size_t n = pos < len ? std::min<size_t>(64, len - pos) : 0;
+            memcpy(dst, msg + pos, n);
+            memset(dst + n, 0, 64 - n);
+            if (len >= pos && len < pos + 64) dst[len - pos] = 0x80;
+            if (blk + 1 == blocks) memcpy(dst + 56, sizedesc, 8);
+        }
+    }
+}
+
 #if defined(USE_ASM) && (defined(__x86_64__) || defined(__amd64__) || defined(__i386__))
 /** Check whether the OS has enabled AVX registers. */
 bool AVXEnabled()
@@ -612,6 +671,7 @@ std::string SHA256AutoDetect()
 #endif
 #if defined(ENABLE_SSE41) && !defined(BUILD_BITCOIN_INTERNAL)
         TransformD64_4way = sha256d64_sse41::Transform_4way;
+        TransformMulti_4way = sha256d64_sse41::TransformMulti_4way;
         ret += ",sse41(4way)";
 #endif
     }
@@ -619,6 +679,7 @@ std::string SHA256AutoDetect()
 #if defined(ENABLE_AVX2) && !defined(BUILD_BITCOIN_INTERNAL)
     if (have_avx2 && have_avx && enabled_avx) {
         TransformD64_8way = sha256d64_avx2::Transform_8way;
+        TransformMulti_8way = sha256d64_avx2::TransformMulti_8way;
         ret += ",avx2(8way)";
     }
 #endif
@@ -718,3 +779,35 @@ void SHA256D64(unsigned char* out, const unsigned char* in, size_t blocks)
         --blocks;
     }
 }
+
+void SHA256Multi(unsigned char* out, const unsigned char* in, size_t len, size_t count)
+{
+    const size_t blocks = (len + 9 + 63) / 64;
+    if (blocks <= MULTI_MAX_BLOCKS) {
+        unsigned char buf[MULTI_MAX_BLOCKS * 64 * 8];
+        if (TransformMulti_8way) {
+            while (count >= 8) {
+                PadInterleaved(buf, in, len, blocks, 8);
+                TransformMulti_8way(out, buf, blocks);
+                out += 256;
+                in += 8 * len;
+                count -= 8;
+            }
+        }
+        if (TransformMulti_4way) {
+            while (count >= 4) {
+                PadInterleaved(buf, in, len, blocks, 4);
+                TransformMulti_4way(out, buf, blocks);
+                out += 128;
+                in += 4 * len;
+                count -= 4;
+            }
+        }
+    }
+    while (count) {
+        CSHA256().Write(in, len).Finalize(out);
+        out += 32;
+        in += len;
+        --count;
+    }
+}
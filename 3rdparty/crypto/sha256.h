@@ -38,4 +38,14 @@ std::string SHA256AutoDetect();
  */
 void SHA256D64(unsigned char* output, const unsigned char* input, size_t blocks);
 
+/** Compute the SHA256's of multiple independent messages of equal length,
+ *  using the multi-buffer transforms when available. Intended for many short
+ *  messages, such as the fixed-size preimages of UHS IDs.
+ *  output:  pointer to a count*32 byte output buffer
+ *  input:   pointer to count messages of len bytes each, stored contiguously
+ *  len:     length of each message in bytes
+ *  count:   the number of messages to hash.
+ */
+void SHA256Multi(unsigned char* output, const unsigned char* input, size_t len, size_t count);
+
 #endif // BITCOIN_CRYPTO_SHA256_H
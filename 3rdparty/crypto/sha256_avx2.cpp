@@ -4,6 +4,7 @@
 
 #ifdef ENABLE_AVX2
 
+#include <stddef.h>
 #include <stdint.h>
 #include <immintrin.h>
 
@@ -70,6 +71,70 @@ void inline Write8(unsigned char* out, int offset, __m256i v) {
     WriteLE32(out + 224 + offset, _mm256_extract_epi32(v, 0));
 }
 
+/** Round constants, for the rolled multi-block transform. */
+const uint32_t ROUND_K[64] = {
+    0x428a2f98ul, 0x71374491ul, 0xb5c0fbcful, 0xe9b5dba5ul, 0x3956c25bul, 0x59f111f1ul, 0x923f82a4ul, 0xab1c5ed5ul,
+    0xd807aa98ul, 0x12835b01ul, 0x243185beul, 0x550c7dc3ul, 0x72be5d74ul, 0x80deb1feul, 0x9bdc06a7ul, 0xc19bf174ul,
+    0xe49b69c1ul, 0xefbe4786ul, 0x0fc19dc6ul, 0x240ca1ccul, 0x2de92c6ful, 0x4a7484aaul, 0x5cb0a9dcul, 0x76f988daul,
+    0x983e5152ul, 0xa831c66dul, 0xb00327c8ul, 0xbf597fc7ul, 0xc6e00bf3ul, 0xd5a79147ul, 0x06ca6351ul, 0x14292967ul,
+    0x27b70a85ul, 0x2e1b2138ul, 0x4d2c6dfcul, 0x53380d13ul, 0x650a7354ul, 0x766a0abbul, 0x81c2c92eul, 0x92722c85ul,
+    0xa2bfe8a1ul, 0xa81a664bul, 0xc24b8b70ul, 0xc76c51a3ul, 0xd192e819ul, 0xd6990624ul, 0xf40e3585ul, 0x106aa070ul,
+    0x19a4c116ul, 0x1e376c08ul, 0x2748774cul, 0x34b0bcb5ul, 0x391c0cb3ul, 0x4ed8aa4aul, 0x5b9cca4ful, 0x682e6ff3ul,
+    0x748f82eeul, 0x78a5636ful, 0x84c87814ul, 0x8cc70208ul, 0x90befffaul, 0xa4506cebul, 0xbef9a3f7ul, 0xc67178f2ul
+};
+
+}
+
+void TransformMulti_8way(unsigned char* out, const unsigned char* in, size_t blocks)
+{
+    __m256i s0 = K(0x6a09e667ul);
+    __m256i s1 = K(0xbb67ae85ul);
+    __m256i s2 = K(0x3c6ef372ul);
+    __m256i s3 = K(0xa54ff53aul);
+    __m256i s4 = K(0x510e527ful);
+    __m256i s5 = K(0x9b05688cul);
+    __m256i s6 = K(0x1f83d9abul);
+    __m256i s7 = K(0x5be0cd19ul);
+
+    for (size_t blk = 0; blk < blocks; ++blk, in += 64 * 8) {
+        __m256i w[16];
+        for (int i = 0; i < 16; ++i) {
+            w[i] = Read8(in, 4 * i);
+        }
+        __m256i a = s0, b = s1, c = s2, d = s3, e = s4, f = s5, g = s6, h = s7;
+        for (int i = 0; i < 64; ++i) {
+            if (i >= 16) {
+                Inc(w[i & 15], sigma1(w[(i - 2) & 15]), w[(i - 7) & 15], sigma0(w[(i - 15) & 15]));
+            }
+            __m256i t1 = Add(h, Sigma1(e), Ch(e, f, g), Add(K(ROUND_K[i]), w[i & 15]));
+            __m256i t2 = Add(Sigma0(a), Maj(a, b, c));
+            h = g;
+            g = f;
+            f = e;
+            e = Add(d, t1);
+            d = c;
+            c = b;
+            b = a;
+            a = Add(t1, t2);
+        }
+        Inc(s0, a);
+        Inc(s1, b);
+        Inc(s2, c);
+        Inc(s3, d);
+        Inc(s4, e);
+        Inc(s5, f);
+        Inc(s6, g);
+        Inc(s7, h);
+    }
+
+    Write8(out, 0, s0);
+    Write8(out, 4, s1);
+    Write8(out, 8, s2);
+    Write8(out, 12, s3);
+    Write8(out, 16, s4);
+    Write8(out, 20, s5);
+    Write8(out, 24, s6);
+    Write8(out, 28, s7);
 }
 
 void Transform_8way(unsigned char* out, const unsigned char* in)
@@ -0,0 +1,188 @@
+// Copyright (c) 2021 MIT Digital Currency Initiative,
+//                    Federal Reserve Bank of Boston
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "util/common/flat_hash_set.hpp"
+#include "util/common/hash.hpp"
+#include "util/common/hashmap.hpp"
+
+#include <benchmark/benchmark.h>
+#include <random>
+#include <unordered_set>
+
+namespace {
+    /// Bytes currently allocated through \ref counting_allocator.
+    size_t allocated_bytes{0};
+
+    /// Allocator that tracks the bytes requested by a container, so the
+    /// node-based set's footprint can be compared with the flat set's
+    /// slot arrays. Excludes malloc bookkeeping, which adds roughly another
+    /// 8-16 bytes to every node but not to the flat set's two arrays.
+    template<typename T>
+    struct counting_allocator {
+        using value_type = T;
+
+        counting_allocator() = default;
+        template<typename U>
+        explicit counting_allocator(const counting_allocator<U>& /* a */) {}
+
+        auto allocate(size_t n) -> T* {
+            allocated_bytes += n * sizeof(T);
+            return std::allocator<T>().allocate(n);
+        }
+
+        void deallocate(T* p, size_t n) {
+            allocated_bytes -= n * sizeof(T);
+            std::allocator<T>().deallocate(p, n);
+        }
+
+        template<typename U>
+        auto operator==(const counting_allocator<U>& /* a */) const -> bool {
+            return true;
+        }
+
+        template<typename U>
+        auto operator!=(const counting_allocator<U>& /* a */) const -> bool {
+            return false;
+        }
+    };
+
+    using node_set = std::unordered_set<cbdc::hash_t,
+                                        cbdc::hashing::null,
+                                        std::equal_to<>,
+                                        counting_allocator<cbdc::hash_t>>;
+    using flat_set = cbdc::flat_hash_set<cbdc::hash_t, cbdc::hashing::null>;
+
+    /// Generates random UHS IDs whose leading byte is fixed, as in a
+    /// single locking shard.
+    auto make_hashes(size_t count, uint64_t seed)
+        -> std::vector<cbdc::hash_t> {
+        auto engine = std::mt19937_64(seed);
+        auto ret = std::vector<cbdc::hash_t>(count);
+        for(auto& h : ret) {
+            for(size_t i{0}; i < cbdc::hash_size / sizeof(uint64_t); i++) {
+                const auto val = engine();
+                std::memcpy(&h[i * sizeof(val)], &val, sizeof(val));
+            }
+            h[0] = 0;
+        }
+        return ret;
+    }
+
+    constexpr uint64_t present_seed = 1;
+    constexpr uint64_t absent_seed = 2;
+
+    template<typename S>
+    void report_memory(benchmark::State& state, const S& set, size_t bytes) {
+        state.counters["bytes_per_entry"]
+            = static_cast<double>(bytes) / static_cast<double>(set.size());
+    }
+}
+
+static void node_set_insert(benchmark::State& state) {
+    const auto count = static_cast<size_t>(state.range(0));
+    const auto hashes = make_hashes(count, present_seed);
+    for(auto _ : state) {
+        state.PauseTiming();
+        {
+            auto set = node_set();
+            state.ResumeTiming();
+            for(const auto& h : hashes) {
+                set.emplace(h);
+            }
+            state.PauseTiming();
+            report_memory(state, set, allocated_bytes);
+        }
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations()
+                            * static_cast<int64_t>(count));
+}
+
+static void flat_set_insert(benchmark::State& state) {
+    const auto count = static_cast<size_t>(state.range(0));
+    const auto hashes = make_hashes(count, present_seed);
+    for(auto _ : state) {
+        state.PauseTiming();
+        {
+            auto set = flat_set();
+            state.ResumeTiming();
+            for(const auto& h : hashes) {
+                set.emplace(h);
+            }
+            state.PauseTiming();
+            report_memory(state,
+                          set,
+                          set.bucket_count() * (sizeof(cbdc::hash_t) + 1));
+        }
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations()
+                            * static_cast<int64_t>(count));
+}
+
+static void flat_set_reserved_insert(benchmark::State& state) {
+    const auto count = static_cast<size_t>(state.range(0));
+    const auto hashes = make_hashes(count, present_seed);
+    for(auto _ : state) {
+        state.PauseTiming();
+        {
+            auto set = flat_set(count);
+            state.ResumeTiming();
+            for(const auto& h : hashes) {
+                set.emplace(h);
+            }
+            state.PauseTiming();
+            report_memory(state,
+                          set,
+                          set.bucket_count() * (sizeof(cbdc::hash_t) + 1));
+        }
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations()
+                            * static_cast<int64_t>(count));
+}
+
+template<typename S>
+static void lookup(benchmark::State& state, uint64_t query_seed) {
+    const auto count = static_cast<size_t>(state.range(0));
+    auto set = S();
+    for(const auto& h : make_hashes(count, present_seed)) {
+        set.emplace(h);
+    }
+    const auto queries = make_hashes(count, query_seed);
+    size_t i{0};
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(set.find(queries[i]) != set.end());
+        i = (i + 1 == count) ? 0 : i + 1;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void node_set_lookup_hit(benchmark::State& state) {
+    lookup<node_set>(state, present_seed);
+}
+
+static void flat_set_lookup_hit(benchmark::State& state) {
+    lookup<flat_set>(state, present_seed);
+}
+
+static void node_set_lookup_miss(benchmark::State& state) {
+    lookup<node_set>(state, absent_seed);
+}
+
+static void flat_set_lookup_miss(benchmark::State& state) {
+    lookup<flat_set>(state, absent_seed);
+}
+
+static constexpr auto min_entries = 1 << 10;
+static constexpr auto max_entries = 1 << 22;
+
+BENCHMARK(node_set_insert)->Range(min_entries, max_entries);
+BENCHMARK(flat_set_insert)->Range(min_entries, max_entries);
+BENCHMARK(flat_set_reserved_insert)->Range(min_entries, max_entries);
+BENCHMARK(node_set_lookup_hit)->Range(min_entries, max_entries);
+BENCHMARK(flat_set_lookup_hit)->Range(min_entries, max_entries);
+BENCHMARK(node_set_lookup_miss)->Range(min_entries, max_entries);
+BENCHMARK(flat_set_lookup_miss)->Range(min_entries, max_entries);
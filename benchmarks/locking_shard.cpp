@@ -0,0 +1,124 @@
+// Copyright (c) 2021 MIT Digital Currency Initiative,
+//                    Federal Reserve Bank of Boston
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "uhs/twophase/locking_shard/locking_shard.hpp"
+
+#include <benchmark/benchmark.h>
+#include <random>
+#include <thread>
+
+namespace {
+    constexpr size_t batch_size = 1000;
+    constexpr size_t batches_per_thread = 20;
+    constexpr size_t inputs_per_tx = 2;
+    constexpr size_t completed_txs_cache_size = 1000000;
+
+    auto make_id(std::mt19937_64& engine) -> cbdc::hash_t {
+        auto ret = cbdc::hash_t();
+        for(size_t i{0}; i < cbdc::hash_size / sizeof(uint64_t); i++) {
+            const auto val = engine();
+            std::memcpy(&ret[i * sizeof(val)], &val, sizeof(val));
+        }
+        return ret;
+    }
+
+    /// Batches of transactions for each thread to lock and apply, spending
+    /// outputs that were minted into the shard beforehand.
+    struct workload {
+        std::unique_ptr<cbdc::locking_shard::locking_shard> m_shard;
+        std::vector<std::vector<std::vector<cbdc::locking_shard::tx>>>
+            m_batches;
+        std::vector<std::vector<cbdc::hash_t>> m_dtx_ids;
+    };
+
+    auto make_workload(size_t threads) -> workload {
+        auto opts = cbdc::config::options();
+        opts.m_attestation_threshold = 0;
+        auto ret = workload();
+        ret.m_shard = std::make_unique<cbdc::locking_shard::locking_shard>(
+            std::make_pair(0, 255),
+            std::make_shared<cbdc::logging::log>(
+                cbdc::logging::log_level::warn),
+            completed_txs_cache_size,
+            "",
+            opts);
+
+        auto engine = std::mt19937_64();
+        auto mint = std::vector<cbdc::locking_shard::tx>();
+        ret.m_batches.resize(threads);
+        ret.m_dtx_ids.resize(threads);
+        for(size_t t{0}; t < threads; t++) {
+            for(size_t b{0}; b < batches_per_thread; b++) {
+                auto batch = std::vector<cbdc::locking_shard::tx>();
+                for(size_t i{0}; i < batch_size; i++) {
+                    auto tx = cbdc::locking_shard::tx();
+                    tx.m_tx.m_id = make_id(engine);
+                    for(size_t j{0}; j < inputs_per_tx; j++) {
+                        auto in = make_id(engine);
+                        auto m = cbdc::locking_shard::tx();
+                        m.m_tx.m_uhs_outputs.push_back(in);
+                        mint.push_back(std::move(m));
+                        tx.m_tx.m_inputs.push_back(in);
+                        tx.m_tx.m_uhs_outputs.push_back(make_id(engine));
+                    }
+                    batch.push_back(std::move(tx));
+                }
+                ret.m_batches[t].push_back(std::move(batch));
+                ret.m_dtx_ids[t].push_back(make_id(engine));
+            }
+        }
+
+        const auto mint_id = make_id(engine);
+        auto res = ret.m_shard->lock_outputs(std::move(mint), mint_id);
+        ret.m_shard->apply_outputs(std::move(res.value()), mint_id);
+        ret.m_shard->discard_dtx(mint_id);
+        return ret;
+    }
+}
+
+/// Locks, applies and discards non-conflicting dtxs against one shard from
+/// the given number of threads.
+static void locking_shard_throughput(benchmark::State& state) {
+    const auto threads = static_cast<size_t>(state.range(0));
+    for(auto _ : state) {
+        state.PauseTiming();
+        auto work = make_workload(threads);
+        state.ResumeTiming();
+
+        auto workers = std::vector<std::thread>();
+        for(size_t t{0}; t < threads; t++) {
+            workers.emplace_back([&, t]() {
+                for(size_t b{0}; b < batches_per_thread; b++) {
+                    const auto& dtx_id = work.m_dtx_ids[t][b];
+                    auto res
+                        = work.m_shard->lock_outputs(std::move(
+                                                         work.m_batches[t][b]),
+                                                     dtx_id);
+                    work.m_shard->apply_outputs(std::move(res.value()),
+                                                dtx_id);
+                    work.m_shard->discard_dtx(dtx_id);
+                }
+            });
+        }
+        for(auto& w : workers) {
+            w.join();
+        }
+
+        state.PauseTiming();
+        work.m_shard.reset();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations()
+                            * static_cast<int64_t>(threads * batches_per_thread
+                                                   * batch_size));
+}
+
+static constexpr auto max_threads = 16;
+
+BENCHMARK(locking_shard_throughput)
+    ->RangeMultiplier(2)
+    ->Range(1, max_threads)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
@@ -0,0 +1,271 @@
+// Copyright (c) 2021 MIT Digital Currency Initiative,
+//                    Federal Reserve Bank of Boston
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "util/network/peer.hpp"
+#include "util/network/reactor.hpp"
+#include "util/network/tcp_listener.hpp"
+
+#include <benchmark/benchmark.h>
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+    constexpr auto bench_port = cbdc::network::port_number_t{29855};
+
+    /// Unix domain socket address, in the abstract namespace so no file is
+    /// left behind.
+    const auto unix_addr
+        = std::string(cbdc::network::unix_scheme) + "@opencbdc_bench";
+
+    /// Size of each message, similar to a small RPC response.
+    constexpr size_t msg_size = 64;
+
+    /// Returns the value of the given counter from /proc/self/io.
+    auto io_counter(const std::string& name) -> uint64_t {
+        auto f = std::ifstream("/proc/self/io");
+        auto key = std::string();
+        uint64_t val{};
+        while(f >> key >> val) {
+            if(key == name + ":") {
+                return val;
+            }
+        }
+        return 0;
+    }
+
+    /// Returns the number of write system calls made by this process so
+    /// far.
+    auto write_syscalls() -> uint64_t {
+        return io_counter("syscw");
+    }
+
+    /// Returns the number of read system calls made by this process so
+    /// far.
+    auto read_syscalls() -> uint64_t {
+        return io_counter("syscr");
+    }
+
+    /// Number of bytes each message occupies on the wire.
+    constexpr size_t wire_size = sizeof(uint64_t) + msg_size;
+
+    /// Connected pair of blocking TCP or Unix domain sockets. Optionally
+    /// starts a thread which drains the server side and counts the bytes
+    /// received. The thread reads in large chunks rather than packet by
+    /// packet, so the sender is the bottleneck.
+    class socket_pair {
+      public:
+        explicit socket_pair(
+            bool drain = true,
+            const cbdc::network::ip_address& addr = cbdc::network::localhost) {
+            m_listener.listen(addr, bench_port);
+            m_client = std::make_unique<cbdc::network::tcp_socket>();
+            std::thread accept_thr([&]() {
+                m_listener.accept(m_server);
+            });
+            m_client->connect(addr, bench_port);
+            accept_thr.join();
+            if(!drain) {
+                return;
+            }
+            m_recv_thr = std::thread([&]() {
+                static constexpr size_t chunk_size = 1 << 16;
+                auto chunk = std::vector<std::byte>(chunk_size);
+                while(true) {
+                    auto n = m_server.read_some(chunk.data(), chunk.size());
+                    if(!n) {
+                        break;
+                    }
+                    std::unique_lock<std::mutex> l(m_mut);
+                    m_received += *n;
+                    m_cv.notify_one();
+                }
+            });
+        }
+
+        ~socket_pair() {
+            if(m_client) {
+                m_client->disconnect();
+            }
+            m_server.disconnect();
+            if(m_recv_thr.joinable()) {
+                m_recv_thr.join();
+            }
+            m_listener.close();
+        }
+
+        socket_pair(const socket_pair&) = delete;
+        auto operator=(const socket_pair&) -> socket_pair& = delete;
+        socket_pair(socket_pair&&) = delete;
+        auto operator=(socket_pair&&) -> socket_pair& = delete;
+
+        /// Waits until the server has received the given number of
+        /// messages in total.
+        void wait_for(uint64_t n) {
+            std::unique_lock<std::mutex> l(m_mut);
+            m_cv.wait(l, [&]() {
+                return m_received >= n * wire_size;
+            });
+        }
+
+        cbdc::network::tcp_listener m_listener;
+        cbdc::network::tcp_socket m_server;
+        std::unique_ptr<cbdc::network::tcp_socket> m_client;
+        std::mutex m_mut;
+        std::condition_variable m_cv;
+        uint64_t m_received{0};
+        std::thread m_recv_thr;
+    };
+
+    void report(benchmark::State& state, uint64_t syscalls, uint64_t msgs) {
+        state.counters["syscalls_per_msg"] = static_cast<double>(syscalls)
+                                           / static_cast<double>(msgs);
+        state.SetItemsProcessed(static_cast<int64_t>(msgs));
+    }
+}
+
+/// Sends small packets one at a time with a blocking tcp_socket, over TCP
+/// loopback if the argument is zero or a Unix domain socket otherwise.
+static void tcp_socket_send(benchmark::State& state) {
+    auto sp = state.range(0) == 0 ? socket_pair()
+                                  : socket_pair(true, unix_addr);
+    auto pkt = cbdc::buffer();
+    pkt.extend(msg_size);
+    uint64_t msgs{0};
+    const auto start = write_syscalls();
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(sp.m_client->send(pkt));
+        msgs++;
+    }
+    const auto syscalls = write_syscalls() - start;
+    sp.wait_for(msgs);
+    report(state, syscalls, msgs);
+}
+
+/// Queues bursts of small packets on a peer serviced by a reactor from
+/// one or more threads, and waits for each burst to arrive.
+static void peer_send_burst(benchmark::State& state) {
+    auto sp = socket_pair();
+    auto r = cbdc::network::reactor();
+    r.start(1);
+    auto p = cbdc::network::peer(
+        std::move(sp.m_client),
+        r,
+        [](std::shared_ptr<cbdc::buffer> /* pkt */) {},
+        []() {},
+        false);
+    const auto burst = static_cast<uint64_t>(state.range(0));
+    const auto n_threads = static_cast<uint64_t>(state.range(1));
+    auto pkt = std::make_shared<cbdc::buffer>();
+    pkt->extend(msg_size);
+    uint64_t msgs{0};
+    const auto start = write_syscalls();
+    for(auto _ : state) {
+        auto threads = std::vector<std::thread>();
+        for(uint64_t t{0}; t < n_threads; t++) {
+            threads.emplace_back([&]() {
+                for(uint64_t i{0}; i < burst / n_threads; i++) {
+                    p.send(pkt);
+                }
+            });
+        }
+        for(auto& t : threads) {
+            t.join();
+        }
+        msgs += burst / n_threads * n_threads;
+        sp.wait_for(msgs);
+    }
+    const auto syscalls = write_syscalls() - start;
+    report(state, syscalls, msgs);
+    p.shutdown();
+}
+
+/// Sends small packets one at a time and waits for each to be echoed back,
+/// over TCP loopback if the argument is zero or a Unix domain socket
+/// otherwise.
+static void tcp_socket_round_trip(benchmark::State& state) {
+    auto sp = state.range(0) == 0 ? socket_pair(false)
+                                  : socket_pair(false, unix_addr);
+    auto echo_thr = std::thread([&]() {
+        auto pkt = cbdc::buffer();
+        while(sp.m_server.receive(pkt)) {
+            if(!sp.m_server.send(pkt)) {
+                return;
+            }
+        }
+    });
+    auto pkt = cbdc::buffer();
+    pkt.extend(msg_size);
+    auto resp = cbdc::buffer();
+    for(auto _ : state) {
+        if(!sp.m_client->send(pkt) || !sp.m_client->receive(resp)) {
+            state.SkipWithError("round trip failed");
+            break;
+        }
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+    sp.m_client->disconnect();
+    sp.m_server.disconnect();
+    echo_thr.join();
+}
+
+/// Receives packets of the given size with a blocking tcp_socket while
+/// another thread writes them as fast as possible.
+static void tcp_socket_receive(benchmark::State& state) {
+    auto sp = socket_pair(false);
+    const auto pkt_size = static_cast<size_t>(state.range(0));
+
+    // Write many small packets per system call so the sender keeps up.
+    static constexpr size_t min_batch_size = 64 * 1024;
+    auto batch = cbdc::buffer();
+    do {
+        const auto sz = static_cast<uint64_t>(pkt_size);
+        batch.append(&sz, sizeof(sz));
+        batch.extend(pkt_size);
+    } while(batch.size() < min_batch_size);
+
+    auto send_thr = std::thread([&]() {
+        while(true) {
+            size_t written{0};
+            while(written < batch.size()) {
+                auto n = sp.m_server.write_some(batch.data_at(written),
+                                                batch.size() - written);
+                if(!n || *n == 0) {
+                    return;
+                }
+                written += *n;
+            }
+        }
+    });
+
+    auto pkt = cbdc::buffer();
+    uint64_t msgs{0};
+    const auto start = read_syscalls();
+    for(auto _ : state) {
+        if(!sp.m_client->receive(pkt)) {
+            state.SkipWithError("receive failed");
+            break;
+        }
+        msgs++;
+    }
+    const auto syscalls = read_syscalls() - start;
+    state.counters["syscalls_per_msg"] = static_cast<double>(syscalls)
+                                       / static_cast<double>(msgs);
+    state.SetBytesProcessed(static_cast<int64_t>(msgs * pkt_size));
+    sp.m_client->disconnect();
+    sp.m_server.disconnect();
+    send_thr.join();
+}
+
+BENCHMARK(tcp_socket_send)->Arg(0)->Arg(1);
+BENCHMARK(tcp_socket_round_trip)->Arg(0)->Arg(1)->UseRealTime();
+BENCHMARK(tcp_socket_receive)->Arg(64)->Arg(1024 * 1024);
+BENCHMARK(peer_send_burst)
+    ->Args({1, 1})
+    ->Args({1024, 1})
+    ->Args({1024, 4})
+    ->UseRealTime();
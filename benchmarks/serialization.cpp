@@ -0,0 +1,111 @@
+// Copyright (c) 2021 MIT Digital Currency Initiative,
+//                    Federal Reserve Bank of Boston
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "uhs/transaction/messages.hpp"
+#include "uhs/transaction/transaction.hpp"
+#include "util/serialization/buffer_serializer.hpp"
+#include "util/serialization/format.hpp"
+#include "util/serialization/util.hpp"
+
+#include <benchmark/benchmark.h>
+#include <random>
+
+namespace {
+    auto make_id(std::mt19937_64& engine) -> cbdc::hash_t {
+        auto ret = cbdc::hash_t();
+        for(size_t i{0}; i < cbdc::hash_size / sizeof(uint64_t); i++) {
+            const auto val = engine();
+            std::memcpy(&ret[i * sizeof(val)], &val, sizeof(val));
+        }
+        return ret;
+    }
+
+    /// Generates a batch of compact transactions with two inputs and two
+    /// outputs each, similar to the contents of a block.
+    auto make_batch(size_t count)
+        -> std::vector<cbdc::transaction::compact_tx> {
+        auto engine = std::mt19937_64(0);
+        auto ret = std::vector<cbdc::transaction::compact_tx>(count);
+        for(auto& tx : ret) {
+            tx.m_id = make_id(engine);
+            for(size_t i{0}; i < 2; i++) {
+                tx.m_inputs.push_back(make_id(engine));
+                tx.m_uhs_outputs.push_back(make_id(engine));
+            }
+        }
+        return ret;
+    }
+}
+
+/// Calculates the serialized size of a batch of compact transactions.
+static void compact_batch_size(benchmark::State& state) {
+    const auto batch = make_batch(static_cast<size_t>(state.range(0)));
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(cbdc::serialized_size(batch));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+/// Serializes a batch of compact transactions into a new buffer.
+static void compact_batch_serialize(benchmark::State& state) {
+    const auto batch = make_batch(static_cast<size_t>(state.range(0)));
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(cbdc::make_buffer(batch));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+/// Serializes a single compact transaction into a new shared buffer, as
+/// when sending a message to a peer.
+static void compact_tx_shared_buffer(benchmark::State& state) {
+    const auto tx = make_batch(1).front();
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(cbdc::make_shared_buffer(tx));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+/// Deserializes a batch of compact transactions from a buffer.
+static void compact_batch_deserialize(benchmark::State& state) {
+    auto buf = cbdc::make_buffer(
+        make_batch(static_cast<size_t>(state.range(0))));
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(
+            cbdc::from_buffer<std::vector<cbdc::transaction::compact_tx>>(
+                buf));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+/// Serializes a block-sized batch of compact transactions, preceded by a
+/// block height, in the wire format given by the second argument. Reports
+/// the encoded size per transaction to compare the bandwidth of each format.
+static void compact_batch_wire_format(benchmark::State& state) {
+    const auto batch = make_batch(static_cast<size_t>(state.range(0)));
+    const auto fmt = static_cast<cbdc::wire_format>(state.range(1));
+    static constexpr uint64_t height = 1000000;
+    auto buf = cbdc::buffer();
+    auto ser = cbdc::buffer_serializer(buf);
+    ser.set_wire_format(fmt);
+    for(auto _ : state) {
+        buf.clear();
+        ser.reset();
+        cbdc::write_varint(ser, height) << batch;
+        benchmark::DoNotOptimize(buf.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.SetBytesProcessed(state.iterations()
+                            * static_cast<int64_t>(buf.size()));
+    state.counters["bytes_per_tx"]
+        = static_cast<double>(buf.size()) / static_cast<double>(batch.size());
+}
+
+BENCHMARK(compact_batch_size)->Arg(1000);
+BENCHMARK(compact_batch_serialize)->Arg(1000);
+BENCHMARK(compact_batch_deserialize)->Arg(1000);
+BENCHMARK(compact_tx_shared_buffer);
+BENCHMARK(compact_batch_wire_format)
+    ->Args({1000, static_cast<int64_t>(cbdc::wire_format::fixed)})
+    ->Args({1000, static_cast<int64_t>(cbdc::wire_format::compact)});
@@ -0,0 +1,155 @@
+// Copyright (c) 2021 MIT Digital Currency Initiative,
+//                    Federal Reserve Bank of Boston
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "crypto/sha256.h"
+#include "uhs/transaction/messages.hpp"
+#include "uhs/transaction/transaction.hpp"
+#include "util/serialization/util.hpp"
+
+#include <benchmark/benchmark.h>
+#include <random>
+
+namespace {
+    /// Selects the fastest SHA256 implementation, as the daemons do on
+    /// startup.
+    const auto sha2_impl = SHA256AutoDetect();
+
+    auto make_id(std::mt19937_64& engine) -> cbdc::hash_t {
+        auto ret = cbdc::hash_t();
+        for(size_t i{0}; i < cbdc::hash_size / sizeof(uint64_t); i++) {
+            const auto val = engine();
+            std::memcpy(&ret[i * sizeof(val)], &val, sizeof(val));
+        }
+        return ret;
+    }
+
+    /// Generates a transaction with the given number of inputs and outputs.
+    auto make_tx(size_t count, uint64_t seed = 0)
+        -> cbdc::transaction::full_tx {
+        auto engine = std::mt19937_64(seed);
+        auto ret = cbdc::transaction::full_tx();
+        for(size_t i{0}; i < count; i++) {
+            auto inp = cbdc::transaction::input();
+            inp.m_prevout.m_tx_id = make_id(engine);
+            inp.m_prevout.m_index = i;
+            inp.m_prevout_data.m_witness_program_commitment = make_id(engine);
+            inp.m_prevout_data.m_value = engine();
+            ret.m_inputs.push_back(inp);
+
+            auto out = cbdc::transaction::output();
+            out.m_witness_program_commitment = make_id(engine);
+            out.m_value = engine();
+            ret.m_outputs.push_back(out);
+        }
+        return ret;
+    }
+
+    auto hash_buffer(const cbdc::buffer& buf) -> cbdc::hash_t {
+        auto sha = CSHA256();
+        sha.Write(buf.c_ptr(), buf.size());
+        auto ret = cbdc::hash_t();
+        sha.Finalize(ret.data());
+        return ret;
+    }
+}
+
+/// Calculates the transaction ID by serializing the inputs and outputs into
+/// temporary buffers, as before \ref cbdc::sha256_serializer.
+static void buffered_tx_id(benchmark::State& state) {
+    const auto tx = make_tx(static_cast<size_t>(state.range(0)));
+    for(auto _ : state) {
+        auto sha = CSHA256();
+        auto inp_buf = cbdc::make_buffer(tx.m_inputs);
+        sha.Write(inp_buf.c_ptr(), inp_buf.size());
+        auto out_buf = cbdc::make_buffer(tx.m_outputs);
+        sha.Write(out_buf.c_ptr(), out_buf.size());
+        auto ret = cbdc::hash_t();
+        sha.Finalize(ret.data());
+        benchmark::DoNotOptimize(ret);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void tx_id(benchmark::State& state) {
+    const auto tx = make_tx(static_cast<size_t>(state.range(0)));
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(cbdc::transaction::tx_id(tx));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+/// Calculates the compact transaction hash by copying the transaction and
+/// serializing the copy into a temporary buffer, as before
+/// \ref cbdc::sha256_serializer.
+static void buffered_compact_tx_hash(benchmark::State& state) {
+    const auto ctx = cbdc::transaction::compact_tx(
+        make_tx(static_cast<size_t>(state.range(0))));
+    for(auto _ : state) {
+        auto copy = ctx;
+        copy.m_attestations.clear();
+        benchmark::DoNotOptimize(hash_buffer(cbdc::make_buffer(copy)));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void compact_tx_hash(benchmark::State& state) {
+    const auto ctx = cbdc::transaction::compact_tx(
+        make_tx(static_cast<size_t>(state.range(0))));
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(ctx.hash());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+/// Builds the compact transaction, hashing every input and output.
+static void compact_tx_build(benchmark::State& state) {
+    const auto tx = make_tx(static_cast<size_t>(state.range(0)));
+    const auto id = cbdc::transaction::tx_id(tx);
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(cbdc::transaction::compact_tx(tx, id));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+/// Builds the compact form of a batch of two-input, two-output
+/// transactions one at a time.
+static void compact_tx_build_serial(benchmark::State& state) {
+    auto txs = std::vector<cbdc::transaction::full_tx>();
+    for(int64_t i{0}; i < state.range(0); i++) {
+        txs.push_back(make_tx(2, static_cast<uint64_t>(i)));
+    }
+    for(auto _ : state) {
+        for(const auto& tx : txs) {
+            benchmark::DoNotOptimize(cbdc::transaction::compact_tx(tx));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+/// Builds the compact form of the same batch with the multi-buffer batch
+/// builder.
+static void compact_tx_build_batch(benchmark::State& state) {
+    auto txs = std::vector<cbdc::transaction::full_tx>();
+    for(int64_t i{0}; i < state.range(0); i++) {
+        txs.push_back(make_tx(2, static_cast<uint64_t>(i)));
+    }
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(cbdc::transaction::make_compact_txs(txs));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static constexpr auto min_io = 1;
+static constexpr auto max_io = 64;
+static constexpr auto min_batch = 8;
+static constexpr auto max_batch = 1024;
+
+BENCHMARK(buffered_tx_id)->Range(min_io, max_io);
+BENCHMARK(tx_id)->Range(min_io, max_io);
+BENCHMARK(buffered_compact_tx_hash)->Range(min_io, max_io);
+BENCHMARK(compact_tx_hash)->Range(min_io, max_io);
+BENCHMARK(compact_tx_build)->Range(min_io, max_io);
+BENCHMARK(compact_tx_build_serial)->Range(min_batch, max_batch);
+BENCHMARK(compact_tx_build_batch)->Range(min_batch, max_batch);
@@ -24,12 +24,12 @@ if [[ "$OSTYPE" == "linux-gnu"* ]]; then
   CPUS=$(grep -c ^processor /proc/cpuinfo)
   if [ -f "/etc/arch-release" ]; then
     pacman -Syu
-    pacman -S wget cmake gtest lcov git rsync gcc make snappy llvm
+    pacman -S wget cmake gtest benchmark lcov git rsync gcc make snappy llvm
     $SUDO ln -s -f $(which clang-format) /usr/local/bin/clang-format
     $SUDO ln -s -f $(which clang-tidy) /usr/local/bin/clang-tidy
   else
     apt update
-    apt install -y build-essential wget cmake libgtest-dev lcov git software-properties-common rsync libsnappy-dev
+    apt install -y build-essential wget cmake libgtest-dev libbenchmark-dev lcov git software-properties-common rsync libsnappy-dev
     wget -O - https://apt.llvm.org/llvm-snapshot.gpg.key | $SUDO apt-key add -
     $SUDO add-apt-repository "deb http://apt.llvm.org/focal/ llvm-toolchain-focal-14 main"
     $SUDO apt install -y clang-format-14 clang-tidy-14
@@ -40,7 +40,7 @@ elif [[ "$OSTYPE" == "darwin"* ]]; then
   CPUS=$(sysctl -n hw.ncpu)
   # ensure development environment is set correctly for clang
   $SUDO xcode-select -switch /Library/Developer/CommandLineTools
-  brew install llvm@14 googletest lcov make wget cmake snappy
+  brew install llvm@14 googletest google-benchmark lcov make wget cmake snappy
   CLANG_TIDY=/usr/local/bin/clang-tidy
   if [ ! -L "$CLANG_TIDY" ]; then
     $SUDO ln -s $(brew --prefix)/opt/llvm@14/bin/clang-tidy /usr/local/bin/clang-tidy
@@ -120,7 +120,8 @@ namespace cbdc::archiver {
             m_opts.m_archiver_endpoints[m_archiver_id],
             [&](auto&& pkt) {
                 return server_handler(std::forward<decltype(pkt)>(pkt));
-            });
+            },
+            m_opts.m_handler_threads);
 
         if(!as.has_value()) {
             m_logger->error("Failed to establish shard server.");
@@ -149,7 +150,8 @@ namespace cbdc::archiver {
 
     auto controller::atomizer_handler(cbdc::network::message_t&& pkt)
         -> std::optional<cbdc::buffer> {
-        auto blk = from_buffer<atomizer::block>(*pkt.m_pkt);
+        auto blk = from_buffer<atomizer::block>(*pkt.m_pkt,
+                                                m_opts.m_wire_format);
         if(!blk.has_value()) {
             m_logger->error("Invalid request packet");
             return std::nullopt;
@@ -278,7 +280,8 @@ namespace cbdc::archiver {
     void controller::request_block(uint64_t height) {
         m_logger->trace("Requesting block", height);
         auto req = atomizer::get_block_request{height};
-        auto pkt = make_shared_buffer(atomizer::request{req});
+        auto pkt = make_shared_buffer(atomizer::request{req},
+                                      m_opts.m_wire_format);
         if(!m_atomizer_network.send_to_one(pkt)) {
             m_logger->error("Failed to request block", height);
         }
@@ -287,7 +290,8 @@ namespace cbdc::archiver {
     void controller::request_prune(uint64_t height) {
         m_logger->trace("Requesting prune h <", height);
         auto req = atomizer::prune_request{height};
-        auto pkt = make_shared_buffer(atomizer::request{req});
+        auto pkt = make_shared_buffer(atomizer::request{req},
+                                      m_opts.m_wire_format);
         if(!m_atomizer_network.send_to_one(pkt)) {
             m_logger->error("Failed to request prune", height);
         }
@@ -11,6 +11,8 @@
 #include "util/raft/util.hpp"
 #include "util/serialization/util.hpp"
 
+#include <algorithm>
+
 namespace cbdc::atomizer {
     atomizer_raft::atomizer_raft(
         uint32_t atomizer_id,
@@ -30,7 +32,11 @@ namespace cbdc::atomizer {
                logger,
                std::move(raft_callback)),
           m_log(std::move(logger)),
-          m_opts(std::move(opts)) {}
+          m_opts(std::move(opts)),
+          // The thread calling tx_notify verifies a share of each batch
+          // alongside the pool workers.
+          m_verify_pool(std::max(std::thread::hardware_concurrency(), 1U)
+                        - 1) {}
 
     auto atomizer_raft::get_sm() -> state_machine* {
         // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
@@ -52,16 +58,30 @@ namespace cbdc::atomizer {
         return get_sm()->tx_notify_count();
     }
 
-    void atomizer_raft::tx_notify(tx_notify_request&& notif) {
-        if(!transaction::validation::check_attestations(
-               notif.m_tx,
-               m_opts.m_sentinel_public_keys,
-               m_opts.m_attestation_threshold)) {
-            m_log->warn("Received invalid compact transaction",
-                        to_string(notif.m_tx.m_id));
-            return;
+    void atomizer_raft::tx_notify(std::vector<tx_notify_request>&& notifs) {
+        using tx_ref = std::reference_wrapper<const transaction::compact_tx>;
+        auto txs = std::vector<tx_ref>();
+        txs.reserve(notifs.size());
+        for(const auto& notif : notifs) {
+            txs.emplace_back(notif.m_tx);
         }
+        auto attested = transaction::validation::check_attestations(
+            txs,
+            m_opts.m_sentinel_public_keys,
+            m_opts.m_attestation_threshold,
+            m_verify_pool);
+
+        for(size_t i{0}; i < notifs.size(); i++) {
+            if(!attested[i]) {
+                m_log->warn("Received invalid compact transaction",
+                            to_string(notifs[i].m_tx.m_id));
+                continue;
+            }
+            add_notification(std::move(notifs[i]));
+        }
+    }
 
+    void atomizer_raft::add_notification(tx_notify_request&& notif) {
         auto maybe_tx = [&]() -> std::optional<decltype(m_txs)::node_type> {
             std::unique_lock l(m_txs_mut);
             auto it = m_txs.find(notif.m_tx);
@@ -10,6 +10,7 @@
 #include "state_machine.hpp"
 #include "util/network/connection_manager.hpp"
 #include "util/raft/node.hpp"
+#include "util/common/thread_pool.hpp"
 #include "util/raft/state_manager.hpp"
 
 namespace cbdc::atomizer {
@@ -53,13 +54,15 @@ namespace cbdc::atomizer {
         /// \return number of transaction notifications.
         [[nodiscard]] auto tx_notify_count() -> uint64_t;
 
-        /// Add the given transaction notification to the set of pending
-        /// notifications. If the notification can be combined with previously
+        /// Add the given transaction notifications to the set of pending
+        /// notifications. If a notification can be combined with previously
         /// received notifications to create an aggregate notification with a
         /// full set of input attestations, create an aggregate notification
-        /// and add it to a list of complete transactions.
-        /// \param notif transaction notification.
-        void tx_notify(tx_notify_request&& notif);
+        /// and add it to a list of complete transactions. Verifies the
+        /// sentinel attestations of the whole batch together, and drops the
+        /// notifications whose transaction is not attested.
+        /// \param notifs transaction notifications.
+        void tx_notify(std::vector<tx_notify_request>&& notifs);
 
         /// Replicate a transaction notification command in the state machine
         /// containing the current set of complete transactions.
@@ -96,6 +99,12 @@ namespace cbdc::atomizer {
         config::options m_opts;
 
         std::mutex m_txs_mut;
+
+        /// Verifies the sentinel attestations of notification batches.
+        thread_pool m_verify_pool;
+
+        /// Adds an attested transaction notification to the pending set.
+        void add_notification(tx_notify_request&& notif);
     };
 }
 
@@ -0,0 +1,114 @@
+// Copyright (c) 2021 MIT Digital Currency Initiative,
+//                    Federal Reserve Bank of Boston
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "block_view.hpp"
+
+#include "util/serialization/format.hpp"
+
+namespace cbdc::atomizer {
+    block_view::iterator::iterator(const unsigned char* pos,
+                                   const unsigned char* end,
+                                   wire_format fmt)
+        : m_pos(pos),
+          m_end(end),
+          m_format(fmt) {
+        if(m_pos != m_end) {
+            m_tx = transaction::compact_tx_view::parse(
+                m_pos,
+                static_cast<size_t>(m_end - m_pos),
+                m_format);
+            assert(m_tx.has_value());
+        }
+    }
+
+    auto block_view::iterator::operator*() const
+        -> const transaction::compact_tx_view& {
+        return *m_tx;
+    }
+
+    auto block_view::iterator::operator->() const
+        -> const transaction::compact_tx_view* {
+        return &*m_tx;
+    }
+
+    auto block_view::iterator::operator++() -> iterator& {
+        *this = iterator(m_pos + m_tx->size(), m_end, m_format);
+        return *this;
+    }
+
+    auto block_view::iterator::operator++(int) -> iterator {
+        auto ret = *this;
+        ++(*this);
+        return ret;
+    }
+
+    auto block_view::iterator::operator==(const iterator& rhs) const -> bool {
+        return m_pos == rhs.m_pos;
+    }
+
+    auto block_view::iterator::operator!=(const iterator& rhs) const -> bool {
+        return m_pos != rhs.m_pos;
+    }
+
+    auto block_view::parse(const buffer& buf, wire_format fmt)
+        -> std::optional<block_view> {
+        auto ret = block_view();
+        ret.m_format = fmt;
+        const auto* pos = buf.c_ptr();
+        const auto* buf_end = buf.c_ptr() + buf.size();
+        auto n = decode_varint(pos, buf.size(), fmt, ret.m_height);
+        if(n == 0) {
+            return std::nullopt;
+        }
+        pos += n;
+        uint64_t count{};
+        n = decode_varint(pos, static_cast<size_t>(buf_end - pos), fmt, count);
+        if(n == 0) {
+            return std::nullopt;
+        }
+        pos += n;
+
+        ret.m_begin = pos;
+        for(uint64_t i{0}; i < count; i++) {
+            auto tx = transaction::compact_tx_view::parse(
+                pos,
+                static_cast<size_t>(buf_end - pos),
+                fmt);
+            if(!tx) {
+                return std::nullopt;
+            }
+            pos += tx->size();
+        }
+        ret.m_count = static_cast<size_t>(count);
+        ret.m_end = pos;
+        return ret;
+    }
+
+    auto block_view::height() const -> uint64_t {
+        return m_height;
+    }
+
+    auto block_view::size() const -> size_t {
+        return m_count;
+    }
+
+    auto block_view::begin() const -> iterator {
+        return {m_begin, m_end, m_format};
+    }
+
+    auto block_view::end() const -> iterator {
+        return {m_end, m_end, m_format};
+    }
+
+    auto block_view::to_block() const -> block {
+        auto ret = block();
+        ret.m_height = m_height;
+        ret.m_transactions.reserve(m_count);
+        for(const auto& tx : *this) {
+            ret.m_transactions.push_back(tx.to_compact_tx());
+        }
+        return ret;
+    }
+}
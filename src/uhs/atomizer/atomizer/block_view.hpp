@@ -0,0 +1,91 @@
+// Copyright (c) 2021 MIT Digital Currency Initiative,
+//                    Federal Reserve Bank of Boston
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef OPENCBDC_TX_SRC_ATOMIZER_BLOCK_VIEW_H_
+#define OPENCBDC_TX_SRC_ATOMIZER_BLOCK_VIEW_H_
+
+#include "block.hpp"
+#include "uhs/transaction/compact_tx_view.hpp"
+
+#include <iterator>
+#include <optional>
+
+namespace cbdc::atomizer {
+    /// \brief Read-only view of a serialized \ref block.
+    ///
+    /// Validates the serialized block once, then iterates over the
+    /// transactions as \ref transaction::compact_tx_view without
+    /// allocating. The view refers to the serialized bytes, which must
+    /// outlive it.
+    class block_view {
+      public:
+        /// Iterator over the transactions in the block.
+        class iterator {
+          public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = transaction::compact_tx_view;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const transaction::compact_tx_view*;
+            using reference = const transaction::compact_tx_view&;
+
+            /// Constructor.
+            /// \param pos pointer to the serialized transaction.
+            /// \param end pointer to the end of the last transaction.
+            /// \param fmt wire format the block was serialized with.
+            iterator(const unsigned char* pos,
+                     const unsigned char* end,
+                     wire_format fmt);
+
+            auto operator*() const -> const transaction::compact_tx_view&;
+            auto operator->() const -> const transaction::compact_tx_view*;
+            auto operator++() -> iterator&;
+            auto operator++(int) -> iterator;
+            auto operator==(const iterator& rhs) const -> bool;
+            auto operator!=(const iterator& rhs) const -> bool;
+
+          private:
+            const unsigned char* m_pos;
+            const unsigned char* m_end;
+            wire_format m_format;
+            std::optional<transaction::compact_tx_view> m_tx;
+        };
+
+        /// Parses the serialized block in the given buffer and checks every
+        /// transaction is well-formed.
+        /// \param buf buffer containing a serialized block.
+        /// \param fmt wire format the block was serialized with.
+        /// \return view of the block, or std::nullopt if the buffer does not
+        ///         contain a well-formed block.
+        static auto parse(const buffer& buf,
+                          wire_format fmt = wire_format::fixed)
+            -> std::optional<block_view>;
+
+        /// Returns the height of the block.
+        /// \return height, as in \ref block::m_height.
+        [[nodiscard]] auto height() const -> uint64_t;
+
+        /// Returns the number of transactions in the block.
+        /// \return transaction count.
+        [[nodiscard]] auto size() const -> size_t;
+
+        [[nodiscard]] auto begin() const -> iterator;
+        [[nodiscard]] auto end() const -> iterator;
+
+        /// Copies the viewed block into a new block.
+        /// \return materialized block.
+        [[nodiscard]] auto to_block() const -> block;
+
+      private:
+        block_view() = default;
+
+        uint64_t m_height{0};
+        size_t m_count{0};
+        const unsigned char* m_begin{nullptr};
+        const unsigned char* m_end{nullptr};
+        wire_format m_format{wire_format::fixed};
+    };
+}
+
+#endif // OPENCBDC_TX_SRC_ATOMIZER_BLOCK_VIEW_H_
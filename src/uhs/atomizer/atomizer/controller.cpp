@@ -58,6 +58,8 @@ namespace cbdc::atomizer {
     }
 
     auto controller::init() -> bool {
+        m_atomizer_network.set_send_queue_limits(m_opts.m_send_queue_limits);
+        m_watchtower_network.set_send_queue_limits(m_opts.m_send_queue_limits);
         if(!m_watchtower_network.cluster_connect(
                m_opts.m_watchtower_internal_endpoints)) {
             m_logger->warn("Failed to connect to watchtowers.");
@@ -105,7 +107,8 @@ namespace cbdc::atomizer {
             return std::nullopt;
         }
 
-        auto maybe_req = from_buffer<request>(*pkt.m_pkt);
+        auto maybe_req = from_buffer<request>(*pkt.m_pkt,
+                                              m_opts.m_wire_format);
         if(!maybe_req.has_value()) {
             m_logger->error("Invalid request packet");
             return std::nullopt;
@@ -146,7 +149,9 @@ namespace cbdc::atomizer {
                             maybe_resp.value()));
                         auto& resp
                             = std::get<get_block_response>(maybe_resp.value());
-                        m_atomizer_network.send(resp.m_blk, peer_id);
+                        m_atomizer_network.send(resp.m_blk,
+                                                peer_id,
+                                                m_opts.m_wire_format);
                     };
                     m_raft_node.make_request(g, result_fn);
                 }},
@@ -208,9 +213,23 @@ namespace cbdc::atomizer {
             std::holds_alternative<make_block_response>(maybe_resp.value()));
         auto& resp = std::get<make_block_response>(maybe_resp.value());
 
-        auto blk_pkt = make_shared_buffer(resp.m_blk);
-
-        m_atomizer_network.broadcast(blk_pkt);
+        auto blk_pkt = make_shared_buffer(resp.m_blk, m_opts.m_wire_format);
+
+        const auto sent = m_atomizer_network.broadcast(blk_pkt);
+        const auto peers = m_atomizer_network.peer_count();
+        if(sent < peers) {
+            const auto stats = m_atomizer_network.get_send_queue_stats();
+            m_logger->warn("Block h:",
+                           resp.m_blk.m_height,
+                           "sent to",
+                           sent,
+                           "of",
+                           peers,
+                           "shards, queued:",
+                           stats.m_messages,
+                           ", dropped:",
+                           stats.m_dropped);
+        }
 
         m_logger->info("Block h:",
                        resp.m_blk.m_height,
@@ -222,7 +241,7 @@ namespace cbdc::atomizer {
                        m_raft_node.tx_notify_count());
 
         if(!resp.m_errs.empty()) {
-            auto buf = make_shared_buffer(resp.m_errs);
+            auto buf = make_shared_buffer(resp.m_errs, m_opts.m_wire_format);
             m_watchtower_network.broadcast(buf);
         }
     }
@@ -240,7 +259,7 @@ namespace cbdc::atomizer {
             assert(maybe_resp.has_value());
             assert(std::holds_alternative<errors>(maybe_resp.value()));
             auto& resp = std::get<errors>(maybe_resp.value());
-            m_watchtower_network.broadcast(resp);
+            m_watchtower_network.broadcast(resp, m_opts.m_wire_format);
         }
     }
 
@@ -270,7 +289,8 @@ namespace cbdc::atomizer {
                 m_opts.m_atomizer_endpoints[m_atomizer_id],
                 [&](auto&& pkt) {
                     return server_handler(std::forward<decltype(pkt)>(pkt));
-                });
+                },
+                m_opts.m_handler_threads);
 
             if(!as.has_value()) {
                 m_logger->fatal("Failed to establish atomizer server.");
@@ -282,13 +302,16 @@ namespace cbdc::atomizer {
     }
 
     void controller::notification_consumer() {
+        // Take whatever notifications are queued, up to a limit, so their
+        // attestations are verified as a batch
+        static constexpr size_t max_batch_size{1000};
         while(m_running) {
-            auto notif = tx_notify_request();
-            auto popped = m_notification_queue.pop(notif);
+            auto notifs = std::vector<tx_notify_request>();
+            auto popped = m_notification_queue.pop_all(notifs, max_batch_size);
             if(!popped) {
                 break;
             }
-            m_raft_node.tx_notify(std::move(notif));
+            m_raft_node.tx_notify(std::move(notifs));
         }
     }
 }
@@ -8,6 +8,7 @@
 
 #include "atomizer_raft.hpp"
 #include "uhs/atomizer/atomizer/block.hpp"
+#include "util/common/blocking_queue.hpp"
 #include "util/common/config.hpp"
 #include "util/network/connection_manager.hpp"
 
@@ -13,12 +13,12 @@
 namespace cbdc {
     auto operator<<(serializer& packet, const cbdc::atomizer::block& blk)
         -> serializer& {
-        return packet << blk.m_height << blk.m_transactions;
+        return write_varint(packet, blk.m_height) << blk.m_transactions;
     }
 
     auto operator>>(serializer& packet, cbdc::atomizer::block& blk)
         -> serializer& {
-        return packet >> blk.m_height >> blk.m_transactions;
+        return read_varint(packet, blk.m_height) >> blk.m_transactions;
     }
 
     auto operator<<(serializer& ser,
@@ -50,13 +50,28 @@ namespace cbdc {
     auto operator<<(serializer& packet,
                     const cbdc::atomizer::tx_notify_request& msg)
         -> serializer& {
-        packet << msg.m_block_height << msg.m_tx << msg.m_attestations;
+        write_varint(packet, msg.m_block_height) << msg.m_tx;
+        write_varint(packet, static_cast<uint64_t>(msg.m_attestations.size()));
+        for(auto idx : msg.m_attestations) {
+            write_varint(packet, idx);
+        }
         return packet;
     }
 
     auto operator>>(serializer& packet, cbdc::atomizer::tx_notify_request& msg)
         -> serializer& {
-        packet >> msg.m_block_height >> msg.m_tx >> msg.m_attestations;
+        read_varint(packet, msg.m_block_height) >> msg.m_tx;
+        uint64_t count{};
+        if(!read_varint(packet, count)) {
+            return packet;
+        }
+        for(uint64_t i{0}; i < count; i++) {
+            uint64_t idx{};
+            if(!read_varint(packet, idx)) {
+                return packet;
+            }
+            msg.m_attestations.insert(idx);
+        }
         return packet;
     }
 
@@ -88,11 +103,11 @@ namespace cbdc {
 
     auto operator<<(serializer& ser, const atomizer::prune_request& r)
         -> serializer& {
-        return ser << r.m_block_height;
+        return write_varint(ser, r.m_block_height);
     }
     auto operator>>(serializer& deser, atomizer::prune_request& r)
         -> serializer& {
-        return deser >> r.m_block_height;
+        return read_varint(deser, r.m_block_height);
     }
 
     auto operator<<(serializer& ser,
@@ -107,11 +122,11 @@ namespace cbdc {
 
     auto operator<<(serializer& ser, const atomizer::get_block_request& r)
         -> serializer& {
-        return ser << r.m_block_height;
+        return write_varint(ser, r.m_block_height);
     }
     auto operator>>(serializer& deser, atomizer::get_block_request& r)
         -> serializer& {
-        return deser >> r.m_block_height;
+        return read_varint(deser, r.m_block_height);
     }
 
     auto operator<<(serializer& ser, const atomizer::make_block_response& r)
@@ -85,30 +85,28 @@ namespace cbdc::sentinel {
 
     auto controller::execute_transaction(transaction::full_tx tx)
         -> std::optional<cbdc::sentinel::execute_response> {
-        const auto res = transaction::validation::check_tx(tx);
+        auto res = transaction::validation::validate_tx(tx);
         tx_status status{tx_status::pending};
-        if(res.has_value()) {
+        if(res.m_error.has_value()) {
             status = tx_status::static_invalid;
         }
 
-        auto tx_id = transaction::tx_id(tx);
-
-        if(!res.has_value()) {
-            m_logger->debug("Accepted tx:", cbdc::to_string(tx_id));
+        if(!res.m_error.has_value()) {
+            m_logger->debug("Accepted tx:", cbdc::to_string(res.m_tx.m_id));
         } else {
-            m_logger->debug("Rejected tx:", cbdc::to_string(tx_id));
+            m_logger->debug("Rejected tx:", cbdc::to_string(res.m_tx.m_id));
         }
 
         // Only forward transactions that are valid
-        if(!res.has_value()) {
-            send_transaction(tx);
+        if(!res.m_error.has_value()) {
+            send_transaction(tx, std::move(res.m_tx));
         }
 
-        return execute_response{status, res};
+        return execute_response{status, res.m_error};
     }
 
-    void controller::send_transaction(const transaction::full_tx& tx) {
-        auto compact_tx = cbdc::transaction::compact_tx(tx);
+    void controller::send_transaction(const transaction::full_tx& tx,
+                                      transaction::compact_tx compact_tx) {
         auto attestation = compact_tx.sign(m_secp.get(), m_privkey);
         compact_tx.m_attestations.insert(attestation);
 
@@ -117,12 +115,11 @@ namespace cbdc::sentinel {
 
     auto controller::validate_transaction(transaction::full_tx tx)
         -> std::optional<validate_response> {
-        const auto res = transaction::validation::check_tx(tx);
-        if(res.has_value()) {
+        const auto res = transaction::validation::validate_tx(tx);
+        if(res.m_error.has_value()) {
             return std::nullopt;
         }
-        auto compact_tx = cbdc::transaction::compact_tx(tx);
-        auto attestation = compact_tx.sign(m_secp.get(), m_privkey);
+        auto attestation = res.m_tx.sign(m_secp.get(), m_privkey);
         return attestation;
     }
 
@@ -133,7 +130,7 @@ namespace cbdc::sentinel {
                                         std::unordered_set<size_t> requested) {
         if(!v_res.has_value()) {
             m_logger->error(cbdc::to_string(ctx.m_id),
-                            "invalid according to remote sentinel");
+                            "not attested by remote sentinel");
             return;
         }
         ctx.m_attestations.insert(std::move(v_res.value()));
@@ -170,7 +167,8 @@ namespace cbdc::sentinel {
     }
 
     void controller::send_compact_tx(const transaction::compact_tx& ctx) {
-        auto ctx_pkt = std::make_shared<cbdc::buffer>(cbdc::make_buffer(ctx));
+        auto ctx_pkt = std::make_shared<cbdc::buffer>(
+            cbdc::make_buffer(ctx, m_opts.m_wire_format));
 
         auto offset = [&]() {
             std::unique_lock l(m_rand_mut);
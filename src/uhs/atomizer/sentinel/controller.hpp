@@ -83,7 +83,8 @@ namespace cbdc::sentinel {
 
         privkey_t m_privkey{};
 
-        void send_transaction(const transaction::full_tx& tx);
+        void send_transaction(const transaction::full_tx& tx,
+                              transaction::compact_tx compact_tx);
 
         void validate_result_handler(async_interface::validate_result v_res,
                                      const transaction::full_tx& tx,
@@ -8,6 +8,7 @@
 
 #include "uhs/sentinel/interface.hpp"
 #include "uhs/transaction/messages.hpp"
+#include "util/common/blocking_queue.hpp"
 #include "util/rpc/async_server.hpp"
 #include "util/rpc/format.hpp"
 
@@ -7,7 +7,9 @@
 
 #include "uhs/atomizer/atomizer/atomizer_raft.hpp"
 #include "uhs/transaction/messages.hpp"
+#include "uhs/transaction/validation.hpp"
 
+#include <algorithm>
 #include <utility>
 
 namespace cbdc::shard {
@@ -18,7 +20,11 @@ namespace cbdc::shard {
           m_opts(std::move(opts)),
           m_logger(std::move(logger)),
           m_shard(m_opts.m_shard_ranges[shard_id]),
-          m_archiver_client(m_opts.m_archiver_endpoints[0], m_logger) {}
+          m_archiver_client(m_opts.m_archiver_endpoints[0], m_logger),
+          // The handler threads verify a share of each batch alongside the
+          // pool workers.
+          m_verify_pool(std::max(std::thread::hardware_concurrency(), 1U)
+                        - 1) {}
 
     controller::~controller() {
         m_shard_network.close();
@@ -111,30 +117,32 @@ namespace cbdc::shard {
 
     auto controller::atomizer_handler(cbdc::network::message_t&& pkt)
         -> std::optional<cbdc::buffer> {
-        auto maybe_blk = from_buffer<atomizer::block>(*pkt.m_pkt);
+        auto maybe_blk = atomizer::block_view::parse(*pkt.m_pkt,
+                                                     m_opts.m_wire_format);
         if(!maybe_blk.has_value()) {
             m_logger->error("Invalid block packet");
             return std::nullopt;
         }
 
-        auto& blk = maybe_blk.value();
+        const auto& blk = maybe_blk.value();
 
-        m_logger->info("Digesting block", blk.m_height, "...");
+        m_logger->info("Digesting block", blk.height(), "...");
 
         // If the block is not contiguous, catch up by requesting
         // blocks from the archiver.
         while(!m_shard.digest_block(blk)) {
             m_logger->warn("Block",
-                           blk.m_height,
+                           blk.height(),
                            "not contiguous with previous block",
                            m_shard.best_block_height());
 
-            if(blk.m_height <= m_shard.best_block_height()) {
+            if(blk.height() <= m_shard.best_block_height()) {
                 break;
             }
 
             // Attempt to catch up to the latest block
-            for(uint64_t i = m_shard.best_block_height() + 1; i < blk.m_height;
+            for(uint64_t i = m_shard.best_block_height() + 1;
+                i < blk.height();
                 i++) {
                 const auto past_blk = m_archiver_client.get_block(i);
                 if(past_blk) {
@@ -149,61 +157,80 @@ namespace cbdc::shard {
             }
         }
 
-        m_logger->info("Digested block", blk.m_height);
+        m_logger->info("Digested block", blk.height());
         return std::nullopt;
     }
 
     void controller::request_consumer() {
-        auto pkt = network::message_t();
-        while(m_request_queue.pop(pkt)) {
-            auto maybe_tx = from_buffer<transaction::compact_tx>(*pkt.m_pkt);
-            if(!maybe_tx.has_value()) {
-                m_logger->error("Invalid transaction packet");
-                continue;
+        // Take whatever requests are queued, up to a limit, so their
+        // attestations are verified as a batch
+        static constexpr size_t max_batch_size{1000};
+        auto pkts = std::vector<network::message_t>();
+        while(m_request_queue.pop_all(pkts, max_batch_size)) {
+            auto txs = std::vector<transaction::compact_tx>();
+            txs.reserve(pkts.size());
+            for(const auto& pkt : pkts) {
+                auto maybe_tx = from_buffer<transaction::compact_tx>(
+                    *pkt.m_pkt,
+                    m_opts.m_wire_format);
+                if(!maybe_tx.has_value()) {
+                    m_logger->error("Invalid transaction packet");
+                    continue;
+                }
+                txs.emplace_back(std::move(maybe_tx.value()));
             }
-
-            auto& tx = maybe_tx.value();
-
-            m_logger->info("Digesting transaction", to_string(tx.m_id), "...");
-
-            if(!transaction::validation::check_attestations(
-                   tx,
-                   m_opts.m_sentinel_public_keys,
-                   m_opts.m_attestation_threshold)) {
-                m_logger->warn("Received invalid compact transaction",
-                               to_string(tx.m_id));
-                continue;
+            pkts.clear();
+
+            using tx_ref
+                = std::reference_wrapper<const transaction::compact_tx>;
+            auto refs = std::vector<tx_ref>(txs.begin(), txs.end());
+            auto attested = transaction::validation::check_attestations(
+                refs,
+                m_opts.m_sentinel_public_keys,
+                m_opts.m_attestation_threshold,
+                m_verify_pool);
+
+            for(size_t i{0}; i < txs.size(); i++) {
+                if(!attested[i]) {
+                    m_logger->warn("Received invalid compact transaction",
+                                   to_string(txs[i].m_id));
+                    continue;
+                }
+                digest_transaction(std::move(txs[i]));
             }
-
-            auto res = m_shard.digest_transaction(std::move(tx));
-
-            auto res_handler = overloaded{
-                [&](const atomizer::tx_notify_request& msg) {
-                    m_logger->info("Digested transaction",
-                                   to_string(msg.m_tx.m_id));
-
-                    m_logger->debug("Sending",
-                                    msg.m_attestations.size(),
-                                    "/",
-                                    msg.m_tx.m_inputs.size(),
-                                    "attestations...");
-                    if(!m_atomizer_network.send_to_one(
-                           atomizer::request{msg})) {
-                        m_logger->error(
-                            "Failed to transmit tx to atomizer. ID:",
-                            to_string(msg.m_tx.m_id));
-                    }
-                },
-                [&](const cbdc::watchtower::tx_error& err) {
-                    m_logger->info("error for Tx:",
-                                   to_string(err.tx_id()),
-                                   err.to_string());
-                    // TODO: batch errors into a single RPC
-                    auto data = std::vector<cbdc::watchtower::tx_error>{err};
-                    auto buf = make_shared_buffer(data);
-                    m_watchtower_network.broadcast(buf);
-                }};
-            std::visit(res_handler, res);
         }
     }
+
+    void controller::digest_transaction(transaction::compact_tx tx) {
+        m_logger->info("Digesting transaction", to_string(tx.m_id), "...");
+
+        auto res = m_shard.digest_transaction(std::move(tx));
+
+        auto res_handler = overloaded{
+            [&](const atomizer::tx_notify_request& msg) {
+                m_logger->info("Digested transaction",
+                               to_string(msg.m_tx.m_id));
+
+                m_logger->debug("Sending",
+                                msg.m_attestations.size(),
+                                "/",
+                                msg.m_tx.m_inputs.size(),
+                                "attestations...");
+                if(!m_atomizer_network.send_to_one(atomizer::request{msg},
+                                                   m_opts.m_wire_format)) {
+                    m_logger->error("Failed to transmit tx to atomizer. ID:",
+                                    to_string(msg.m_tx.m_id));
+                }
+            },
+            [&](const cbdc::watchtower::tx_error& err) {
+                m_logger->info("error for Tx:",
+                               to_string(err.tx_id()),
+                               err.to_string());
+                // TODO: batch errors into a single RPC
+                auto data = std::vector<cbdc::watchtower::tx_error>{err};
+                auto buf = make_shared_buffer(data, m_opts.m_wire_format);
+                m_watchtower_network.broadcast(buf);
+            }};
+        std::visit(res_handler, res);
+    }
 }
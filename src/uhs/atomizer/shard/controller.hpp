@@ -9,7 +9,9 @@
 #include "shard.hpp"
 #include "uhs/atomizer/archiver/client.hpp"
 #include "uhs/atomizer/atomizer/block.hpp"
+#include "util/common/blocking_queue.hpp"
 #include "util/common/config.hpp"
+#include "util/common/thread_pool.hpp"
 #include "util/network/connection_manager.hpp"
 
 #include <memory>
@@ -59,12 +61,15 @@ namespace cbdc::shard {
 
         blocking_queue<network::message_t> m_request_queue;
         std::vector<std::thread> m_handler_threads;
+        /// Verifies the sentinel attestations of transaction batches.
+        thread_pool m_verify_pool;
 
         auto server_handler(cbdc::network::message_t&& pkt)
             -> std::optional<cbdc::buffer>;
         auto atomizer_handler(cbdc::network::message_t&& pkt)
             -> std::optional<cbdc::buffer>;
         void request_consumer();
+        void digest_transaction(transaction::compact_tx tx);
     };
 }
 
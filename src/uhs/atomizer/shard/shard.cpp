@@ -8,6 +8,28 @@
 #include <utility>
 
 namespace cbdc::shard {
+    namespace {
+        auto inputs(const transaction::compact_tx& tx)
+            -> const std::vector<hash_t>& {
+            return tx.m_inputs;
+        }
+
+        auto inputs(const transaction::compact_tx_view& tx)
+            -> transaction::hash_span {
+            return tx.inputs();
+        }
+
+        auto uhs_outputs(const transaction::compact_tx& tx)
+            -> const std::vector<hash_t>& {
+            return tx.m_uhs_outputs;
+        }
+
+        auto uhs_outputs(const transaction::compact_tx_view& tx)
+            -> transaction::hash_span {
+            return tx.uhs_outputs();
+        }
+    }
+
     shard::shard(config::shard_range_t prefix_range)
         : m_prefix_range(std::move(prefix_range)) {}
 
@@ -55,16 +77,25 @@ namespace cbdc::shard {
     }
 
     auto shard::digest_block(const cbdc::atomizer::block& blk) -> bool {
-        if(blk.m_height != m_best_block_height + 1) {
+        return digest_txs(blk.m_height, blk.m_transactions);
+    }
+
+    auto shard::digest_block(const cbdc::atomizer::block_view& blk) -> bool {
+        return digest_txs(blk.height(), blk);
+    }
+
+    template<typename T>
+    auto shard::digest_txs(uint64_t height, const T& txs) -> bool {
+        if(height != m_best_block_height + 1) {
             return false;
         }
 
         leveldb::WriteBatch batch;
 
         // Iterate over all confirmed transactions
-        for(const auto& tx : blk.m_transactions) {
+        for(const auto& tx : txs) {
             // Add new outputs
-            for(const auto& out : tx.m_uhs_outputs) {
+            for(const auto& out : uhs_outputs(tx)) {
                 if(is_output_on_shard(out)) {
                     std::array<char, sizeof(out)> out_arr{};
                     std::memcpy(out_arr.data(), out.data(), out.size());
@@ -74,7 +105,7 @@ namespace cbdc::shard {
             }
 
             // Delete spent inputs
-            for(const auto& inp : tx.m_inputs) {
+            for(const auto& inp : inputs(tx)) {
                 if(is_output_on_shard(inp)) {
                     std::array<char, sizeof(inp)> inp_arr{};
                     std::memcpy(inp_arr.data(), inp.data(), inp.size());
@@ -12,6 +12,7 @@
 
 #include "uhs/atomizer/atomizer/atomizer_raft.hpp"
 #include "uhs/atomizer/atomizer/block.hpp"
+#include "uhs/atomizer/atomizer/block_view.hpp"
 #include "uhs/atomizer/atomizer/format.hpp"
 #include "uhs/atomizer/watchtower/tx_error_messages.hpp"
 #include "uhs/transaction/transaction.hpp"
@@ -61,6 +62,13 @@ namespace cbdc::shard {
         /// \return true if the shard successfully digested the block. False if the block height is not contiguous.
         auto digest_block(const cbdc::atomizer::block& blk) -> bool;
 
+        /// Updates records to reflect changes from a new, contiguous block,
+        /// reading the transactions directly from the serialized block.
+        /// \see \ref digest_block(const cbdc::atomizer::block&)
+        /// \param blk view of the block to digest.
+        /// \return true if the shard successfully digested the block.
+        auto digest_block(const cbdc::atomizer::block_view& blk) -> bool;
+
         /// Returns the height of the most recently digested block.
         /// \return the best block height.
         [[nodiscard]] auto best_block_height() const -> uint64_t;
@@ -71,6 +79,11 @@ namespace cbdc::shard {
 
         void update_snapshot();
 
+        /// Digests the transactions of a block with the given height, either
+        /// compact transactions or views of them.
+        template<typename T>
+        auto digest_txs(uint64_t height, const T& txs) -> bool;
+
         std::unique_ptr<leveldb::DB> m_db;
         leveldb::ReadOptions m_read_options;
         leveldb::WriteOptions m_write_options;
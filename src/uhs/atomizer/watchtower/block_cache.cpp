@@ -5,6 +5,10 @@
 
 #include "block_cache.hpp"
 
+#include "uhs/atomizer/atomizer/format.hpp"
+#include "uhs/transaction/messages.hpp"
+#include "util/serialization/util.hpp"
+
 namespace cbdc::watchtower {
     block_cache::block_cache(size_t k) : m_k_blks(k) {
         static constexpr auto puts_per_tx = 2;
@@ -14,31 +18,40 @@ namespace cbdc::watchtower {
     }
 
     void block_cache::push_block(cbdc::atomizer::block&& blk) {
+        auto buf = std::shared_ptr<const cbdc::buffer>(
+            cbdc::make_shared_buffer(blk));
+        auto view = cbdc::atomizer::block_view::parse(*buf);
+        assert(view.has_value());
+        push_block(*view, std::move(buf));
+    }
+
+    void block_cache::push_block(const cbdc::atomizer::block_view& blk,
+                                 std::shared_ptr<const cbdc::buffer> buf) {
         if((m_k_blks != 0) && (m_blks.size() == m_k_blks)) {
-            auto& old_blk = m_blks.front();
-            for(auto& tx : old_blk.m_transactions) {
-                for(auto& in : tx.m_inputs) {
+            const auto& old_blk = m_blks.front().first;
+            for(const auto& tx : old_blk) {
+                for(const auto& in : tx.inputs()) {
                     m_spent_ids.erase(in);
                 }
-                for(auto& out : tx.m_uhs_outputs) {
+                for(const auto& out : tx.uhs_outputs()) {
                     m_unspent_ids.erase(out);
                 }
             }
             m_blks.pop();
         }
 
-        m_blks.push(std::forward<cbdc::atomizer::block>(blk));
+        m_blks.emplace(blk, std::move(buf));
 
-        auto blk_height = m_blks.back().m_height;
-        for(auto& tx : m_blks.back().m_transactions) {
-            for(auto& in : tx.m_inputs) {
+        auto blk_height = blk.height();
+        for(const auto& tx : blk) {
+            const auto tx_id = tx.id();
+            for(const auto& in : tx.inputs()) {
                 m_unspent_ids.erase(in);
-                m_spent_ids.insert(
-                    {{in, std::make_pair(blk_height, tx.m_id)}});
+                m_spent_ids.insert({{in, std::make_pair(blk_height, tx_id)}});
             }
-            for(auto& out : tx.m_uhs_outputs) {
+            for(const auto& out : tx.uhs_outputs()) {
                 m_unspent_ids.insert(
-                    {{out, std::make_pair(blk_height, tx.m_id)}});
+                    {{out, std::make_pair(blk_height, tx_id)}});
             }
         }
         m_best_blk_height = std::max(m_best_blk_height, blk_height);
@@ -11,6 +11,7 @@
 #define OPENCBDC_TX_SRC_WATCHTOWER_BLOCK_CACHE_H_
 
 #include "uhs/atomizer/atomizer/block.hpp"
+#include "uhs/atomizer/atomizer/block_view.hpp"
 #include "util/common/hashmap.hpp"
 
 #include <forward_list>
@@ -40,6 +41,15 @@ namespace cbdc::watchtower {
         /// \param blk the block to move into the cache.
         void push_block(cbdc::atomizer::block&& blk);
 
+        /// Adds a serialized block to the block cache, evicting the oldest
+        /// block if the cache has reached its maximum size. Reads the
+        /// transactions in place rather than materializing them.
+        /// \param blk view of the block.
+        /// \param buf serialized block viewed by blk. Retained until the
+        ///            block is evicted.
+        void push_block(const cbdc::atomizer::block_view& blk,
+                        std::shared_ptr<const cbdc::buffer> buf);
+
         /// Checks to see if the given UHS ID is spendable according to the
         /// blocks in the cache.
         /// \param uhs_id UHS ID to check.
@@ -60,7 +70,9 @@ namespace cbdc::watchtower {
 
       private:
         size_t m_k_blks;
-        std::queue<cbdc::atomizer::block> m_blks;
+        std::queue<std::pair<cbdc::atomizer::block_view,
+                             std::shared_ptr<const cbdc::buffer>>>
+            m_blks;
         uint64_t m_best_blk_height{0};
         std::unordered_map<hash_t,
                            block_cache_result,
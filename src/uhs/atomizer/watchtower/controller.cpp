@@ -58,7 +58,8 @@ auto cbdc::watchtower::controller::init() -> bool {
         m_opts.m_watchtower_client_endpoints[m_watchtower_id],
         [&](auto&& pkt) {
             return external_server_handler(std::forward<decltype(pkt)>(pkt));
-        });
+        },
+        m_opts.m_handler_threads);
 
     if(!external.has_value()) {
         m_logger->error("Failed to establish watchtower external server.");
@@ -93,20 +94,21 @@ auto cbdc::watchtower::controller::init() -> bool {
 
 auto cbdc::watchtower::controller::atomizer_handler(
     cbdc::network::message_t&& pkt) -> std::optional<cbdc::buffer> {
-    auto maybe_blk = from_buffer<atomizer::block>(*pkt.m_pkt);
+    auto maybe_blk = atomizer::block_view::parse(*pkt.m_pkt,
+                                                 m_opts.m_wire_format);
     if(!maybe_blk.has_value()) {
         m_logger->error("Invalid block packet");
         return std::nullopt;
     }
-    auto& blk = maybe_blk.value();
+    const auto& blk = maybe_blk.value();
     m_logger->debug("Received block",
-                    blk.m_height,
+                    blk.height(),
                     "with",
-                    blk.m_transactions.size(),
+                    blk.size(),
                     "transactions.");
-    if(blk.m_height != (m_last_blk_height + 1)) {
+    if(blk.height() != (m_last_blk_height + 1)) {
         m_logger->warn("Block not contiguous. Last block:", m_last_blk_height);
-        while(blk.m_height != (m_last_blk_height + 1)) {
+        while(blk.height() != (m_last_blk_height + 1)) {
             auto missed_blk
                 = m_archiver_client.get_block(m_last_blk_height + 1);
             if(!missed_blk) {
@@ -121,15 +123,17 @@ auto cbdc::watchtower::controller::atomizer_handler(
             m_watchtower.add_block(std::move(*missed_blk));
         }
     }
-    m_last_blk_height = blk.m_height;
-    m_watchtower.add_block(std::move(blk));
+    m_last_blk_height = blk.height();
+    m_watchtower.add_block(blk, std::move(pkt.m_pkt));
     return std::nullopt;
 }
 
 auto cbdc::watchtower::controller::internal_server_handler(
     cbdc::network::message_t&& pkt) -> std::optional<cbdc::buffer> {
     auto maybe_errs
-        = from_buffer<std::vector<cbdc::watchtower::tx_error>>(*pkt.m_pkt);
+        = from_buffer<std::vector<cbdc::watchtower::tx_error>>(
+            *pkt.m_pkt,
+            m_opts.m_wire_format);
     if(!maybe_errs.has_value()) {
         m_logger->error("Invalid internal request packet");
         return std::nullopt;
@@ -17,6 +17,12 @@ namespace cbdc::watchtower {
         m_bc.push_block(std::move(blk));
     }
 
+    void watchtower::add_block(const cbdc::atomizer::block_view& blk,
+                               std::shared_ptr<const cbdc::buffer> buf) {
+        std::unique_lock lk(m_bc_mut);
+        m_bc.push_block(blk, std::move(buf));
+    }
+
     void watchtower::add_errors(std::vector<tx_error>&& errs) {
         std::shared_lock lk0(m_bc_mut, std::defer_lock);
         std::unique_lock lk1(m_ec_mut, std::defer_lock);
@@ -140,6 +140,13 @@ namespace cbdc::watchtower {
         /// \param blk block to add.
         void add_block(cbdc::atomizer::block&& blk);
 
+        /// Adds a new serialized block from the Atomizer to the Watchtower.
+        /// \param blk view of the block to add.
+        /// \param buf serialized block viewed by blk.
+        /// \see block_cache::push_block(const cbdc::atomizer::block_view&, std::shared_ptr<const cbdc::buffer>)
+        void add_block(const cbdc::atomizer::block_view& blk,
+                       std::shared_ptr<const cbdc::buffer> buf);
+
         /// Adds an error from an internal component to the Watchtower's error
         /// cache.
         /// \param errs error to add.
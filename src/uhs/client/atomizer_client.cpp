@@ -96,6 +96,7 @@ namespace cbdc {
         }
         msg.m_tx = std::move(ctx);
         msg.m_block_height = m_wc.request_best_block_height()->height();
-        return m_atomizer_network.send_to_one(atomizer::request{msg});
+        return m_atomizer_network.send_to_one(atomizer::request{msg},
+                                              m_opts.m_wire_format);
     }
 }
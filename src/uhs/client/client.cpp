@@ -59,7 +59,9 @@ namespace cbdc {
                    std::string client_file)
         : m_opts(std::move(opts)),
           m_logger(std::move(logger)),
-          m_sentinel_client(m_opts.m_sentinel_endpoints, m_logger),
+          m_sentinel_client(m_opts.m_sentinel_endpoints,
+                            m_logger,
+                            m_opts.m_endpoint_selection_policy),
           m_client_file(std::move(client_file)),
           m_wallet_file(std::move(wallet_file)) {}
 
@@ -17,7 +17,8 @@ namespace cbdc {
           m_coordinator_client(opts.m_coordinator_endpoints[0]),
           m_shard_status_client(opts.m_locking_shard_readonly_endpoints,
                                 opts.m_shard_ranges,
-                                m_client_timeout),
+                                m_client_timeout,
+                                opts.m_endpoint_selection_policy),
           m_logger(logger),
           m_opts(opts) {}
 
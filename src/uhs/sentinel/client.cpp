@@ -11,9 +11,10 @@
 
 namespace cbdc::sentinel::rpc {
     client::client(std::vector<network::endpoint_t> endpoints,
-                   std::shared_ptr<logging::log> logger)
+                   std::shared_ptr<logging::log> logger,
+                   cbdc::rpc::selection_policy policy)
         : m_logger(std::move(logger)),
-          m_client(std::move(endpoints)) {}
+          m_client(std::move(endpoints), 0, policy) {}
 
     auto client::init() -> bool {
         if(!m_client.init()) {
@@ -43,7 +44,8 @@ namespace cbdc::sentinel::rpc {
                     return;
                 }
                 cb(std::get<execute_response>(res.value()));
-            });
+            },
+            execute_timeout);
     }
 
     auto client::validate_transaction(cbdc::transaction::full_tx tx)
@@ -66,6 +68,12 @@ namespace cbdc::sentinel::rpc {
                     return;
                 }
                 cb(std::get<validate_response>(res.value()));
-            });
+            },
+            validate_timeout);
+    }
+
+    auto client::get_endpoint_stats()
+        -> std::vector<cbdc::rpc::endpoint_stats> {
+        return m_client.get_endpoint_stats();
     }
 }
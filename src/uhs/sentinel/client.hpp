@@ -19,8 +19,12 @@ namespace cbdc::sentinel::rpc {
         /// Constructor.
         /// \param endpoints sentinel cluster RPC endpoints.
         /// \param logger pointer shared logger.
+        /// \param policy policy for choosing which sentinel in the cluster
+        ///               receives each request.
         client(std::vector<network::endpoint_t> endpoints,
-               std::shared_ptr<logging::log> logger);
+               std::shared_ptr<logging::log> logger,
+               cbdc::rpc::selection_policy policy
+               = cbdc::rpc::selection_policy::random);
 
         ~client() override = default;
 
@@ -47,7 +51,9 @@ namespace cbdc::sentinel::rpc {
         /// Send a transaction to the sentinel and return the response via a
         /// callback function asynchronously.
         /// \param tx transaction to send to the sentinel.
-        /// \param result_callback callback function to call with the result.
+        /// \param result_callback callback function to call with the result,
+        ///                        or std::nullopt if the sentinel does not
+        ///                        respond within \ref execute_timeout.
         /// \return true if the request was sent successfully.
         auto execute_transaction(
             transaction::full_tx tx,
@@ -68,13 +74,27 @@ namespace cbdc::sentinel::rpc {
         /// Send a transaction to the sentinel for validation and return the
         /// response via a callback function asynchronously.
         /// \param tx transaction to validate and attest to.
-        /// \param result_callback callback function to call with the result.
+        /// \param result_callback callback function to call with the result,
+        ///                        or std::nullopt if the sentinel does not
+        ///                        respond within \ref validate_timeout.
         /// \return true if the request was sent successfully.
         auto validate_transaction(
             transaction::full_tx tx,
             std::function<void(validate_result_type)> result_callback)
             -> bool override;
 
+        /// Returns the request and response statistics of each sentinel
+        /// endpoint, in the order passed to the constructor.
+        /// \return statistics by endpoint.
+        [[nodiscard]] auto get_endpoint_stats()
+            -> std::vector<cbdc::rpc::endpoint_stats>;
+
+        /// Time an asynchronous execute request waits for a response. Covers
+        /// the whole settlement of the transaction by the sentinel.
+        static constexpr auto execute_timeout = std::chrono::seconds(30);
+        /// Time an asynchronous validate request waits for a response.
+        static constexpr auto validate_timeout = std::chrono::seconds(5);
+
       private:
         cbdc::config::options m_opts;
         std::shared_ptr<logging::log> m_logger;
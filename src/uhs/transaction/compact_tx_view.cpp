@@ -0,0 +1,170 @@
+// Copyright (c) 2021 MIT Digital Currency Initiative,
+//                    Federal Reserve Bank of Boston
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "compact_tx_view.hpp"
+
+#include "util/serialization/format.hpp"
+
+#include <cstring>
+
+namespace cbdc::transaction {
+    namespace {
+        /// Serialized size of a sentinel attestation.
+        constexpr size_t attestation_size
+            = sizeof(pubkey_t) + sizeof(signature_t);
+
+        /// Reads the element count of a serialized vector or map at the
+        /// given position, and advances the position to the first element.
+        /// \return element count, or std::nullopt if the count is malformed
+        ///         or the elements extend beyond the end of the data.
+        auto read_count(const unsigned char* data,
+                        size_t len,
+                        size_t& pos,
+                        size_t elem_size,
+                        wire_format fmt) -> std::optional<size_t> {
+            uint64_t count{};
+            auto n = decode_varint(data + pos, len - pos, fmt, count);
+            if(n == 0) {
+                return std::nullopt;
+            }
+            pos += n;
+            if(count > (len - pos) / elem_size) {
+                return std::nullopt;
+            }
+            return static_cast<size_t>(count);
+        }
+    }
+
+    hash_span::iterator::iterator(const unsigned char* pos) : m_pos(pos) {}
+
+    auto hash_span::iterator::operator*() const -> hash_t {
+        auto ret = hash_t();
+        std::memcpy(ret.data(), m_pos, ret.size());
+        return ret;
+    }
+
+    auto hash_span::iterator::operator++() -> iterator& {
+        m_pos += sizeof(hash_t);
+        return *this;
+    }
+
+    auto hash_span::iterator::operator++(int) -> iterator {
+        auto ret = *this;
+        ++(*this);
+        return ret;
+    }
+
+    auto hash_span::iterator::operator==(const iterator& rhs) const -> bool {
+        return m_pos == rhs.m_pos;
+    }
+
+    auto hash_span::iterator::operator!=(const iterator& rhs) const -> bool {
+        return m_pos != rhs.m_pos;
+    }
+
+    hash_span::hash_span(const unsigned char* data, size_t count)
+        : m_data(data),
+          m_count(count) {}
+
+    auto hash_span::size() const -> size_t {
+        return m_count;
+    }
+
+    auto hash_span::empty() const -> bool {
+        return m_count == 0;
+    }
+
+    auto hash_span::operator[](size_t i) const -> hash_t {
+        return *iterator(m_data + i * sizeof(hash_t));
+    }
+
+    auto hash_span::begin() const -> iterator {
+        return iterator(m_data);
+    }
+
+    auto hash_span::end() const -> iterator {
+        return iterator(m_data + m_count * sizeof(hash_t));
+    }
+
+    auto compact_tx_view::parse(const unsigned char* data,
+                                size_t len,
+                                wire_format fmt)
+        -> std::optional<compact_tx_view> {
+        if(len < sizeof(hash_t)) {
+            return std::nullopt;
+        }
+        auto ret = compact_tx_view();
+        ret.m_data = data;
+        size_t pos{sizeof(hash_t)};
+
+        auto n_inputs = read_count(data, len, pos, sizeof(hash_t), fmt);
+        if(!n_inputs) {
+            return std::nullopt;
+        }
+        ret.m_inputs = hash_span(data + pos, *n_inputs);
+        pos += *n_inputs * sizeof(hash_t);
+
+        auto n_outputs = read_count(data, len, pos, sizeof(hash_t), fmt);
+        if(!n_outputs) {
+            return std::nullopt;
+        }
+        ret.m_uhs_outputs = hash_span(data + pos, *n_outputs);
+        pos += *n_outputs * sizeof(hash_t);
+
+        auto n_atts = read_count(data, len, pos, attestation_size, fmt);
+        if(!n_atts) {
+            return std::nullopt;
+        }
+        ret.m_attestations = data + pos;
+        ret.m_attestation_count = *n_atts;
+        pos += *n_atts * attestation_size;
+
+        ret.m_size = pos;
+        return ret;
+    }
+
+    auto compact_tx_view::id() const -> hash_t {
+        return *hash_span::iterator(m_data);
+    }
+
+    auto compact_tx_view::inputs() const -> hash_span {
+        return m_inputs;
+    }
+
+    auto compact_tx_view::uhs_outputs() const -> hash_span {
+        return m_uhs_outputs;
+    }
+
+    auto compact_tx_view::attestation_count() const -> size_t {
+        return m_attestation_count;
+    }
+
+    auto compact_tx_view::attestation(size_t i) const
+        -> sentinel_attestation {
+        const auto* pos = m_attestations + i * attestation_size;
+        auto ret = sentinel_attestation();
+        std::memcpy(ret.first.data(), pos, ret.first.size());
+        std::memcpy(ret.second.data(),
+                    pos + ret.first.size(),
+                    ret.second.size());
+        return ret;
+    }
+
+    auto compact_tx_view::size() const -> size_t {
+        return m_size;
+    }
+
+    auto compact_tx_view::to_compact_tx() const -> compact_tx {
+        auto ret = compact_tx();
+        ret.m_id = id();
+        ret.m_inputs.assign(m_inputs.begin(), m_inputs.end());
+        ret.m_uhs_outputs.assign(m_uhs_outputs.begin(), m_uhs_outputs.end());
+        ret.m_attestations.reserve(m_attestation_count);
+        for(size_t i{0}; i < m_attestation_count; i++) {
+            ret.m_attestations.insert(attestation(i));
+        }
+        return ret;
+    }
+}
@@ -0,0 +1,140 @@
+// Copyright (c) 2021 MIT Digital Currency Initiative,
+//                    Federal Reserve Bank of Boston
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef OPENCBDC_TX_SRC_TRANSACTION_COMPACT_TX_VIEW_H_
+#define OPENCBDC_TX_SRC_TRANSACTION_COMPACT_TX_VIEW_H_
+
+#include "transaction.hpp"
+#include "util/serialization/serializer.hpp"
+
+#include <cstddef>
+#include <iterator>
+#include <optional>
+
+namespace cbdc::transaction {
+    /// Read-only view of a sequence of hashes stored contiguously in a
+    /// serialized message. Elements are copied out on access, so the
+    /// underlying bytes do not need to be aligned.
+    class hash_span {
+      public:
+        /// Iterator over the hashes in the span.
+        class iterator {
+          public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = hash_t;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const hash_t*;
+            using reference = hash_t;
+
+            iterator() = default;
+
+            /// Constructor.
+            /// \param pos pointer to the serialized hash.
+            explicit iterator(const unsigned char* pos);
+
+            auto operator*() const -> hash_t;
+            auto operator++() -> iterator&;
+            auto operator++(int) -> iterator;
+            auto operator==(const iterator& rhs) const -> bool;
+            auto operator!=(const iterator& rhs) const -> bool;
+
+          private:
+            const unsigned char* m_pos{nullptr};
+        };
+
+        hash_span() = default;
+
+        /// Constructor.
+        /// \param data pointer to the first serialized hash.
+        /// \param count number of hashes.
+        hash_span(const unsigned char* data, size_t count);
+
+        /// Returns the number of hashes in the span.
+        /// \return hash count.
+        [[nodiscard]] auto size() const -> size_t;
+
+        /// Indicates whether the span contains no hashes.
+        /// \return true if the span is empty.
+        [[nodiscard]] auto empty() const -> bool;
+
+        /// Returns a copy of the hash at the given index.
+        /// \param i index of the hash. Must be less than \ref size.
+        /// \return hash at the index.
+        auto operator[](size_t i) const -> hash_t;
+
+        [[nodiscard]] auto begin() const -> iterator;
+        [[nodiscard]] auto end() const -> iterator;
+
+      private:
+        const unsigned char* m_data{nullptr};
+        size_t m_count{0};
+    };
+
+    /// \brief Read-only view of a serialized \ref compact_tx.
+    ///
+    /// Parses the serialized form in place rather than allocating vectors
+    /// and a map for each transaction, for components which only scan the
+    /// inputs and outputs of the transactions they receive. The view refers
+    /// to the serialized bytes, which must outlive it.
+    ///
+    /// \see \ref cbdc::operator<<(serializer&, const transaction::compact_tx&)
+    class compact_tx_view {
+      public:
+        /// Parses the compact transaction serialized at the start of the
+        /// given bytes.
+        /// \param data pointer to the serialized transaction.
+        /// \param len number of bytes available from data.
+        /// \param fmt wire format the transaction was serialized with.
+        /// \return view of the transaction, or std::nullopt if the bytes do
+        ///         not start with a well-formed compact transaction.
+        static auto parse(const unsigned char* data,
+                          size_t len,
+                          wire_format fmt = wire_format::fixed)
+            -> std::optional<compact_tx_view>;
+
+        /// Returns the transaction ID.
+        /// \return ID, as in \ref compact_tx::m_id.
+        [[nodiscard]] auto id() const -> hash_t;
+
+        /// Returns the hashes of the transaction's inputs.
+        /// \return input hashes, as in \ref compact_tx::m_inputs.
+        [[nodiscard]] auto inputs() const -> hash_span;
+
+        /// Returns the UHS IDs of the transaction's outputs.
+        /// \return output UHS IDs, as in \ref compact_tx::m_uhs_outputs.
+        [[nodiscard]] auto uhs_outputs() const -> hash_span;
+
+        /// Returns the number of sentinel attestations.
+        /// \return attestation count.
+        [[nodiscard]] auto attestation_count() const -> size_t;
+
+        /// Returns a copy of the sentinel attestation at the given index.
+        /// Attestations are in serialized order.
+        /// \param i index of the attestation. Must be less than
+        ///          \ref attestation_count.
+        /// \return attestation at the index.
+        [[nodiscard]] auto attestation(size_t i) const -> sentinel_attestation;
+
+        /// Returns the number of bytes the serialized transaction occupies.
+        /// \return serialized size.
+        [[nodiscard]] auto size() const -> size_t;
+
+        /// Copies the viewed transaction into a new compact transaction.
+        /// \return materialized transaction.
+        [[nodiscard]] auto to_compact_tx() const -> compact_tx;
+
+      private:
+        compact_tx_view() = default;
+
+        const unsigned char* m_data{nullptr};
+        hash_span m_inputs;
+        hash_span m_uhs_outputs;
+        const unsigned char* m_attestations{nullptr};
+        size_t m_attestation_count{0};
+        size_t m_size{0};
+    };
+}
+
+#endif // OPENCBDC_TX_SRC_TRANSACTION_COMPACT_TX_VIEW_H_
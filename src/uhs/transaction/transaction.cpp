@@ -5,12 +5,77 @@
 
 #include "transaction.hpp"
 
-#include "crypto/sha256.h"
 #include "messages.hpp"
 #include "util/serialization/format.hpp"
-#include "util/serialization/util.hpp"
+#include "util/serialization/sha256_serializer.hpp"
 
 namespace cbdc::transaction {
+    namespace {
+        /// Serialized size of an output.
+        constexpr size_t output_size = hash_size + sizeof(uint64_t);
+        /// Size of the preimages of input hashes and UHS IDs. Both are an
+        /// ID, an index and a serialized output.
+        constexpr size_t preimage_size
+            = hash_size + sizeof(uint64_t) + output_size;
+        /// Number of transactions make_compact_txs hashes at once.
+        constexpr size_t compact_chunk_size = 64;
+
+        /// Calculates the input hashes and UHS IDs of the given transactions
+        /// and stores them in the corresponding compact transactions, whose
+        /// IDs must already be set. The preimages of the whole batch are
+        /// hashed together using the multi-buffer SHA256 implementation.
+        void hash_inputs_outputs(const full_tx* txs,
+                                 compact_tx* ctxs,
+                                 size_t count) {
+            size_t n_hashes{0};
+            for(size_t i{0}; i < count; i++) {
+                n_hashes += txs[i].m_inputs.size() + txs[i].m_outputs.size();
+            }
+
+            auto preimages = cbdc::buffer();
+            preimages.extend(n_hashes * preimage_size);
+            auto ser = cbdc::buffer_serializer(preimages);
+            for(size_t i{0}; i < count; i++) {
+                for(const auto& inp : txs[i].m_inputs) {
+                    ser << inp;
+                }
+                for(uint64_t j{0}; j < txs[i].m_outputs.size(); j++) {
+                    ser.write(ctxs[i].m_id.data(), ctxs[i].m_id.size());
+                    ser.write(&j, sizeof(j));
+                    ser << txs[i].m_outputs[j];
+                }
+            }
+            assert(ser.end_of_buffer());
+
+            auto hashes = std::vector<unsigned char>(n_hashes * hash_size);
+            SHA256Multi(hashes.data(),
+                        preimages.c_ptr(),
+                        preimage_size,
+                        n_hashes);
+
+            size_t idx{0};
+            auto next_hash = [&]() {
+                auto ret = hash_t();
+                std::memcpy(ret.data(), &hashes[idx * hash_size], hash_size);
+                idx++;
+                return ret;
+            };
+            for(size_t i{0}; i < count; i++) {
+                auto& ctx = ctxs[i];
+                ctx.m_inputs.clear();
+                ctx.m_inputs.reserve(txs[i].m_inputs.size());
+                for(size_t j{0}; j < txs[i].m_inputs.size(); j++) {
+                    ctx.m_inputs.push_back(next_hash());
+                }
+                ctx.m_uhs_outputs.clear();
+                ctx.m_uhs_outputs.reserve(txs[i].m_outputs.size());
+                for(size_t j{0}; j < txs[i].m_outputs.size(); j++) {
+                    ctx.m_uhs_outputs.push_back(next_hash());
+                }
+            }
+        }
+    }
+
     auto out_point::operator==(const out_point& rhs) const -> bool {
         return m_tx_id == rhs.m_tx_id && m_index == rhs.m_index;
     }
@@ -42,15 +107,7 @@ namespace cbdc::transaction {
     }
 
     auto input::hash() const -> hash_t {
-        auto buf = cbdc::make_buffer(*this);
-
-        CSHA256 sha;
-        hash_t result;
-
-        sha.Write(buf.c_ptr(), buf.size());
-        sha.Finalize(result.data());
-
-        return result;
+        return serialized_hash(*this);
     }
 
     auto full_tx::operator==(const full_tx& rhs) const -> bool {
@@ -66,18 +123,9 @@ namespace cbdc::transaction {
     }
 
     auto tx_id(const full_tx& tx) noexcept -> hash_t {
-        CSHA256 sha;
-
-        auto inp_buf = cbdc::make_buffer(tx.m_inputs);
-        sha.Write(inp_buf.c_ptr(), inp_buf.size());
-
-        auto out_buf = cbdc::make_buffer(tx.m_outputs);
-        sha.Write(out_buf.c_ptr(), out_buf.size());
-
-        hash_t ret;
-        sha.Finalize(ret.data());
-
-        return ret;
+        auto ser = sha256_serializer();
+        ser << tx.m_inputs << tx.m_outputs;
+        return ser.finalize();
     }
 
     auto input_from_output(const full_tx& tx, size_t i, const hash_t& txid)
@@ -101,35 +149,77 @@ namespace cbdc::transaction {
     auto uhs_id_from_output(const hash_t& entropy,
                             uint64_t i,
                             const output& output) -> hash_t {
-        CSHA256 sha;
-        hash_t ret;
-        sha.Write(entropy.data(), entropy.size());
-        std::array<unsigned char, sizeof(i)> index_arr{};
-        std::memcpy(index_arr.data(), &i, sizeof(i));
-        sha.Write(index_arr.data(), sizeof(i));
-
-        auto buf = cbdc::make_buffer(output);
-
-        sha.Write(buf.c_ptr(), buf.size());
-        sha.Finalize(ret.data());
-        return ret;
+        auto ser = sha256_serializer();
+        ser.write(entropy.data(), entropy.size());
+        ser.write(&i, sizeof(i));
+        ser << output;
+        return ser.finalize();
     }
 
     auto compact_tx::operator==(const compact_tx& tx) const noexcept -> bool {
         return m_id == tx.m_id;
     }
 
-    compact_tx::compact_tx(const full_tx& tx) {
-        m_id = tx_id(tx);
+    compact_tx::compact_tx(const full_tx& tx) : compact_tx(tx, tx_id(tx)) {}
+
+    compact_tx::compact_tx(const full_tx& tx, const hash_t& id) : m_id(id) {
+        m_inputs.reserve(tx.m_inputs.size());
         for(const auto& inp : tx.m_inputs) {
             m_inputs.push_back(inp.hash());
         }
+        m_uhs_outputs.reserve(tx.m_outputs.size());
         for(uint64_t i = 0; i < tx.m_outputs.size(); i++) {
             m_uhs_outputs.push_back(
                 uhs_id_from_output(m_id, i, tx.m_outputs[i]));
         }
     }
 
+    auto make_compact_txs(const std::vector<full_tx>& txs)
+        -> std::vector<compact_tx> {
+        auto ret = std::vector<compact_tx>(txs.size());
+        auto sizes = std::vector<size_t>();
+        sizes.reserve(txs.size());
+        for(const auto& tx : txs) {
+            sizes.push_back(serialized_size(tx.m_inputs)
+                            + serialized_size(tx.m_outputs));
+        }
+
+        // Hash the IDs of each run of transactions with the same serialized
+        // size together, such as those with the same number of inputs and
+        // outputs. Runs are split into chunks so the preimages stay in
+        // cache.
+        auto preimages = cbdc::buffer();
+        auto ids = std::vector<unsigned char>();
+        for(size_t i{0}; i < txs.size();) {
+            auto end = i + 1;
+            while(end < txs.size() && end - i < compact_chunk_size
+                  && sizes[end] == sizes[i]) {
+                end++;
+            }
+            preimages.clear();
+            preimages.extend((end - i) * sizes[i]);
+            auto ser = cbdc::buffer_serializer(preimages);
+            for(auto j = i; j < end; j++) {
+                ser << txs[j].m_inputs << txs[j].m_outputs;
+            }
+            ids.resize((end - i) * hash_size);
+            SHA256Multi(ids.data(), preimages.c_ptr(), sizes[i], end - i);
+            for(auto j = i; j < end; j++) {
+                std::memcpy(ret[j].m_id.data(),
+                            &ids[(j - i) * hash_size],
+                            hash_size);
+            }
+            i = end;
+        }
+
+        for(size_t i{0}; i < txs.size(); i += compact_chunk_size) {
+            hash_inputs_outputs(&txs[i],
+                                &ret[i],
+                                std::min(compact_chunk_size, txs.size() - i));
+        }
+        return ret;
+    }
+
     auto compact_tx::sign(secp256k1_context* ctx, const privkey_t& key) const
         -> sentinel_attestation {
         auto payload = hash();
@@ -152,15 +242,12 @@ namespace cbdc::transaction {
     }
 
     auto compact_tx::hash() const -> hash_t {
-        // Don't include the attesations in the hash
-        auto ctx = *this;
-        ctx.m_attestations.clear();
-        auto buf = make_buffer(ctx);
-        auto sha = CSHA256();
-        sha.Write(buf.c_ptr(), buf.size());
-        auto ret = hash_t();
-        sha.Finalize(ret.data());
-        return ret;
+        // Don't include the attesations in the hash. Hashes the same bytes as
+        // serializing a copy with no attestations, whose empty map
+        // serializes as its zero length.
+        auto ser = sha256_serializer();
+        ser << m_id << m_inputs << m_uhs_outputs << static_cast<uint64_t>(0);
+        return ser.finalize();
     }
 
     auto compact_tx::verify(secp256k1_context* ctx,
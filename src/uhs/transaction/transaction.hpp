@@ -136,6 +136,12 @@ namespace cbdc::transaction {
 
         explicit compact_tx(const full_tx& tx);
 
+        /// Constructs the compact form of a transaction whose ID has already
+        /// been calculated.
+        /// \param tx full transaction.
+        /// \param id ID of the transaction, as returned by \ref tx_id.
+        compact_tx(const full_tx& tx, const hash_t& id);
+
         /// Sign the compact transaction and return the signature.
         /// \param ctx secp256k1 context with which to sign the transaction.
         /// \param key private key with which to sign the transaction.
@@ -196,6 +202,15 @@ namespace cbdc::transaction {
     auto uhs_id_from_output(const hash_t& entropy,
                             uint64_t i,
                             const output& output) -> hash_t;
+
+    /// Converts a batch of transactions into their compact form. Equivalent
+    /// to constructing a \ref compact_tx from each transaction, but hashes
+    /// the short, fixed-size preimages of the whole batch together using the
+    /// multi-buffer SHA256 implementation.
+    /// \param txs transactions to convert.
+    /// \return compact transactions, in the same order as txs.
+    auto make_compact_txs(const std::vector<full_tx>& txs)
+        -> std::vector<compact_tx>;
 }
 
 #endif // OPENCBDC_TX_SRC_TRANSACTION_TRANSACTION_H_
@@ -9,6 +9,7 @@
 
 #include <cassert>
 #include <memory>
+#include <optional>
 #include <secp256k1.h>
 #include <secp256k1_schnorrsig.h>
 #include <set>
@@ -34,6 +35,11 @@ namespace cbdc::transaction::validation {
     }
 
     auto check_tx(const cbdc::transaction::full_tx& tx)
+        -> std::optional<tx_error> {
+        return check_tx(tx, cbdc::transaction::tx_id(tx));
+    }
+
+    auto check_tx(const cbdc::transaction::full_tx& tx, const hash_t& txid)
         -> std::optional<tx_error> {
         const auto structure_err = check_tx_structure(tx);
         if(structure_err) {
@@ -63,7 +69,7 @@ namespace cbdc::transaction::validation {
         }
 
         for(size_t idx = 0; idx < tx.m_witness.size(); idx++) {
-            const auto witness_err = check_witness(tx, idx);
+            const auto witness_err = check_witness(tx, idx, txid);
             if(witness_err) {
                 return tx_error{witness_error{witness_err.value(), idx}};
             }
@@ -72,6 +78,18 @@ namespace cbdc::transaction::validation {
         return std::nullopt;
     }
 
+    auto validate_tx(const cbdc::transaction::full_tx& tx) -> validated_tx {
+        auto ret = validated_tx();
+        const auto txid = cbdc::transaction::tx_id(tx);
+        ret.m_error = check_tx(tx, txid);
+        if(ret.m_error.has_value()) {
+            ret.m_tx.m_id = txid;
+        } else {
+            ret.m_tx = cbdc::transaction::compact_tx(tx, txid);
+        }
+        return ret;
+    }
+
     auto check_tx_structure(const cbdc::transaction::full_tx& tx)
         -> std::optional<tx_error> {
         const auto input_count_err = check_input_count(tx);
@@ -137,6 +155,13 @@ namespace cbdc::transaction::validation {
     //       already been checked.
     auto check_witness(const cbdc::transaction::full_tx& tx, size_t idx)
         -> std::optional<witness_error_code> {
+        return check_witness(tx, idx, cbdc::transaction::tx_id(tx));
+    }
+
+    auto check_witness(const cbdc::transaction::full_tx& tx,
+                       size_t idx,
+                       const hash_t& sighash)
+        -> std::optional<witness_error_code> {
         const auto& witness_program = tx.m_witness[idx];
         if(witness_program.empty()) {
             return witness_error_code::missing_witness_program_type;
@@ -149,13 +174,15 @@ namespace cbdc::transaction::validation {
                 witness_program[0]);
         switch(witness_program_type) {
             case witness_program_type::p2pk:
-                return check_p2pk_witness(tx, idx);
+                return check_p2pk_witness(tx, idx, sighash);
             default:
                 return witness_error_code::unknown_witness_program_type;
         }
     }
 
-    auto check_p2pk_witness(const cbdc::transaction::full_tx& tx, size_t idx)
+    auto check_p2pk_witness(const cbdc::transaction::full_tx& tx,
+                            size_t idx,
+                            const hash_t& sighash)
         -> std::optional<witness_error_code> {
         const auto witness_len_err = check_p2pk_witness_len(tx, idx);
         if(witness_len_err) {
@@ -168,7 +195,8 @@ namespace cbdc::transaction::validation {
             return witness_commitment_err;
         }
 
-        const auto witness_sig_err = check_p2pk_witness_signature(tx, idx);
+        const auto witness_sig_err
+            = check_p2pk_witness_signature(tx, idx, sighash);
         if(witness_sig_err) {
             return witness_sig_err;
         }
@@ -205,7 +233,8 @@ namespace cbdc::transaction::validation {
     }
 
     auto check_p2pk_witness_signature(const cbdc::transaction::full_tx& tx,
-                                      size_t idx)
+                                      size_t idx,
+                                      const hash_t& sighash)
         -> std::optional<witness_error_code> {
         const auto& wit = tx.m_witness[idx];
         secp256k1_xonly_pubkey pubkey{};
@@ -223,8 +252,6 @@ namespace cbdc::transaction::validation {
             return witness_error_code::invalid_public_key;
         }
 
-        const auto sighash = cbdc::transaction::tx_id(tx);
-
         std::array<unsigned char, sig_len> sig_arr{};
         std::memcpy(sig_arr.data(),
                     &wit[p2pk_witness_prog_len],
@@ -404,6 +431,32 @@ namespace cbdc::transaction::validation {
         return str;
     }
 
+    namespace {
+        /// Verifies a single attestation against a precomputed payload so
+        /// the transaction hash is not recomputed for every attestation.
+        auto check_attestation(
+            const hash_t& payload,
+            const std::pair<const pubkey_t, signature_t>& att,
+            const std::unordered_set<pubkey_t, hashing::null>& pubkeys)
+            -> bool {
+            if(pubkeys.find(att.first) == pubkeys.end()) {
+                return false;
+            }
+            secp256k1_xonly_pubkey pubkey{};
+            if(secp256k1_xonly_pubkey_parse(secp_context.get(),
+                                            &pubkey,
+                                            att.first.data())
+               != 1) {
+                return false;
+            }
+            return secp256k1_schnorrsig_verify(secp_context.get(),
+                                               att.second.data(),
+                                               payload.data(),
+                                               &pubkey)
+                == 1;
+        }
+    }
+
     auto check_attestations(
         const transaction::compact_tx& tx,
         const std::unordered_set<pubkey_t, hashing::null>& pubkeys,
@@ -412,11 +465,64 @@ namespace cbdc::transaction::validation {
             return false;
         }
 
+        const auto payload = tx.hash();
         return std::all_of(tx.m_attestations.begin(),
                            tx.m_attestations.end(),
                            [&](const auto& att) {
-                               return pubkeys.find(att.first) != pubkeys.end()
-                                   && tx.verify(secp_context.get(), att);
+                               return check_attestation(payload,
+                                                        att,
+                                                        pubkeys);
                            });
     }
+
+    auto check_attestations(
+        const std::vector<std::reference_wrapper<const compact_tx>>& txs,
+        const std::unordered_set<pubkey_t, hashing::null>& pubkeys,
+        size_t threshold,
+        thread_pool& pool) -> std::vector<bool> {
+        // Hash each transaction once, skipping those which cannot meet the
+        // threshold regardless of their signatures.
+        auto payloads = std::vector<std::optional<hash_t>>(txs.size());
+        pool.parallel_for(txs.size(), [&](size_t i) {
+            const auto& tx = txs[i].get();
+            if(tx.m_attestations.size() >= threshold) {
+                payloads[i] = tx.hash();
+            }
+        });
+
+        // Flatten the attestations of the whole batch so the verification
+        // load is spread evenly across the pool even when transactions
+        // carry different numbers of attestations.
+        using attestation_ref
+            = std::pair<size_t, const std::pair<const pubkey_t, signature_t>*>;
+        auto atts = std::vector<attestation_ref>();
+        for(size_t i{0}; i < txs.size(); i++) {
+            if(!payloads[i].has_value()) {
+                continue;
+            }
+            for(const auto& att : txs[i].get().m_attestations) {
+                atts.emplace_back(i, &att);
+            }
+        }
+
+        // Not std::vector<bool>, whose packed elements cannot be written
+        // from different threads.
+        auto valid = std::vector<uint8_t>(atts.size());
+        pool.parallel_for(atts.size(), [&](size_t j) {
+            const auto& [i, att] = atts[j];
+            valid[j] = static_cast<uint8_t>(
+                check_attestation(payloads[i].value(), *att, pubkeys));
+        });
+
+        auto ret = std::vector<bool>(txs.size());
+        for(size_t i{0}; i < txs.size(); i++) {
+            ret[i] = payloads[i].has_value();
+        }
+        for(size_t j{0}; j < atts.size(); j++) {
+            if(valid[j] == 0) {
+                ret[atts[j].first] = false;
+            }
+        }
+        return ret;
+    }
 }
@@ -7,8 +7,10 @@
 #define OPENCBDC_TX_SRC_TRANSACTION_VALIDATION_H_
 
 #include "transaction.hpp"
+#include "util/common/thread_pool.hpp"
 
 #include <cassert>
+#include <functional>
 #include <memory>
 #include <optional>
 #include <secp256k1.h>
@@ -120,6 +122,42 @@ namespace cbdc::transaction::validation {
     /// \param tx transaction to validate
     /// \return null if transaction is valid, otherwise error information
     auto check_tx(const transaction::full_tx& tx) -> std::optional<tx_error>;
+
+    /// \brief Runs static validation checks on the given transaction
+    ///
+    /// Uses the given transaction ID as the signature hash for every witness
+    /// rather than recomputing it.
+    ///
+    /// \param tx transaction to validate
+    /// \param txid ID of the transaction, as returned by
+    ///             \ref transaction::tx_id
+    /// \return null if transaction is valid, otherwise error information
+    auto check_tx(const transaction::full_tx& tx, const hash_t& txid)
+        -> std::optional<tx_error>;
+
+    /// \brief Result of \ref validate_tx
+    ///
+    /// Carries the identifiers computed while validating a transaction so
+    /// callers can reuse them rather than reserializing the transaction.
+    struct validated_tx {
+        /// Compact form of the transaction. The transaction ID is always
+        /// set. The input and output hashes are only set if the transaction
+        /// is valid.
+        transaction::compact_tx m_tx{};
+
+        /// Validation error, or std::nullopt if the transaction is valid.
+        std::optional<tx_error> m_error{};
+    };
+
+    /// \brief Validates a transaction and builds its compact form
+    ///
+    /// Computes the transaction ID once, uses it to check every witness
+    /// signature and, if the transaction is valid, to derive the UHS IDs of
+    /// its outputs.
+    ///
+    /// \param tx transaction to validate
+    /// \return compact transaction and validation result
+    auto validate_tx(const transaction::full_tx& tx) -> validated_tx;
     auto check_tx_structure(const transaction::full_tx& tx)
         -> std::optional<tx_error>;
     auto check_input_structure(const transaction::input& inp) -> std::optional<
@@ -130,7 +168,13 @@ namespace cbdc::transaction::validation {
     //       already been checked.
     auto check_witness(const transaction::full_tx& tx, size_t idx)
         -> std::optional<witness_error_code>;
-    auto check_p2pk_witness(const transaction::full_tx& tx, size_t idx)
+    auto check_witness(const transaction::full_tx& tx,
+                       size_t idx,
+                       const hash_t& sighash)
+        -> std::optional<witness_error_code>;
+    auto check_p2pk_witness(const transaction::full_tx& tx,
+                            size_t idx,
+                            const hash_t& sighash)
         -> std::optional<witness_error_code>;
     auto check_p2pk_witness_len(const transaction::full_tx& tx, size_t idx)
         -> std::optional<witness_error_code>;
@@ -138,7 +182,8 @@ namespace cbdc::transaction::validation {
                                        size_t idx)
         -> std::optional<witness_error_code>;
     auto check_p2pk_witness_signature(const transaction::full_tx& tx,
-                                      size_t idx)
+                                      size_t idx,
+                                      const hash_t& sighash)
         -> std::optional<witness_error_code>;
     auto check_input_count(const transaction::full_tx& tx)
         -> std::optional<tx_error>;
@@ -164,6 +209,22 @@ namespace cbdc::transaction::validation {
         const transaction::compact_tx& tx,
         const std::unordered_set<pubkey_t, hashing::null>& pubkeys,
         size_t threshold) -> bool;
+
+    /// Validates the sentinel attestations attached to a batch of compact
+    /// transactions. Computes each transaction's hash once and verifies the
+    /// attestations of the whole batch in parallel using the given pool.
+    /// \param txs compact transactions to validate.
+    /// \param pubkeys set of public keys whose attestations will be accepted.
+    /// \param threshold number of attestations required for a transaction to
+    ///                  be considered valid.
+    /// \param pool thread pool with which to verify the attestations.
+    /// \return for each transaction, true if the required number of unique
+    ///         attestations are attached to the transaction.
+    auto check_attestations(
+        const std::vector<std::reference_wrapper<const compact_tx>>& txs,
+        const std::unordered_set<pubkey_t, hashing::null>& pubkeys,
+        size_t threshold,
+        thread_pool& pool) -> std::vector<bool>;
 }
 
 #endif // OPENCBDC_TX_SRC_TRANSACTION_VALIDATION_H_
@@ -0,0 +1,46 @@
+// Copyright (c) 2021 MIT Digital Currency Initiative,
+//                    Federal Reserve Bank of Boston
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "batch_sizer.hpp"
+
+#include <algorithm>
+
+namespace cbdc::coordinator {
+    batch_sizer::batch_sizer(size_t max_size,
+                             std::chrono::microseconds target_latency)
+        : m_max_size(std::max(max_size, size_t{1})),
+          m_target_latency(target_latency),
+          m_limit(m_max_size) {}
+
+    auto batch_sizer::limit() const -> size_t {
+        return m_limit;
+    }
+
+    void batch_sizer::record(size_t batch_size,
+                             std::chrono::microseconds latency) {
+        if(m_target_latency.count() == 0) {
+            return;
+        }
+
+        std::unique_lock<std::mutex> l(m_mut);
+        if(m_avg_latency.count() == 0) {
+            m_avg_latency = latency;
+        } else {
+            m_avg_latency += (latency - m_avg_latency) / m_avg_weight;
+        }
+
+        size_t limit = m_limit;
+        if(m_avg_latency > m_target_latency) {
+            limit = std::max(limit * m_shrink_numerator / m_shrink_denominator,
+                             size_t{1});
+        } else if(batch_size * 2 >= limit) {
+            // Only grow when batches are at least half full, otherwise the
+            // batch size is limited by load rather than the limit.
+            const auto step = std::max(m_max_size / m_grow_divisor, size_t{1});
+            limit = std::min(limit + step, m_max_size);
+        }
+        m_limit = limit;
+    }
+}
@@ -0,0 +1,60 @@
+// Copyright (c) 2021 MIT Digital Currency Initiative,
+//                    Federal Reserve Bank of Boston
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef OPENCBDC_TX_SRC_COORDINATOR_BATCH_SIZER_H_
+#define OPENCBDC_TX_SRC_COORDINATOR_BATCH_SIZER_H_
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+
+namespace cbdc::coordinator {
+    /// \brief Adapts the coordinator's dtx batch size to a latency target.
+    ///
+    /// Tracks a moving average of the time taken to execute each dtx.
+    /// Shrinks the batch size limit multiplicatively while the average is
+    /// above the target, and grows it additively while the average is below
+    /// the target and batches are filling up. Larger batches amortize the
+    /// per-dtx round-trips to the shards, so this keeps batches as large as
+    /// possible while meeting the latency target.
+    class batch_sizer {
+      public:
+        /// Constructor.
+        /// \param max_size maximum batch size. The limit starts at this
+        ///                 value.
+        /// \param target_latency target dtx execution time. Zero disables
+        ///                       adaptation so the limit is always
+        ///                       max_size.
+        batch_sizer(size_t max_size,
+                    std::chrono::microseconds target_latency);
+
+        /// Returns the current batch size limit.
+        /// \return batch size limit, between one and the maximum size.
+        [[nodiscard]] auto limit() const -> size_t;
+
+        /// Records the execution time of a dtx and adjusts the limit.
+        /// \param batch_size number of transactions in the dtx.
+        /// \param latency time taken to execute the dtx.
+        void record(size_t batch_size, std::chrono::microseconds latency);
+
+      private:
+        size_t m_max_size;
+        std::chrono::microseconds m_target_latency;
+        std::atomic<size_t> m_limit;
+
+        std::mutex m_mut;
+        std::chrono::microseconds m_avg_latency{0};
+
+        /// Weight of each new sample in the moving average, as a divisor.
+        static constexpr int64_t m_avg_weight{4};
+        /// The limit shrinks to numerator/denominator of its value.
+        static constexpr size_t m_shrink_numerator{3};
+        static constexpr size_t m_shrink_denominator{4};
+        /// Divisor of the maximum size giving the amount the limit grows.
+        static constexpr size_t m_grow_divisor{32};
+    };
+}
+
+#endif // OPENCBDC_TX_SRC_COORDINATOR_BATCH_SIZER_H_
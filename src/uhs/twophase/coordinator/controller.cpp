@@ -12,6 +12,7 @@
 #include "util/serialization/format.hpp"
 #include "util/serialization/util.hpp"
 
+#include <future>
 #include <utility>
 
 namespace cbdc::coordinator {
@@ -23,18 +24,24 @@ namespace cbdc::coordinator {
           m_coordinator_id(coordinator_id),
           m_opts(std::move(opts)),
           m_logger(std::move(logger)),
-          m_state_machine(nuraft::cs_new<state_machine>(m_logger)),
+          m_state_machine(nuraft::cs_new<state_machine>(
+              m_logger,
+              "coordinator" + std::to_string(m_coordinator_id) + "_snps_"
+                  + std::to_string(m_node_id))),
           m_shard_endpoints(m_opts.m_locking_shard_endpoints),
           m_shard_ranges(m_opts.m_shard_ranges),
-          m_batch_size(m_opts.m_batch_size),
-          m_exec_threads(m_opts.m_coordinator_max_threads) {
+          m_batch_sizer(m_opts.m_batch_size,
+                        std::chrono::microseconds(
+                            m_opts.m_coordinator_target_latency)),
+          m_batch_linger(m_opts.m_coordinator_batch_linger) {
         m_raft_params.election_timeout_lower_bound_
             = static_cast<int>(m_opts.m_election_timeout_lower);
         m_raft_params.election_timeout_upper_bound_
             = static_cast<int>(m_opts.m_election_timeout_upper);
         m_raft_params.heart_beat_interval_
             = static_cast<int>(m_opts.m_heartbeat);
-        m_raft_params.snapshot_distance_ = 0; // TODO: implement snapshots
+        m_raft_params.snapshot_distance_
+            = static_cast<int>(m_opts.m_snapshot_distance);
         m_raft_params.max_append_size_
             = static_cast<int>(m_opts.m_raft_max_batch);
     }
@@ -188,7 +195,8 @@ namespace cbdc::coordinator {
             m_running = false;
         }
         m_rpc_server.reset();
-        m_batch_cv.notify_one();
+        m_batch_cv.notify_all();
+        m_exec_cv.notify_one();
 
         // Stop each of the locking shard clients to cancel any pending RPCs
         // and unblock any of the current dtxs so they can mark themselves as
@@ -206,8 +214,31 @@ namespace cbdc::coordinator {
             m_batch_exec_thread.join();
         }
 
-        // Join any existing dtxs still executing
-        join_execs();
+        // Wait for any existing dtxs to finish executing and stop the
+        // executor threads. Queued dtxs still run so their callbacks are
+        // called, but fail quickly as the shard clients are stopped.
+        if(m_exec_pool) {
+            m_exec_pool->wait_idle();
+            auto pool = std::unique_ptr<thread_pool>();
+            {
+                std::lock_guard<std::mutex> l(m_exec_pool_mut);
+                pool = std::move(m_exec_pool);
+            }
+            pool.reset();
+        }
+
+        // Stop the discard thread. Any dtxs not yet discarded remain in the
+        // state machine for the next leader to recover.
+        {
+            std::lock_guard<std::mutex> l(m_discard_mut);
+            m_discarding = false;
+        }
+        m_discard_cv.notify_one();
+        if(m_discard_thread.joinable()) {
+            m_discard_thread.join();
+        }
+        m_discard_pool.reset();
+        m_discard_dtxs.clear();
 
         // Disconnect from the shards
         {
@@ -299,8 +330,7 @@ namespace cbdc::coordinator {
             m_logger->info("Recovering dtx", dtx_id_str);
             // Create a lambda that handles the execution and cleanup of the
             // dtx
-            auto f = [&, c{std::move(coord)}, s{std::move(dtx_id_str)}](
-                         size_t thread_idx) {
+            auto f = [&, c{std::move(coord)}, s{std::move(dtx_id_str)}]() {
                 // Execute the dtx from its most recent phase
                 auto exec_res = c->execute();
                 if(!exec_res) {
@@ -311,19 +341,14 @@ namespace cbdc::coordinator {
                 } else {
                     m_logger->info("Recovered dtx", s);
                 }
-                // Mark the thread we were using as done so it can be re-used
-                {
-                    std::shared_lock<std::shared_mutex> l(m_exec_mut);
-                    m_exec_threads[thread_idx].second = false;
-                }
             };
-            // Schedule the lambda on an available executor thread. Blocks
-            // until there's a thread available
-            schedule_exec(std::move(f));
+            // Queue the lambda for an executor thread. Blocks while the
+            // queue is full
+            m_exec_pool->push(std::move(f));
         }
 
         // Make sure we recovered fully before returning
-        join_execs();
+        m_exec_pool->wait_idle();
 
         return success;
     }
@@ -367,9 +392,17 @@ namespace cbdc::coordinator {
                 // Wait until there are transactions ready to be processed in a
                 // dtx batch
                 std::unique_lock<std::mutex> l(m_batch_mut);
-                m_batch_cv.wait(l, [&]() {
+                m_exec_cv.wait(l, [&]() {
                     return !m_current_txs->empty() || !m_running;
                 });
+                // Give the batch up to the linger time to fill, trading
+                // latency for larger batches
+                if(m_batch_linger.count() > 0) {
+                    m_exec_cv.wait_for(l, m_batch_linger, [&]() {
+                        return m_current_txs->size() >= m_batch_sizer.limit()
+                            || !m_running;
+                    });
+                }
             }
             if(!m_running) {
                 break;
@@ -405,19 +438,29 @@ namespace cbdc::coordinator {
                     decltype(m_current_txs)::element_type>();
             }
 
-            // Notify the handler thread it can re-start adding transactions to
-            // the current batch
-            m_batch_cv.notify_one();
+            // Notify the handler threads they can re-start adding
+            // transactions to the current batch
+            m_batch_cv.notify_all();
 
             // Lambda to execute the batch and respond to the sentinel with the
             // result
-            auto f = [&, b{std::move(batch)}, t{std::move(txs)}](
-                         size_t thread_idx) {
+            auto f = [&, b{std::move(batch)}, t{std::move(txs)}]() {
                 auto dtxid = to_string(b->get_id());
-                m_logger->info("dtxn start:", dtxid, "size:", t->size());
+                // Include the executor occupancy so we can tell when the
+                // number of executor threads limits throughput
+                m_logger->info("dtxn start:",
+                               dtxid,
+                               "size:",
+                               t->size(),
+                               "busy:",
+                               m_exec_pool->busy(),
+                               "queued:",
+                               m_exec_pool->queue_depth());
                 auto s = std::chrono::high_resolution_clock::now();
-                // Execute the batch from the start
-                auto res = b->execute();
+                // Execute the prepare and commit phases of the batch. The
+                // results are final after the commit phase so we can respond
+                // to the sentinels before discarding the dtx.
+                auto res = b->execute_commit();
                 // For each tx result in the batch create a message with
                 // the txid and the result, and send it to the appropriate
                 // sentinel.
@@ -438,22 +481,104 @@ namespace cbdc::coordinator {
                 } else {
                     auto e = std::chrono::high_resolution_clock::now();
                     auto l = (e - s).count();
+                    // Adapt the size of future batches to the latency of
+                    // this one
+                    m_batch_sizer.record(
+                        res->size(),
+                        std::chrono::duration_cast<std::chrono::microseconds>(
+                            e - s));
                     m_logger->info("dtxn done:",
                                    dtxid,
                                    "t:",
                                    l,
                                    "size:",
                                    res->size());
-                }
-                // Mark our thread as done so it can be re-used
-                {
-                    std::shared_lock<std::shared_mutex> l(m_exec_mut);
-                    m_exec_threads[thread_idx].second = false;
+                    // Hand the dtx to the discard thread so this thread can
+                    // start on the next batch while the discard round trips
+                    // are in flight
+                    {
+                        std::lock_guard<std::mutex> ll(m_discard_mut);
+                        m_discard_dtxs.emplace_back(b);
+                    }
+                    m_discard_cv.notify_one();
                 }
             };
-            // Schedule our executor lambda, block until there's a thread
-            // available
-            schedule_exec(std::move(f));
+            // Queue our executor lambda, block while the queue is full so
+            // the next batch keeps growing
+            m_exec_pool->push(std::move(f));
+        }
+    }
+
+    void controller::discard_func() {
+        while(true) {
+            auto dtxs = std::vector<std::shared_ptr<distributed_tx>>();
+            {
+                // Wait until there are committed dtxs to discard
+                std::unique_lock<std::mutex> l(m_discard_mut);
+                m_discard_cv.wait(l, [&]() {
+                    return !m_discard_dtxs.empty() || !m_discarding;
+                });
+                if(!m_discarding) {
+                    break;
+                }
+                std::swap(dtxs, m_discard_dtxs);
+            }
+
+            // Discard every dtx committed since the last round together.
+            // The discard pool replicates the discard state of the dtxs
+            // concurrently, then each shard receives a single discard
+            // request for all of its dtxs. Discards are idempotent by dtx ID
+            // so a failed dtx is safe for the next leader to recover.
+            auto started = std::vector<uint8_t>(dtxs.size());
+            m_discard_pool->parallel_for(dtxs.size(), [&](size_t i) {
+                started[i] = static_cast<uint8_t>(dtxs[i]->begin_discard());
+            });
+
+            auto shards
+                = std::vector<std::shared_ptr<locking_shard::interface>>();
+            {
+                std::shared_lock<std::shared_mutex> l(m_shards_mut);
+                shards = m_shards;
+            }
+            auto shard_dtxs = std::vector<std::vector<hash_t>>(shards.size());
+            for(size_t i{0}; i < dtxs.size(); i++) {
+                if(started[i] == 0) {
+                    continue;
+                }
+                for(auto s : dtxs[i]->active_shards()) {
+                    shard_dtxs[s].emplace_back(dtxs[i]->get_id());
+                }
+            }
+
+            auto results = std::vector<std::future<bool>>(shards.size());
+            for(size_t s{0}; s < shards.size(); s++) {
+                auto res = std::make_shared<std::promise<bool>>();
+                results[s] = res->get_future();
+                shards[s]->discard_dtxs(std::move(shard_dtxs[s]),
+                                        [res](bool r) {
+                                            res->set_value(r);
+                                        });
+            }
+            auto discarded = std::vector<uint8_t>(shards.size());
+            for(size_t s{0}; s < shards.size(); s++) {
+                discarded[s] = static_cast<uint8_t>(results[s].get());
+            }
+
+            m_discard_pool->parallel_for(dtxs.size(), [&](size_t i) {
+                if(started[i] == 0) {
+                    m_logger->warn("dtxn discard failed:",
+                                   to_string(dtxs[i]->get_id()));
+                    return;
+                }
+                auto ok = true;
+                for(auto s : dtxs[i]->active_shards()) {
+                    ok = ok && discarded[s] != 0;
+                }
+                if(!dtxs[i]->finish_discard(ok)) {
+                    m_logger->warn("dtxn discard failed:",
+                                   to_string(dtxs[i]->get_id()));
+                }
+            });
         }
     }
 
@@ -488,51 +613,6 @@ namespace cbdc::coordinator {
         }
     }
 
-    void controller::schedule_exec(std::function<void(size_t)>&& f) {
-        // Loop until we successfully scheduled the given lambda on a thread
-        bool found_thread{false};
-        while(!found_thread) {
-            {
-                std::unique_lock<std::shared_mutex> l(m_exec_mut);
-                for(size_t i{0}; i < m_exec_threads.size(); i++) {
-                    auto& thr = m_exec_threads[i];
-                    // If the thread is marked done we can use it
-                    if(!thr.second) {
-                        // Make sure the previous thread is joined
-                        if(thr.first && thr.first->joinable()) {
-                            thr.first->join();
-                        }
-                        // Mark the thread as in-use
-                        thr.second = true;
-                        // Start the thread with the given lambda and provide
-                        // index of the thread so it can mark itself as done
-                        // Not use-after-move because the outer loop exits once
-                        // f has been moved due to found_thread.
-                        thr.first // NOLINTNEXTLINE(bugprone-use-after-move)
-                            = std::make_shared<std::thread>(std::move(f), i);
-                        found_thread = true;
-                        break;
-                    }
-                }
-            }
-            if(!found_thread) {
-                // For now just yield to the scheduler if there were no
-                // complete threads this time. In the future this could be a
-                // condition variable instead.
-                std::this_thread::yield();
-            }
-        }
-    }
-
-    void controller::join_execs() {
-        std::shared_lock<std::shared_mutex> l(m_exec_mut);
-        for(auto& t : m_exec_threads) {
-            if(t.first && t.first->joinable()) {
-                t.first->join();
-            }
-        }
-    }
-
     void controller::start_stop_func() {
         while(!m_quit) {
             bool stopping{false};
@@ -595,6 +675,13 @@ namespace cbdc::coordinator {
         m_logger->warn("Connecting to shards");
         // Connect to the shard clusters
         connect_shards();
+        // Start the executor threads for recovered and new dtxs
+        {
+            std::lock_guard<std::mutex> l(m_exec_pool_mut);
+            m_exec_pool = std::make_unique<thread_pool>(
+                m_opts.m_coordinator_max_threads,
+                m_max_queued_dtxs);
+        }
         m_logger->warn("Became leader, recovering dtxs");
         // Attempt recovery of existing dtxs until we stop being the leader or
         // recovery succeeds
@@ -635,6 +722,17 @@ namespace cbdc::coordinator {
                 = std::make_shared<decltype(m_current_txs)::element_type>();
         }
 
+        // Start the thread discarding committed dtxs
+        {
+            std::lock_guard<std::mutex> ll(m_discard_mut);
+            m_discarding = true;
+        }
+        m_discard_pool
+            = std::make_unique<thread_pool>(m_opts.m_coordinator_max_threads);
+        m_discard_thread = std::thread([&] {
+            discard_func();
+        });
+
         // Start the batch executor thread
         m_batch_exec_thread = std::thread([&] {
             batch_executor_func();
@@ -689,6 +787,11 @@ namespace cbdc::coordinator {
             return false;
         }
 
+        // Each call carries a single transaction, which must be verified
+        // before it joins the current batch and is acknowledged to the
+        // sentinel, so there is no batch to verify together here. The RPC
+        // handler threads calling this method verify their transactions
+        // concurrently instead.
         if(!transaction::validation::check_attestations(
                tx,
                m_opts.m_sentinel_public_keys,
@@ -702,7 +805,8 @@ namespace cbdc::coordinator {
             // Wait until there's space in the current batch
             std::unique_lock<std::mutex> l(m_batch_mut);
             m_batch_cv.wait(l, [&]() {
-                return m_current_txs->size() < m_batch_size || !m_running;
+                return m_current_txs->size() < m_batch_sizer.limit()
+                    || !m_running;
             });
             if(!m_running) {
                 return false;
@@ -724,9 +828,20 @@ namespace cbdc::coordinator {
         if(added) {
             // If this was a new TX, notify the executor thread there's work to
             // do
-            m_batch_cv.notify_one();
+            m_exec_cv.notify_one();
         }
 
         return added;
     }
+
+    auto controller::get_executor_stats() -> executor_stats {
+        std::lock_guard<std::mutex> l(m_exec_pool_mut);
+        auto stats = executor_stats();
+        if(m_exec_pool) {
+            stats.m_threads = m_exec_pool->size();
+            stats.m_busy = m_exec_pool->busy();
+            stats.m_queued = m_exec_pool->queue_depth();
+        }
+        return stats;
+    }
 }
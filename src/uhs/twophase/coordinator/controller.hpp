@@ -6,6 +6,7 @@
 #ifndef OPENCBDC_TX_SRC_COORDINATOR_CONTROLLER_H_
 #define OPENCBDC_TX_SRC_COORDINATOR_CONTROLLER_H_
 
+#include "batch_sizer.hpp"
 #include "distributed_tx.hpp"
 #include "interface.hpp"
 #include "server.hpp"
@@ -13,6 +14,7 @@
 #include "uhs/twophase/locking_shard/locking_shard.hpp"
 #include "util/common/buffer.hpp"
 #include "util/common/random_source.hpp"
+#include "util/common/thread_pool.hpp"
 #include "util/network/connection_manager.hpp"
 #include "util/raft/node.hpp"
 
@@ -135,6 +137,23 @@ namespace cbdc::coordinator {
                                  callback_type result_callback)
             -> bool override;
 
+        /// Occupancy of the pool of threads executing dtxs.
+        struct executor_stats {
+            /// Number of executor threads. Zero unless this node is the
+            /// leader.
+            size_t m_threads{0};
+            /// Number of executor threads running a dtx.
+            size_t m_busy{0};
+            /// Number of dtxs waiting for an executor thread.
+            size_t m_queued{0};
+        };
+
+        /// Returns the current occupancy of the dtx executor pool. A pool
+        /// whose threads are all busy with dtxs queued limits throughput,
+        /// and may need more coordinator_max_threads.
+        /// \return executor occupancy.
+        [[nodiscard]] auto get_executor_stats() -> executor_stats;
+
       private:
         size_t m_node_id;
         size_t m_coordinator_id;
@@ -150,20 +169,41 @@ namespace cbdc::coordinator {
         std::vector<cbdc::config::shard_range_t> m_shard_ranges;
         random_source m_rnd{config::random_source};
         std::mutex m_batch_mut;
+        /// Notifies the handler threads there's space in the current batch.
         std::condition_variable m_batch_cv;
+        /// Notifies the batch executor thread the current batch changed.
+        std::condition_variable m_exec_cv;
         std::shared_ptr<distributed_tx> m_current_batch;
         std::shared_ptr<std::unordered_map<hash_t,
                                            std::pair<callback_type, size_t>,
                                            hashing::const_sip_hash<hash_t>>>
             m_current_txs;
-        size_t m_batch_size;
+        batch_sizer m_batch_sizer;
+        std::chrono::microseconds m_batch_linger;
         std::shared_mutex m_shards_mut;
         std::thread m_batch_exec_thread;
         std::unique_ptr<rpc::server> m_rpc_server;
         network::endpoint_t m_handler_endpoint;
-        std::vector<std::pair<std::shared_ptr<std::thread>, std::atomic_bool>>
-            m_exec_threads;
-        std::shared_mutex m_exec_mut;
+        /// Executes dtxs. Created by start() and destroyed by stop().
+        std::unique_ptr<thread_pool> m_exec_pool;
+        /// Protects m_exec_pool while it is created and destroyed, so the
+        /// executor statistics can be read from other threads.
+        std::mutex m_exec_pool_mut;
+        /// Number of dtxs which may wait for an executor thread before the
+        /// batch executor blocks. Keeping this small lets the next batch
+        /// grow while all the executor threads are busy.
+        static constexpr size_t m_max_queued_dtxs{1};
+
+        /// Dtxs whose commit phase completed, waiting for the discard
+        /// thread to discard them as a group.
+        std::vector<std::shared_ptr<distributed_tx>> m_discard_dtxs;
+        std::mutex m_discard_mut;
+        std::condition_variable m_discard_cv;
+        bool m_discarding{false};
+        std::thread m_discard_thread;
+        /// Replicates the discard state of each dtx in a group. Created and
+        /// destroyed with the discard thread.
+        std::unique_ptr<thread_pool> m_discard_pool;
 
         std::thread m_start_thread;
         bool m_start_flag{false};
@@ -182,6 +222,8 @@ namespace cbdc::coordinator {
 
         void batch_executor_func();
 
+        void discard_func();
+
         auto raft_callback(nuraft::cb_func::Type type,
                            nuraft::cb_func::Param* param)
             -> nuraft::cb_func::ReturnCode;
@@ -202,10 +244,6 @@ namespace cbdc::coordinator {
             -> std::optional<nuraft::ptr<nuraft::buffer>>;
 
         void connect_shards();
-
-        void schedule_exec(std::function<void(size_t)>&& f);
-
-        void join_execs();
     };
 }
 
@@ -5,9 +5,53 @@
 
 #include "distributed_tx.hpp"
 
-#include <future>
+#include <condition_variable>
+#include <mutex>
 
 namespace cbdc::coordinator {
+    namespace {
+        /// Gathers the results of asynchronous requests to several shards.
+        /// Shared with the response callbacks, which may outlive the caller
+        /// of wait() if they are still returning after the last result.
+        template<typename T>
+        class shard_results {
+          public:
+            /// Constructor.
+            /// \param count number of results to wait for.
+            explicit shard_results(size_t count)
+                : m_results(count),
+                  m_remaining(count) {}
+
+            /// Sets one of the results.
+            /// \param idx index of the result.
+            /// \param res result value.
+            void set(size_t idx, T res) {
+                {
+                    std::unique_lock<std::mutex> l(m_mut);
+                    m_results[idx] = std::move(res);
+                    m_remaining--;
+                }
+                m_cv.notify_one();
+            }
+
+            /// Blocks until all the results are set.
+            /// \return the results, in index order.
+            auto wait() -> std::vector<T>& {
+                std::unique_lock<std::mutex> l(m_mut);
+                m_cv.wait(l, [&]() {
+                    return m_remaining == 0;
+                });
+                return m_results;
+            }
+
+          private:
+            std::vector<T> m_results;
+            size_t m_remaining;
+            std::mutex m_mut;
+            std::condition_variable m_cv;
+        };
+    }
+
     distributed_tx::distributed_tx(
         const hash_t& dtx_id,
         std::vector<std::shared_ptr<locking_shard::interface>> shards,
@@ -28,40 +72,42 @@ namespace cbdc::coordinator {
                 return std::nullopt;
             }
         }
-        auto futures = std::vector<
-            std::pair<std::future<std::optional<std::vector<bool>>>,
-                      size_t>>();
-        for(size_t i{0}; i < m_shards.size(); i++) {
-            if(m_tx_idxs[i].empty()) {
-                continue;
-            }
-            const auto& shard = m_shards[i];
-            auto f = std::async(std::launch::async,
-                                &locking_shard::interface::lock_outputs,
-                                shard,
-                                std::move(m_txs[i]),
-                                m_dtx_id);
-            futures.emplace_back(std::move(f), i);
+        // Send the lock requests to all the participating shards at once
+        // and wait for every response
+        auto shard_idxs = active_shards();
+        auto results = std::make_shared<
+            shard_results<std::optional<std::vector<bool>>>>(
+            shard_idxs.size());
+        for(size_t i{0}; i < shard_idxs.size(); i++) {
+            const auto shard_idx = shard_idxs[i];
+            m_shards[shard_idx]->lock_outputs(
+                std::move(m_txs[shard_idx]),
+                m_dtx_id,
+                [results, i](std::optional<std::vector<bool>> res) {
+                    results->set(i, std::move(res));
+                });
         }
         auto ret = std::vector<bool>(m_full_txs.size(), true);
-        for(auto& f : futures) {
-            auto res = f.first.get();
+        auto& responses = results->wait();
+        for(size_t i{0}; i < shard_idxs.size(); i++) {
+            const auto& res = responses[i];
+            const auto& tx_idxs = m_tx_idxs[shard_idxs[i]];
             if(!res) {
                 m_state = dtx_state::failed;
                 return std::nullopt;
             }
-            if(res->size() != m_tx_idxs[f.second].size()) {
+            if(res->size() != tx_idxs.size()) {
                 m_logger->fatal(
                     "Shard prepare response has not enough statuses",
                     to_string(m_dtx_id),
                     "expected:",
-                    m_tx_idxs[f.second].size(),
+                    tx_idxs.size(),
                     "got:",
                     res->size());
             }
-            for(size_t i{0}; i < res->size(); i++) {
-                if(!(*res)[i]) {
-                    ret[m_tx_idxs[f.second][i]] = false;
+            for(size_t j{0}; j < res->size(); j++) {
+                if(!(*res)[j]) {
+                    ret[tx_idxs[j]] = false;
                 }
             }
         }
@@ -78,25 +124,23 @@ namespace cbdc::coordinator {
                 return false;
             }
         }
-        auto futures = std::vector<std::future<bool>>();
-        for(size_t i{0}; i < m_shards.size(); i++) {
-            if(m_tx_idxs[i].empty()) {
-                continue;
-            }
-            const auto& shard = m_shards[i];
-            auto shard_complete_txs = std::vector<bool>(m_tx_idxs[i].size());
+        auto shard_idxs = active_shards();
+        auto results
+            = std::make_shared<shard_results<bool>>(shard_idxs.size());
+        for(size_t i{0}; i < shard_idxs.size(); i++) {
+            const auto shard_idx = shard_idxs[i];
+            const auto& tx_idxs = m_tx_idxs[shard_idx];
+            auto shard_complete_txs = std::vector<bool>(tx_idxs.size());
             for(size_t j{0}; j < shard_complete_txs.size(); j++) {
-                shard_complete_txs[j] = complete_txs[m_tx_idxs[i][j]];
+                shard_complete_txs[j] = complete_txs[tx_idxs[j]];
             }
-            auto f = std::async(std::launch::async,
-                                &locking_shard::interface::apply_outputs,
-                                shard,
-                                std::move(shard_complete_txs),
-                                m_dtx_id);
-            futures.emplace_back(std::move(f));
+            m_shards[shard_idx]->apply_outputs(std::move(shard_complete_txs),
+                                               m_dtx_id,
+                                               [results, i](bool res) {
+                                                   results->set(i, res);
+                                               });
         }
-        for(auto& f : futures) {
-            auto res = f.get();
+        for(auto res : results->wait()) {
             if(!res) {
                 m_state = dtx_state::failed;
                 return false;
@@ -107,6 +151,18 @@ namespace cbdc::coordinator {
     }
 
     auto distributed_tx::execute() -> std::optional<std::vector<bool>> {
+        auto res = execute_commit();
+        if(!res) {
+            return std::nullopt;
+        }
+        if(!execute_discard()) {
+            return std::nullopt;
+        }
+        return res;
+    }
+
+    auto distributed_tx::execute_commit()
+        -> std::optional<std::vector<bool>> {
         auto dtxid_str = to_string(m_dtx_id);
         if(m_state == dtx_state::prepare || m_state == dtx_state::start) {
             m_logger->info("Preparing", dtxid_str);
@@ -133,15 +189,20 @@ namespace cbdc::coordinator {
             }
             m_logger->info("Committed", dtxid_str);
         }
+        return m_complete_txs;
+    }
+
+    auto distributed_tx::execute_discard() -> bool {
         if(m_state == dtx_state::discard) {
+            auto dtxid_str = to_string(m_dtx_id);
             m_logger->info("Discarding", dtxid_str);
             auto res = discard();
             if(!res) {
-                return std::nullopt;
+                return false;
             }
             m_logger->info("Discarded", dtxid_str);
         }
-        return m_complete_txs;
+        return m_state == dtx_state::done;
     }
 
     auto distributed_tx::add_tx(const transaction::compact_tx& tx) -> size_t {
@@ -177,7 +238,10 @@ namespace cbdc::coordinator {
         return m_full_txs.size() - 1;
     }
 
-    auto distributed_tx::discard() -> bool {
+    auto distributed_tx::begin_discard() -> bool {
+        if(m_state != dtx_state::discard) {
+            return false;
+        }
         if(m_discard_cb) {
             auto res = m_discard_cb(m_dtx_id);
             if(!res) {
@@ -185,24 +249,13 @@ namespace cbdc::coordinator {
                 return false;
             }
         }
-        auto futures = std::vector<std::future<bool>>();
-        for(size_t i{0}; i < m_shards.size(); i++) {
-            if(m_tx_idxs[i].empty()) {
-                continue;
-            }
-            const auto& shard = m_shards[i];
-            auto f = std::async(std::launch::async,
-                                &locking_shard::interface::discard_dtx,
-                                shard,
-                                m_dtx_id);
-            futures.emplace_back(std::move(f));
-        }
-        for(auto& f : futures) {
-            auto res = f.get();
-            if(!res) {
-                m_state = dtx_state::failed;
-                return false;
-            }
+        return true;
+    }
+
+    auto distributed_tx::finish_discard(bool discarded) -> bool {
+        if(!discarded) {
+            m_state = dtx_state::failed;
+            return false;
         }
         if(m_done_cb) {
             auto res = m_done_cb(m_dtx_id);
@@ -215,6 +268,36 @@ namespace cbdc::coordinator {
         return true;
     }
 
+    auto distributed_tx::discard() -> bool {
+        if(!begin_discard()) {
+            return false;
+        }
+        auto shard_idxs = active_shards();
+        auto results
+            = std::make_shared<shard_results<bool>>(shard_idxs.size());
+        for(size_t i{0}; i < shard_idxs.size(); i++) {
+            m_shards[shard_idxs[i]]->discard_dtx(m_dtx_id,
+                                                 [results, i](bool res) {
+                                                     results->set(i, res);
+                                                 });
+        }
+        auto discarded = true;
+        for(auto res : results->wait()) {
+            discarded = discarded && res;
+        }
+        return finish_discard(discarded);
+    }
+
+    auto distributed_tx::active_shards() const -> std::vector<size_t> {
+        auto ret = std::vector<size_t>();
+        for(size_t i{0}; i < m_shards.size(); i++) {
+            if(!m_tx_idxs[i].empty()) {
+                ret.push_back(i);
+            }
+        }
+        return ret;
+    }
+
     auto distributed_tx::get_id() const -> hash_t {
         return m_dtx_id;
     }
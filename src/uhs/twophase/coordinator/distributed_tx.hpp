@@ -40,6 +40,40 @@ namespace cbdc::coordinator {
         ///         were rolled back by the transaction's index in the batch.
         [[nodiscard]] auto execute() -> std::optional<std::vector<bool>>;
 
+        /// Executes the prepare and commit phases of the dtx batch, either
+        /// from the start or an intermediate state if one of the recover
+        /// functions were used. Leaves the dtx ready for \ref
+        /// execute_discard. The results are final once the commit phase
+        /// completes, so they can be reported before the discard phase.
+        /// \return empty optional if the dtx failed, or a vector of flags
+        ///         indicating which constituent transactions settled and which
+        ///         were rolled back by the transaction's index in the batch.
+        [[nodiscard]] auto execute_commit()
+            -> std::optional<std::vector<bool>>;
+
+        /// Executes the discard phase of the dtx batch after \ref
+        /// execute_commit completed.
+        /// \return true if the dtx completed, false if it failed.
+        [[nodiscard]] auto execute_discard() -> bool;
+
+        /// Starts the discard phase of the dtx batch after \ref
+        /// execute_commit completed, without contacting the shards. Used
+        /// with \ref finish_discard by callers discarding a group of dtxs
+        /// together with locking_shard::interface::discard_dtxs.
+        /// \return true if the dtx is ready for the shards to discard it,
+        ///         false if it failed.
+        [[nodiscard]] auto begin_discard() -> bool;
+
+        /// Completes the discard phase started by \ref begin_discard.
+        /// \param discarded true if every shard in \ref active_shards
+        ///                  discarded the dtx.
+        /// \return true if the dtx completed, false if it failed.
+        [[nodiscard]] auto finish_discard(bool discarded) -> bool;
+
+        /// Returns the indexes of the shards with transactions in the batch.
+        /// \return shard indexes, in the order passed to the constructor.
+        [[nodiscard]] auto active_shards() const -> std::vector<size_t>;
+
         /// Adds a TX to the batch managed by this coordinator and dtx ID.
         /// Should not be used after calling execute().
         /// \param tx compact transaction to add
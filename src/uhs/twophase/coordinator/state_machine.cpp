@@ -8,9 +8,47 @@
 #include "controller.hpp"
 #include "format.hpp"
 #include "util/raft/serialization.hpp"
+#include "util/serialization/format.hpp"
 #include "util/serialization/util.hpp"
 
 namespace cbdc::coordinator {
+    namespace {
+        using buffer_map = std::unordered_map<hash_t,
+                                              nuraft::ptr<nuraft::buffer>,
+                                              hashing::const_sip_hash<hash_t>>;
+
+        // Unlike the response to a get command, snapshots store the length
+        // of each dtx's buffer so the state can be read back as-is.
+        auto write_buffers(serializer& ser, const buffer_map& bufs) -> bool {
+            ser << static_cast<uint64_t>(bufs.size());
+            for(const auto& [dtx_id, buf] : bufs) {
+                ser << dtx_id << static_cast<uint64_t>(buf->size());
+                ser.write(buf->data_begin(), buf->size());
+            }
+            return static_cast<bool>(ser);
+        }
+
+        auto read_buffers(serializer& deser, buffer_map& bufs) -> bool {
+            auto count = uint64_t();
+            if(!(deser >> count)) {
+                return false;
+            }
+            for(uint64_t i{0}; i < count; i++) {
+                auto dtx_id = hash_t();
+                auto sz = uint64_t();
+                if(!(deser >> dtx_id >> sz)) {
+                    return false;
+                }
+                auto buf = nuraft::buffer::alloc(sz);
+                if(!deser.read(buf->data_begin(), buf->size())) {
+                    return false;
+                }
+                bufs.emplace(dtx_id, std::move(buf));
+            }
+            return true;
+        }
+    }
+
     auto state_machine::commit(uint64_t log_idx, nuraft::buffer& data)
         -> nuraft::ptr<nuraft::buffer> {
         assert(log_idx == m_last_committed_idx + 1);
@@ -98,13 +136,47 @@ namespace cbdc::coordinator {
         m_last_committed_idx = log_idx;
     }
 
-    auto state_machine::apply_snapshot(nuraft::snapshot& /* s */) -> bool {
-        // TODO: implement snapshots (cf. #768)
-        return false;
+    auto
+    state_machine::read_logical_snp_obj(nuraft::snapshot& s,
+                                        void*& user_snp_ctx,
+                                        nuraft::ulong obj_id,
+                                        nuraft::ptr<nuraft::buffer>& data_out,
+                                        bool& is_last_obj) -> int {
+        return m_snapshots.read_object(s,
+                                       user_snp_ctx,
+                                       obj_id,
+                                       data_out,
+                                       is_last_obj);
+    }
+
+    void state_machine::save_logical_snp_obj(nuraft::snapshot& s,
+                                             nuraft::ulong& obj_id,
+                                             nuraft::buffer& data,
+                                             bool is_first_obj,
+                                             bool is_last_obj) {
+        m_snapshots.save_object(s, obj_id, data, is_first_obj, is_last_obj);
+    }
+
+    void state_machine::free_user_snp_ctx(void*& user_snp_ctx) {
+        raft::snapshot_store::free_context(user_snp_ctx);
+    }
+
+    auto state_machine::apply_snapshot(nuraft::snapshot& s) -> bool {
+        auto state = coordinator_state();
+        if(!m_snapshots.read(s, [&](serializer& deser) {
+               return read_buffers(deser, state.m_prepare_txs)
+                   && read_buffers(deser, state.m_commit_txs)
+                   && deser >> state.m_discard_txs;
+           })) {
+            return false;
+        }
+        m_state = std::move(state);
+        m_last_committed_idx = s.get_last_log_idx();
+        return true;
     }
 
     auto state_machine::last_snapshot() -> nuraft::ptr<nuraft::snapshot> {
-        return nullptr;
+        return m_snapshots.last_snapshot();
     }
 
     auto state_machine::last_commit_index() -> uint64_t {
@@ -112,13 +184,30 @@ namespace cbdc::coordinator {
     }
 
     void state_machine::create_snapshot(
-        nuraft::snapshot& /* s */,
+        nuraft::snapshot& s,
         nuraft::async_result<bool>::handler_type& when_done) {
-        bool res{false};
-        auto snp = nuraft::ptr<std::exception>();
-        when_done(res, snp);
+        assert(s.get_last_log_idx() == last_commit_index());
+        // The dtx buffers are never modified once committed, so copying the
+        // maps of pointers is enough to snapshot the state.
+        auto state = std::make_shared<coordinator_state>(m_state);
+        m_snapshots.write_async(
+            s,
+            [state](serializer& ser) {
+                return write_buffers(ser, state->m_prepare_txs)
+                    && write_buffers(ser, state->m_commit_txs)
+                    && ser << state->m_discard_txs;
+            },
+            when_done);
     }
 
-    state_machine::state_machine(std::shared_ptr<logging::log> logger)
-        : m_logger(std::move(logger)) {}
+    state_machine::state_machine(std::shared_ptr<logging::log> logger,
+                                 std::string snapshot_dir)
+        : m_logger(std::move(logger)),
+          m_snapshots(std::move(snapshot_dir), m_logger) {
+        auto snp = m_snapshots.last_snapshot();
+        if(snp && !state_machine::apply_snapshot(*snp)) {
+            m_logger->fatal("Failed to restore snapshot",
+                            snp->get_last_log_idx());
+        }
+    }
 }
@@ -8,6 +8,7 @@
 
 #include "util/common/hashmap.hpp"
 #include "util/common/logging.hpp"
+#include "util/raft/snapshot_store.hpp"
 
 #include <libnuraft/nuraft.hxx>
 #include <unordered_map>
@@ -21,10 +22,14 @@ namespace cbdc::coordinator {
     class state_machine final : public nuraft::state_machine {
       public:
         /// Constructor.
-        /// Constructs a new coordinator state machine.
+        /// Constructs a new coordinator state machine, restoring the newest
+        /// snapshot in the snapshot directory if there is one.
         ///
         /// \param logger pointer to logger instance.
-        explicit state_machine(std::shared_ptr<logging::log> logger);
+        /// \param snapshot_dir path to directory in which to store snapshots.
+        ///                     Will create the directory if it doesn't exist.
+        state_machine(std::shared_ptr<logging::log> logger,
+                      std::string snapshot_dir);
 
         /// Types of command the state machine can process.
         enum class command : uint8_t {
@@ -71,26 +76,72 @@ namespace cbdc::coordinator {
             nuraft::ulong log_idx,
             nuraft::ptr<nuraft::cluster_config>& /*new_conf*/) override;
 
-        /// Not implemented for coordinators.
-        /// \return false (unconditionally).
-        auto apply_snapshot(nuraft::snapshot& /* s */) -> bool override;
+        /// Read the portion of the state machine snapshot associated with
+        /// the given metadata and object ID into a buffer.
+        /// \param s metadata of snapshot to read.
+        /// \param user_snp_ctx pointer to a snapshot context; must be provided
+        ///                     to all successive calls to this method for the
+        ///                     same snapshot.
+        /// \param obj_id ID of the snapshot object to read.
+        /// \param data_out buffer in which to write the snapshot object.
+        /// \param is_last_obj set to true if this object ID is the last
+        ///                    snapshot object.
+        /// \return 0 if the object was read successfully.
+        auto read_logical_snp_obj(nuraft::snapshot& s,
+                                  void*& user_snp_ctx,
+                                  nuraft::ulong obj_id,
+                                  nuraft::ptr<nuraft::buffer>& data_out,
+                                  bool& is_last_obj) -> int override;
 
-        /// Not implemented for coordinators.
-        /// \return nullptr (unconditionally).
+        /// Saves the portion of the state machine snapshot associated with
+        /// the given metadata and object ID into persistent storage.
+        /// \param s metadata of snapshot to save.
+        /// \param obj_id ID of the snapshot object to save. Set to the ID of
+        ///               the next object to request.
+        /// \param data buffer from which to read the snapshot object data to
+        ///             save.
+        /// \param is_first_obj true if this object ID is the first snapshot
+        ///                     object.
+        /// \param is_last_obj true if this object ID is the last snapshot
+        ///                    object.
+        void save_logical_snp_obj(nuraft::snapshot& s,
+                                  nuraft::ulong& obj_id,
+                                  nuraft::buffer& data,
+                                  bool is_first_obj,
+                                  bool is_last_obj) override;
+
+        /// Releases the snapshot context created by
+        /// \ref read_logical_snp_obj.
+        /// \param user_snp_ctx snapshot context to free.
+        void free_user_snp_ctx(void*& user_snp_ctx) override;
+
+        /// Replaces the coordinator state with the state stored in the
+        /// snapshot referenced by the given snapshot metadata.
+        /// \param s snapshot metadata.
+        /// \return true if the operation successfully applied the snapshot.
+        auto apply_snapshot(nuraft::snapshot& s) -> bool override;
+
+        /// Returns the most recent snapshot metadata.
+        /// \return snapshot metadata, or nullptr if there is no snapshot.
         auto last_snapshot() -> nuraft::ptr<nuraft::snapshot> override;
 
         /// Returns the index of the last-committed command.
         auto last_commit_index() -> uint64_t override;
 
-        /// Not implemented for coordinators.
+        /// Creates a snapshot of the dtxs currently in progress with the
+        /// given metadata. The state is written to disk in the background.
+        /// \param s snapshot metadata.
+        /// \param when_done function to call when snapshot creation is
+        ///                  complete.
         void create_snapshot(
-            nuraft::snapshot& /* s */,
+            nuraft::snapshot& s,
             nuraft::async_result<bool>::handler_type& when_done) override;
 
       private:
         std::atomic<uint64_t> m_last_committed_idx{0};
         coordinator_state m_state{};
         std::shared_ptr<logging::log> m_logger;
+        raft::snapshot_store m_snapshots;
     };
 }
 
@@ -8,6 +8,8 @@
 #include "format.hpp"
 #include "util/serialization/format.hpp"
 
+#include <tuple>
+
 namespace cbdc::locking_shard::rpc {
     client::client(std::vector<network::endpoint_t> endpoints,
                    const std::pair<uint8_t, uint8_t>& output_range,
@@ -23,6 +25,9 @@ namespace cbdc::locking_shard::rpc {
     }
 
     auto client::init() -> bool {
+        m_retry_thread = std::thread([&]() {
+            retry_func();
+        });
         return m_client->init();
     }
 
@@ -36,6 +41,20 @@ namespace cbdc::locking_shard::rpc {
         return std::get<lock_response>(resp.value());
     }
 
+    void client::lock_outputs(std::vector<tx>&& txs,
+                              const hash_t& dtx_id,
+                              lock_callback_type result_callback) {
+        send_request(request{dtx_id, std::move(txs)},
+                     [cb = std::move(result_callback)](
+                         std::optional<response> res) {
+                         if(!res.has_value()) {
+                             cb(std::nullopt);
+                             return;
+                         }
+                         cb(std::get<lock_response>(std::move(res.value())));
+                     });
+    }
+
     auto client::apply_outputs(std::vector<bool>&& complete_txs,
                                const hash_t& dtx_id) -> bool {
         auto req = request{dtx_id, std::move(complete_txs)};
@@ -43,12 +62,49 @@ namespace cbdc::locking_shard::rpc {
         return res.has_value();
     }
 
+    void client::apply_outputs(std::vector<bool>&& complete_txs,
+                               const hash_t& dtx_id,
+                               result_callback_type result_callback) {
+        send_request(request{dtx_id, std::move(complete_txs)},
+                     [cb = std::move(result_callback)](
+                         std::optional<response> res) {
+                         cb(res.has_value());
+                     });
+    }
+
     auto client::discard_dtx(const hash_t& dtx_id) -> bool {
         auto req = request{dtx_id, discard_params()};
         auto res = send_request(req);
         return res.has_value();
     }
 
+    void client::discard_dtx(const hash_t& dtx_id,
+                             result_callback_type result_callback) {
+        send_request(request{dtx_id, discard_params()},
+                     [cb = std::move(result_callback)](
+                         std::optional<response> res) {
+                         cb(res.has_value());
+                     });
+    }
+
+    void client::discard_dtxs(std::vector<hash_t> dtx_ids,
+                              result_callback_type result_callback) {
+        if(dtx_ids.empty()) {
+            result_callback(true);
+            return;
+        }
+        // The first dtx ID is the ID of the request, the rest travel in the
+        // discard parameters
+        auto dtx_id = dtx_ids.front();
+        dtx_ids.erase(dtx_ids.begin());
+        auto req = request{dtx_id, discard_batch_params(std::move(dtx_ids))};
+        send_request(std::move(req),
+                     [cb = std::move(result_callback)](
+                         std::optional<response> res) {
+                         cb(res.has_value());
+                     });
+    }
+
     auto client::send_request(const request& req) -> std::optional<response> {
         auto result_timeout = std::chrono::seconds(3);
         constexpr auto max_result_timeout = std::chrono::seconds(10);
@@ -68,8 +124,136 @@ namespace cbdc::locking_shard::rpc {
         return res;
     }
 
+    void client::send_request(request req,
+                              response_callback_type result_callback) {
+        uint64_t id{};
+        {
+            std::unique_lock<std::mutex> l(m_pending_mut);
+            if(!m_running) {
+                l.unlock();
+                result_callback(std::nullopt);
+                return;
+            }
+            id = m_next_request++;
+            auto& pending = m_pending[id];
+            pending.m_req = req;
+            pending.m_callback = std::move(result_callback);
+            pending.m_in_flight = true;
+            pending.m_timeout = m_initial_timeout;
+        }
+        send_attempt(id, 0, req, m_initial_timeout);
+    }
+
+    void client::send_attempt(uint64_t id,
+                              uint64_t attempt,
+                              const request& req,
+                              std::chrono::milliseconds timeout) {
+        // The RPC client calls back with std::nullopt if the attempt times
+        // out, so a lost response is retried like a failed send
+        auto sent = m_client->call(
+            req,
+            [this, id, attempt](std::optional<response> res) {
+                handle_response(id, attempt, std::move(res));
+            },
+            timeout);
+        if(!sent) {
+            handle_response(id, attempt, std::nullopt);
+        }
+    }
+
+    void client::handle_response(uint64_t id,
+                                 uint64_t attempt,
+                                 std::optional<response> res) {
+        auto cb = response_callback_type();
+        {
+            std::unique_lock<std::mutex> l(m_pending_mut);
+            auto it = m_pending.find(id);
+            // Ignore responses to attempts which already failed
+            if(it == m_pending.end() || it->second.m_attempt != attempt
+               || !it->second.m_in_flight) {
+                return;
+            }
+            if(!res.has_value()) {
+                m_log.warn("Shard request failed");
+                retry_later(id, it->second);
+                l.unlock();
+                m_pending_cv.notify_one();
+                return;
+            }
+            cb = std::move(it->second.m_callback);
+            m_pending.erase(it);
+        }
+        cb(std::move(res));
+    }
+
+    void client::retry_later(uint64_t id, pending_request& pending) {
+        pending.m_in_flight = false;
+        pending.m_timeout = std::min(
+            std::chrono::duration_cast<std::chrono::milliseconds>(
+                m_max_timeout),
+            pending.m_timeout * 2);
+        m_retries.emplace_back(std::chrono::steady_clock::now()
+                                   + m_retry_delay,
+                               id);
+    }
+
+    void client::retry_func() {
+        std::unique_lock<std::mutex> l(m_pending_mut);
+        while(m_running) {
+            if(m_retries.empty()) {
+                m_pending_cv.wait(l, [&]() {
+                    return !m_running || !m_retries.empty();
+                });
+                continue;
+            }
+            const auto now = std::chrono::steady_clock::now();
+            using attempt = std::
+                tuple<uint64_t, uint64_t, request, std::chrono::milliseconds>;
+            auto resend = std::vector<attempt>();
+            while(!m_retries.empty() && m_retries.front().first <= now) {
+                auto id = m_retries.front().second;
+                m_retries.pop_front();
+                auto it = m_pending.find(id);
+                if(it == m_pending.end()) {
+                    continue;
+                }
+                auto& pending = it->second;
+                pending.m_attempt++;
+                pending.m_in_flight = true;
+                resend.emplace_back(id,
+                                    pending.m_attempt,
+                                    pending.m_req,
+                                    pending.m_timeout);
+            }
+            if(!resend.empty()) {
+                // Send outside the lock as responses may arrive immediately
+                l.unlock();
+                for(const auto& [id, n, req, timeout] : resend) {
+                    send_attempt(id, n, req, timeout);
+                }
+                l.lock();
+                continue;
+            }
+            m_pending_cv.wait_until(l, m_retries.front().first);
+        }
+    }
+
     void client::stop() {
-        m_running = false;
+        auto pending = decltype(m_pending)();
+        {
+            std::unique_lock<std::mutex> l(m_pending_mut);
+            m_running = false;
+            std::swap(pending, m_pending);
+            m_retries.clear();
+        }
+        m_pending_cv.notify_one();
+        if(m_retry_thread.joinable()) {
+            m_retry_thread.join();
+        }
         m_client.reset();
+        // Fail any requests still waiting for a response
+        for(auto& [id, p] : pending) {
+            p.m_callback(std::nullopt);
+        }
     }
 }
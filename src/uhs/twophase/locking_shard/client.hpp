@@ -11,6 +11,10 @@
 #include "util/common/logging.hpp"
 #include "util/rpc/tcp_client.hpp"
 
+#include <condition_variable>
+#include <deque>
+#include <unordered_map>
+
 namespace cbdc::locking_shard::rpc {
     /// RPC client for the mutable interface to a locking shard raft cluster.
     class client final : public interface {
@@ -50,6 +54,17 @@ namespace cbdc::locking_shard::rpc {
         auto lock_outputs(std::vector<tx>&& txs, const hash_t& dtx_id)
             -> std::optional<std::vector<bool>> override;
 
+        /// Issues a lock RPC to the remote shard without blocking. Retries
+        /// the RPC until it succeeds or the client is stopped.
+        /// \param txs vector of txs representing the input and output UHS
+        ///            IDs to lock for spending or creation
+        /// \param dtx_id dtx ID for this batch of transactions
+        /// \param result_callback function to call with the response, or
+        ///                        std::nullopt if the client was stopped
+        void lock_outputs(std::vector<tx>&& txs,
+                          const hash_t& dtx_id,
+                          lock_callback_type result_callback) override;
+
         /// Issues an apply RPC to the remote shard and returns its response.
         /// \param complete_txs vector of flags to indicate which transactions
         ///                     in the distributed transaction should be
@@ -59,20 +74,99 @@ namespace cbdc::locking_shard::rpc {
         auto apply_outputs(std::vector<bool>&& complete_txs,
                            const hash_t& dtx_id) -> bool override;
 
+        /// Issues an apply RPC to the remote shard without blocking. Retries
+        /// the RPC until it succeeds or the client is stopped.
+        /// \param complete_txs vector of flags to indicate which transactions
+        ///                     in the distributed transaction should be
+        ///                     finalized or rolled back
+        /// \param dtx_id dtx ID upon which to perform apply
+        /// \param result_callback function to call with true once the apply
+        ///                        succeeded, or false if the client was
+        ///                        stopped
+        void apply_outputs(std::vector<bool>&& complete_txs,
+                           const hash_t& dtx_id,
+                           result_callback_type result_callback) override;
+
         /// Issues a discard RPC to the remote shard and returns its response.
         /// \param dtx_id dtx ID to discard
         /// \return true if the discard operation succeeded
         auto discard_dtx(const hash_t& dtx_id) -> bool override;
 
+        /// Issues a discard RPC to the remote shard without blocking. Retries
+        /// the RPC until it succeeds or the client is stopped.
+        /// \param dtx_id dtx ID to discard
+        /// \param result_callback function to call with true once the
+        ///                        discard succeeded, or false if the client
+        ///                        was stopped
+        void discard_dtx(const hash_t& dtx_id,
+                         result_callback_type result_callback) override;
+
+        /// Issues a single discard RPC for a group of dtxs to the remote
+        /// shard without blocking. Retries the RPC until it succeeds or the
+        /// client is stopped.
+        /// \param dtx_ids dtx IDs to discard
+        /// \param result_callback function to call with true once the
+        ///                        discard succeeded, or false if the client
+        ///                        was stopped
+        void discard_dtxs(std::vector<hash_t> dtx_ids,
+                          result_callback_type result_callback) override;
+
         /// Shuts down the client and unblocks any existing requests waiting
         /// for a response.
         void stop() override;
 
       private:
+        using response_callback_type
+            = std::function<void(std::optional<response>)>;
+
+        /// Asynchronous request awaiting a response from the shard.
+        struct pending_request {
+            /// Request to send, kept for retries.
+            request m_req;
+            /// Function to call with the response.
+            response_callback_type m_callback;
+            /// Number of times the request has been sent.
+            uint64_t m_attempt{0};
+            /// Whether the current attempt is waiting for a response, or
+            /// waiting to be retried.
+            bool m_in_flight{false};
+            /// Timeout for the current attempt.
+            std::chrono::milliseconds m_timeout;
+        };
+
         auto send_request(const request& req) -> std::optional<response>;
 
+        void send_request(request req, response_callback_type result_callback);
+
+        void send_attempt(uint64_t id,
+                          uint64_t attempt,
+                          const request& req,
+                          std::chrono::milliseconds timeout);
+
+        void handle_response(uint64_t id,
+                             uint64_t attempt,
+                             std::optional<response> res);
+
+        void retry_later(uint64_t id, pending_request& pending);
+
+        void retry_func();
+
+        static constexpr auto m_initial_timeout = std::chrono::seconds(3);
+        static constexpr auto m_max_timeout = std::chrono::seconds(10);
+        static constexpr auto m_retry_delay = std::chrono::seconds(1);
+
         std::atomic_bool m_running{true};
 
+        std::mutex m_pending_mut;
+        std::condition_variable m_pending_cv;
+        uint64_t m_next_request{0};
+        std::unordered_map<uint64_t, pending_request> m_pending;
+        /// Failed requests by the time to retry them. Every retry waits for
+        /// the same delay so the times are in order.
+        std::deque<std::pair<std::chrono::steady_clock::time_point, uint64_t>>
+            m_retries;
+        std::thread m_retry_thread;
+
         std::unique_ptr<cbdc::rpc::tcp_client<request, response>> m_client;
 
         logging::log& m_log;
@@ -8,7 +8,40 @@
 #include "uhs/transaction/messages.hpp"
 #include "util/serialization/format.hpp"
 
+#include <type_traits>
+
 namespace cbdc {
+    namespace {
+        /// Writes the snapshot. If the snapshot is not const, releases each
+        /// UHS partition and prepared dtx as soon as it is written.
+        template<typename Snapshot>
+        auto write_snapshot(serializer& ser, Snapshot& s) -> serializer& {
+            constexpr auto release = !std::is_const_v<Snapshot>;
+            // Matches the encoding of the containers in the state struct so
+            // the snapshot can be read back as a state.
+            auto write_sets = [&](auto& sets) {
+                write_varint(ser, static_cast<uint64_t>(sets.size()));
+                for(auto& set : sets) {
+                    ser << *set;
+                    if constexpr(release) {
+                        set.reset();
+                    }
+                }
+            };
+            write_sets(s.m_uhs);
+            write_sets(s.m_locked);
+            write_varint(ser,
+                         static_cast<uint64_t>(s.m_prepared_dtxs.size()));
+            for(auto& [dtx_id, dtx] : s.m_prepared_dtxs) {
+                ser << dtx_id << *dtx;
+                if constexpr(release) {
+                    dtx.reset();
+                }
+            }
+            return ser << s.m_applied_dtxs << s.m_completed_txs;
+        }
+    }
+
     auto operator<<(serializer& packet, const locking_shard::tx& tx)
         -> serializer& {
         return packet << tx.m_tx;
@@ -18,6 +51,43 @@ namespace cbdc {
         return packet >> tx.m_tx;
     }
 
+    auto operator<<(serializer& ser,
+                    const locking_shard::locking_shard::prepared_dtx& p)
+        -> serializer& {
+        return ser << p.m_txs << p.m_results;
+    }
+
+    auto operator>>(serializer& deser,
+                    locking_shard::locking_shard::prepared_dtx& p)
+        -> serializer& {
+        return deser >> p.m_txs >> p.m_results;
+    }
+
+    auto operator<<(serializer& ser,
+                    const locking_shard::locking_shard::state& s)
+        -> serializer& {
+        return ser << s.m_uhs << s.m_locked << s.m_prepared_dtxs
+                   << s.m_applied_dtxs << s.m_completed_txs;
+    }
+
+    auto operator>>(serializer& deser, locking_shard::locking_shard::state& s)
+        -> serializer& {
+        return deser >> s.m_uhs >> s.m_locked >> s.m_prepared_dtxs
+            >> s.m_applied_dtxs >> s.m_completed_txs;
+    }
+
+    auto operator<<(serializer& ser,
+                    const locking_shard::locking_shard::snapshot& s)
+        -> serializer& {
+        return write_snapshot(ser, s);
+    }
+
+    auto operator<<(serializer& ser,
+                    locking_shard::locking_shard::snapshot&& s)
+        -> serializer& {
+        return write_snapshot(ser, s);
+    }
+
     auto operator<<(serializer& packet, const locking_shard::rpc::request& p)
         -> serializer& {
         return packet << p.m_dtx_id << p.m_params;
@@ -14,6 +14,29 @@ namespace cbdc {
         -> serializer&;
     auto operator>>(serializer& packet, locking_shard::tx& tx) -> serializer&;
 
+    auto operator<<(serializer& ser,
+                    const locking_shard::locking_shard::prepared_dtx& p)
+        -> serializer&;
+    auto operator>>(serializer& deser,
+                    locking_shard::locking_shard::prepared_dtx& p)
+        -> serializer&;
+
+    auto operator<<(serializer& ser,
+                    const locking_shard::locking_shard::state& s)
+        -> serializer&;
+    auto operator<<(serializer& ser,
+                    const locking_shard::locking_shard::snapshot& s)
+        -> serializer&;
+    /// Serializes the snapshot like the const overload, but releases each
+    /// UHS partition as soon as it is written. The shard then modifies the
+    /// partition in place again instead of copying it for the rest of the
+    /// write.
+    auto operator<<(serializer& ser,
+                    locking_shard::locking_shard::snapshot&& s)
+        -> serializer&;
+    auto operator>>(serializer& deser, locking_shard::locking_shard::state& s)
+        -> serializer&;
+
     auto operator<<(serializer& packet, const locking_shard::rpc::request& p)
         -> serializer&;
     auto operator>>(serializer& packet, locking_shard::rpc::request& p)
@@ -9,6 +9,7 @@
 #include "uhs/transaction/transaction.hpp"
 #include "util/common/hash.hpp"
 
+#include <functional>
 #include <optional>
 #include <variant>
 #include <vector>
@@ -40,6 +41,15 @@ namespace cbdc::locking_shard {
         interface(interface&&) = delete;
         auto operator=(interface&&) -> interface& = delete;
 
+        /// Callback function type for the result of an asynchronous lock
+        /// operation.
+        using lock_callback_type
+            = std::function<void(std::optional<std::vector<bool>>)>;
+
+        /// Callback function type for the result of an asynchronous apply or
+        /// discard operation. Called with true if the operation succeeded.
+        using result_callback_type = std::function<void(bool)>;
+
         /// Attempts to lock the input hashes for the given vector of
         /// transactions. Only considers input hashes relevant to this shard
         /// based on the shard range. The batch of transactions is a single
@@ -53,6 +63,18 @@ namespace cbdc::locking_shard {
         virtual auto lock_outputs(std::vector<tx>&& txs, const hash_t& dtx_id)
             -> std::optional<std::vector<bool>> = 0;
 
+        /// Asynchronously attempts to lock the input hashes for the given
+        /// vector of transactions, as in the synchronous overload.
+        /// \param txs list of txs to attempt to lock.
+        /// \param dtx_id distributed tx ID for lock operation.
+        /// \param result_callback function to call with the result of the
+        ///                        lock operation. Called exactly once,
+        ///                        possibly before this method returns.
+        virtual void lock_outputs(std::vector<tx>&& txs,
+                                  const hash_t& dtx_id,
+                                  lock_callback_type result_callback)
+            = 0;
+
         /// Completes a previous lock operation by deleting input hashes and
         /// creating output hashes, or unlocking input hashes.
         /// \param complete_txs vector of flags indicating which txs from the
@@ -66,6 +88,21 @@ namespace cbdc::locking_shard {
                                    const hash_t& dtx_id) -> bool
             = 0;
 
+        /// Asynchronously completes a previous lock operation, as in the
+        /// synchronous overload.
+        /// \param complete_txs vector of flags indicating which txs from the
+        ///                     previous lock operation the shard should apply
+        ///                     and which it should cancel.
+        /// \param dtx_id distributed transaction ID of the previous lock
+        ///               operation.
+        /// \param result_callback function to call with the result of the
+        ///                        apply operation. Called exactly once,
+        ///                        possibly before this method returns.
+        virtual void apply_outputs(std::vector<bool>&& complete_txs,
+                                   const hash_t& dtx_id,
+                                   result_callback_type result_callback)
+            = 0;
+
         /// Returns whether a given hash is within the shard's range.
         /// \param h hash to check.
         /// \return true if the hash is within the shard's range.
@@ -79,6 +116,28 @@ namespace cbdc::locking_shard {
         /// \return true if the discard operation succeeded.
         virtual auto discard_dtx(const hash_t& dtx_id) -> bool = 0;
 
+        /// Asynchronously discards any cached information about a given
+        /// distributed transaction.
+        /// \param dtx_id distributed transaction ID of a previous apply
+        ///               command.
+        /// \param result_callback function to call with the result of the
+        ///                        discard operation. Called exactly once,
+        ///                        possibly before this method returns.
+        virtual void discard_dtx(const hash_t& dtx_id,
+                                 result_callback_type result_callback)
+            = 0;
+
+        /// Asynchronously discards any cached information about a group of
+        /// distributed transactions.
+        /// \param dtx_ids distributed transaction IDs of previous apply
+        ///                commands.
+        /// \param result_callback function to call with true if every dtx
+        ///                        was discarded. Called exactly once,
+        ///                        possibly before this method returns.
+        virtual void discard_dtxs(std::vector<hash_t> dtx_ids,
+                                  result_callback_type result_callback)
+            = 0;
+
         /// Stops the locking shard implementation from processing further
         /// commands and unblocks any pending commands.
         virtual void stop() = 0;
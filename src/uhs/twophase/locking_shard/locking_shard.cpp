@@ -11,16 +11,33 @@
 #include "util/serialization/format.hpp"
 #include "util/serialization/istream_serializer.hpp"
 
+#include <algorithm>
+
 namespace cbdc::locking_shard {
     auto locking_shard::discard_dtx(const hash_t& dtx_id) -> bool {
-        std::unique_lock<std::shared_mutex> l(m_mut);
+        auto& dtxs = m_dtx_partitions[dtx_partition_index(dtx_id)];
+        std::unique_lock<std::mutex> l(dtxs.m_mut);
         bool running = m_running;
         if(running) {
-            m_applied_dtxs.erase(dtx_id);
+            dtxs.m_applied_dtxs.erase(dtx_id);
         }
         return running;
     }
 
+    void locking_shard::discard_dtx(const hash_t& dtx_id,
+                                    result_callback_type result_callback) {
+        result_callback(discard_dtx(dtx_id));
+    }
+
+    void locking_shard::discard_dtxs(std::vector<hash_t> dtx_ids,
+                                     result_callback_type result_callback) {
+        auto res = true;
+        for(const auto& dtx_id : dtx_ids) {
+            res = discard_dtx(dtx_id) && res;
+        }
+        result_callback(res);
+    }
+
     locking_shard::locking_shard(
         const std::pair<uint8_t, uint8_t>& output_range,
         std::shared_ptr<logging::log> logger,
@@ -30,25 +47,31 @@ namespace cbdc::locking_shard {
         : interface(output_range),
           m_logger(std::move(logger)),
           m_completed_txs(completed_txs_cache_size),
-          m_opts(std::move(opts)) {
-        m_uhs.max_load_factor(std::numeric_limits<float>::max());
-        m_applied_dtxs.max_load_factor(std::numeric_limits<float>::max());
-        m_prepared_dtxs.max_load_factor(std::numeric_limits<float>::max());
-        m_locked.max_load_factor(std::numeric_limits<float>::max());
-
+          m_opts(std::move(opts)),
+          // The thread calling lock_outputs verifies a share of each batch
+          // alongside the pool workers.
+          m_verify_pool(std::max(std::thread::hardware_concurrency(), 1U)
+                        - 1) {
         static constexpr auto dtx_buckets = 100000;
-        m_applied_dtxs.rehash(dtx_buckets);
-        m_prepared_dtxs.rehash(dtx_buckets);
-
-        static constexpr auto locked_buckets = 10000000;
-        m_locked.rehash(locked_buckets);
+        for(auto& dtxs : m_dtx_partitions) {
+            dtxs.m_applied_dtxs.max_load_factor(
+                std::numeric_limits<float>::max());
+            dtxs.m_prepared_dtxs.max_load_factor(
+                std::numeric_limits<float>::max());
+            dtxs.m_applied_dtxs.rehash(dtx_buckets / dtx_partition_count);
+            dtxs.m_prepared_dtxs.rehash(dtx_buckets / dtx_partition_count);
+        }
 
         if(!preseed_file.empty()) {
             m_logger->info("Reading preseed file into memory");
             if(!read_preseed_file(preseed_file)) {
                 m_logger->error("Preseeding failed");
             } else {
-                m_logger->info("Preseeding complete -", m_uhs.size(), "utxos");
+                size_t utxos{0};
+                for(const auto& part : m_uhs_partitions) {
+                    utxos += part.m_uhs->size();
+                }
+                m_logger->info("Preseeding complete -", utxos, "utxos");
             }
         }
     }
@@ -57,19 +80,29 @@ namespace cbdc::locking_shard {
         -> bool {
         if(std::filesystem::exists(preseed_file)) {
             auto in = std::ifstream(preseed_file, std::ios::binary);
-            in.seekg(0, std::ios::end);
-            auto sz = in.tellg();
-            if(sz == -1) {
+            auto deser = istream_serializer(in);
+            auto count = uint64_t();
+            if(!(deser >> count)) {
                 return false;
             }
-            in.seekg(0, std::ios::beg);
-            auto deser = istream_serializer(in);
-            m_uhs.clear();
-            static constexpr auto uhs_size_factor = 2;
-            auto bucket_count = static_cast<unsigned long>(sz / cbdc::hash_size
-                                                           * uhs_size_factor);
-            m_uhs.rehash(bucket_count);
-            deser >> m_uhs;
+            // Leave some slack for the uneven spread of IDs across
+            // partitions so no partition has to grow while reading.
+            static constexpr auto slack_divisor = 16;
+            const auto per_partition
+                = static_cast<size_t>(count / uhs_partition_count);
+            for(auto& part : m_uhs_partitions) {
+                part.m_uhs->clear();
+                part.m_uhs->reserve(per_partition
+                                    + per_partition / slack_divisor);
+            }
+            for(uint64_t i{0}; i < count; i++) {
+                auto uhs_id = hash_t();
+                if(!(deser >> uhs_id)) {
+                    return false;
+                }
+                m_uhs_partitions[uhs_partition_index(uhs_id)].m_uhs->emplace(
+                    uhs_id);
+            }
             return true;
         }
         return false;
@@ -78,75 +111,125 @@ namespace cbdc::locking_shard {
     auto locking_shard::lock_outputs(std::vector<tx>&& txs,
                                      const hash_t& dtx_id)
         -> std::optional<std::vector<bool>> {
-        std::unique_lock<std::shared_mutex> l(m_mut);
-        if(!m_running) {
+        auto& dtxs = m_dtx_partitions[dtx_partition_index(dtx_id)];
+        auto find_prepared = [&]() -> std::optional<std::vector<bool>> {
+            auto prepared_dtx_it = dtxs.m_prepared_dtxs.find(dtx_id);
+            if(prepared_dtx_it != dtxs.m_prepared_dtxs.end()) {
+                return prepared_dtx_it->second->m_results;
+            }
             return std::nullopt;
+        };
+
+        {
+            std::unique_lock<std::mutex> l(dtxs.m_mut);
+            if(!m_running) {
+                return std::nullopt;
+            }
+            if(auto prepared = find_prepared()) {
+                return prepared;
+            }
         }
 
-        auto prepared_dtx_it = m_prepared_dtxs.find(dtx_id);
-        if(prepared_dtx_it != m_prepared_dtxs.end()) {
-            return prepared_dtx_it->second.m_results;
+        auto attested = check_attestations(txs);
+
+        std::unique_lock<std::mutex> l(dtxs.m_mut);
+        if(!m_running) {
+            return std::nullopt;
+        }
+        // Another call for the same dtx may have completed while the
+        // attestations were being verified.
+        if(auto prepared = find_prepared()) {
+            return prepared;
         }
 
         auto ret = std::vector<bool>();
         ret.reserve(txs.size());
-        for(auto&& tx : txs) {
-            auto success = check_and_lock_tx(tx);
+        for(size_t i{0}; i < txs.size(); i++) {
+            if(!attested[i]) {
+                m_logger->warn("Received invalid compact transaction",
+                               to_string(txs[i].m_tx.m_id));
+                ret.push_back(false);
+                continue;
+            }
+            auto success = check_and_lock_tx(txs[i]);
             ret.push_back(success);
         }
-        auto p = prepared_dtx();
-        p.m_results = ret;
-        p.m_txs = std::move(txs);
-        m_prepared_dtxs.emplace(dtx_id, std::move(p));
+        auto p = std::make_shared<prepared_dtx>();
+        p->m_results = ret;
+        p->m_txs = std::move(txs);
+        dtxs.m_prepared_dtxs.emplace(dtx_id, std::move(p));
         return ret;
     }
 
+    auto locking_shard::check_attestations(const std::vector<tx>& txs)
+        -> std::vector<bool> {
+        using tx_ref = std::reference_wrapper<const transaction::compact_tx>;
+        auto ctxs = std::vector<tx_ref>();
+        ctxs.reserve(txs.size());
+        for(const auto& t : txs) {
+            ctxs.emplace_back(t.m_tx);
+        }
+        return transaction::validation::check_attestations(
+            ctxs,
+            m_opts.m_sentinel_public_keys,
+            m_opts.m_attestation_threshold,
+            m_verify_pool);
+    }
+
     auto locking_shard::check_and_lock_tx(const tx& t) -> bool {
-        bool success{true};
-        if(!transaction::validation::check_attestations(
-               t.m_tx,
-               m_opts.m_sentinel_public_keys,
-               m_opts.m_attestation_threshold)) {
-            m_logger->warn("Received invalid compact transaction",
-                           to_string(t.m_tx.m_id));
-            success = false;
-        }
-        if(success) {
-            for(const auto& uhs_id : t.m_tx.m_inputs) {
-                if(hash_in_shard_range(uhs_id)
-                   && m_uhs.find(uhs_id) == m_uhs.end()) {
-                    success = false;
-                    break;
-                }
+        // Lock every partition the inputs fall in, in index order so
+        // concurrent transactions cannot deadlock.
+        auto parts = std::vector<size_t>();
+        parts.reserve(t.m_tx.m_inputs.size());
+        for(const auto& uhs_id : t.m_tx.m_inputs) {
+            if(hash_in_shard_range(uhs_id)) {
+                parts.push_back(uhs_partition_index(uhs_id));
             }
         }
-        if(success) {
-            for(const auto& uhs_id : t.m_tx.m_inputs) {
-                if(hash_in_shard_range(uhs_id)) {
-                    auto n = m_uhs.extract(uhs_id);
-                    assert(!n.empty());
-                    m_locked.emplace(uhs_id);
-                }
+        std::sort(parts.begin(), parts.end());
+        parts.erase(std::unique(parts.begin(), parts.end()), parts.end());
+        auto locks = std::vector<std::unique_lock<std::shared_mutex>>();
+        locks.reserve(parts.size());
+        for(auto idx : parts) {
+            locks.emplace_back(m_uhs_partitions[idx].m_mut);
+        }
+
+        for(const auto& uhs_id : t.m_tx.m_inputs) {
+            if(hash_in_shard_range(uhs_id)
+               && !m_uhs_partitions[uhs_partition_index(uhs_id)]
+                       .m_uhs->contains(uhs_id)) {
+                return false;
+            }
+        }
+        for(const auto& uhs_id : t.m_tx.m_inputs) {
+            if(hash_in_shard_range(uhs_id)) {
+                auto& part = m_uhs_partitions[uhs_partition_index(uhs_id)];
+                [[maybe_unused]] auto n = writable(part.m_uhs).erase(uhs_id);
+                assert(n == 1);
+                writable(part.m_locked).emplace(uhs_id);
             }
         }
-        return success;
+        return true;
     }
 
     auto locking_shard::apply_outputs(std::vector<bool>&& complete_txs,
                                       const hash_t& dtx_id) -> bool {
-        std::unique_lock<std::shared_mutex> l(m_mut);
+        auto& dtxs = m_dtx_partitions[dtx_partition_index(dtx_id)];
+        std::unique_lock<std::mutex> l(dtxs.m_mut);
         if(!m_running) {
             return false;
         }
-        auto prepared_dtx_it = m_prepared_dtxs.find(dtx_id);
-        if(prepared_dtx_it == m_prepared_dtxs.end()) {
-            if(m_applied_dtxs.find(dtx_id) == m_applied_dtxs.end()) {
+        auto prepared_dtx_it = dtxs.m_prepared_dtxs.find(dtx_id);
+        if(prepared_dtx_it == dtxs.m_prepared_dtxs.end()) {
+            if(dtxs.m_applied_dtxs.find(dtx_id)
+               == dtxs.m_applied_dtxs.end()) {
                 m_logger->fatal("Unable to find dtx data for apply",
                                 to_string(dtx_id));
             }
             return true;
         }
-        auto& dtx = prepared_dtx_it->second.m_txs;
+        const auto& dtx = prepared_dtx_it->second->m_txs;
+        const auto& locked = prepared_dtx_it->second->m_results;
         if(complete_txs.size() != dtx.size()) {
             // This would only happen due to a bug in the controller
             m_logger->fatal("Incorrect number of complete tx flags for apply",
@@ -163,37 +246,171 @@ namespace cbdc::locking_shard {
 
             for(auto&& uhs_id : tx.m_tx.m_uhs_outputs) {
                 if(hash_in_shard_range(uhs_id) && complete_txs[i]) {
-                    m_uhs.emplace(uhs_id);
+                    auto& part
+                        = m_uhs_partitions[uhs_partition_index(uhs_id)];
+                    std::unique_lock<std::shared_mutex> pl(part.m_mut);
+                    writable(part.m_uhs).emplace(uhs_id);
                 }
             }
+            // Only release inputs this dtx locked. Otherwise aborting a tx
+            // that lost a race for its inputs would release the lock held
+            // by the concurrent dtx that won.
+            if(!locked[i]) {
+                continue;
+            }
             for(auto&& uhs_id : tx.m_tx.m_inputs) {
                 if(hash_in_shard_range(uhs_id)) {
-                    auto was_locked = m_locked.erase(uhs_id);
+                    auto& part
+                        = m_uhs_partitions[uhs_partition_index(uhs_id)];
+                    std::unique_lock<std::shared_mutex> pl(part.m_mut);
+                    auto was_locked = writable(part.m_locked).erase(uhs_id);
                     if(!complete_txs[i] && (was_locked != 0U)) {
-                        m_uhs.emplace(uhs_id);
+                        writable(part.m_uhs).emplace(uhs_id);
                     }
                 }
             }
         }
 
-        m_prepared_dtxs.erase(dtx_id);
-        m_applied_dtxs.insert(dtx_id);
+        dtxs.m_prepared_dtxs.erase(prepared_dtx_it);
+        dtxs.m_applied_dtxs.insert(dtx_id);
         return true;
     }
 
+    void locking_shard::lock_outputs(std::vector<tx>&& txs,
+                                     const hash_t& dtx_id,
+                                     lock_callback_type result_callback) {
+        result_callback(lock_outputs(std::move(txs), dtx_id));
+    }
+
+    void locking_shard::apply_outputs(std::vector<bool>&& complete_txs,
+                                      const hash_t& dtx_id,
+                                      result_callback_type result_callback) {
+        result_callback(apply_outputs(std::move(complete_txs), dtx_id));
+    }
+
     void locking_shard::stop() {
         m_running = false;
     }
 
     auto locking_shard::check_unspent(const hash_t& uhs_id)
         -> std::optional<bool> {
-        std::shared_lock<std::shared_mutex> l(m_mut);
-        return m_uhs.find(uhs_id) != m_uhs.end()
-            || m_locked.find(uhs_id) != m_locked.end();
+        const auto& part = m_uhs_partitions[uhs_partition_index(uhs_id)];
+        std::shared_lock<std::shared_mutex> l(part.m_mut);
+        return part.m_uhs->contains(uhs_id)
+            || part.m_locked->contains(uhs_id);
     }
 
     auto locking_shard::check_tx_id(const hash_t& tx_id)
         -> std::optional<bool> {
         return m_completed_txs.contains(tx_id);
     }
+
+    auto locking_shard::writable(std::shared_ptr<uhs_set>& set)
+        -> uhs_set& {
+        // Snapshots only take references under the partition's shared lock,
+        // so while the unique lock is held the count can only fall. A stale
+        // count at worst causes an unnecessary copy.
+        if(set.use_count() > 1) {
+            set = std::make_shared<uhs_set>(*set);
+        } else {
+            // Pairs with the release of the last snapshot reference so the
+            // snapshot's reads of the set happen before the writes that
+            // follow.
+            std::atomic_thread_fence(std::memory_order_acquire);
+        }
+        return *set;
+    }
+
+    auto locking_shard::get_snapshot() -> snapshot {
+        auto ret = snapshot();
+        ret.m_uhs.reserve(uhs_partition_count);
+        ret.m_locked.reserve(uhs_partition_count);
+        for(const auto& part : m_uhs_partitions) {
+            std::shared_lock<std::shared_mutex> l(part.m_mut);
+            ret.m_uhs.emplace_back(part.m_uhs);
+            ret.m_locked.emplace_back(part.m_locked);
+        }
+        for(auto& dtxs : m_dtx_partitions) {
+            std::unique_lock<std::mutex> l(dtxs.m_mut);
+            ret.m_prepared_dtxs.insert(ret.m_prepared_dtxs.end(),
+                                       dtxs.m_prepared_dtxs.begin(),
+                                       dtxs.m_prepared_dtxs.end());
+            ret.m_applied_dtxs.insert(ret.m_applied_dtxs.end(),
+                                      dtxs.m_applied_dtxs.begin(),
+                                      dtxs.m_applied_dtxs.end());
+        }
+        ret.m_completed_txs = m_completed_txs.values();
+        return ret;
+    }
+
+    void locking_shard::set_state(state&& new_state) {
+        // Snapshots taken with the same partition count can be moved into
+        // place. Otherwise redistribute the IDs.
+        const auto same_partitions
+            = new_state.m_uhs.size() == uhs_partition_count
+           && new_state.m_locked.size() == uhs_partition_count;
+        for(size_t i{0}; i < uhs_partition_count; i++) {
+            auto& part = m_uhs_partitions[i];
+            std::unique_lock<std::shared_mutex> l(part.m_mut);
+            // Replace rather than clear the sets, which snapshots may share.
+            if(same_partitions) {
+                part.m_uhs
+                    = std::make_shared<uhs_set>(std::move(new_state.m_uhs[i]));
+                part.m_locked = std::make_shared<uhs_set>(
+                    std::move(new_state.m_locked[i]));
+            } else {
+                part.m_uhs = std::make_shared<uhs_set>();
+                part.m_locked = std::make_shared<uhs_set>();
+            }
+        }
+        if(!same_partitions) {
+            for(const auto& set : new_state.m_uhs) {
+                for(const auto& uhs_id : set) {
+                    auto& part
+                        = m_uhs_partitions[uhs_partition_index(uhs_id)];
+                    std::unique_lock<std::shared_mutex> l(part.m_mut);
+                    part.m_uhs->emplace(uhs_id);
+                }
+            }
+            for(const auto& set : new_state.m_locked) {
+                for(const auto& uhs_id : set) {
+                    auto& part
+                        = m_uhs_partitions[uhs_partition_index(uhs_id)];
+                    std::unique_lock<std::shared_mutex> l(part.m_mut);
+                    part.m_locked->emplace(uhs_id);
+                }
+            }
+        }
+
+        for(auto& dtxs : m_dtx_partitions) {
+            std::unique_lock<std::mutex> l(dtxs.m_mut);
+            dtxs.m_prepared_dtxs.clear();
+            dtxs.m_applied_dtxs.clear();
+        }
+        for(auto&& [dtx_id, dtx] : new_state.m_prepared_dtxs) {
+            auto& dtxs = m_dtx_partitions[dtx_partition_index(dtx_id)];
+            std::unique_lock<std::mutex> l(dtxs.m_mut);
+            dtxs.m_prepared_dtxs.emplace(
+                dtx_id,
+                std::make_shared<prepared_dtx>(std::move(dtx)));
+        }
+        for(const auto& dtx_id : new_state.m_applied_dtxs) {
+            auto& dtxs = m_dtx_partitions[dtx_partition_index(dtx_id)];
+            std::unique_lock<std::mutex> l(dtxs.m_mut);
+            dtxs.m_applied_dtxs.insert(dtx_id);
+        }
+
+        m_completed_txs.clear();
+        for(const auto& tx_id : new_state.m_completed_txs) {
+            m_completed_txs.add(tx_id);
+        }
+    }
+
+    auto locking_shard::uhs_partition_index(const hash_t& uhs_id) -> size_t {
+        return uhs_id[1] % uhs_partition_count;
+    }
+
+    auto locking_shard::dtx_partition_index(const hash_t& dtx_id) -> size_t {
+        return hashing::null()(dtx_id) % dtx_partition_count;
+    }
 }
@@ -11,14 +11,19 @@
 #include "status_interface.hpp"
 #include "uhs/transaction/transaction.hpp"
 #include "util/common/cache_set.hpp"
+#include "util/common/flat_hash_set.hpp"
 #include "util/common/hash.hpp"
 #include "util/common/hashmap.hpp"
 #include "util/common/logging.hpp"
+#include "util/common/thread_pool.hpp"
 
+#include <array>
 #include <filesystem>
 #include <future>
 #include <leveldb/db.h>
 #include <memory>
+#include <mutex>
+#include <shared_mutex>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
@@ -29,7 +34,6 @@ namespace cbdc::locking_shard {
     /// \brief In-memory implementation of \ref interface and
     /// \ref status_interface.
     ///
-    /// \warning Not thread safe.
     /// Implements a UHS through conservative two-phase locking. Callers
     /// atomically check a batch of prospective transactions for spendable
     /// input UHS IDs in this shard's range, and lock those UHS IDs. Based on
@@ -41,6 +45,12 @@ namespace cbdc::locking_shard {
     /// recently applied in the system. This is useful for recipients in a
     /// transaction to verify that the transaction has completed, or if the
     /// sender disconnects from the sentinel before receiving a response.
+    ///
+    /// Thread safe. The UHS and lock set are split into partitions keyed by
+    /// UHS ID bits, and the dtx tables into partitions keyed by dtx ID, each
+    /// with its own mutex. Operations on different dtxs whose transactions
+    /// touch disjoint partitions proceed in parallel, as do status queries.
+    /// Operations on the same dtx ID are serialized.
     class locking_shard final : public interface, public status_interface {
       public:
         /// Constructor.
@@ -62,11 +72,13 @@ namespace cbdc::locking_shard {
         /// \brief Attempts to lock the input hashes for the given batch of
         /// transactions.
         ///
-        /// Only considers input hashes within this shard's range. The batch of
-        /// transactions is a single distributed transaction, or 'dtx'. The
-        /// coordinator that communicates with instances of this class provides
-        /// a globally unique dtx ID along for each dtx. The provided vector of
-        /// transactions may be a subset of the overall
+        /// Verifies the sentinel attestations of the whole batch in parallel
+        /// before taking any locks, so only the UHS check-and-lock step is
+        /// serialized. Only considers input hashes within this shard's range.
+        /// The batch of transactions is a single distributed transaction, or
+        /// 'dtx'. The coordinator that communicates with instances of this
+        /// class provides a globally unique dtx ID along for each dtx. The
+        /// provided vector of transactions may be a subset of the overall
         /// batch only including transactions relevant to this shard.
         /// \param txs list of txs to attempt to lock.
         /// \param dtx_id distributed tx ID for lock operation.
@@ -76,6 +88,15 @@ namespace cbdc::locking_shard {
         auto lock_outputs(std::vector<tx>&& txs, const hash_t& dtx_id)
             -> std::optional<std::vector<bool>> final;
 
+        /// Locks the given batch of transactions as in the synchronous
+        /// overload and calls the callback with the result before returning.
+        /// \param txs list of txs to attempt to lock.
+        /// \param dtx_id distributed tx ID for lock operation.
+        /// \param result_callback function to call with the result.
+        void lock_outputs(std::vector<tx>&& txs,
+                          const hash_t& dtx_id,
+                          lock_callback_type result_callback) final;
+
         /// \brief Selectively applies the transactions from a previous lock
         /// operation.
         ///
@@ -95,6 +116,17 @@ namespace cbdc::locking_shard {
         auto apply_outputs(std::vector<bool>&& complete_txs,
                            const hash_t& dtx_id) -> bool final;
 
+        /// Applies the transactions from a previous lock operation as in the
+        /// synchronous overload and calls the callback with the result
+        /// before returning.
+        /// \param complete_txs vector of flags indicating which txs to apply.
+        /// \param dtx_id distributed transaction ID of the previous lock
+        ///               operation.
+        /// \param result_callback function to call with the result.
+        void apply_outputs(std::vector<bool>&& complete_txs,
+                           const hash_t& dtx_id,
+                           result_callback_type result_callback) final;
+
         /// Discards any cached information about a given distributed
         /// transaction. Called as the final step of a distributed transaction
         /// once all other participating shards have finished processing \ref
@@ -104,6 +136,23 @@ namespace cbdc::locking_shard {
         /// \return true if the discard operation succeeded.
         auto discard_dtx(const hash_t& dtx_id) -> bool final;
 
+        /// Discards the given dtx as in the synchronous overload and calls
+        /// the callback with the result before returning.
+        /// \param dtx_id distributed transaction ID of a previous apply
+        ///               command.
+        /// \param result_callback function to call with the result.
+        void discard_dtx(const hash_t& dtx_id,
+                         result_callback_type result_callback) final;
+
+        /// Discards each of the given dtxs as in \ref discard_dtx and calls
+        /// the callback with the result before returning.
+        /// \param dtx_ids distributed transaction IDs of previous apply
+        ///                commands.
+        /// \param result_callback function to call with true if every dtx
+        ///                        was discarded.
+        void discard_dtxs(std::vector<hash_t> dtx_ids,
+                          result_callback_type result_callback) final;
+
         /// \brief Stops the locking shard from processing further commands.
         /// Any future calls to methods of this class will return a failure
         /// result.
@@ -124,25 +173,132 @@ namespace cbdc::locking_shard {
         [[nodiscard]] auto check_tx_id(const hash_t& tx_id)
             -> std::optional<bool> final;
 
+        /// Transactions locked by a dtx that has not yet been applied.
+        struct prepared_dtx {
+            /// Transactions in the dtx relevant to this shard.
+            std::vector<tx> m_txs;
+            /// Flags indicating which transactions had their inputs locked.
+            std::vector<bool> m_results;
+        };
+
+        /// Set of UHS IDs in one partition.
+        using uhs_set = flat_hash_set<hash_t, hashing::null>;
+
+        /// Copy of the shard's state at a point in time, read from Raft
+        /// snapshots.
+        struct state {
+            /// Unspent UHS IDs, one set per UHS partition.
+            std::vector<uhs_set> m_uhs;
+            /// Locked UHS IDs, one set per UHS partition.
+            std::vector<uhs_set> m_locked;
+            /// Dtxs which have been locked but not yet applied.
+            std::unordered_map<hash_t, prepared_dtx, hashing::null>
+                m_prepared_dtxs;
+            /// Dtxs which have been applied but not yet discarded.
+            std::unordered_set<hash_t, hashing::null> m_applied_dtxs;
+            /// Recently completed TX IDs, from oldest to newest.
+            std::vector<hash_t> m_completed_txs;
+        };
+
+        /// \brief Read-only view of the shard's state at a point in time,
+        /// used to write Raft snapshots.
+        ///
+        /// Shares the UHS partitions and prepared dtxs with the shard rather
+        /// than copying them. While a snapshot refers to a UHS partition,
+        /// the shard copies the partition before modifying it, so the
+        /// snapshot is unaffected by later operations. Serializes to the
+        /// same format as \ref state.
+        struct snapshot {
+            /// Unspent UHS IDs, one set per UHS partition.
+            std::vector<std::shared_ptr<const uhs_set>> m_uhs;
+            /// Locked UHS IDs, one set per UHS partition.
+            std::vector<std::shared_ptr<const uhs_set>> m_locked;
+            /// Dtxs which have been locked but not yet applied.
+            std::vector<std::pair<hash_t, std::shared_ptr<const prepared_dtx>>>
+                m_prepared_dtxs;
+            /// Dtxs which have been applied but not yet discarded.
+            std::vector<hash_t> m_applied_dtxs;
+            /// Recently completed TX IDs, from oldest to newest.
+            std::vector<hash_t> m_completed_txs;
+        };
+
+        /// \brief Returns a snapshot of the shard's state.
+        ///
+        /// Locks one partition at a time, so callers must ensure no other
+        /// operations modify the shard concurrently if they require a
+        /// consistent snapshot. Only takes references to the UHS partitions
+        /// and prepared dtxs, so the cost does not grow with the size of the
+        /// UHS and the snapshot can be serialized elsewhere without blocking
+        /// further operations on the shard.
+        /// \return shard snapshot.
+        [[nodiscard]] auto get_snapshot() -> snapshot;
+
+        /// Replaces the shard's state with the given state.
+        /// \param new_state state to restore, usually read from a snapshot.
+        void set_state(state&& new_state);
+
       private:
+        /// Number of partitions the UHS and lock set are split into.
+        static constexpr size_t uhs_partition_count = 64;
+        /// Number of partitions the dtx tables are split into.
+        static constexpr size_t dtx_partition_count = 64;
+
         auto read_preseed_file(const std::string& preseed_file) -> bool;
         auto check_and_lock_tx(const tx& t) -> bool;
 
-        struct prepared_dtx {
-            std::vector<tx> m_txs;
-            std::vector<bool> m_results;
+        /// Checks the attestations of the whole batch of transactions using
+        /// the verification pool.
+        /// \param txs batch of transactions to check.
+        /// \return flags indicating which transactions carry valid
+        ///         attestations.
+        auto check_attestations(const std::vector<tx>& txs)
+            -> std::vector<bool>;
+
+        /// Unspent and locked UHS IDs whose partition bits select this
+        /// partition.
+        /// partition. The sets may be shared with snapshots, so must only be
+        /// modified through \ref writable.
+        struct uhs_partition {
+            mutable std::shared_mutex m_mut;
+            std::shared_ptr<uhs_set> m_uhs{std::make_shared<uhs_set>()};
+            std::shared_ptr<uhs_set> m_locked{std::make_shared<uhs_set>()};
         };
+
+        /// Returns the given set for modification, first replacing it with
+        /// a copy if a snapshot shares it. Must be called with the unique
+        /// lock of the set's partition held.
+        /// \param set set to modify.
+        /// \return set which is not shared with any snapshot.
+        static auto writable(std::shared_ptr<uhs_set>& set) -> uhs_set&;
+
+        /// Prepared and applied dtxs whose ID selects this partition.
+        /// Prepared dtxs are immutable, so snapshots share them.
+        struct dtx_partition {
+            std::mutex m_mut;
+            std::unordered_map<hash_t,
+                               std::shared_ptr<const prepared_dtx>,
+                               hashing::null>
+                m_prepared_dtxs;
+            std::unordered_set<hash_t, hashing::null> m_applied_dtxs;
+        };
+
+        /// Returns the partition responsible for the given UHS ID. Skips the
+        /// leading byte, which selects the shard.
+        [[nodiscard]] static auto uhs_partition_index(const hash_t& uhs_id)
+            -> size_t;
+
+        /// Returns the partition responsible for the given dtx ID.
+        [[nodiscard]] static auto dtx_partition_index(const hash_t& dtx_id)
+            -> size_t;
+
         std::atomic_bool m_running{true};
 
         std::shared_ptr<logging::log> m_logger;
-        mutable std::shared_mutex m_mut;
-        std::unordered_set<hash_t, hashing::null> m_uhs;
-        std::unordered_set<hash_t, hashing::null> m_locked;
-        std::unordered_map<hash_t, prepared_dtx, hashing::null>
-            m_prepared_dtxs;
-        std::unordered_set<hash_t, hashing::null> m_applied_dtxs;
+        std::array<uhs_partition, uhs_partition_count> m_uhs_partitions;
+        std::array<dtx_partition, dtx_partition_count> m_dtx_partitions;
         cbdc::cache_set<hash_t, hashing::null> m_completed_txs;
         config::options m_opts;
+        thread_pool m_verify_pool;
     };
 }
 
@@ -22,14 +22,20 @@ namespace cbdc::locking_shard::rpc {
             return true;
         };
     };
+    /// IDs of further dtxs to discard along with the dtx ID of the request,
+    /// so a group of dtxs takes one request per shard
+    using discard_batch_params = std::vector<hash_t>;
 
     /// Request to a shard
     struct request {
         /// The distributed transaction ID corresponding to the request
         hash_t m_dtx_id{};
-        /// If the command is lock or apply, the parameters for these
-        /// commands
-        std::variant<lock_params, apply_params, discard_params> m_params{};
+        /// The parameters of the command
+        std::variant<lock_params,
+                     apply_params,
+                     discard_params,
+                     discard_batch_params>
+            m_params{};
 
         auto operator==(const request& rhs) const -> bool;
     };
@@ -17,9 +17,11 @@ namespace cbdc::locking_shard {
         std::shared_ptr<logging::log> logger,
         size_t completed_txs_cache_size,
         const std::string& preseed_file,
-        config::options opts)
+        config::options opts,
+        std::string snapshot_dir)
         : m_output_range(output_range),
-          m_logger(std::move(logger)) {
+          m_logger(std::move(logger)),
+          m_snapshots(std::move(snapshot_dir), m_logger) {
         register_handler_callback([&](rpc::request req) {
             return process_request(std::move(req));
         });
@@ -28,6 +30,12 @@ namespace cbdc::locking_shard {
                                                   completed_txs_cache_size,
                                                   preseed_file,
                                                   std::move(opts));
+
+        auto snp = m_snapshots.last_snapshot();
+        if(snp && !state_machine::apply_snapshot(*snp)) {
+            m_logger->fatal("Failed to restore snapshot",
+                            snp->get_last_log_idx());
+        }
     }
 
     auto state_machine::commit(uint64_t log_idx, nuraft::buffer& data)
@@ -53,12 +61,45 @@ namespace cbdc::locking_shard {
         m_last_committed_idx = log_idx;
     }
 
-    auto state_machine::apply_snapshot(nuraft::snapshot& /* s */) -> bool {
-        return false;
+    auto
+    state_machine::read_logical_snp_obj(nuraft::snapshot& s,
+                                        void*& user_snp_ctx,
+                                        nuraft::ulong obj_id,
+                                        nuraft::ptr<nuraft::buffer>& data_out,
+                                        bool& is_last_obj) -> int {
+        return m_snapshots.read_object(s,
+                                       user_snp_ctx,
+                                       obj_id,
+                                       data_out,
+                                       is_last_obj);
+    }
+
+    void state_machine::save_logical_snp_obj(nuraft::snapshot& s,
+                                             nuraft::ulong& obj_id,
+                                             nuraft::buffer& data,
+                                             bool is_first_obj,
+                                             bool is_last_obj) {
+        m_snapshots.save_object(s, obj_id, data, is_first_obj, is_last_obj);
+    }
+
+    void state_machine::free_user_snp_ctx(void*& user_snp_ctx) {
+        raft::snapshot_store::free_context(user_snp_ctx);
+    }
+
+    auto state_machine::apply_snapshot(nuraft::snapshot& s) -> bool {
+        auto state = locking_shard::state();
+        if(!m_snapshots.read(s, [&](serializer& deser) {
+               return static_cast<bool>(deser >> state);
+           })) {
+            return false;
+        }
+        m_shard->set_state(std::move(state));
+        m_last_committed_idx = s.get_last_log_idx();
+        return true;
     }
 
     auto state_machine::last_snapshot() -> nuraft::ptr<nuraft::snapshot> {
-        return nullptr;
+        return m_snapshots.last_snapshot();
     }
 
     auto state_machine::last_commit_index() -> uint64_t {
@@ -66,11 +107,21 @@ namespace cbdc::locking_shard {
     }
 
     void state_machine::create_snapshot(
-        nuraft::snapshot& /* s */,
+        nuraft::snapshot& s,
         nuraft::async_result<bool>::handler_type& when_done) {
-        nuraft::ptr<std::exception> except(nullptr);
-        bool ret = false;
-        when_done(ret, except);
+        assert(s.get_last_log_idx() == last_commit_index());
+        // Take the snapshot here, where no commits can happen concurrently,
+        // and serialize it in the background. The shard copies any UHS
+        // partition it modifies while the snapshot still holds it, so each
+        // partition is released as soon as it is written.
+        auto snp = std::make_shared<locking_shard::locking_shard::snapshot>(
+            m_shard->get_snapshot());
+        m_snapshots.write_async(
+            s,
+            [snp](serializer& ser) {
+                return static_cast<bool>(ser << std::move(*snp));
+            },
+            when_done);
     }
 
     auto state_machine::get_shard_instance()
@@ -113,6 +164,23 @@ namespace cbdc::locking_shard {
                            assert(res);
                            m_logger->info("Done discard", dtxid_str);
                            return rpc::discard_response();
+                       },
+                       [&](rpc::discard_batch_params&& params)
+                           -> cbdc::locking_shard::rpc::response {
+                           m_logger->info("Processing discard",
+                                          dtxid_str,
+                                          "with",
+                                          params.size(),
+                                          "more dtxs");
+                           [[maybe_unused]] auto res
+                               = m_shard->discard_dtx(req.m_dtx_id);
+                           assert(res);
+                           for(const auto& dtx_id : params) {
+                               res = m_shard->discard_dtx(dtx_id);
+                               assert(res);
+                           }
+                           m_logger->info("Done discard", dtxid_str);
+                           return rpc::discard_response();
                        }},
             std::move(req.m_params));
     }
@@ -8,6 +8,7 @@
 
 #include "locking_shard.hpp"
 #include "util/common/logging.hpp"
+#include "util/raft/snapshot_store.hpp"
 #include "util/rpc/blocking_server.hpp"
 
 #include <libnuraft/nuraft.hxx>
@@ -31,11 +32,14 @@ namespace cbdc::locking_shard {
         /// \param preseed_file path to file containing shard pre-seeding data
         ///                     or empty string to disable pre-seeding.
         /// \param opts configuration options.
+        /// \param snapshot_dir path to directory in which to store snapshots.
+        ///                     Will create the directory if it doesn't exist.
         state_machine(const std::pair<uint8_t, uint8_t>& output_range,
                       std::shared_ptr<logging::log> logger,
                       size_t completed_txs_cache_size,
                       const std::string& preseed_file,
-                      config::options opts);
+                      config::options opts,
+                      std::string snapshot_dir);
 
         /// Commit the given raft log entry at the given log index, and return
         /// the result.
@@ -52,23 +56,73 @@ namespace cbdc::locking_shard {
             nuraft::ulong log_idx,
             nuraft::ptr<nuraft::cluster_config>& /*new_conf*/) override;
 
-        /// Not implemented for locking shard.
-        /// \return false.
-        auto apply_snapshot(nuraft::snapshot& /* s */) -> bool override;
-
-        /// Not implemented for locking shard.
-        /// \return nullptr.
-        auto last_snapshot() -> nuraft::ptr<nuraft::snapshot> override;
+        /// Read the portion of the state machine snapshot associated with
+        /// the given metadata and object ID into a buffer. Snapshots are
+        /// sent to followers in fixed-size chunks, one per object ID.
+        /// \param s metadata of snapshot to read.
+        /// \param user_snp_ctx pointer to a snapshot context; must be provided
+        ///                     to all successive calls to this method for the
+        ///                     same snapshot.
+        /// \param obj_id ID of the snapshot object to read.
+        /// \param data_out buffer in which to write the snapshot object.
+        /// \param is_last_obj set to true if this object ID is the last
+        ///                    snapshot object.
+        /// \return 0 if the object was read successfully.
+        [[nodiscard]] auto
+        read_logical_snp_obj(nuraft::snapshot& s,
+                             void*& user_snp_ctx,
+                             nuraft::ulong obj_id,
+                             nuraft::ptr<nuraft::buffer>& data_out,
+                             bool& is_last_obj) -> int override;
+
+        /// Saves the portion of the state machine snapshot associated with
+        /// the given metadata and object ID into persistent storage.
+        /// \param s metadata of snapshot to save.
+        /// \param obj_id ID of the snapshot object to save. Set to the ID of
+        ///               the next object to request.
+        /// \param data buffer from which to read the snapshot object data to
+        ///             save.
+        /// \param is_first_obj true if this object ID is the first snapshot
+        ///                     object.
+        /// \param is_last_obj true if this object ID is the last snapshot
+        ///                    object.
+        void save_logical_snp_obj(nuraft::snapshot& s,
+                                  nuraft::ulong& obj_id,
+                                  nuraft::buffer& data,
+                                  bool is_first_obj,
+                                  bool is_last_obj) override;
+
+        /// Releases the snapshot context created by
+        /// \ref read_logical_snp_obj.
+        /// \param user_snp_ctx snapshot context to free.
+        void free_user_snp_ctx(void*& user_snp_ctx) override;
+
+        /// Replaces the state of the locking shard with the state stored in
+        /// the snapshot referenced by the given snapshot metadata.
+        /// \param s snapshot metadata.
+        /// \return true if the operation successfully applied the snapshot.
+        [[nodiscard]] auto apply_snapshot(nuraft::snapshot& s)
+            -> bool override;
+
+        /// Returns the most recent snapshot metadata.
+        /// \return snapshot metadata, or nullptr if there is no snapshot.
+        [[nodiscard]] auto last_snapshot()
+            -> nuraft::ptr<nuraft::snapshot> override;
 
         /// Returns the most recently committed log entry index.
         /// \return log entry index.
         auto last_commit_index() -> uint64_t override;
 
-        /// Not implemented for locking shard.
+        /// Creates a snapshot with the given metadata. Takes references to
+        /// the shard state and writes it to disk on a background thread, so
+        /// the commit path is not blocked for a time proportional to the
+        /// size of the UHS.
+        /// \param s snapshot metadata.
+        /// \param when_done function to call when snapshot creation is
+        ///                  complete.
         void create_snapshot(
-            nuraft::snapshot& /* s */,
-            nuraft::async_result<bool>::handler_type& /* when_done */)
-            override;
+            nuraft::snapshot& s,
+            nuraft::async_result<bool>::handler_type& when_done) override;
 
         /// Returns a pointer to the locking shard instance managed by this
         /// state machine.
@@ -81,18 +135,12 @@ namespace cbdc::locking_shard {
             -> cbdc::locking_shard::rpc::response;
 
         std::atomic<uint64_t> m_last_committed_idx{0};
-        nuraft::ptr<nuraft::snapshot> m_snapshot{};
-        std::shared_mutex m_snapshots_mut{};
-
-        nuraft::ptr<nuraft::snapshot> m_tmp_snapshot{};
-        std::mutex m_tmp_mut{};
 
         std::shared_ptr<cbdc::locking_shard::locking_shard> m_shard{};
         std::pair<uint8_t, uint8_t> m_output_range{};
-        std::string m_snapshot_dir{};
-        std::string m_db_dir{};
 
         std::shared_ptr<logging::log> m_logger;
+        raft::snapshot_store m_snapshots;
     };
 }
 
@@ -12,7 +12,8 @@ namespace cbdc::locking_shard::rpc {
         std::vector<std::vector<network::endpoint_t>>
             shard_read_only_endpoints,
         std::vector<config::shard_range_t> shard_ranges,
-        std::chrono::milliseconds timeout)
+        std::chrono::milliseconds timeout,
+        cbdc::rpc::selection_policy policy)
         : m_shard_ranges(std::move(shard_ranges)),
           m_request_timeout(timeout) {
         assert(m_shard_ranges.size() == shard_read_only_endpoints.size());
@@ -21,7 +22,9 @@ namespace cbdc::locking_shard::rpc {
             m_shard_clients.emplace_back(
                 std::make_unique<
                     cbdc::rpc::tcp_client<status_request, status_response>>(
-                    std::move(cluster)));
+                    std::move(cluster),
+                    0,
+                    policy));
         }
     }
 
@@ -26,11 +26,15 @@ namespace cbdc::locking_shard::rpc {
         ///                     shard_read_only_endpoints.
         /// \param timeout optional timeout for status requests. Zero indicates
         ///                no timeout.
+        /// \param policy policy for choosing which node of a shard cluster
+        ///               receives each request.
         status_client(std::vector<std::vector<network::endpoint_t>>
                           shard_read_only_endpoints,
                       std::vector<config::shard_range_t> shard_ranges,
                       std::chrono::milliseconds timeout
-                      = std::chrono::milliseconds::zero());
+                      = std::chrono::milliseconds::zero(),
+                      cbdc::rpc::selection_policy policy
+                      = cbdc::rpc::selection_policy::random);
 
         /// Destructor.
         ~status_client() override = default;
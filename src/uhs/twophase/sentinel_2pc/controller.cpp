@@ -55,7 +55,8 @@ namespace cbdc::sentinel_2pc {
             m_sentinel_clients.emplace_back(std::move(client));
         }
 
-        m_dist = decltype(m_dist)(0, m_sentinel_clients.size() - 1);
+        m_selector = cbdc::rpc::make_endpoint_selector(
+            m_opts.m_endpoint_selection_policy);
 
         auto rpc_server = std::make_unique<cbdc::rpc::tcp_server<
             cbdc::rpc::async_server<cbdc::sentinel::request,
@@ -76,21 +77,20 @@ namespace cbdc::sentinel_2pc {
     auto controller::execute_transaction(
         transaction::full_tx tx,
         execute_result_callback_type result_callback) -> bool {
-        const auto validation_err = transaction::validation::check_tx(tx);
-        if(validation_err.has_value()) {
-            auto tx_id = transaction::tx_id(tx);
+        auto res = transaction::validation::validate_tx(tx);
+        if(res.m_error.has_value()) {
             m_logger->debug(
                 "Rejected (",
-                transaction::validation::to_string(validation_err.value()),
+                transaction::validation::to_string(res.m_error.value()),
                 ")",
-                to_string(tx_id));
+                to_string(res.m_tx.m_id));
             result_callback(cbdc::sentinel::execute_response{
                 cbdc::sentinel::tx_status::static_invalid,
-                validation_err});
+                res.m_error});
             return true;
         }
 
-        auto compact_tx = cbdc::transaction::compact_tx(tx);
+        auto compact_tx = std::move(res.m_tx);
 
         if(m_opts.m_attestation_threshold > 0) {
             auto attestation = compact_tx.sign(m_secp.get(), m_privkey);
@@ -121,13 +121,12 @@ namespace cbdc::sentinel_2pc {
     auto controller::validate_transaction(
         transaction::full_tx tx,
         validate_result_callback_type result_callback) -> bool {
-        const auto validation_err = transaction::validation::check_tx(tx);
-        if(validation_err.has_value()) {
+        const auto res = transaction::validation::validate_tx(tx);
+        if(res.m_error.has_value()) {
             result_callback(std::nullopt);
             return true;
         }
-        auto compact_tx = cbdc::transaction::compact_tx(tx);
-        auto attestation = compact_tx.sign(m_secp.get(), m_privkey);
+        auto attestation = res.m_tx.sign(m_secp.get(), m_privkey);
         result_callback(std::move(attestation));
         return true;
     }
@@ -140,7 +139,7 @@ namespace cbdc::sentinel_2pc {
         std::unordered_set<size_t> requested) {
         if(!v_res.has_value()) {
             m_logger->error(to_string(ctx.m_id),
-                            "invalid according to remote sentinel");
+                            "not attested by remote sentinel");
             result_callback(std::nullopt);
             return;
         }
@@ -158,11 +157,27 @@ namespace cbdc::sentinel_2pc {
         std::unordered_set<size_t> requested) {
         if(ctx.m_attestations.size() < m_opts.m_attestation_threshold) {
             auto success = false;
+            auto failed = std::unordered_set<size_t>();
             while(!success) {
-                auto sentinel_id = m_dist(m_rand);
-                if(requested.find(sentinel_id) != requested.end()) {
+                auto selected = select_sentinel(requested, failed);
+                if(!selected.has_value()) {
+                    if(failed.empty()) {
+                        // Every sentinel has already been asked, so the
+                        // threshold cannot be met.
+                        m_logger->error(to_string(ctx.m_id),
+                                        "not enough sentinels to attest");
+                        result_callback(std::nullopt);
+                        return;
+                    }
+                    // Every remaining sentinel is unreachable. Wait before
+                    // retrying so we don't spin until one reconnects.
+                    static constexpr auto retry_delay
+                        = std::chrono::milliseconds(100);
+                    std::this_thread::sleep_for(retry_delay);
+                    failed.clear();
                     continue;
                 }
+                auto sentinel_id = selected.value();
                 success
                     = m_sentinel_clients[sentinel_id]->validate_transaction(
                         tx,
@@ -175,6 +190,9 @@ namespace cbdc::sentinel_2pc {
                                                     ctx,
                                                     r);
                         });
+                if(!success) {
+                    failed.insert(sentinel_id);
+                }
             }
             return;
         }
@@ -184,6 +202,24 @@ namespace cbdc::sentinel_2pc {
         send_compact_tx(ctx, std::move(result_callback));
     }
 
+    auto controller::select_sentinel(
+        const std::unordered_set<size_t>& requested,
+        const std::unordered_set<size_t>& failed) -> std::optional<size_t> {
+        auto stats = std::vector<cbdc::rpc::endpoint_stats>();
+        auto candidates = std::vector<size_t>();
+        stats.reserve(m_sentinel_clients.size());
+        for(size_t i = 0; i < m_sentinel_clients.size(); i++) {
+            // Each client connects to a single sentinel.
+            stats.push_back(m_sentinel_clients[i]->get_endpoint_stats()[0]);
+            if(requested.find(i) == requested.end()
+               && failed.find(i) == failed.end()) {
+                candidates.push_back(i);
+            }
+        }
+        std::unique_lock<std::mutex> l(m_selector_mut);
+        return m_selector->select(stats, candidates);
+    }
+
     void
     controller::send_compact_tx(const transaction::compact_tx& ctx,
                                 execute_result_callback_type result_callback) {
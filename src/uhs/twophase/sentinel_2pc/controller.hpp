@@ -16,8 +16,9 @@
 #include "util/common/config.hpp"
 #include "util/common/hashmap.hpp"
 #include "util/network/connection_manager.hpp"
+#include "util/rpc/endpoint_selector.hpp"
 
-#include <random>
+#include <mutex>
 
 namespace cbdc::sentinel_2pc {
     /// Manages a sentinel server for the two-phase commit architecture.
@@ -82,6 +83,16 @@ namespace cbdc::sentinel_2pc {
                                  const transaction::compact_tx& ctx,
                                  std::unordered_set<size_t> requested);
 
+        /// Chooses a sentinel to request an attestation from, excluding
+        /// those already asked and those whose request could not be sent.
+        /// \param requested indices of sentinels already asked.
+        /// \param failed indices of sentinels which are unreachable.
+        /// \return index into m_sentinel_clients, or std::nullopt if every
+        ///         sentinel is excluded.
+        auto select_sentinel(const std::unordered_set<size_t>& requested,
+                             const std::unordered_set<size_t>& failed)
+            -> std::optional<size_t>;
+
         void send_compact_tx(const transaction::compact_tx& ctx,
                              execute_result_callback_type result_callback);
 
@@ -101,9 +112,8 @@ namespace cbdc::sentinel_2pc {
         std::vector<std::unique_ptr<sentinel::rpc::client>>
             m_sentinel_clients{};
 
-        std::random_device m_r{};
-        std::default_random_engine m_rand{m_r()};
-        std::uniform_int_distribution<size_t> m_dist{};
+        std::mutex m_selector_mut;
+        std::unique_ptr<cbdc::rpc::endpoint_selector> m_selector;
 
         privkey_t m_privkey{};
     };
@@ -10,6 +10,7 @@
 #include <functional>
 #include <mutex>
 #include <queue>
+#include <vector>
 
 namespace cbdc {
     /// Thread-safe producer-consumer FIFO queue supporting multiple
@@ -77,6 +78,37 @@ namespace cbdc {
             }
         }
 
+        /// \brief Pops up to a given number of elements from the queue.
+        ///
+        /// Blocks while the queue is empty as in \ref pop, then pops the
+        /// queued elements so the caller can process them as a batch.
+        /// \param items vector to which to append the popped elements.
+        /// \param max_items maximum number of elements to pop.
+        /// \return true on success, false if interrupted by \ref clear() or
+        ///         destruction.
+        [[nodiscard]] auto pop_all(std::vector<T>& items, size_t max_items)
+            -> bool {
+            std::unique_lock<std::mutex> lck(m_mut);
+            if(m_buffer.empty()) {
+                m_cv.wait(lck, [&] {
+                    return m_wake;
+                });
+            }
+
+            bool popped{false};
+            while(!m_buffer.empty() && max_items > 0) {
+                items.emplace_back(std::move(first_item<T, Q>()));
+                m_buffer.pop();
+                max_items--;
+                popped = true;
+            }
+            if(popped) {
+                m_wake = !m_buffer.empty();
+            }
+
+            return popped;
+        }
+
         /// Clears the queue and unblocks waiting consumers.
         void clear() {
             {
@@ -74,6 +74,11 @@ namespace cbdc {
         return ret.str();
     }
 
+    auto share_buffer(buffer&& buf) -> std::shared_ptr<buffer> {
+        return std::allocate_shared<buffer>(pool_allocator<buffer>(),
+                                            std::move(buf));
+    }
+
     auto buffer::from_hex(const std::string& hex) -> std::optional<buffer> {
         constexpr auto max_size = 102400;
         if(hex.empty() || ((hex.size() % 2) != 0) || (hex.size() > max_size)) {
@@ -6,12 +6,17 @@
 #ifndef OPENCBDC_TX_SRC_COMMON_BUFFER_H_
 #define OPENCBDC_TX_SRC_COMMON_BUFFER_H_
 
+#include "buffer_pool.hpp"
+
+#include <memory>
 #include <optional>
 #include <string>
 #include <vector>
 
 namespace cbdc {
-    /// Buffer to store and retrieve byte data.
+    /// Buffer to store and retrieve byte data. Storage is drawn from the
+    /// process-wide \ref buffer_pool and returned to it when the buffer is
+    /// destroyed.
     class buffer {
       public:
         buffer() = default;
@@ -49,7 +54,8 @@ namespace cbdc {
 
         auto operator==(const buffer& other) const -> bool;
 
-        /// Extends the size of the buffer by the given length.
+        /// Extends the size of the buffer by the given length. The added
+        /// bytes are uninitialized.
         /// \param len the number of bytes to add.
         void extend(size_t len);
 
@@ -72,8 +78,14 @@ namespace cbdc {
         [[nodiscard]] auto to_hex() const -> std::string;
 
       private:
-        std::vector<std::byte> m_data{};
+        std::vector<std::byte, pool_allocator<std::byte>> m_data{};
     };
+
+    /// Moves the given buffer into a shared pointer. Allocates the shared
+    /// pointer's control block from the \ref buffer_pool.
+    /// \param buf buffer to share.
+    /// \return shared pointer to the buffer.
+    auto share_buffer(buffer&& buf) -> std::shared_ptr<buffer>;
 }
 
 #endif // OPENCBDC_TX_SRC_COMMON_BUFFER_H_
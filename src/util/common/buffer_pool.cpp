@@ -0,0 +1,181 @@
+// Copyright (c) 2021 MIT Digital Currency Initiative,
+//                    Federal Reserve Bank of Boston
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "buffer_pool.hpp"
+
+#include <algorithm>
+
+namespace cbdc {
+    struct buffer_pool::thread_cache {
+        std::array<std::vector<void*>, n_classes> m_blocks;
+
+        thread_cache() {
+            for(size_t i{0}; i < n_classes; i++) {
+                m_blocks[i].reserve(thread_cache_limit(i));
+            }
+        }
+
+        ~thread_cache();
+
+        thread_cache(const thread_cache&) = delete;
+        auto operator=(const thread_cache&) -> thread_cache& = delete;
+        thread_cache(thread_cache&&) = delete;
+        auto operator=(thread_cache&&) -> thread_cache& = delete;
+    };
+
+    namespace {
+        // Trivially destructible, so still valid while objects with static
+        // storage duration release blocks after the thread's cache is
+        // destroyed.
+        thread_local bool cache_destroyed{false};
+    }
+
+    buffer_pool::thread_cache::~thread_cache() {
+        cache_destroyed = true;
+        auto& pool = buffer_pool::get();
+        for(size_t i{0}; i < n_classes; i++) {
+            pool.give(i, m_blocks[i].data(), m_blocks[i].size());
+        }
+    }
+
+    buffer_pool::buffer_pool(bool use_thread_cache)
+        : m_thread_cache(use_thread_cache) {}
+
+    buffer_pool::~buffer_pool() {
+        for(auto& c : m_classes) {
+            for(auto* ptr : c.m_free) {
+                ::operator delete(ptr);
+            }
+        }
+    }
+
+    auto buffer_pool::get() -> buffer_pool& {
+        // NOLINTNEXTLINE(cppcoreguidelines-owning-memory)
+        static auto* pool = new buffer_pool(true);
+        return *pool;
+    }
+
+    auto buffer_pool::local_cache() -> thread_cache* {
+        if(cache_destroyed) {
+            return nullptr;
+        }
+        thread_local thread_cache cache;
+        return &cache;
+    }
+
+    auto buffer_pool::class_index(size_t len) -> size_t {
+        size_t idx{0};
+        while(class_size(idx) < len) {
+            idx++;
+        }
+        return idx;
+    }
+
+    auto buffer_pool::class_size(size_t idx) -> size_t {
+        return min_class_size << idx;
+    }
+
+    auto buffer_pool::thread_cache_limit(size_t idx) -> size_t {
+        return std::clamp(max_thread_cached_bytes / class_size(idx),
+                          size_t{1},
+                          max_thread_cached_blocks);
+    }
+
+    auto buffer_pool::allocate(size_t len) -> void* {
+        if(len > max_class_size) {
+            return ::operator new(len);
+        }
+        const auto idx = class_index(len);
+        auto* cache = m_thread_cache ? local_cache() : nullptr;
+        if(cache == nullptr) {
+            return take(idx, nullptr);
+        }
+        auto& blocks = cache->m_blocks[idx];
+        if(blocks.empty()) {
+            return take(idx, &blocks);
+        }
+        auto* ptr = blocks.back();
+        blocks.pop_back();
+        return ptr;
+    }
+
+    void buffer_pool::deallocate(void* ptr, size_t len) noexcept {
+        if(ptr == nullptr) {
+            return;
+        }
+        if(len > max_class_size) {
+            ::operator delete(ptr);
+            return;
+        }
+        const auto idx = class_index(len);
+        auto* cache = m_thread_cache ? local_cache() : nullptr;
+        if(cache == nullptr) {
+            give(idx, &ptr, 1);
+            return;
+        }
+        // Move half the thread's cache to the shared list when it is full,
+        // so the next few frees do not need the lock.
+        auto& blocks = cache->m_blocks[idx];
+        const auto limit = thread_cache_limit(idx);
+        if(blocks.size() >= limit) {
+            const auto n = limit - limit / 2;
+            give(idx, blocks.data() + blocks.size() - n, n);
+            blocks.resize(blocks.size() - n);
+        }
+        blocks.push_back(ptr);
+    }
+
+    auto buffer_pool::take(size_t idx, std::vector<void*>* blocks) -> void* {
+        auto& c = m_classes[idx];
+        {
+            std::lock_guard<std::mutex> l(c.m_mut);
+            if(!c.m_free.empty()) {
+                // Refill half the thread's cache along with the block
+                // returned, so the next few allocations do not need the
+                // lock.
+                if(blocks != nullptr) {
+                    const auto n = std::min(c.m_free.size() - 1,
+                                            thread_cache_limit(idx) / 2);
+                    const auto first = c.m_free.end()
+                                     - static_cast<std::ptrdiff_t>(n);
+                    blocks->insert(blocks->end(), first, c.m_free.end());
+                    c.m_free.erase(first, c.m_free.end());
+                }
+                auto* ptr = c.m_free.back();
+                c.m_free.pop_back();
+                return ptr;
+            }
+            c.m_allocated++;
+        }
+        return ::operator new(class_size(idx));
+    }
+
+    void buffer_pool::give(size_t idx, void* const* ptrs, size_t count) {
+        const auto max_free = max_cached_bytes / class_size(idx);
+        size_t kept{0};
+        {
+            auto& c = m_classes[idx];
+            std::lock_guard<std::mutex> l(c.m_mut);
+            if(c.m_free.size() < max_free) {
+                kept = std::min(count, max_free - c.m_free.size());
+            }
+            c.m_free.insert(c.m_free.end(), ptrs, ptrs + kept);
+        }
+        for(auto i = kept; i < count; i++) {
+            ::operator delete(ptrs[i]);
+        }
+    }
+
+    auto buffer_pool::get_stats() -> stats {
+        auto ret = stats();
+        for(size_t i{0}; i < n_classes; i++) {
+            auto& c = m_classes[i];
+            std::lock_guard<std::mutex> l(c.m_mut);
+            ret.m_allocated += c.m_allocated;
+            ret.m_cached_bytes += c.m_free.size() * class_size(i);
+        }
+        return ret;
+    }
+}
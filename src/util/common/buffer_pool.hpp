@@ -0,0 +1,158 @@
+// Copyright (c) 2021 MIT Digital Currency Initiative,
+//                    Federal Reserve Bank of Boston
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef OPENCBDC_TX_SRC_COMMON_BUFFER_POOL_H_
+#define OPENCBDC_TX_SRC_COMMON_BUFFER_POOL_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace cbdc {
+    /// \brief Process-wide pool of recycled memory blocks.
+    ///
+    /// Rounds allocations up to a power-of-two size class and keeps freed
+    /// blocks on a free list per class, so a process exchanging messages
+    /// of similar sizes reuses the same blocks rather than returning to
+    /// the heap. Blocks are often freed on a different thread than the one
+    /// which allocated them, so the free lists are shared between threads.
+    /// The process-wide pool also keeps a few blocks of each class per
+    /// thread, moving them to and from the shared lists in batches, so most
+    /// allocations do not take a lock. Allocations larger than the largest
+    /// class bypass the pool.
+    class buffer_pool {
+      public:
+        /// Size of the smallest class in bytes.
+        static constexpr size_t min_class_size = 64;
+        /// Size of the largest class in bytes.
+        static constexpr size_t max_class_size = 1024 * 1024;
+        /// Maximum number of bytes kept on the shared free list of each
+        /// class. Further freed blocks are returned to the heap.
+        static constexpr size_t max_cached_bytes = 8 * 1024 * 1024;
+        /// Maximum number of bytes of each class kept by each thread.
+        static constexpr size_t max_thread_cached_bytes = 1024 * 1024;
+        /// Maximum number of blocks of each class kept by each thread.
+        static constexpr size_t max_thread_cached_blocks = 32;
+
+        /// Allocation counters.
+        struct stats {
+            /// Allocations served from the heap rather than a free list.
+            uint64_t m_allocated{0};
+            /// Bytes held on the shared free lists, excluding the blocks
+            /// cached by each thread.
+            size_t m_cached_bytes{0};
+        };
+
+        /// Constructs a pool without per-thread caches.
+        buffer_pool() = default;
+        ~buffer_pool();
+
+        buffer_pool(const buffer_pool&) = delete;
+        auto operator=(const buffer_pool&) -> buffer_pool& = delete;
+        buffer_pool(buffer_pool&&) = delete;
+        auto operator=(buffer_pool&&) -> buffer_pool& = delete;
+
+        /// Returns the pool shared by the process. The pool is never
+        /// destroyed, so objects with static storage duration may release
+        /// blocks during shutdown.
+        /// \return shared pool.
+        static auto get() -> buffer_pool&;
+
+        /// Allocates a block of at least the given size.
+        /// \param len number of bytes.
+        /// \return pointer to the block, aligned as by operator new.
+        auto allocate(size_t len) -> void*;
+
+        /// Returns a block to the pool.
+        /// \param ptr block returned by \ref allocate.
+        /// \param len size passed to \ref allocate.
+        void deallocate(void* ptr, size_t len) noexcept;
+
+        /// Returns the allocation counters.
+        /// \return counters.
+        auto get_stats() -> stats;
+
+      private:
+        static constexpr size_t n_classes = 15;
+        static_assert(min_class_size << (n_classes - 1) == max_class_size);
+
+        struct size_class {
+            std::mutex m_mut;
+            std::vector<void*> m_free;
+            uint64_t m_allocated{0};
+        };
+
+        struct thread_cache;
+
+        std::array<size_class, n_classes> m_classes;
+        bool m_thread_cache{false};
+
+        explicit buffer_pool(bool use_thread_cache);
+
+        static auto class_index(size_t len) -> size_t;
+        static auto class_size(size_t idx) -> size_t;
+        static auto thread_cache_limit(size_t idx) -> size_t;
+        static auto local_cache() -> thread_cache*;
+
+        auto take(size_t idx, std::vector<void*>* blocks) -> void*;
+        void give(size_t idx, void* const* ptrs, size_t count);
+    };
+
+    /// \brief Allocator drawing from the process-wide \ref buffer_pool.
+    ///
+    /// Default-initializes elements constructed without arguments, so
+    /// resizing a container of trivial types leaves the new elements
+    /// uninitialized rather than zero-filling them.
+    /// \tparam T type of element to allocate.
+    template<typename T>
+    class pool_allocator {
+      public:
+        using value_type = T;
+        using is_always_equal = std::true_type;
+
+        pool_allocator() = default;
+
+        /// Converting constructor, required to rebind the allocator.
+        template<typename U>
+        // NOLINTNEXTLINE(google-explicit-constructor)
+        pool_allocator(const pool_allocator<U>& /* other */) {}
+
+        auto allocate(size_t n) -> T* {
+            return static_cast<T*>(buffer_pool::get().allocate(n * sizeof(T)));
+        }
+
+        void deallocate(T* ptr, size_t n) noexcept {
+            buffer_pool::get().deallocate(ptr, n * sizeof(T));
+        }
+
+        template<typename U>
+        void construct(U* ptr) noexcept(
+            std::is_nothrow_default_constructible_v<U>) {
+            ::new(static_cast<void*>(ptr)) U;
+        }
+
+        template<typename U, typename... Args>
+        void construct(U* ptr, Args&&... args) {
+            ::new(static_cast<void*>(ptr)) U(std::forward<Args>(args)...);
+        }
+
+        template<typename U>
+        auto operator==(const pool_allocator<U>& /* rhs */) const -> bool {
+            return true;
+        }
+
+        template<typename U>
+        auto operator!=(const pool_allocator<U>& /* rhs */) const -> bool {
+            return false;
+        }
+    };
+}
+
+#endif // OPENCBDC_TX_SRC_COMMON_BUFFER_POOL_H_
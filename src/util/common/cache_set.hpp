@@ -7,9 +7,10 @@
 #define CACHE_SET_H_INC
 
 #include <cassert>
-#include <queue>
+#include <deque>
 #include <shared_mutex>
 #include <unordered_set>
+#include <vector>
 
 namespace cbdc {
     /// \brief Thread-safe set with a maximum size.
@@ -39,11 +40,11 @@ namespace cbdc {
             std::unique_lock<std::shared_mutex> l(m_mut);
             auto added = m_vals.emplace(std::forward<T>(val));
             if(added.second) {
-                m_eviction_queue.push(std::ref(*added.first));
+                m_eviction_queue.push_back(std::ref(*added.first));
                 if(m_eviction_queue.size() >= m_max_size) {
                     auto& v = m_eviction_queue.front();
                     m_vals.erase(v);
-                    m_eviction_queue.pop();
+                    m_eviction_queue.pop_front();
                 }
             }
             assert(m_eviction_queue.size() <= m_max_size);
@@ -58,9 +59,28 @@ namespace cbdc {
             return m_vals.find(val) != m_vals.end();
         }
 
+        /// Returns the values in the set, in the order they will be evicted.
+        /// \return values from oldest to newest.
+        [[nodiscard]] auto values() const -> std::vector<K> {
+            std::shared_lock<std::shared_mutex> l(m_mut);
+            auto ret = std::vector<K>();
+            ret.reserve(m_eviction_queue.size());
+            for(const auto& v : m_eviction_queue) {
+                ret.push_back(v.get());
+            }
+            return ret;
+        }
+
+        /// Removes all values from the set.
+        void clear() {
+            std::unique_lock<std::shared_mutex> l(m_mut);
+            m_eviction_queue.clear();
+            m_vals.clear();
+        }
+
       private:
         std::unordered_set<K, H> m_vals;
-        std::queue<std::reference_wrapper<const K>> m_eviction_queue;
+        std::deque<std::reference_wrapper<const K>> m_eviction_queue;
         size_t m_max_size;
         mutable std::shared_mutex m_mut;
     };
@@ -11,6 +11,10 @@
 
 namespace cbdc::config {
     auto parse_ip_port(const std::string& in_str) -> network::endpoint_t {
+        if(network::unix_socket_path(in_str).has_value()) {
+            return {in_str, 0};
+        }
+
         // TODO: error handling for string parsing
         std::istringstream ss(in_str);
 
@@ -402,6 +406,12 @@ namespace cbdc::config {
         opts.m_coordinator_max_threads
             = cfg.get_ulong(coordinator_max_threads)
                   .value_or(opts.m_coordinator_max_threads);
+        opts.m_coordinator_batch_linger
+            = cfg.get_ulong(coordinator_batch_linger_key)
+                  .value_or(opts.m_coordinator_batch_linger);
+        opts.m_coordinator_target_latency
+            = cfg.get_ulong(coordinator_target_latency_key)
+                  .value_or(opts.m_coordinator_target_latency);
 
         return std::nullopt;
     }
@@ -623,6 +633,67 @@ namespace cbdc::config {
 
         opts.m_twophase_mode = cfg.get_ulong(two_phase_mode).value_or(0) != 0;
 
+        const auto wire_version
+            = cfg.get_ulong(wire_format_key)
+                  .value_or(static_cast<size_t>(opts.m_wire_format));
+        if(wire_version > static_cast<size_t>(wire_format::compact)) {
+            return "Unknown wire format version "
+                 + std::to_string(wire_version) + " (" + wire_format_key
+                 + ")";
+        }
+        opts.m_wire_format = static_cast<wire_format>(wire_version);
+
+        opts.m_handler_threads = cfg.get_ulong(handler_threads_key)
+                                     .value_or(opts.m_handler_threads);
+        if(opts.m_handler_threads == 0) {
+            return std::string("Handler thread count (")
+                 + handler_threads_key + ") must be at least one";
+        }
+
+        opts.m_send_queue_limits.m_max_bytes
+            = cfg.get_ulong(send_queue_max_bytes_key)
+                  .value_or(opts.m_send_queue_limits.m_max_bytes);
+        opts.m_send_queue_limits.m_max_messages
+            = cfg.get_ulong(send_queue_max_messages_key)
+                  .value_or(opts.m_send_queue_limits.m_max_messages);
+        const auto policy = cfg.get_string(send_queue_policy_key);
+        if(policy.has_value()) {
+            if(policy.value() == "block") {
+                opts.m_send_queue_limits.m_policy
+                    = network::overflow_policy::block;
+            } else if(policy.value() == "drop_oldest") {
+                opts.m_send_queue_limits.m_policy
+                    = network::overflow_policy::drop_oldest;
+            } else if(policy.value() == "disconnect") {
+                opts.m_send_queue_limits.m_policy
+                    = network::overflow_policy::disconnect;
+            } else {
+                return "Unknown send queue policy " + policy.value() + " ("
+                     + send_queue_policy_key + ")";
+            }
+        }
+
+        const auto selection = cfg.get_string(endpoint_selection_policy_key);
+        if(selection.has_value()) {
+            if(selection.value() == "random") {
+                opts.m_endpoint_selection_policy
+                    = rpc::selection_policy::random;
+            } else if(selection.value() == "least_outstanding") {
+                opts.m_endpoint_selection_policy
+                    = rpc::selection_policy::least_outstanding;
+            } else if(selection.value() == "ewma_latency") {
+                opts.m_endpoint_selection_policy
+                    = rpc::selection_policy::ewma_latency;
+            } else if(selection.value() == "sticky_leader") {
+                opts.m_endpoint_selection_policy
+                    = rpc::selection_policy::sticky_leader;
+            } else {
+                return "Unknown endpoint selection policy "
+                     + selection.value() + " ("
+                     + endpoint_selection_policy_key + ")";
+            }
+        }
+
         auto err = read_sentinel_options(opts, cfg);
         if(err.has_value()) {
             return err.value();
@@ -16,7 +16,10 @@
 #include "hashmap.hpp"
 #include "keys.hpp"
 #include "logging.hpp"
+#include "util/network/send_queue_limits.hpp"
 #include "util/network/socket.hpp"
+#include "util/rpc/selection_policy.hpp"
+#include "util/serialization/serializer.hpp"
 
 #include <map>
 #include <optional>
@@ -110,11 +113,23 @@ namespace cbdc::config {
     static constexpr auto watchtower_error_cache_size_key
         = "watchtower_error_cache_size";
     static constexpr auto two_phase_mode = "2pc";
+    static constexpr auto wire_format_key = "wire_format";
+    static constexpr auto handler_threads_key = "handler_threads";
+    static constexpr auto send_queue_max_bytes_key = "send_queue_max_bytes";
+    static constexpr auto send_queue_max_messages_key
+        = "send_queue_max_messages";
+    static constexpr auto send_queue_policy_key = "send_queue_policy";
+    static constexpr auto endpoint_selection_policy_key
+        = "endpoint_selection_policy";
     static constexpr auto count_postfix = "count";
     static constexpr auto readonly = "readonly";
     static constexpr auto coordinator_prefix = "coordinator";
     static constexpr auto coordinator_count_key = "coordinator_count";
     static constexpr auto coordinator_max_threads = "coordinator_max_threads";
+    static constexpr auto coordinator_batch_linger_key
+        = "coordinator_batch_linger";
+    static constexpr auto coordinator_target_latency_key
+        = "coordinator_target_latency";
     static constexpr auto initial_mint_count_key = "initial_mint_count";
     static constexpr auto initial_mint_value_key = "initial_mint_value";
     static constexpr auto loadgen_count_key = "loadgen_count";
@@ -211,6 +226,22 @@ namespace cbdc::config {
         bool m_fixed_tx_mode{false};
         /// Flag set if the architecture is two-phase commit.
         bool m_twophase_mode{false};
+        /// Encoding of lengths and heights in the block, transaction and
+        /// error messages exchanged between atomizer architecture components.
+        /// Every component must use the same format.
+        wire_format m_wire_format{wire_format::fixed};
+        /// Number of threads handling requests from clients in the atomizer,
+        /// archiver and watchtower servers. Requests from each client are
+        /// handled in order by a single thread.
+        size_t m_handler_threads{1};
+        /// Limits on the packets the atomizer queues to send to each shard
+        /// and watchtower. Unlimited by default.
+        network::send_queue_limits m_send_queue_limits;
+        /// Policy clients use to choose between the replicas of a shard
+        /// cluster for read-only status queries, and sentinels use to choose
+        /// which other sentinels to ask for attestations. Random by default.
+        rpc::selection_policy m_endpoint_selection_policy{
+            rpc::selection_policy::random};
         /// List of locking shard endpoints, ordered by shard ID then node ID.
         std::vector<std::vector<network::endpoint_t>>
             m_locking_shard_endpoints;
@@ -230,6 +261,14 @@ namespace cbdc::config {
             m_coordinator_raft_endpoints;
         /// Coordinator thread count limit.
         size_t m_coordinator_max_threads{defaults::coordinator_max_threads};
+        /// Maximum time in microseconds the coordinator waits for a batch to
+        /// fill before executing it. Zero executes batches as soon as they
+        /// contain a transaction.
+        size_t m_coordinator_batch_linger{0};
+        /// Target dtx execution time in microseconds. When non-zero, the
+        /// coordinator adapts the batch size, up to m_batch_size, to keep
+        /// dtx latency near the target.
+        size_t m_coordinator_target_latency{0};
         /// List of coordinator log levels, ordered by coordinator ID.
         std::vector<logging::log_level> m_coordinator_loglevels;
 
@@ -393,6 +432,12 @@ namespace cbdc::config {
         std::map<std::string, value_t> m_options;
     };
 
+    /// Parses an endpoint of the form "host:port", or "unix:path" for a
+    /// Unix domain socket. Unix domain sockets are only supported by
+    /// components communicating through cbdc::network, not by raft
+    /// endpoints.
+    /// \param in_str string to parse.
+    /// \return endpoint.
     auto parse_ip_port(const std::string& in_str) -> network::endpoint_t;
 }
 
@@ -0,0 +1,539 @@
+// Copyright (c) 2021 MIT Digital Currency Initiative,
+//                    Federal Reserve Bank of Boston
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef OPENCBDC_TX_SRC_COMMON_FLAT_HASH_SET_H_
+#define OPENCBDC_TX_SRC_COMMON_FLAT_HASH_SET_H_
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace cbdc {
+    /// \brief Open-addressing hash set with SIMD group probing.
+    ///
+    /// Stores values inline in a flat slot array alongside a parallel array
+    /// of one-byte control words, so there is no per-element allocation. The
+    /// table is split into groups of 16 slots. A lookup hashes the key once,
+    /// selects a group from the high bits of the hash, and compares the low
+    /// 7 bits against all 16 control bytes of the group at once (using SSE2
+    /// where available, with a portable fallback). Only slots whose control
+    /// byte matches are compared with the key, so most lookups touch one
+    /// control group and one slot.
+    ///
+    /// The table holds at most 7/8 of its slots and grows by doubling. The
+    /// number of groups need not be a power of two, so reserve() sizes the
+    /// table to within one group of the requested count. Erased slots become
+    /// tombstones unless their group still has an empty slot, and are
+    /// reclaimed on the next rehash.
+    ///
+    /// \warning Not thread safe. Inserting or erasing invalidates all
+    ///          iterators.
+    /// \tparam K type of the values in the set. Must be trivially copyable.
+    /// \tparam H hasher compatible with std::unordered_set.
+    /// \tparam E equality comparator for values.
+    template<typename K,
+             typename H = std::hash<K>,
+             typename E = std::equal_to<K>>
+    class flat_hash_set {
+        static_assert(std::is_trivially_copyable_v<K>,
+                      "flat_hash_set values must be trivially copyable");
+        static_assert(std::is_default_constructible_v<K>,
+                      "flat_hash_set values must be default constructible");
+
+        using ctrl_t = int8_t;
+
+        /// Control byte of a slot that has never held a value.
+        static constexpr ctrl_t empty_ctrl = -128;
+        /// Control byte of a slot whose value has been erased.
+        static constexpr ctrl_t deleted_ctrl = -2;
+        /// Number of slots probed together.
+        static constexpr size_t group_width = 16;
+        /// Number of hash bits stored in the control byte of a full slot.
+        static constexpr size_t ctrl_bits = 7;
+        static constexpr size_t ctrl_mask = (1U << ctrl_bits) - 1;
+        /// Maximum load factor of the table is max_load_num / max_load_den.
+        static constexpr size_t max_load_num = 7;
+        static constexpr size_t max_load_den = 8;
+
+      public:
+        using key_type = K;
+        using value_type = K;
+        using size_type = size_t;
+        using hasher = H;
+        using key_equal = E;
+
+        /// Forward iterator over the values in the set. Values cannot be
+        /// modified through the iterator.
+        class const_iterator {
+          public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = K;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const K*;
+            using reference = const K&;
+
+            const_iterator() = default;
+
+            auto operator*() const -> reference {
+                return *m_slot;
+            }
+
+            auto operator->() const -> pointer {
+                return m_slot;
+            }
+
+            auto operator++() -> const_iterator& {
+                ++m_ctrl;
+                ++m_slot;
+                skip_free();
+                return *this;
+            }
+
+            auto operator++(int) -> const_iterator {
+                auto ret = *this;
+                ++(*this);
+                return ret;
+            }
+
+            auto operator==(const const_iterator& rhs) const -> bool {
+                return m_ctrl == rhs.m_ctrl;
+            }
+
+            auto operator!=(const const_iterator& rhs) const -> bool {
+                return m_ctrl != rhs.m_ctrl;
+            }
+
+          private:
+            friend class flat_hash_set;
+
+            const_iterator(const ctrl_t* ctrl,
+                           const K* slot,
+                           const ctrl_t* end)
+                : m_ctrl(ctrl),
+                  m_slot(slot),
+                  m_end(end) {}
+
+            void skip_free() {
+                while(m_ctrl != m_end && *m_ctrl < 0) {
+                    ++m_ctrl;
+                    ++m_slot;
+                }
+            }
+
+            const ctrl_t* m_ctrl{nullptr};
+            const K* m_slot{nullptr};
+            const ctrl_t* m_end{nullptr};
+        };
+
+        using iterator = const_iterator;
+
+        flat_hash_set() = default;
+
+        /// Constructor.
+        /// \param count number of values to reserve space for.
+        explicit flat_hash_set(size_t count) {
+            reserve(count);
+        }
+
+        ~flat_hash_set() = default;
+        flat_hash_set(const flat_hash_set&) = default;
+        auto operator=(const flat_hash_set&) -> flat_hash_set& = default;
+
+        flat_hash_set(flat_hash_set&& other) noexcept
+            : m_ctrl(std::move(other.m_ctrl)),
+              m_slots(std::move(other.m_slots)),
+              m_size(std::exchange(other.m_size, 0)),
+              m_growth_left(std::exchange(other.m_growth_left, 0)) {}
+
+        auto operator=(flat_hash_set&& other) noexcept -> flat_hash_set& {
+            m_ctrl = std::move(other.m_ctrl);
+            m_slots = std::move(other.m_slots);
+            m_size = std::exchange(other.m_size, 0);
+            m_growth_left = std::exchange(other.m_growth_left, 0);
+            return *this;
+        }
+
+        [[nodiscard]] auto begin() const -> const_iterator {
+            auto it = iterator_at(0);
+            it.skip_free();
+            return it;
+        }
+
+        [[nodiscard]] auto end() const -> const_iterator {
+            return iterator_at(m_ctrl.size());
+        }
+
+        /// Returns the number of values in the set.
+        /// \return set size.
+        [[nodiscard]] auto size() const -> size_t {
+            return m_size;
+        }
+
+        /// Returns whether the set contains no values.
+        /// \return true if the set is empty.
+        [[nodiscard]] auto empty() const -> bool {
+            return m_size == 0;
+        }
+
+        /// Returns the number of slots allocated in the table.
+        /// \return table capacity.
+        [[nodiscard]] auto bucket_count() const -> size_t {
+            return m_ctrl.size();
+        }
+
+        /// Returns an iterator to the given value.
+        /// \param key value to find.
+        /// \return iterator to the value, or end() if the value is not in the
+        ///         set.
+        [[nodiscard]] auto find(const K& key) const -> const_iterator {
+            auto idx = find_index(key, hash_of(key));
+            if(idx == npos) {
+                return end();
+            }
+            return iterator_at(idx);
+        }
+
+        /// Determines whether the set contains the given value.
+        /// \param key value to check.
+        /// \return true if the value is in the set.
+        [[nodiscard]] auto contains(const K& key) const -> bool {
+            return find_index(key, hash_of(key)) != npos;
+        }
+
+        /// Returns the number of copies of the given value in the set.
+        /// \param key value to count.
+        /// \return 1 if the value is in the set, otherwise 0.
+        [[nodiscard]] auto count(const K& key) const -> size_t {
+            return contains(key) ? 1 : 0;
+        }
+
+        /// Inserts a value into the set.
+        /// \param key value to insert.
+        /// \return iterator to the value in the set and true if the value
+        ///         was inserted, or false if it was already present.
+        auto insert(const K& key) -> std::pair<const_iterator, bool> {
+            auto h = hash_of(key);
+            auto [idx, found] = find_or_prepare_insert(key, h);
+            if(!found) {
+                m_slots[idx] = key;
+                ++m_size;
+            }
+            return {iterator_at(idx), !found};
+        }
+
+        /// Constructs a value in-place and inserts it into the set.
+        /// \see insert
+        template<typename... Args>
+        auto emplace(Args&&... args) -> std::pair<const_iterator, bool> {
+            return insert(K(std::forward<Args>(args)...));
+        }
+
+        /// Removes a value from the set.
+        /// \param key value to remove.
+        /// \return number of values removed.
+        auto erase(const K& key) -> size_t {
+            auto idx = find_index(key, hash_of(key));
+            if(idx == npos) {
+                return 0;
+            }
+            erase_at(idx);
+            return 1;
+        }
+
+        /// Removes the value at the given position from the set.
+        /// \param it iterator to a value in the set.
+        void erase(const_iterator it) {
+            assert(it != end());
+            erase_at(static_cast<size_t>(it.m_ctrl - m_ctrl.data()));
+        }
+
+        /// Removes all values from the set. Keeps the allocated capacity.
+        void clear() {
+            std::fill(m_ctrl.begin(), m_ctrl.end(), empty_ctrl);
+            m_size = 0;
+            m_growth_left = max_load(m_ctrl.size());
+        }
+
+        /// Grows the table so that it holds at least the given number of
+        /// values without rehashing.
+        /// \param count number of values to reserve space for.
+        void reserve(size_t count) {
+            auto cap = capacity_for(count);
+            if(cap > m_ctrl.size()) {
+                resize(cap);
+            }
+        }
+
+      private:
+        static constexpr size_t npos = static_cast<size_t>(-1);
+
+        /// Bitmask of the slots in a group matching a predicate. Bit i is
+        /// set if slot i of the group matched.
+        class group {
+          public:
+            explicit group(const ctrl_t* pos) {
+#ifdef __SSE2__
+                m_ctrl
+                    = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pos));
+#else
+                std::memcpy(m_ctrl, pos, group_width);
+#endif
+            }
+
+            /// Returns the slots whose control byte equals the given value.
+            [[nodiscard]] auto match(ctrl_t val) const -> uint32_t {
+#ifdef __SSE2__
+                auto cmp = _mm_cmpeq_epi8(m_ctrl, _mm_set1_epi8(val));
+                return static_cast<uint32_t>(_mm_movemask_epi8(cmp));
+#else
+                uint32_t ret{};
+                for(size_t i{0}; i < group_width; i++) {
+                    if(m_ctrl[i] == val) {
+                        ret |= 1U << i;
+                    }
+                }
+                return ret;
+#endif
+            }
+
+            /// Returns the slots that are empty.
+            [[nodiscard]] auto match_empty() const -> uint32_t {
+                return match(empty_ctrl);
+            }
+
+            /// Returns the slots that are empty or erased. Both special
+            /// control bytes have the sign bit set.
+            [[nodiscard]] auto match_free() const -> uint32_t {
+#ifdef __SSE2__
+                return static_cast<uint32_t>(_mm_movemask_epi8(m_ctrl));
+#else
+                uint32_t ret{};
+                for(size_t i{0}; i < group_width; i++) {
+                    if(m_ctrl[i] < 0) {
+                        ret |= 1U << i;
+                    }
+                }
+                return ret;
+#endif
+            }
+
+          private:
+#ifdef __SSE2__
+            __m128i m_ctrl;
+#else
+            ctrl_t m_ctrl[group_width];
+#endif
+        };
+
+        std::vector<ctrl_t> m_ctrl;
+        std::vector<K> m_slots;
+        size_t m_size{};
+        size_t m_growth_left{};
+
+        /// Hashes the key and mixes the result. The mixing step matters for
+        /// hashers like \ref hashing::null that pass raw ID bytes through:
+        /// the leading byte of every UHS ID in a shard falls in the shard's
+        /// range, so the unmixed low bits would cluster.
+        [[nodiscard]] static auto hash_of(const K& key) -> uint64_t {
+            auto h = static_cast<uint64_t>(H()(key));
+            // MurmurHash3 64-bit finalizer
+            static constexpr uint64_t mul0 = 0xff51afd7ed558ccd;
+            static constexpr uint64_t mul1 = 0xc4ceb9fe1a85ec53;
+            static constexpr auto shift = 33;
+            h ^= h >> shift;
+            h *= mul0;
+            h ^= h >> shift;
+            h *= mul1;
+            h ^= h >> shift;
+            return h;
+        }
+
+        [[nodiscard]] static auto ctrl_of(uint64_t h) -> ctrl_t {
+            return static_cast<ctrl_t>(h & ctrl_mask);
+        }
+
+        [[nodiscard]] static auto max_load(size_t cap) -> size_t {
+            return cap / max_load_den * max_load_num;
+        }
+
+        /// Returns the smallest capacity (a whole number of groups) that
+        /// holds the given number of values.
+        [[nodiscard]] static auto capacity_for(size_t count) -> size_t {
+            if(count == 0) {
+                return 0;
+            }
+            auto groups = (count + max_load(group_width) - 1)
+                        / max_load(group_width);
+            return groups * group_width;
+        }
+
+        /// Maps the high 32 bits of the hash onto the group range with a
+        /// multiply-shift rather than a modulo.
+        [[nodiscard]] auto first_group(uint64_t h) const -> size_t {
+            static constexpr auto half_bits = 32;
+            const auto groups = static_cast<uint64_t>(m_ctrl.size()
+                                                      / group_width);
+            return static_cast<size_t>(((h >> half_bits) * groups)
+                                       >> half_bits);
+        }
+
+        [[nodiscard]] auto next_group(size_t g) const -> size_t {
+            return g + 1 == m_ctrl.size() / group_width ? 0 : g + 1;
+        }
+
+        [[nodiscard]] auto iterator_at(size_t idx) const -> const_iterator {
+            return const_iterator(m_ctrl.data() + idx,
+                                  m_slots.data() + idx,
+                                  m_ctrl.data() + m_ctrl.size());
+        }
+
+        [[nodiscard]] auto find_index(const K& key, uint64_t h) const
+            -> size_t {
+            if(m_ctrl.empty()) {
+                return npos;
+            }
+            auto g = first_group(h);
+            const auto c = ctrl_of(h);
+            for(;;) {
+                const auto base = g * group_width;
+                const auto grp = group(m_ctrl.data() + base);
+                for(auto m = grp.match(c); m != 0; m &= m - 1) {
+                    const auto idx = base + lowest_bit(m);
+                    if(E()(m_slots[idx], key)) {
+                        return idx;
+                    }
+                }
+                if(grp.match_empty() != 0) {
+                    return npos;
+                }
+                g = next_group(g);
+            }
+        }
+
+        /// Probes for the key, returning its index if present. Otherwise
+        /// claims a free slot for it, growing the table if needed, and
+        /// returns the index of the claimed slot.
+        auto find_or_prepare_insert(const K& key, uint64_t h)
+            -> std::pair<size_t, bool> {
+            if(!m_ctrl.empty()) {
+                auto g = first_group(h);
+                const auto c = ctrl_of(h);
+                auto target = npos;
+                for(;;) {
+                    const auto base = g * group_width;
+                    const auto grp = group(m_ctrl.data() + base);
+                    for(auto m = grp.match(c); m != 0; m &= m - 1) {
+                        const auto idx = base + lowest_bit(m);
+                        if(E()(m_slots[idx], key)) {
+                            return {idx, true};
+                        }
+                    }
+                    if(target == npos) {
+                        auto free = grp.match_free();
+                        if(free != 0) {
+                            target = base + lowest_bit(free);
+                        }
+                    }
+                    if(grp.match_empty() != 0) {
+                        break;
+                    }
+                    g = next_group(g);
+                }
+                // Reusing a tombstone never consumes growth.
+                if(m_ctrl[target] == deleted_ctrl) {
+                    m_ctrl[target] = c;
+                    return {target, false};
+                }
+                if(m_growth_left > 0) {
+                    m_ctrl[target] = c;
+                    --m_growth_left;
+                    return {target, false};
+                }
+            }
+            grow();
+            auto idx = find_free_slot(h);
+            m_ctrl[idx] = ctrl_of(h);
+            --m_growth_left;
+            return {idx, false};
+        }
+
+        /// Returns the first free slot in the probe sequence for the given
+        /// hash. Only valid on a table with no tombstones, as after a
+        /// rehash.
+        [[nodiscard]] auto find_free_slot(uint64_t h) const -> size_t {
+            auto g = first_group(h);
+            for(;;) {
+                const auto base = g * group_width;
+                auto free = group(m_ctrl.data() + base).match_free();
+                if(free != 0) {
+                    return base + lowest_bit(free);
+                }
+                g = next_group(g);
+            }
+        }
+
+        void erase_at(size_t idx) {
+            const auto base = idx / group_width * group_width;
+            // If the group still has an empty slot, no probe sequence
+            // continues past it, so the slot can become empty again instead
+            // of a tombstone.
+            if(group(m_ctrl.data() + base).match_empty() != 0) {
+                m_ctrl[idx] = empty_ctrl;
+                ++m_growth_left;
+            } else {
+                m_ctrl[idx] = deleted_ctrl;
+            }
+            --m_size;
+        }
+
+        /// Makes room for at least one more value. Rehashes in place to drop
+        /// tombstones if the table is at most half full, otherwise doubles
+        /// the capacity.
+        void grow() {
+            if(m_ctrl.empty()) {
+                resize(group_width);
+            } else if(m_size + 1 <= max_load(m_ctrl.size()) / 2) {
+                resize(m_ctrl.size());
+            } else {
+                resize(m_ctrl.size() * 2);
+            }
+        }
+
+        void resize(size_t cap) {
+            assert(cap % group_width == 0);
+            assert(max_load(cap) >= m_size);
+            auto old_ctrl = std::move(m_ctrl);
+            auto old_slots = std::move(m_slots);
+            m_ctrl.assign(cap, empty_ctrl);
+            m_slots.resize(cap);
+            m_growth_left = max_load(cap) - m_size;
+            for(size_t i{0}; i < old_ctrl.size(); i++) {
+                if(old_ctrl[i] < 0) {
+                    continue;
+                }
+                const auto h = hash_of(old_slots[i]);
+                const auto idx = find_free_slot(h);
+                m_ctrl[idx] = ctrl_of(h);
+                m_slots[idx] = old_slots[i];
+            }
+        }
+
+        [[nodiscard]] static auto lowest_bit(uint32_t mask) -> size_t {
+            return static_cast<size_t>(__builtin_ctz(mask));
+        }
+    };
+}
+
+#endif // OPENCBDC_TX_SRC_COMMON_FLAT_HASH_SET_H_
@@ -0,0 +1,142 @@
+// Copyright (c) 2021 MIT Digital Currency Initiative,
+//                    Federal Reserve Bank of Boston
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+namespace cbdc {
+    thread_pool::thread_pool(size_t n_threads, size_t max_queued)
+        : m_max_queued(max_queued) {
+        m_workers.reserve(n_threads);
+        for(size_t i{0}; i < n_threads; i++) {
+            m_workers.emplace_back([&]() {
+                worker();
+            });
+        }
+    }
+
+    thread_pool::~thread_pool() {
+        {
+            std::unique_lock<std::mutex> l(m_mut);
+            m_stop = true;
+            m_tasks.clear();
+        }
+        m_task_cv.notify_all();
+        m_space_cv.notify_all();
+        m_idle_cv.notify_all();
+        for(auto& t : m_workers) {
+            if(t.joinable()) {
+                t.join();
+            }
+        }
+    }
+
+    void thread_pool::push(task_type task) {
+        {
+            std::unique_lock<std::mutex> l(m_mut);
+            m_space_cv.wait(l, [&]() {
+                return m_max_queued == 0 || m_tasks.size() < m_max_queued
+                    || m_stop;
+            });
+            if(m_stop) {
+                return;
+            }
+            m_tasks.push_back(std::move(task));
+        }
+        m_task_cv.notify_one();
+    }
+
+    void thread_pool::parallel_for(size_t count,
+                                   const std::function<void(size_t)>& fn) {
+        if(count == 0) {
+            return;
+        }
+        // One chunk for each worker plus one for the calling thread
+        const auto chunks = std::min(count, m_workers.size() + 1);
+        const auto chunk_size = (count + chunks - 1) / chunks;
+        auto run_chunk = [&](size_t chunk) {
+            const auto begin = chunk * chunk_size;
+            const auto end = std::min(count, begin + chunk_size);
+            for(size_t i{begin}; i < end; i++) {
+                fn(i);
+            }
+        };
+
+        std::mutex mut;
+        std::condition_variable cv;
+        size_t remaining{chunks - 1};
+        for(size_t chunk{1}; chunk < chunks; chunk++) {
+            push([&, chunk]() {
+                run_chunk(chunk);
+                // Notify under the lock: the waiter owns cv and may destroy
+                // it as soon as it observes remaining == 0.
+                std::unique_lock<std::mutex> l(mut);
+                remaining--;
+                cv.notify_one();
+            });
+        }
+        run_chunk(0);
+
+        std::unique_lock<std::mutex> l(mut);
+        cv.wait(l, [&]() {
+            return remaining == 0;
+        });
+    }
+
+    void thread_pool::wait_idle() {
+        std::unique_lock<std::mutex> l(m_mut);
+        m_idle_cv.wait(l, [&]() {
+            return (m_tasks.empty() && m_busy == 0) || m_stop;
+        });
+    }
+
+    auto thread_pool::size() const -> size_t {
+        return m_workers.size();
+    }
+
+    auto thread_pool::queue_depth() const -> size_t {
+        std::unique_lock<std::mutex> l(m_mut);
+        return m_tasks.size();
+    }
+
+    auto thread_pool::busy() const -> size_t {
+        std::unique_lock<std::mutex> l(m_mut);
+        return m_busy;
+    }
+
+    void thread_pool::worker() {
+        while(true) {
+            auto task = task_type();
+            {
+                std::unique_lock<std::mutex> l(m_mut);
+                m_task_cv.wait(l, [&]() {
+                    return !m_tasks.empty() || m_stop;
+                });
+                if(m_stop) {
+                    return;
+                }
+                task = std::move(m_tasks.front());
+                m_tasks.pop_front();
+                m_busy++;
+            }
+            m_space_cv.notify_one();
+
+            assert(task);
+            task();
+
+            bool idle{false};
+            {
+                std::unique_lock<std::mutex> l(m_mut);
+                m_busy--;
+                idle = m_busy == 0 && m_tasks.empty();
+            }
+            if(idle) {
+                m_idle_cv.notify_all();
+            }
+        }
+    }
+}
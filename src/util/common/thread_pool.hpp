@@ -0,0 +1,85 @@
+// Copyright (c) 2021 MIT Digital Currency Initiative,
+//                    Federal Reserve Bank of Boston
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef OPENCBDC_TX_SRC_COMMON_THREAD_POOL_H_
+#define OPENCBDC_TX_SRC_COMMON_THREAD_POOL_H_
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace cbdc {
+    /// Fixed-size pool of worker threads consuming tasks from a shared
+    /// queue. Workers are started in the constructor and joined in the
+    /// destructor. The queue may optionally be bounded, in which case
+    /// producers block until a worker takes a task from the queue.
+    class thread_pool {
+      public:
+        /// Task type executed by the pool.
+        using task_type = std::function<void()>;
+
+        /// Constructor. Starts the worker threads.
+        /// \param n_threads number of worker threads.
+        /// \param max_queued maximum number of tasks waiting for a worker,
+        ///                   or zero for an unbounded queue.
+        explicit thread_pool(size_t n_threads, size_t max_queued = 0);
+
+        /// Destructor. Discards any queued tasks and joins the workers
+        /// after they finish their current task.
+        ~thread_pool();
+
+        thread_pool(const thread_pool&) = delete;
+        auto operator=(const thread_pool&) -> thread_pool& = delete;
+        thread_pool(thread_pool&&) = delete;
+        auto operator=(thread_pool&&) -> thread_pool& = delete;
+
+        /// Queues a task for execution by the next available worker. Blocks
+        /// while the queue is full. Tasks running on a bounded pool must
+        /// not push to the same pool, otherwise the workers may deadlock.
+        /// \param task function to execute.
+        void push(task_type task);
+
+        /// Calls fn for every index in [0, count), splitting the range into
+        /// contiguous chunks executed by the workers and the calling
+        /// thread. Blocks until every call has returned.
+        /// \param count number of indices.
+        /// \param fn function to call with each index.
+        void parallel_for(size_t count, const std::function<void(size_t)>& fn);
+
+        /// Blocks until the queue is empty and no worker is running a task.
+        void wait_idle();
+
+        /// Returns the number of worker threads.
+        /// \return worker count.
+        [[nodiscard]] auto size() const -> size_t;
+
+        /// Returns the number of tasks waiting for a worker.
+        /// \return queue depth.
+        [[nodiscard]] auto queue_depth() const -> size_t;
+
+        /// Returns the number of workers currently running a task.
+        /// \return busy worker count.
+        [[nodiscard]] auto busy() const -> size_t;
+
+      private:
+        size_t m_max_queued;
+        std::deque<task_type> m_tasks;
+        size_t m_busy{0};
+        bool m_stop{false};
+        mutable std::mutex m_mut;
+        std::condition_variable m_task_cv;
+        std::condition_variable m_space_cv;
+        std::condition_variable m_idle_cv;
+
+        std::vector<std::thread> m_workers;
+
+        void worker();
+    };
+}
+
+#endif // OPENCBDC_TX_SRC_COMMON_THREAD_POOL_H_
@@ -0,0 +1,136 @@
+// Copyright (c) 2021 MIT Digital Currency Initiative,
+//                    Federal Reserve Bank of Boston
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef OPENCBDC_TX_SRC_COMMON_TIMING_WHEEL_H_
+#define OPENCBDC_TX_SRC_COMMON_TIMING_WHEEL_H_
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace cbdc {
+    /// \brief Hashed timing wheel for scheduling many deadlines.
+    ///
+    /// Rounds deadlines up to a whole number of ticks and hashes each onto
+    /// one of a fixed number of slots, so scheduling a deadline is O(1) and
+    /// advancing the wheel only visits the slots for the elapsed ticks.
+    /// Deadlines further away than one revolution of the wheel share a slot
+    /// with nearer ones and are kept until their tick comes around.
+    ///
+    /// Scheduled keys cannot be cancelled. Callers which complete work
+    /// before its deadline should ignore the key when it expires. Not
+    /// thread-safe.
+    /// \tparam K type of key identifying each deadline.
+    template<typename K>
+    class timing_wheel {
+      public:
+        /// Clock used for deadlines.
+        using clock_type = std::chrono::steady_clock;
+
+        /// Constructor.
+        /// \param tick granularity of deadlines.
+        /// \param n_slots number of slots. Ideally the longest expected
+        ///                timeout divided by the tick.
+        /// \param start time of the first tick.
+        timing_wheel(clock_type::duration tick,
+                     size_t n_slots,
+                     clock_type::time_point start = clock_type::now())
+            : m_tick(tick),
+              m_slots(n_slots),
+              m_start(start) {
+            assert(m_tick.count() > 0);
+            assert(!m_slots.empty());
+        }
+
+        /// Schedules a key to expire at the given time. Deadlines before
+        /// the next tick expire on the next call to \ref advance which
+        /// reaches the next tick.
+        /// \param key key to return when the deadline passes.
+        /// \param deadline time after which the key expires.
+        void schedule(const K& key, clock_type::time_point deadline) {
+            // Round up so keys never expire early.
+            auto t = m_current + 1;
+            if(deadline > m_start) {
+                t = std::max(t,
+                             static_cast<uint64_t>((deadline - m_start
+                                                    + m_tick - tick_unit)
+                                                   / m_tick));
+            }
+            m_slots[t % m_slots.size()].push_back({key, t});
+            m_size++;
+        }
+
+        /// Advances the wheel to the given time and returns the keys whose
+        /// deadlines have passed.
+        /// \param now current time.
+        /// \return expired keys, in no particular order.
+        auto advance(clock_type::time_point now) -> std::vector<K> {
+            auto ret = std::vector<K>();
+            if(now < m_start) {
+                return ret;
+            }
+            const auto target
+                = static_cast<uint64_t>((now - m_start) / m_tick);
+            if(target <= m_current) {
+                return ret;
+            }
+            // Every slot needs visiting at most once, however many ticks
+            // elapsed.
+            const auto steps = std::min(target - m_current,
+                                        static_cast<uint64_t>(m_slots.size()));
+            for(uint64_t i{1}; i <= steps; i++) {
+                auto& slot = m_slots[(m_current + i) % m_slots.size()];
+                auto it = std::partition(slot.begin(),
+                                         slot.end(),
+                                         [&](const entry& e) {
+                                             return e.m_tick > target;
+                                         });
+                for(auto e = it; e != slot.end(); e++) {
+                    ret.push_back(e->m_key);
+                }
+                m_size -= static_cast<size_t>(slot.end() - it);
+                slot.erase(it, slot.end());
+            }
+            m_current = target;
+            return ret;
+        }
+
+        /// Returns the number of keys scheduled and not yet expired.
+        /// \return key count.
+        [[nodiscard]] auto size() const -> size_t {
+            return m_size;
+        }
+
+        /// Indicates whether no keys are scheduled.
+        /// \return true if the wheel is empty.
+        [[nodiscard]] auto empty() const -> bool {
+            return m_size == 0;
+        }
+
+        /// Returns the granularity of deadlines.
+        /// \return tick duration.
+        [[nodiscard]] auto tick() const -> clock_type::duration {
+            return m_tick;
+        }
+
+      private:
+        static constexpr auto tick_unit = clock_type::duration(1);
+
+        struct entry {
+            K m_key;
+            uint64_t m_tick;
+        };
+
+        clock_type::duration m_tick;
+        std::vector<std::vector<entry>> m_slots;
+        clock_type::time_point m_start;
+        uint64_t m_current{0};
+        size_t m_size{0};
+    };
+}
+
+#endif // OPENCBDC_TX_SRC_COMMON_TIMING_WHEEL_H_
@@ -5,9 +5,31 @@
 
 #include "connection_manager.hpp"
 
+#include "util/common/blocking_queue.hpp"
+
+#include <cerrno>
+#include <sys/epoll.h>
+
 namespace cbdc::network {
+    connection_manager::connection_manager(size_t io_threads) {
+        [[maybe_unused]] const auto started = m_reactor.start(io_threads);
+        assert(started);
+        m_maintenance_thread = std::thread([&]() {
+            maintain_peers();
+        });
+    }
+
     connection_manager::~connection_manager() {
         close();
+        {
+            std::lock_guard<std::mutex> l(m_maintenance_mut);
+            m_maintenance_stop = true;
+        }
+        m_maintenance_cv.notify_one();
+        if(m_maintenance_thread.joinable()) {
+            m_maintenance_thread.join();
+        }
+        m_reactor.stop();
     }
 
     auto connection_manager::listen(const ip_address& host,
@@ -15,35 +37,64 @@ namespace cbdc::network {
         if(!m_listener.listen(host, port)) {
             return false;
         }
-        if(!m_listen_selector.init()) {
+        if(!m_listener.set_blocking(false)) {
             return false;
         }
-        return m_listen_selector.add(m_listener);
+        m_listener_registration
+            = m_reactor.add(m_listener, EPOLLIN, [&](uint32_t /* events */) {
+                  accept_connections();
+              });
+        return m_listener_registration.has_value();
     }
 
     auto connection_manager::pump() -> bool {
+        std::unique_lock<std::mutex> l(m_listen_mut);
+        m_listen_cv.wait(l, [&]() {
+            return !m_running || m_listen_failed;
+        });
+        return !m_listen_failed;
+    }
+
+    void connection_manager::accept_connections() {
         while(m_running) {
-            if(!m_listen_selector.wait()) {
-                continue;
-            }
             auto sock = std::make_unique<tcp_socket>();
             if(m_listener.accept(*sock)) {
                 add(std::move(sock), false);
-            } else {
-                return false;
+                continue;
+            }
+            if(errno == EAGAIN || errno == EWOULDBLOCK) {
+                return;
+            }
+            if(errno == EINTR || errno == ECONNABORTED) {
+                continue;
             }
+            {
+                std::lock_guard<std::mutex> l(m_listen_mut);
+                m_listen_failed = true;
+            }
+            m_listen_cv.notify_all();
+            return;
         }
-
-        return true;
     }
 
-    void connection_manager::broadcast(const std::shared_ptr<buffer>& data) {
+    auto connection_manager::broadcast(const std::shared_ptr<buffer>& data)
+        -> size_t {
+        // Send outside the lock, as sends may block on a full queue.
+        auto peers = std::vector<std::shared_ptr<peer>>();
         {
             std::shared_lock<std::shared_mutex> l(m_peer_mutex);
-            for(const auto& peer : m_peers) {
-                peer.m_peer->send(data);
+            peers.reserve(m_peers.size());
+            for(const auto& p : m_peers) {
+                peers.push_back(p.m_peer);
             }
         }
+        size_t sent{0};
+        for(const auto& p : peers) {
+            if(p->send(data)) {
+                sent++;
+            }
+        }
+        return sent;
     }
 
     auto connection_manager::handle_messages() -> std::vector<message_t> {
@@ -99,9 +150,15 @@ namespace cbdc::network {
 
         {
             std::unique_lock<std::shared_mutex> l(m_peer_mutex);
-            auto p = std::make_unique<peer>(std::move(sock),
-                                            recv_cb,
-                                            attempt_reconnect);
+            auto p = std::make_unique<peer>(
+                std::move(sock),
+                m_reactor,
+                recv_cb,
+                [&]() {
+                    signal_maintenance();
+                },
+                attempt_reconnect,
+                m_send_limits);
             if(m_running) {
                 m_peers.emplace_back(std::move(p), peer_id);
             }
@@ -127,24 +184,26 @@ namespace cbdc::network {
 
     auto connection_manager::start_cluster_handler(
         const std::vector<endpoint_t>& endpoints,
-        const packet_handler_t& handler) -> std::optional<std::thread> {
+        const packet_handler_t& handler,
+        size_t n_workers) -> std::optional<std::thread> {
         if(!cluster_connect(endpoints)) {
             return std::nullopt;
         }
 
-        return start_handler(handler);
+        return start_handler(handler, n_workers);
     }
 
     auto connection_manager::start_server(const endpoint_t& listen_endpoint,
-                                          const packet_handler_t& handler)
+                                          const packet_handler_t& handler,
+                                          size_t n_workers)
         -> std::optional<std::thread> {
         if(!listen(listen_endpoint.first, listen_endpoint.second)) {
             return std::nullopt;
         }
 
-        return std::thread{[this, handler]() {
+        return std::thread{[this, handler, n_workers]() {
             auto l_thread = start_server_listener();
-            auto h_thread = start_handler(handler);
+            auto h_thread = start_handler(handler, n_workers);
             h_thread.join();
             l_thread.join();
         }};
@@ -158,33 +217,77 @@ namespace cbdc::network {
         }};
     }
 
-    auto connection_manager::start_handler(const packet_handler_t& handler)
-        -> std::thread {
-        return std::thread{[this, handler]() {
-            while(m_running) {
-                auto pkts = handle_messages();
-
-                for(auto&& pkt : pkts) {
-                    if(!pkt.m_pkt) {
-                        continue;
+    auto connection_manager::start_handler(const packet_handler_t& handler,
+                                           size_t n_workers) -> std::thread {
+        return std::thread{[this, handler, n_workers]() {
+            if(n_workers <= 1) {
+                while(m_running) {
+                    auto pkts = handle_messages();
+                    for(auto&& pkt : pkts) {
+                        handle_packet(handler, std::move(pkt));
                     }
+                }
+                return;
+            }
 
-                    auto pid = pkt.m_peer_id;
-                    auto res = handler(std::move(pkt));
-
-                    if(res.has_value()) {
-                        send(std::make_shared<buffer>(std::move(res.value())),
-                             pid);
+            using queue_type = blocking_queue<message_t>;
+            auto queues = std::vector<std::unique_ptr<queue_type>>();
+            auto workers = std::vector<std::thread>();
+            for(size_t i = 0; i < n_workers; i++) {
+                auto* q = queues.emplace_back(std::make_unique<queue_type>())
+                              .get();
+                workers.emplace_back([this, &handler, q]() {
+                    auto pkt = message_t();
+                    while(q->pop(pkt)) {
+                        handle_packet(handler, std::move(pkt));
                     }
+                });
+            }
+
+            // Packets from a peer always go to the same worker, so each
+            // peer's packets are handled in the order they were received.
+            while(m_running) {
+                auto pkts = handle_messages();
+                for(auto&& pkt : pkts) {
+                    queues[pkt.m_peer_id % n_workers]->push(pkt);
                 }
             }
+
+            for(auto& q : queues) {
+                q->clear();
+            }
+            for(auto& w : workers) {
+                w.join();
+            }
         }};
     }
 
+    void connection_manager::handle_packet(const packet_handler_t& handler,
+                                           message_t&& pkt) {
+        if(!pkt.m_pkt) {
+            return;
+        }
+
+        auto pid = pkt.m_peer_id;
+        auto res = handler(std::move(pkt));
+
+        if(res.has_value()) {
+            send(share_buffer(std::move(res.value())), pid);
+        }
+    }
+
     void connection_manager::close() {
         m_running = false;
-        m_listen_selector.unblock();
+        if(m_listener_registration) {
+            m_reactor.remove(*m_listener_registration);
+            m_listener_registration.reset();
+        }
         m_listener.close();
+        {
+            // Synchronize with pump() so it cannot miss the notification.
+            std::lock_guard<std::mutex> l(m_listen_mut);
+        }
+        m_listen_cv.notify_all();
         {
             std::shared_lock<std::shared_mutex> l(m_peer_mutex);
             for(auto&& peer : m_peers) {
@@ -198,8 +301,8 @@ namespace cbdc::network {
         m_async_recv_cv.notify_all();
     }
 
-    void connection_manager::send(const std::shared_ptr<buffer>& data,
-                                  peer_id_t peer_id) {
+    auto connection_manager::send(const std::shared_ptr<buffer>& data,
+                                  peer_id_t peer_id) -> bool {
         std::shared_ptr<peer> peer;
         {
             std::shared_lock<std::shared_mutex> l(m_peer_mutex);
@@ -211,9 +314,7 @@ namespace cbdc::network {
             }
         }
 
-        if(peer) {
-            peer->send(data);
-        }
+        return peer && peer->send(data);
     }
 
     auto connection_manager::peer_count() -> size_t {
@@ -226,6 +327,10 @@ namespace cbdc::network {
         assert(!m_running);
         m_running = true;
         m_next_peer_id = 0;
+        {
+            std::lock_guard<std::mutex> l(m_listen_mut);
+            m_listen_failed = false;
+        }
         {
             std::lock_guard<std::mutex> l(m_async_recv_mut);
             m_async_recv_queues.clear();
@@ -235,7 +340,7 @@ namespace cbdc::network {
 
     auto connection_manager::send_to_one(const std::shared_ptr<buffer>& data)
         -> bool {
-        bool sent{false};
+        std::shared_ptr<peer> peer;
         {
             std::shared_lock<std::shared_mutex> l(m_peer_mutex);
             // Start at a random place in the peers vector to balance load
@@ -247,13 +352,46 @@ namespace cbdc::network {
                 auto idx = (i + offset) % m_peers.size();
                 const auto& p = m_peers[idx];
                 if(p.m_peer->connected()) {
-                    p.m_peer->send(data);
-                    sent = true;
+                    peer = p.m_peer;
                     break;
                 }
             }
         }
-        return sent;
+        // Send outside the lock, as the send may block on a full queue.
+        return peer && peer->send(data);
+    }
+
+    void connection_manager::set_send_queue_limits(send_queue_limits limits) {
+        std::unique_lock<std::shared_mutex> l(m_peer_mutex);
+        m_send_limits = limits;
+        for(const auto& p : m_peers) {
+            p.m_peer->set_send_queue_limits(limits);
+        }
+    }
+
+    auto connection_manager::get_send_queue_stats(peer_id_t peer_id)
+        -> std::optional<send_queue_stats> {
+        std::shared_lock<std::shared_mutex> l(m_peer_mutex);
+        for(const auto& p : m_peers) {
+            if(p.m_peer_id == peer_id) {
+                return p.m_peer->get_send_queue_stats();
+            }
+        }
+        return std::nullopt;
+    }
+
+    auto connection_manager::get_send_queue_stats() -> send_queue_stats {
+        auto ret = send_queue_stats();
+        std::shared_lock<std::shared_mutex> l(m_peer_mutex);
+        for(const auto& p : m_peers) {
+            const auto s = p.m_peer->get_send_queue_stats();
+            ret.m_messages += s.m_messages;
+            ret.m_bytes += s.m_bytes;
+            ret.m_dropped += s.m_dropped;
+            ret.m_blocked += s.m_blocked;
+            ret.m_disconnects += s.m_disconnects;
+        }
+        return ret;
     }
 
     connection_manager::m_peer_t::m_peer_t(std::unique_ptr<peer> peer,
@@ -284,4 +422,39 @@ namespace cbdc::network {
         }
         return false;
     }
+
+    void connection_manager::signal_maintenance() {
+        {
+            std::lock_guard<std::mutex> l(m_maintenance_mut);
+            m_maintenance_pending = true;
+        }
+        m_maintenance_cv.notify_one();
+    }
+
+    void connection_manager::maintain_peers() {
+        static constexpr auto retry_delay = std::chrono::seconds(3);
+        while(true) {
+            {
+                std::unique_lock<std::mutex> l(m_maintenance_mut);
+                m_maintenance_cv.wait_for(l, retry_delay, [&]() {
+                    return m_maintenance_pending || m_maintenance_stop;
+                });
+                if(m_maintenance_stop) {
+                    return;
+                }
+                m_maintenance_pending = false;
+            }
+
+            auto peers = std::vector<std::shared_ptr<peer>>();
+            {
+                std::shared_lock<std::shared_mutex> l(m_peer_mutex);
+                for(const auto& p : m_peers) {
+                    peers.push_back(p.m_peer);
+                }
+            }
+            for(const auto& p : peers) {
+                p->maintain();
+            }
+        }
+    }
 }
@@ -7,7 +7,7 @@
 #define OPENCBDC_TX_SRC_NETWORK_CONNECTION_MANAGER_H_
 
 #include "peer.hpp"
-#include "socket_selector.hpp"
+#include "reactor.hpp"
 #include "tcp_listener.hpp"
 #include "tcp_socket.hpp"
 #include "util/common/config.hpp"
@@ -50,9 +50,18 @@ namespace cbdc::network {
     /// incoming connections on a TCP socket, connecting to outgoing peers,
     /// and passing incoming packets to a handler callback. Supports sending a
     /// packet to a specific peer, or broadcasting a packet to all peers.
+    ///
+    /// All sockets are serviced by a \ref reactor with a fixed number of
+    /// I/O threads, and one further thread reconnects disconnected peers, so
+    /// the number of threads does not depend on the number of peers.
     class connection_manager {
       public:
-        connection_manager() = default;
+        /// Default number of reactor I/O threads.
+        static constexpr size_t default_io_threads = 2;
+
+        /// Constructor. Starts the reactor and peer maintenance threads.
+        /// \param io_threads number of reactor I/O threads.
+        explicit connection_manager(size_t io_threads = default_io_threads);
 
         connection_manager(const connection_manager&) = delete;
         auto operator=(const connection_manager&)
@@ -71,21 +80,27 @@ namespace cbdc::network {
         [[nodiscard]] auto listen(const ip_address& host, unsigned short port)
             -> bool;
 
-        /// Listens for and accepts inbound connections.
+        /// Blocks while the reactor accepts inbound connections.
         /// \return true on a clean shutdown. False upon a socket accept failure.
         [[nodiscard]] auto pump() -> bool;
 
         /// Sends the provided data to all added peers.
         /// \param data packet to to send.
+        /// \return number of peers which queued the packet. Less than
+        ///         \ref peer_count if a peer's send queue was full or the peer
+        ///         was disconnected.
         /// \see connection_manager::add
-        void broadcast(const std::shared_ptr<buffer>& data);
+        auto broadcast(const std::shared_ptr<buffer>& data) -> size_t;
 
         /// Serialize the data and broadcast it to all peers. Wraps
         /// connection_manager::broadcast.
         /// \param data data to serialize and send.
+        /// \param fmt wire format of lengths, indices and heights.
+        /// \return number of peers which queued the packet.
         template<typename Ta>
-        void broadcast(const Ta& data) {
-            auto pkt = make_shared_buffer(data);
+        auto broadcast(const Ta& data, wire_format fmt = wire_format::fixed)
+            -> size_t {
+            auto pkt = make_shared_buffer(data, fmt);
             return broadcast(pkt);
         }
 
@@ -114,24 +129,30 @@ namespace cbdc::network {
         /// for packets received from those endpoints.
         /// \param endpoints set of server endpoints to which to establish TCP socket connections.
         /// \param handler function to handle packets from server connections.
+        /// \param n_workers number of threads calling the handler.
+        ///                  \see start_handler.
         /// \return the thread on which the handler will be called, or nullopt if any client connection fails. May be joined by callers.
         /// \note Calling this method and start_server on the same connection_manager
         ///       instance will result in two handler threads.
         [[nodiscard]] auto
         start_cluster_handler(const std::vector<endpoint_t>& endpoints,
-                              const packet_handler_t& handler)
+                              const packet_handler_t& handler,
+                              size_t n_workers = 1)
             -> std::optional<std::thread>;
 
         /// Establishes a server at the specified endpoint which handles
         /// inbound traffic with the specified handler function.
         /// \param listen_endpoint the endpoint at which to start the server.
         /// \param handler function to handle packets from client connections.
+        /// \param n_workers number of threads calling the handler.
+        ///                  \see start_handler.
         /// \return the thread on which the handler will be called, or nullopt if the server fails to start. May be joined by callers.
         /// \note Calling this method and start_cluster_handler on the same
         ///       connection_manager instance will result in two handler
         ///       threads.
         [[nodiscard]] auto start_server(const endpoint_t& listen_endpoint,
-                                        const packet_handler_t& handler)
+                                        const packet_handler_t& handler,
+                                        size_t n_workers = 1)
             -> std::optional<std::thread>;
 
         /// Launches a thread that listens for and accepts inbound connections.
@@ -141,10 +162,22 @@ namespace cbdc::network {
 
         /// Starts a thread to handle messages from established connections
         /// using the specified handler function.
+        ///
+        /// With more than one worker, the returned thread dispatches each
+        /// packet to a worker chosen by the ID of the peer which sent it.
+        /// Packets from the same peer are therefore handled one at a time,
+        /// in the order they were received, while packets from different
+        /// peers are handled concurrently. The handler must then be safe to
+        /// call from several threads at once. Responses are sent to the
+        /// peer which sent the packet, as with a single worker.
         /// \param handler function to handle packets from client connections.
-        /// \return the thread on which the handler will be called.
-        [[nodiscard]] auto start_handler(const packet_handler_t& handler)
-            -> std::thread;
+        /// \param n_workers number of threads calling the handler. With one
+        ///                  worker, the returned thread calls the handler
+        ///                  itself.
+        /// \return the thread which receives packets. Joins the workers
+        ///         before exiting.
+        [[nodiscard]] auto start_handler(const packet_handler_t& handler,
+                                         size_t n_workers = 1) -> std::thread;
 
         /// Shuts down the network listener and all existing peer connections.
         void close();
@@ -152,15 +185,21 @@ namespace cbdc::network {
         /// Sends the provided data to the specified peer. Conducts an O(n)
         /// search for the target peer. \param data data packet to send.
         /// \param peer_id ID of the peer to whom to send data.
-        void send(const std::shared_ptr<buffer>& data, peer_id_t peer_id);
+        /// \return true if the peer queued the packet.
+        auto send(const std::shared_ptr<buffer>& data, peer_id_t peer_id)
+            -> bool;
 
         /// Serialize the data and transmit it in a packet to the remote host
         /// at the specified peer ID.
         /// \param data data to serialize and send.
         /// \param peer_id ID of the peer to whom to send data.
+        /// \param fmt wire format of lengths, indices and heights.
+        /// \return true if the peer queued the packet.
         template<typename Ta>
-        void send(const Ta& data, peer_id_t peer_id) {
-            auto pkt = make_shared_buffer(data);
+        auto send(const Ta& data,
+                  peer_id_t peer_id,
+                  wire_format fmt = wire_format::fixed) -> bool {
+            auto pkt = make_shared_buffer(data, fmt);
             return send(pkt, peer_id);
         }
 
@@ -182,13 +221,30 @@ namespace cbdc::network {
         /// Serialize and send the provided data to an online peer managed by
         /// this network. Wraps connection_manager::send_to_one.
         /// \param data serializable object to send.
+        /// \param fmt wire format of lengths, indices and heights.
         /// \return flag to indicate whether the packet was sent to a peer.
         template<typename T>
-        [[nodiscard]] auto send_to_one(const T& data) -> bool {
-            auto pkt = make_shared_buffer(data);
+        [[nodiscard]] auto send_to_one(const T& data,
+                                       wire_format fmt = wire_format::fixed)
+            -> bool {
+            auto pkt = make_shared_buffer(data, fmt);
             return send_to_one(pkt);
         }
 
+        /// Sets the send queue limits of existing and future peers.
+        /// \param limits limits on each peer's send queue.
+        void set_send_queue_limits(send_queue_limits limits);
+
+        /// Returns the send queue statistics of the given peer.
+        /// \param peer_id the peer to check.
+        /// \return statistics, or std::nullopt if there is no such peer.
+        [[nodiscard]] auto get_send_queue_stats(peer_id_t peer_id)
+            -> std::optional<send_queue_stats>;
+
+        /// Returns the send queue statistics summed over all peers.
+        /// \return total statistics.
+        [[nodiscard]] auto get_send_queue_stats() -> send_queue_stats;
+
         /// Determines whether the given peer ID is connected
         /// \param peer_id the peer to check
         /// \return true if the peer is connected, otherwise false
@@ -199,7 +255,13 @@ namespace cbdc::network {
         [[nodiscard]] auto connected_to_one() -> bool;
 
       private:
+        reactor m_reactor;
+
         tcp_listener m_listener;
+        std::optional<reactor::registration_id> m_listener_registration;
+        std::mutex m_listen_mut;
+        std::condition_variable m_listen_cv;
+        bool m_listen_failed{false};
 
         struct m_peer_t {
             m_peer_t() = delete;
@@ -221,6 +283,7 @@ namespace cbdc::network {
         std::atomic<peer_id_t> m_next_peer_id{0};
 
         std::shared_mutex m_peer_mutex;
+        send_queue_limits m_send_limits;
 
         std::atomic_bool m_running{true};
 
@@ -229,10 +292,22 @@ namespace cbdc::network {
         std::vector<std::queue<message_t>> m_async_recv_queues;
         bool m_async_recv_data{false};
 
-        socket_selector m_listen_selector;
+        std::thread m_maintenance_thread;
+        std::mutex m_maintenance_mut;
+        std::condition_variable m_maintenance_cv;
+        bool m_maintenance_pending{false};
+        bool m_maintenance_stop{false};
 
         std::random_device m_r{cbdc::config::random_source};
         std::default_random_engine m_rnd{m_r()};
+
+        void accept_connections();
+
+        void handle_packet(const packet_handler_t& handler, message_t&& pkt);
+
+        void signal_maintenance();
+
+        void maintain_peers();
     };
 }
 
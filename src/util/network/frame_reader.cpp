@@ -0,0 +1,86 @@
+// Copyright (c) 2021 MIT Digital Currency Initiative,
+//                    Federal Reserve Bank of Boston
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "frame_reader.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace cbdc::network {
+    frame_reader::frame_reader(size_t chunk_size)
+        : m_chunk_size(chunk_size) {}
+
+    void frame_reader::reset() {
+        m_begin = 0;
+        m_end = 0;
+        m_have_size = false;
+        m_pkt.clear();
+        m_pkt_read = 0;
+        m_direct = false;
+    }
+
+    auto frame_reader::next_packet(buffer& pkt) -> bool {
+        if(!m_have_size) {
+            uint64_t pkt_sz{};
+            if(m_end - m_begin < sizeof(pkt_sz)) {
+                return false;
+            }
+            std::memcpy(&pkt_sz, m_chunk.data() + m_begin, sizeof(pkt_sz));
+            m_begin += sizeof(pkt_sz);
+            m_have_size = true;
+            m_pkt.clear();
+            m_pkt.extend(static_cast<size_t>(pkt_sz));
+            m_pkt_read = 0;
+        }
+
+        const auto n = std::min(m_end - m_begin, m_pkt.size() - m_pkt_read);
+        if(n > 0) {
+            std::memcpy(m_pkt.data_at(m_pkt_read),
+                        m_chunk.data() + m_begin,
+                        n);
+            m_begin += n;
+            m_pkt_read += n;
+        }
+        if(m_pkt_read < m_pkt.size()) {
+            return false;
+        }
+
+        pkt = std::move(m_pkt);
+        m_pkt = buffer();
+        m_have_size = false;
+        return true;
+    }
+
+    auto frame_reader::read_target() -> std::pair<void*, size_t> {
+        // next_packet() consumed the whole chunk if a packet is in
+        // progress, so the rest of a large packet can bypass the chunk.
+        const auto remaining = m_pkt.size() - m_pkt_read;
+        m_direct = m_have_size && remaining >= m_chunk_size;
+        if(m_direct) {
+            return {m_pkt.data_at(m_pkt_read), remaining};
+        }
+
+        if(m_chunk.empty()) {
+            m_chunk.resize(m_chunk_size);
+        }
+        // Move any partial size prefix to the start of the chunk.
+        if(m_begin != 0) {
+            std::memmove(m_chunk.data(),
+                         m_chunk.data() + m_begin,
+                         m_end - m_begin);
+            m_end -= m_begin;
+            m_begin = 0;
+        }
+        return {m_chunk.data() + m_end, m_chunk.size() - m_end};
+    }
+
+    void frame_reader::commit(size_t n) {
+        if(m_direct) {
+            m_pkt_read += n;
+        } else {
+            m_end += n;
+        }
+    }
+}
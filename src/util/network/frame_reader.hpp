@@ -0,0 +1,89 @@
+// Copyright (c) 2021 MIT Digital Currency Initiative,
+//                    Federal Reserve Bank of Boston
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef OPENCBDC_TX_SRC_NETWORK_FRAME_READER_H_
+#define OPENCBDC_TX_SRC_NETWORK_FRAME_READER_H_
+
+#include "util/common/buffer.hpp"
+
+#include <cstddef>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace cbdc::network {
+    /// \brief Splits a byte stream into size-prefixed packets.
+    ///
+    /// Reads from the stream in chunks, so a single read can return
+    /// several small packets, and keeps any bytes past the end of a packet
+    /// for the next call. Packets at least as large as the chunk size are
+    /// read directly into the packet buffer once their size prefix is
+    /// known, so large packets are not copied.
+    /// \see tcp_socket for the packet format.
+    class frame_reader {
+      public:
+        /// Default number of bytes to request per read.
+        static constexpr size_t default_chunk_size = 64 * 1024;
+
+        /// Outcome of \ref read.
+        enum class result {
+            /// A complete packet was returned.
+            packet,
+            /// The stream has no more data available without blocking.
+            would_block,
+            /// The stream closed or failed.
+            closed
+        };
+
+        /// Constructor. Allocates the chunk buffer on the first read.
+        /// \param chunk_size number of bytes to request per read.
+        explicit frame_reader(size_t chunk_size = default_chunk_size);
+
+        /// Returns the next packet in the stream, reading more bytes from
+        /// the stream as necessary. Partially-read packets are kept until
+        /// the next call.
+        /// \param read_some function with the signature of
+        ///                  \ref tcp_socket::read_some used to read bytes
+        ///                  from the stream.
+        /// \param pkt buffer to move the packet into.
+        /// \return result::packet if pkt holds a new packet.
+        template<typename Read>
+        auto read(Read&& read_some, buffer& pkt) -> result {
+            while(!next_packet(pkt)) {
+                auto [dest, len] = read_target();
+                const std::optional<size_t> n = read_some(dest, len);
+                if(!n) {
+                    return result::closed;
+                }
+                if(*n == 0) {
+                    return result::would_block;
+                }
+                commit(*n);
+            }
+            return result::packet;
+        }
+
+        /// Discards any buffered bytes and partially-read packet, for
+        /// example after reconnecting the stream.
+        void reset();
+
+      private:
+        size_t m_chunk_size;
+        std::vector<std::byte> m_chunk;
+        size_t m_begin{0};
+        size_t m_end{0};
+
+        bool m_have_size{false};
+        buffer m_pkt;
+        size_t m_pkt_read{0};
+        bool m_direct{false};
+
+        auto next_packet(buffer& pkt) -> bool;
+        auto read_target() -> std::pair<void*, size_t>;
+        void commit(size_t n);
+    };
+}
+
+#endif
@@ -5,134 +5,350 @@
 
 #include "peer.hpp"
 
-#include <cassert>
+#include <algorithm>
+#include <array>
+#include <sys/epoll.h>
 #include <utility>
 
 namespace cbdc::network {
     peer::peer(std::unique_ptr<tcp_socket> sock,
+               reactor& r,
                peer::callback_type cb,
-               bool attempt_reconnect)
+               peer::disconnect_callback_type disconnect_cb,
+               bool attempt_reconnect,
+               send_queue_limits limits)
         : m_sock(std::move(sock)),
+          m_reactor(r),
+          m_send_limits(limits),
           m_attempt_reconnect(attempt_reconnect),
-          m_recv_cb(std::move(cb)) {
-        do_send();
-        do_recv();
-        do_reconnect();
+          m_recv_cb(std::move(cb)),
+          m_disconnect_cb(std::move(disconnect_cb)) {
+        std::unique_lock<std::mutex> l(m_state_mut);
+        if(!start()) {
+            m_disconnect_cb();
+        }
     }
 
     peer::~peer() {
         shutdown();
     }
 
-    void peer::send(const std::shared_ptr<cbdc::buffer>& data) {
-        if(!m_shut_down) {
-            m_send_queue.push(data);
+    auto peer::send(const std::shared_ptr<cbdc::buffer>& data) -> bool {
+        if(m_shut_down || !data) {
+            return false;
+        }
+        std::unique_lock<std::mutex> l(m_send_mut);
+        if(!enqueue(data, l)) {
+            return false;
+        }
+        if(!m_sending && !m_send_blocked && m_running) {
+            flush(l);
+        }
+        return true;
+    }
+
+    void peer::set_send_queue_limits(send_queue_limits limits) {
+        {
+            std::unique_lock<std::mutex> l(m_send_mut);
+            m_send_limits = limits;
+        }
+        m_send_cv.notify_all();
+    }
+
+    auto peer::get_send_queue_stats() -> send_queue_stats {
+        std::unique_lock<std::mutex> l(m_send_mut);
+        return m_send_stats;
+    }
+
+    auto peer::has_room(size_t len) const -> bool {
+        if(m_send_limits.m_max_messages != 0
+           && m_send_stats.m_messages >= m_send_limits.m_max_messages) {
+            return false;
+        }
+        return m_send_limits.m_max_bytes == 0 || m_send_stats.m_messages == 0
+            || m_send_stats.m_bytes + len <= m_send_limits.m_max_bytes;
+    }
+
+    auto peer::enqueue(const std::shared_ptr<cbdc::buffer>& data,
+                       std::unique_lock<std::mutex>& l) -> bool {
+        const auto len = data->size();
+        if(!has_room(len)) {
+            if(!m_running) {
+                m_send_stats.m_dropped++;
+                return false;
+            }
+            switch(m_send_limits.m_policy) {
+                case overflow_policy::block:
+                    m_send_stats.m_blocked++;
+                    m_send_cv.wait(l, [&]() {
+                        return has_room(len) || !m_running || m_shut_down;
+                    });
+                    if(!has_room(len)) {
+                        m_send_stats.m_dropped++;
+                        return false;
+                    }
+                    break;
+                case overflow_policy::drop_oldest: {
+                    // Keep the packets being written, and the front packet
+                    // if it is partially written.
+                    auto keep = std::max(m_send_in_flight,
+                                         m_send_offset > 0 ? size_t{1}
+                                                           : size_t{0});
+                    while(!has_room(len) && m_send_queue.size() > keep) {
+                        const auto it = m_send_queue.begin()
+                                      + static_cast<std::ptrdiff_t>(keep);
+                        m_send_stats.m_bytes -= (*it)->size();
+                        m_send_stats.m_messages--;
+                        m_send_stats.m_dropped++;
+                        m_send_queue.erase(it);
+                    }
+                    break;
+                }
+                case overflow_policy::disconnect:
+                    m_send_stats.m_disconnects++;
+                    m_send_stats.m_dropped++;
+                    l.unlock();
+                    signal_disconnect();
+                    l.lock();
+                    return false;
+            }
         }
+        m_send_queue.push_back(data);
+        m_send_stats.m_messages++;
+        m_send_stats.m_bytes += len;
+        return true;
+    }
+
+    void peer::pop_send_queue() {
+        m_send_stats.m_bytes -= m_send_queue.front()->size();
+        m_send_stats.m_messages--;
+        m_send_queue.pop_front();
     }
 
     void peer::shutdown() {
         m_shut_down = true;
-        m_reconnect_cv.notify_one();
-        if(m_reconnect_thread.joinable()) {
-            m_reconnect_thread.join();
+        std::unique_lock<std::mutex> l(m_state_mut);
+        close();
+    }
+
+    void peer::maintain() {
+        std::unique_lock<std::mutex> l(m_state_mut);
+        if(m_shut_down || m_running) {
+            return;
         }
         close();
+        if(!m_attempt_reconnect) {
+            m_shut_down = true;
+            return;
+        }
+        if(m_sock->reconnect()) {
+            start();
+        }
     }
 
     auto peer::connected() const -> bool {
         return !m_shut_down && m_running && m_sock->connected();
     }
 
-    void peer::do_send() {
-        m_send_thread = std::thread([&]() {
-            while(m_running) {
-                std::shared_ptr<cbdc::buffer> pkt;
-                if(!m_send_queue.pop(pkt)) {
-                    assert(!m_running);
-                    break;
-                }
+    auto peer::start() -> bool {
+        if(!m_sock->set_blocking(false)) {
+            return false;
+        }
+        // The send queue is written in batches, so Nagle's algorithm would
+        // only delay the last packet of each batch until the previous batch
+        // is acknowledged. The option is not required for correctness.
+        m_sock->set_nodelay(true);
+        m_running = true;
+        m_registration = m_reactor.add(*m_sock,
+                                       EPOLLIN | EPOLLOUT | EPOLLRDHUP,
+                                       [&](uint32_t events) {
+                                           handle_events(events);
+                                       });
+        if(!m_registration) {
+            m_running = false;
+            return false;
+        }
+        return true;
+    }
 
-                if(pkt) {
-                    const auto result = m_sock->send(*pkt);
-                    if(!result) {
-                        signal_reconnect();
-                        return;
-                    }
-                }
-            }
-        });
+    void peer::close() {
+        m_running = false;
+        if(m_registration) {
+            m_reactor.remove(*m_registration);
+            m_registration.reset();
+        }
+        {
+            // Wait for any thread writing the queue to finish with the
+            // socket and the queued packets.
+            std::unique_lock<std::mutex> l(m_send_mut);
+            m_send_cv.wait(l, [&]() {
+                return !m_sending;
+            });
+            m_send_queue.clear();
+            m_send_stats.m_messages = 0;
+            m_send_stats.m_bytes = 0;
+            m_send_offset = 0;
+            m_send_blocked = false;
+            m_send_writable = false;
+        }
+        // Wake senders blocked on a full queue.
+        m_send_cv.notify_all();
+        m_sock->disconnect();
+        {
+            std::unique_lock<std::mutex> l(m_recv_mut);
+            m_reader.reset();
+        }
     }
 
-    void peer::do_recv() {
-        m_recv_thread = std::thread([&]() {
-            while(m_running) {
-                auto pkt = std::make_shared<cbdc::buffer>();
-                if(!m_sock->receive(*pkt)) {
-                    signal_reconnect();
-                    return;
-                }
+    void peer::handle_events(uint32_t events) {
+        if(!m_running) {
+            return;
+        }
+
+        static constexpr uint32_t recv_events
+            = EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR;
+        if((events & recv_events) != 0) {
+            std::unique_lock<std::mutex> l(m_recv_mut);
+            if(!do_recv()) {
+                l.unlock();
+                signal_disconnect();
+                return;
+            }
+        }
 
-                m_recv_cb(std::move(pkt));
+        if((events & EPOLLOUT) != 0) {
+            std::unique_lock<std::mutex> l(m_send_mut);
+            m_send_blocked = false;
+            if(m_sending) {
+                m_send_writable = true;
+            } else if(!m_send_queue.empty()) {
+                flush(l);
             }
-        });
+        }
     }
 
-    void peer::do_reconnect() {
-        m_reconnect_thread = std::thread([&]() {
-            while(!m_shut_down) {
-                {
-                    std::unique_lock<std::mutex> l(m_reconnect_mut);
-                    m_reconnect_cv.wait(l, [&]() {
-                        return m_reconnect || m_shut_down;
-                    });
-                    m_reconnect = false;
+    void peer::flush(std::unique_lock<std::mutex>& l) {
+        m_sending = true;
+        // Cork the socket if the queue takes more than one system call to
+        // write, so the batches leave as full segments rather than each
+        // batch ending in a partial one. Corking is only an optimization, so
+        // failing to set the option is not an error.
+        const auto cork = m_send_queue.size() > max_send_batch;
+        if(cork) {
+            m_sock->set_cork(true);
+        }
+        const auto ok = write_queue(l);
+        if(cork) {
+            m_sock->set_cork(false);
+        }
+        m_sending = false;
+        m_send_cv.notify_all();
+        if(!ok) {
+            l.unlock();
+            signal_disconnect();
+        }
+    }
+
+    auto peer::write_queue(std::unique_lock<std::mutex>& l) -> bool {
+        auto sizes = std::array<uint64_t, max_send_batch>();
+        auto iov = std::array<iovec, 2 * max_send_batch>();
+        while(!m_send_queue.empty() && m_running) {
+            // Gather the size prefix and data of each queued packet,
+            // skipping the bytes of the first packet already written.
+            size_t iovcnt{0};
+            size_t batch_len{0};
+            auto skip = m_send_offset;
+            auto add = [&](const void* base, size_t len) {
+                if(skip >= len) {
+                    skip -= len;
+                    return;
                 }
-                if(m_shut_down) {
+                // writev does not modify the data despite the non-const
+                // iovec base pointer.
+                // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+                auto* ptr = static_cast<std::byte*>(const_cast<void*>(base));
+                iov[iovcnt].iov_base = ptr + skip;
+                iov[iovcnt].iov_len = len - skip;
+                batch_len += len - skip;
+                skip = 0;
+                iovcnt++;
+            };
+            size_t n_pkts{0};
+            for(const auto& pkt : m_send_queue) {
+                if(n_pkts == max_send_batch) {
                     break;
                 }
-                if(m_attempt_reconnect) {
-                    close();
-                    while(!m_shut_down && !m_sock->reconnect()) {
-                        static constexpr auto retry_delay
-                            = std::chrono::seconds(3);
-                        std::unique_lock<std::mutex> l(m_reconnect_mut);
-                        m_reconnect_cv.wait_for(l, retry_delay, [&]() -> bool {
-                            return m_shut_down;
-                        });
-                    }
-                    if(!m_shut_down) {
-                        m_running = true;
-                        do_send();
-                        do_recv();
-                    }
-                } else {
-                    m_shut_down = true;
-                    close();
-                    m_send_queue.clear();
-                    return;
+                sizes[n_pkts] = static_cast<uint64_t>(pkt->size());
+                add(&sizes[n_pkts], sizeof(uint64_t));
+                add(pkt->data(), pkt->size());
+                n_pkts++;
+            }
+
+            // Other threads may queue packets during the write. Only this
+            // thread removes packets, and appending to the deque does not
+            // move the packets already gathered.
+            m_send_writable = false;
+            m_send_in_flight = n_pkts;
+            l.unlock();
+            const auto n = m_sock->write_some(iov.data(), iovcnt);
+            l.lock();
+            m_send_in_flight = 0;
+            if(!n) {
+                return false;
+            }
+
+            auto written = m_send_offset + *n;
+            while(!m_send_queue.empty()) {
+                const auto pkt_len
+                    = sizeof(uint64_t) + m_send_queue.front()->size();
+                if(written < pkt_len) {
+                    break;
                 }
+                written -= pkt_len;
+                pop_send_queue();
             }
-        });
-    }
+            m_send_offset = written;
+            // Wake senders blocked on a full queue.
+            m_send_cv.notify_all();
 
-    void peer::close() {
-        m_running = false;
-        m_sock->disconnect();
-        m_send_queue.clear();
-        if(m_send_thread.joinable()) {
-            m_send_thread.join();
+            if(*n < batch_len && !m_send_writable) {
+                // The socket is full. The reactor flushes the queue again
+                // once the socket is writable.
+                m_send_blocked = true;
+                return true;
+            }
         }
-        if(m_recv_thread.joinable()) {
-            m_recv_thread.join();
+        return true;
+    }
+
+    auto peer::do_recv() -> bool {
+        auto read_some = [&](void* data, size_t len) {
+            return m_sock->read_some(data, len);
+        };
+        while(true) {
+            auto pkt = cbdc::buffer();
+            switch(m_reader.read(read_some, pkt)) {
+                case frame_reader::result::packet:
+                    m_recv_cb(share_buffer(std::move(pkt)));
+                    break;
+                case frame_reader::result::would_block:
+                    // Edge-triggered: the reactor calls do_recv() again
+                    // once more data arrives.
+                    return true;
+                case frame_reader::result::closed:
+                    return false;
+            }
         }
-        m_send_queue.reset();
     }
 
-    void peer::signal_reconnect() {
-        {
-            std::lock_guard<std::mutex> l(m_reconnect_mut);
-            m_reconnect = true;
+    void peer::signal_disconnect() {
+        if(m_running.exchange(false)) {
+            {
+                // Wake senders blocked on a full queue.
+                std::unique_lock<std::mutex> l(m_send_mut);
+            }
+            m_send_cv.notify_all();
+            m_disconnect_cb();
         }
-        m_reconnect_cv.notify_one();
     }
 }
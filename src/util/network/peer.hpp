@@ -6,18 +6,37 @@
 #ifndef OPENCBDC_TX_SRC_NETWORK_PEER_H_
 #define OPENCBDC_TX_SRC_NETWORK_PEER_H_
 
+#include "frame_reader.hpp"
+#include "reactor.hpp"
+#include "send_queue_limits.hpp"
 #include "tcp_socket.hpp"
-#include "util/common/blocking_queue.hpp"
 
 #include <atomic>
-#include <thread>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
 
 namespace cbdc::network {
+    /// Snapshot of the send queue of a \ref peer.
+    struct send_queue_stats {
+        /// Number of packets queued.
+        size_t m_messages{0};
+        /// Number of bytes queued.
+        size_t m_bytes{0};
+        /// Total packets dropped or rejected because the queue was full.
+        uint64_t m_dropped{0};
+        /// Total sends which blocked because the queue was full.
+        uint64_t m_blocked{0};
+        /// Total disconnects because the queue was full.
+        uint64_t m_disconnects{0};
+    };
+
     /// \brief Maintains a TCP socket.
     ///
-    /// Handles reconnecting to a TCP socket, queuing discrete packets to send,
-    /// sending queued packets, and passing received packets to a callback
-    /// function.
+    /// Handles queuing discrete packets to send, sending queued packets, and
+    /// passing received packets to a callback function. The socket is
+    /// non-blocking and serviced by the I/O threads of a \ref reactor shared
+    /// with other peers, so a peer does not own any threads.
     class peer {
       public:
         /// Type for the packet receipt callback function. Accepts a pointer to
@@ -25,19 +44,28 @@ namespace cbdc::network {
         using callback_type
             = std::function<void(std::shared_ptr<cbdc::buffer>)>;
 
-        /// \brief Constructor. Starts socket management threads.
+        /// Type for the function called when the socket disconnects.
+        using disconnect_callback_type = std::function<void()>;
+
+        /// \brief Constructor. Registers the socket with the reactor.
         ///
-        /// Starts a thread to send queued packets via the
-        /// associated TCP socket. Starts a thread to receive packets and call
-        /// a callback function. Starts a thread to monitor the connection
-        /// status of the TCP socket and reconnect if the socket disconnects.
+        /// Packets received by the socket are passed to the callback on a
+        /// reactor I/O thread. When the socket disconnects, the peer calls
+        /// the disconnect callback, and the owner should then call
+        /// \ref maintain from a thread other than a reactor I/O thread.
         /// \param sock TCP socket to manage.
+        /// \param r reactor to service the socket. Must outlive the peer.
         /// \param cb callback function to call with packets received by the socket.
+        /// \param disconnect_cb function to call when the socket disconnects.
         /// \param attempt_reconnect true if the instance should reconnect the TCP
         ///                          socket if it loses the connection.
+        /// \param limits limits on the send queue.
         peer(std::unique_ptr<tcp_socket> sock,
+             reactor& r,
              callback_type cb,
-             bool attempt_reconnect);
+             disconnect_callback_type disconnect_cb,
+             bool attempt_reconnect,
+             send_queue_limits limits = {});
 
         /// Destructor. Calls \ref shutdown().
         ~peer();
@@ -50,47 +78,100 @@ namespace cbdc::network {
 
         /// \brief Sends buffered data.
         ///
-        /// Queues a packet to send via the TCP socket. The recipient peer
-        /// receives it as a discrete unit.
+        /// Queues a packet to send via the TCP socket. If no other thread is
+        /// writing the queue and the socket is writable, writes as much of
+        /// the queue as the socket accepts without blocking. Otherwise
+        /// returns immediately, and the packet is written together with the
+        /// rest of the queue by the thread already writing, or by the
+        /// reactor once the socket is writable. The recipient peer receives
+        /// the packet as a discrete unit.
+        ///
+        /// If the packet would take the queue past its limits, applies the
+        /// \ref overflow_policy. Blocking sends return once the queue has
+        /// room or the socket disconnects. A full queue rejects packets
+        /// while the socket is disconnected, whatever the policy.
         /// \param data buffer to send.
-        void send(const std::shared_ptr<cbdc::buffer>& data);
+        /// \return true if the packet was queued.
+        auto send(const std::shared_ptr<cbdc::buffer>& data) -> bool;
 
-        /// Clears any packets in the pending send queue. Stops the send,
-        /// receive, and reconnect threads. Disconnects the TCP socket.
+        /// Replaces the send queue limits. Applies to subsequent sends.
+        /// \param limits new limits.
+        void set_send_queue_limits(send_queue_limits limits);
+
+        /// Returns the current size of the send queue and its overflow
+        /// counters.
+        /// \return send queue statistics.
+        [[nodiscard]] auto get_send_queue_stats() -> send_queue_stats;
+
+        /// Clears any packets in the pending send queue. Deregisters and
+        /// disconnects the TCP socket.
         void shutdown();
 
+        /// Handles a disconnected socket. Reconnects the socket if the peer
+        /// was constructed with attempt_reconnect, otherwise shuts the peer
+        /// down. Does nothing if the socket is connected.
+        void maintain();
+
         /// Indicates whether the TCP socket is currently connected.
         /// \return true if the TCP socket is connected.
         [[nodiscard]] auto connected() const -> bool;
 
       private:
         std::unique_ptr<tcp_socket> m_sock;
+        reactor& m_reactor;
+
+        std::mutex m_state_mut;
+        std::optional<reactor::registration_id> m_registration;
+
+        /// Maximum number of queued packets written in one system call.
+        static constexpr size_t max_send_batch = 64;
+
+        std::mutex m_send_mut;
+        std::condition_variable m_send_cv;
+        std::deque<std::shared_ptr<cbdc::buffer>> m_send_queue;
+        size_t m_send_offset{0};
+        send_queue_limits m_send_limits;
+        send_queue_stats m_send_stats;
+        /// Number of packets at the front of the queue being written.
+        size_t m_send_in_flight{0};
+        /// A thread is writing the queue to the socket.
+        bool m_sending{false};
+        /// The socket was full at the last write.
+        bool m_send_blocked{false};
+        /// The socket became writable while a thread was writing.
+        bool m_send_writable{false};
+
+        std::mutex m_recv_mut;
+        frame_reader m_reader;
 
-        blocking_queue<std::shared_ptr<cbdc::buffer>> m_send_queue;
-
-        std::thread m_recv_thread;
-        std::thread m_send_thread;
-
-        std::thread m_reconnect_thread;
-        std::mutex m_reconnect_mut;
-        std::condition_variable m_reconnect_cv;
-        bool m_reconnect{false};
         bool m_attempt_reconnect{};
 
-        std::atomic_bool m_running{true};
+        std::atomic_bool m_running{false};
         std::atomic_bool m_shut_down{false};
 
         callback_type m_recv_cb;
+        disconnect_callback_type m_disconnect_cb;
+
+        auto start() -> bool;
 
-        void do_send();
+        void close();
 
-        void do_recv();
+        void handle_events(uint32_t events);
 
-        void do_reconnect();
+        auto enqueue(const std::shared_ptr<cbdc::buffer>& data,
+                     std::unique_lock<std::mutex>& l) -> bool;
 
-        void close();
+        auto has_room(size_t len) const -> bool;
+
+        void pop_send_queue();
+
+        void flush(std::unique_lock<std::mutex>& l);
+
+        auto write_queue(std::unique_lock<std::mutex>& l) -> bool;
+
+        auto do_recv() -> bool;
 
-        void signal_reconnect();
+        void signal_disconnect();
     };
 }
 
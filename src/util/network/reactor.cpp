@@ -0,0 +1,160 @@
+// Copyright (c) 2021 MIT Digital Currency Initiative,
+//                    Federal Reserve Bank of Boston
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "reactor.hpp"
+
+#include <array>
+#include <cerrno>
+#include <limits>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+namespace cbdc::network {
+    namespace {
+        /// Event data identifying the eventfd used to wake the I/O threads.
+        constexpr auto wake_id
+            = std::numeric_limits<reactor::registration_id>::max();
+    }
+
+    reactor::~reactor() {
+        stop();
+    }
+
+    auto reactor::start(size_t n_threads) -> bool {
+        m_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        if(m_epoll_fd == -1) {
+            return false;
+        }
+
+        m_wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if(m_wake_fd == -1) {
+            stop();
+            return false;
+        }
+
+        // Level-triggered, and never read, so that every I/O thread wakes
+        // up once stop() writes to it.
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.u64 = wake_id;
+        if(epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, m_wake_fd, &ev) != 0) {
+            stop();
+            return false;
+        }
+
+        m_running = true;
+        for(size_t i = 0; i < n_threads; i++) {
+            m_threads.emplace_back([&]() {
+                run();
+            });
+        }
+        return true;
+    }
+
+    void reactor::stop() {
+        m_running = false;
+        if(m_wake_fd != -1) {
+            static constexpr uint64_t one = 1;
+            [[maybe_unused]] auto res = write(m_wake_fd, &one, sizeof(one));
+        }
+        for(auto& t : m_threads) {
+            if(t.joinable()) {
+                t.join();
+            }
+        }
+        m_threads.clear();
+        if(m_wake_fd != -1) {
+            close(m_wake_fd);
+            m_wake_fd = -1;
+        }
+        if(m_epoll_fd != -1) {
+            close(m_epoll_fd);
+            m_epoll_fd = -1;
+        }
+    }
+
+    auto reactor::add(const socket& sock,
+                      uint32_t events,
+                      handler_type handler)
+        -> std::optional<registration_id> {
+        std::unique_lock<std::mutex> l(m_mut);
+        const auto id = m_next_id++;
+        auto& reg = m_registrations[id];
+        reg.m_handler = std::move(handler);
+        reg.m_fd = sock.m_sock_fd;
+
+        epoll_event ev{};
+        ev.events = events | EPOLLET;
+        ev.data.u64 = id;
+        if(epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, sock.m_sock_fd, &ev) != 0) {
+            m_registrations.erase(id);
+            return std::nullopt;
+        }
+        return id;
+    }
+
+    void reactor::remove(registration_id id) {
+        std::unique_lock<std::mutex> l(m_mut);
+        auto it = m_registrations.find(id);
+        if(it == m_registrations.end()) {
+            return;
+        }
+        auto& reg = it->second;
+        reg.m_removed = true;
+        epoll_ctl(m_epoll_fd, EPOLL_CTL_DEL, reg.m_fd, nullptr);
+        m_idle_cv.wait(l, [&]() {
+            return reg.m_in_flight == 0;
+        });
+        m_registrations.erase(it);
+    }
+
+    void reactor::run() {
+        static constexpr auto max_events = 64;
+        std::array<epoll_event, max_events> events{};
+        while(m_running) {
+            const auto n = epoll_wait(m_epoll_fd,
+                                      events.data(),
+                                      static_cast<int>(events.size()),
+                                      -1);
+            if(n < 0) {
+                if(errno == EINTR) {
+                    continue;
+                }
+                return;
+            }
+
+            for(size_t i = 0; i < static_cast<size_t>(n); i++) {
+                const auto& ev = events[i];
+                if(ev.data.u64 == wake_id) {
+                    continue;
+                }
+
+                // Registrations are not erased while a handler call is in
+                // flight, so the reference stays valid after unlocking.
+                registration* reg{};
+                {
+                    std::unique_lock<std::mutex> l(m_mut);
+                    auto it = m_registrations.find(ev.data.u64);
+                    if(it == m_registrations.end() || it->second.m_removed) {
+                        continue;
+                    }
+                    reg = &it->second;
+                    reg->m_in_flight++;
+                }
+
+                reg->m_handler(ev.events);
+
+                {
+                    std::unique_lock<std::mutex> l(m_mut);
+                    reg->m_in_flight--;
+                    if(reg->m_in_flight == 0 && reg->m_removed) {
+                        m_idle_cv.notify_all();
+                    }
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,97 @@
+// Copyright (c) 2021 MIT Digital Currency Initiative,
+//                    Federal Reserve Bank of Boston
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef OPENCBDC_TX_SRC_NETWORK_REACTOR_H_
+#define OPENCBDC_TX_SRC_NETWORK_REACTOR_H_
+
+#include "socket.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace cbdc::network {
+    /// \brief Dispatches socket readiness events to handlers on a fixed pool
+    ///        of I/O threads.
+    ///
+    /// Wraps an epoll instance. Sockets are registered edge-triggered, so
+    /// handlers must read or write until the operation would block. Two
+    /// events for the same socket may be handled concurrently by different
+    /// I/O threads, so handlers must synchronize access to their socket.
+    class reactor {
+      public:
+        /// Type for readiness handlers. Receives the epoll event mask.
+        using handler_type = std::function<void(uint32_t)>;
+
+        /// Identifies a registered socket.
+        using registration_id = uint64_t;
+
+        /// Constructs a reactor with no I/O threads.
+        reactor() = default;
+
+        /// Destructor. Calls \ref stop.
+        ~reactor();
+
+        reactor(const reactor&) = delete;
+        auto operator=(const reactor&) -> reactor& = delete;
+
+        reactor(reactor&&) = delete;
+        auto operator=(reactor&&) -> reactor& = delete;
+
+        /// Creates the epoll instance and starts the I/O threads. Must be
+        /// called before sockets are added.
+        /// \param n_threads number of I/O threads to start.
+        /// \return true if the reactor started successfully.
+        auto start(size_t n_threads) -> bool;
+
+        /// Stops and joins the I/O threads. Handlers must be removed before
+        /// the objects they refer to are destroyed.
+        void stop();
+
+        /// Registers a socket. The socket should be non-blocking.
+        /// \param sock socket to register.
+        /// \param events epoll events to wait for, such as EPOLLIN.
+        /// \param handler function to call on an I/O thread when the socket
+        ///                is ready.
+        /// \return ID of the registration, or std::nullopt if the socket
+        ///         could not be registered.
+        auto add(const socket& sock, uint32_t events, handler_type handler)
+            -> std::optional<registration_id>;
+
+        /// Deregisters a socket and waits for any running calls to its
+        /// handler to return. Must not be called from the handler itself.
+        /// Deregister sockets before closing them, as the kernel may reuse
+        /// the file descriptor.
+        /// \param id ID of the registration to remove.
+        void remove(registration_id id);
+
+      private:
+        struct registration {
+            handler_type m_handler;
+            int m_fd{-1};
+            size_t m_in_flight{0};
+            bool m_removed{false};
+        };
+
+        int m_epoll_fd{-1};
+        int m_wake_fd{-1};
+        std::vector<std::thread> m_threads;
+        std::atomic_bool m_running{false};
+
+        std::mutex m_mut;
+        std::condition_variable m_idle_cv;
+        std::unordered_map<registration_id, registration> m_registrations;
+        registration_id m_next_id{0};
+
+        void run();
+    };
+}
+
+#endif // OPENCBDC_TX_SRC_NETWORK_REACTOR_H_
@@ -0,0 +1,37 @@
+// Copyright (c) 2021 MIT Digital Currency Initiative,
+//                    Federal Reserve Bank of Boston
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef OPENCBDC_TX_SRC_NETWORK_SEND_QUEUE_LIMITS_H_
+#define OPENCBDC_TX_SRC_NETWORK_SEND_QUEUE_LIMITS_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace cbdc::network {
+    /// Action a \ref peer takes when a packet would take its send queue
+    /// past the queue limits.
+    enum class overflow_policy : uint8_t {
+        /// Block the sender until the queue has room.
+        block,
+        /// Drop the oldest queued packets which are not being written.
+        drop_oldest,
+        /// Disconnect the peer, discarding the queue.
+        disconnect
+    };
+
+    /// Limits on the packets queued to send to a \ref peer. Zero means
+    /// unlimited.
+    struct send_queue_limits {
+        /// Maximum number of bytes queued. A packet larger than the limit
+        /// is still accepted by an empty queue.
+        size_t m_max_bytes{0};
+        /// Maximum number of packets queued.
+        size_t m_max_messages{0};
+        /// Action to take when a packet would exceed a limit.
+        overflow_policy m_policy{overflow_policy::block};
+    };
+}
+
+#endif // OPENCBDC_TX_SRC_NETWORK_SEND_QUEUE_LIMITS_H_
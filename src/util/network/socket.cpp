@@ -6,9 +6,31 @@
 #include "socket.hpp"
 
 #include <csignal>
+#include <cstddef>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/un.h>
 #include <unistd.h>
 
 namespace cbdc::network {
+    namespace {
+        /// addrinfo for a Unix domain socket, with storage for its
+        /// address.
+        struct unix_addrinfo {
+            addrinfo m_info{};
+            sockaddr_un m_addr{};
+        };
+    }
+
+    auto unix_socket_path(const ip_address& address)
+        -> std::optional<std::string> {
+        const auto scheme = std::string(unix_scheme);
+        if(address.compare(0, scheme.size(), scheme) != 0) {
+            return std::nullopt;
+        }
+        return address.substr(scheme.size());
+    }
+
     socket::socket() {
         // Ignore SIGPIPE if the socket disconnects and we try to write to it
         static std::atomic_flag sigpipe_ignored = ATOMIC_FLAG_INIT;
@@ -23,6 +45,32 @@ namespace cbdc::network {
 
     auto socket::get_addrinfo(const ip_address& address, port_number_t port)
         -> std::shared_ptr<addrinfo> {
+        auto path = unix_socket_path(address);
+        if(path.has_value()) {
+            auto ret = std::make_shared<unix_addrinfo>();
+            auto& sun_path = ret->m_addr.sun_path;
+            // Leave room for the terminator of filesystem paths.
+            if(path->empty() || path->size() >= sizeof(sun_path)) {
+                return nullptr;
+            }
+            ret->m_addr.sun_family = AF_UNIX;
+            std::memcpy(&sun_path[0], path->data(), path->size());
+            auto len = offsetof(sockaddr_un, sun_path) + path->size();
+            if(path->front() == '@') {
+                // Abstract socket names are not terminated.
+                sun_path[0] = '\0';
+            } else {
+                len++;
+            }
+            ret->m_info.ai_family = AF_UNIX;
+            ret->m_info.ai_socktype = SOCK_STREAM;
+            ret->m_info.ai_addrlen = static_cast<socklen_t>(len);
+            // sockaddr_un is layout-compatible with sockaddr by design.
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+            ret->m_info.ai_addr = reinterpret_cast<sockaddr*>(&ret->m_addr);
+            return {ret, &ret->m_info};
+        }
+
         addrinfo hints{};
         hints.ai_family = PF_UNSPEC;
         hints.ai_socktype = SOCK_STREAM;
@@ -44,6 +92,7 @@ namespace cbdc::network {
 
     auto socket::create_socket(int domain, int type, int protocol) -> bool {
         m_sock_fd = ::socket(domain, type, protocol);
+        m_family = domain;
         return m_sock_fd != -1;
     }
 
@@ -57,4 +106,23 @@ namespace cbdc::network {
         }
         return true;
     }
+
+    auto socket::set_blocking(bool blocking) -> bool {
+        if(m_sock_fd == -1) {
+            return false;
+        }
+        // fcntl is variadic, which is unavoidable for this system call.
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg)
+        auto flags = fcntl(m_sock_fd, F_GETFL, 0);
+        if(flags == -1) {
+            return false;
+        }
+        if(blocking) {
+            flags &= ~O_NONBLOCK;
+        } else {
+            flags |= O_NONBLOCK;
+        }
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg)
+        return fcntl(m_sock_fd, F_SETFL, flags) == 0;
+    }
 }
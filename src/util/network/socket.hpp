@@ -8,6 +8,7 @@
 
 #include <memory>
 #include <netdb.h>
+#include <optional>
 #include <string>
 
 namespace cbdc::network {
@@ -15,17 +16,32 @@ namespace cbdc::network {
     using ip_address = std::string;
     /// Port number.
     using port_number_t = unsigned short;
-    /// [host name, port number].
+    /// [host name, port number]. Unix domain socket endpoints have an
+    /// address with the \ref unix_scheme prefix and ignore the port.
     using endpoint_t = std::pair<ip_address, port_number_t>;
 
     /// IP address for localhost.
     static const auto localhost = ip_address("127.0.0.1");
 
+    /// Prefix of addresses naming a Unix domain socket rather than a TCP
+    /// host, followed by the socket's path. Paths starting with '@' name
+    /// a socket in the Linux abstract namespace.
+    static constexpr auto unix_scheme = "unix:";
+
+    /// Returns the path of the Unix domain socket named by the given
+    /// address.
+    /// \param address address to check.
+    /// \return socket path, or std::nullopt if the address does not have
+    ///         the \ref unix_scheme prefix.
+    auto unix_socket_path(const ip_address& address)
+        -> std::optional<std::string>;
+
     /// \brief Generic superclass for network sockets.
     ///
     /// Provides a socket file descriptor and utility methods for configuring
     /// UNIX network sockets. Implementations must derive from this class; it
-    /// cannot be used directly.
+    /// cannot be used directly. Resolves addresses with the
+    /// \ref unix_scheme prefix to Unix domain sockets, and others to TCP.
     /// \see tcp_socket.
     class socket {
       public:
@@ -37,14 +53,22 @@ namespace cbdc::network {
 
         virtual ~socket() = default;
 
+        /// Switches the socket between blocking and non-blocking mode.
+        /// Sockets are blocking by default.
+        /// \param blocking true to make the socket blocking.
+        /// \return true if the mode was set successfully.
+        auto set_blocking(bool blocking) -> bool;
+
       private:
         socket();
 
         int m_sock_fd{-1};
+        int m_family{AF_UNSPEC};
 
         friend class tcp_socket;
         friend class tcp_listener;
         friend class socket_selector;
+        friend class reactor;
 
         static auto get_addrinfo(const ip_address& address, port_number_t port)
             -> std::shared_ptr<addrinfo>;
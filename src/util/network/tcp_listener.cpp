@@ -5,9 +5,34 @@
 
 #include "tcp_listener.hpp"
 
+#include <cerrno>
+#include <sys/stat.h>
 #include <unistd.h>
 
 namespace cbdc::network {
+    namespace {
+        /// Removes the socket file at the given path if no process is
+        /// listening on it any more, so the path can be bound again. Leaves
+        /// live sockets and other files alone so binding fails instead.
+        void remove_stale_socket(const std::string& path,
+                                 const addrinfo& addr) {
+            struct stat st {};
+            if(::lstat(path.c_str(), &st) != 0 || !S_ISSOCK(st.st_mode)) {
+                return;
+            }
+            auto fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+            if(fd == -1) {
+                return;
+            }
+            auto stale = ::connect(fd, addr.ai_addr, addr.ai_addrlen) != 0
+                      && errno == ECONNREFUSED;
+            ::close(fd);
+            if(stale) {
+                ::unlink(path.c_str());
+            }
+        }
+    }
+
     auto tcp_listener::listen(const ip_address& local_address,
                               port_number_t local_port) -> bool {
         auto res0 = get_addrinfo(local_address, local_port);
@@ -15,6 +40,17 @@ namespace cbdc::network {
             return false;
         }
 
+        // Abstract socket names have no file in the filesystem.
+        auto path = unix_socket_path(local_address);
+        if(path.has_value() && path->front() == '@') {
+            path.reset();
+        }
+        if(path.has_value()) {
+            // Binding fails if the path exists, even if no process is
+            // listening on it any more.
+            remove_stale_socket(*path, *res0);
+        }
+
         for(auto* res = res0.get(); res != nullptr; res = res->ai_next) {
             if(!create_socket(res->ai_family,
                               res->ai_socktype,
@@ -42,6 +78,15 @@ namespace cbdc::network {
             break;
         }
 
+        if(m_sock_fd != -1 && path.has_value()) {
+            struct stat st {};
+            if(::stat(path->c_str(), &st) == 0) {
+                m_unix_path = path;
+                m_unix_dev = st.st_dev;
+                m_unix_ino = st.st_ino;
+            }
+        }
+
         return m_sock_fd != -1;
     }
 
@@ -49,6 +94,7 @@ namespace cbdc::network {
         sockaddr cli_addr{};
         unsigned int cli_len = sizeof(cli_addr);
         sock.m_sock_fd = ::accept(m_sock_fd, &cli_addr, &cli_len);
+        sock.m_family = m_family;
         return sock.m_sock_fd != -1;
     }
 
@@ -58,6 +104,15 @@ namespace cbdc::network {
             ::close(m_sock_fd);
             m_sock_fd = -1;
         }
+        if(m_unix_path.has_value()) {
+            // Another listener may have replaced the file since.
+            struct stat st {};
+            if(::lstat(m_unix_path->c_str(), &st) == 0
+               && st.st_dev == m_unix_dev && st.st_ino == m_unix_ino) {
+                ::unlink(m_unix_path->c_str());
+            }
+            m_unix_path.reset();
+        }
     }
 
     tcp_listener::~tcp_listener() {
@@ -8,8 +8,11 @@
 
 #include "tcp_socket.hpp"
 
+#include <sys/types.h>
+
 namespace cbdc::network {
-    /// Listens for incoming TCP connections on a given endpoint.
+    /// Listens for incoming TCP or Unix domain socket connections on a
+    /// given endpoint.
     class tcp_listener : public socket {
       public:
         /// Constructs a new tcp_listener.
@@ -22,7 +25,10 @@ namespace cbdc::network {
         tcp_listener(tcp_listener&&) = delete;
         auto operator=(tcp_listener&&) -> tcp_listener& = delete;
 
-        /// Starts the listener on the given local port and address.
+        /// Starts the listener on the given local port and address. For a
+        /// Unix domain socket address, removes a socket file left at the
+        /// path by a process which is no longer listening. Fails if a live
+        /// socket or any other file exists at the path.
         /// \param local_address the address of the interface to listen on
         /// \param local_port the port number to listen on
         /// \return true if the listener started listening successfully.
@@ -36,8 +42,16 @@ namespace cbdc::network {
         auto accept(tcp_socket& sock) -> bool;
 
         /// Stops the listener and unblocks any blocking calls associated
-        /// with this listener.
+        /// with this listener. Removes the file of a Unix domain socket if
+        /// it is still the one this listener created.
         void close();
+
+      private:
+        /// Path, device and inode of the Unix domain socket file created
+        /// by this listener.
+        std::optional<std::string> m_unix_path;
+        dev_t m_unix_dev{};
+        ino_t m_unix_ino{};
     };
 }
 
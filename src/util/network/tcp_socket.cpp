@@ -5,8 +5,11 @@
 
 #include "tcp_socket.hpp"
 
+#include <algorithm>
 #include <array>
+#include <cerrno>
 #include <cstring>
+#include <netinet/tcp.h>
 #include <unistd.h>
 
 namespace cbdc::network {
@@ -18,6 +21,7 @@ namespace cbdc::network {
                              port_number_t remote_port) -> bool {
         m_addr = remote_address;
         m_port = remote_port;
+        m_reader.reset();
         auto res0 = get_addrinfo(remote_address, remote_port);
         if(!res0) {
             return false;
@@ -61,23 +65,28 @@ namespace cbdc::network {
         const auto sz_val = static_cast<uint64_t>(pkt.size());
         std::array<std::byte, sizeof(sz_val)> sz_arr{};
         std::memcpy(sz_arr.data(), &sz_val, sizeof(sz_val));
+        const auto total = sz_arr.size() + pkt.size();
         size_t total_written = 0;
-        while(total_written != sizeof(sz_val)) {
-            auto n = write(m_sock_fd,
-                           &sz_arr.at(total_written),
-                           sizeof(sz_val) - total_written);
-            if(n <= 0) {
-                return false;
+        while(total_written != total) {
+            auto iov = std::array<iovec, 2>();
+            size_t iovcnt{0};
+            if(total_written < sz_arr.size()) {
+                iov[iovcnt].iov_base = &sz_arr.at(total_written);
+                iov[iovcnt].iov_len = sz_arr.size() - total_written;
+                iovcnt++;
             }
-            total_written += static_cast<size_t>(n);
-        }
-
-        total_written = 0;
-        while(total_written
-              != static_cast<decltype(total_written)>(pkt.size())) {
-            auto n = write(m_sock_fd,
-                           pkt.data_at(total_written),
-                           pkt.size() - total_written);
+            const auto pkt_written
+                = total_written - std::min(total_written, sz_arr.size());
+            if(pkt_written < pkt.size()) {
+                // iovec is shared with readv so its base pointer is
+                // non-const, but writev does not modify the data.
+                // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+                iov[iovcnt].iov_base
+                    = const_cast<void*>(pkt.data_at(pkt_written));
+                iov[iovcnt].iov_len = pkt.size() - pkt_written;
+                iovcnt++;
+            }
+            auto n = writev(m_sock_fd, iov.data(), static_cast<int>(iovcnt));
             if(n <= 0) {
                 return false;
             }
@@ -87,37 +96,86 @@ namespace cbdc::network {
         return true;
     }
 
-    auto tcp_socket::receive(buffer& pkt) const -> bool {
-        uint64_t pkt_sz{};
-        std::array<std::byte, sizeof(pkt_sz)> sz_buf{};
-        uint64_t total_read{0};
-        while(total_read != sz_buf.size()) {
-            auto n = read(m_sock_fd,
-                          &sz_buf.at(total_read),
-                          sizeof(pkt_sz) - total_read);
-            if(n <= 0) {
-                return false;
+    auto tcp_socket::receive(buffer& pkt) -> bool {
+        const auto res = m_reader.read(
+            [&](void* data, size_t len) {
+                return read_some(data, len);
+            },
+            pkt);
+        return res == frame_reader::result::packet;
+    }
+
+    auto tcp_socket::read_some(void* data, size_t len) const
+        -> std::optional<size_t> {
+        while(true) {
+            auto n = read(m_sock_fd, data, len);
+            if(n > 0) {
+                return static_cast<size_t>(n);
+            }
+            if(n == 0) {
+                return std::nullopt;
+            }
+            if(errno == EAGAIN || errno == EWOULDBLOCK) {
+                return 0;
+            }
+            if(errno != EINTR) {
+                return std::nullopt;
             }
-            total_read += static_cast<uint64_t>(n);
         }
-        std::memcpy(&pkt_sz, sz_buf.data(), sizeof(pkt_sz));
+    }
 
-        pkt.clear();
+    auto tcp_socket::write_some(const void* data, size_t len) const
+        -> std::optional<size_t> {
+        while(true) {
+            auto n = write(m_sock_fd, data, len);
+            if(n >= 0) {
+                return static_cast<size_t>(n);
+            }
+            if(errno == EAGAIN || errno == EWOULDBLOCK) {
+                return 0;
+            }
+            if(errno != EINTR) {
+                return std::nullopt;
+            }
+        }
+    }
 
-        total_read = 0;
-        auto buf = std::vector<std::byte>(pkt_sz);
-        while(total_read < pkt_sz) {
-            const auto buf_sz = pkt_sz - total_read;
-            auto n = read(m_sock_fd, buf.data(), buf_sz);
-            if(n <= 0) {
-                return false;
+    auto tcp_socket::write_some(const iovec* iov, size_t iovcnt) const
+        -> std::optional<size_t> {
+        while(true) {
+            auto n = writev(m_sock_fd, iov, static_cast<int>(iovcnt));
+            if(n >= 0) {
+                return static_cast<size_t>(n);
             }
+            if(errno == EAGAIN || errno == EWOULDBLOCK) {
+                return 0;
+            }
+            if(errno != EINTR) {
+                return std::nullopt;
+            }
+        }
+    }
 
-            total_read += static_cast<uint64_t>(n);
-            pkt.append(buf.data(), static_cast<size_t>(n));
+    auto tcp_socket::set_cork(bool cork) -> bool {
+        if(m_family == AF_UNIX) {
+            return true;
         }
+        const int val = cork ? 1 : 0;
+        return setsockopt(m_sock_fd, IPPROTO_TCP, TCP_CORK, &val, sizeof(val))
+            == 0;
+    }
 
-        return true;
+    auto tcp_socket::set_nodelay(bool nodelay) -> bool {
+        if(m_family == AF_UNIX) {
+            return true;
+        }
+        const int val = nodelay ? 1 : 0;
+        return setsockopt(m_sock_fd,
+                          IPPROTO_TCP,
+                          TCP_NODELAY,
+                          &val,
+                          sizeof(val))
+            == 0;
     }
 
     auto tcp_socket::reconnect() -> bool {
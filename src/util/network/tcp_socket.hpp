@@ -6,21 +6,25 @@
 #ifndef OPENCBDC_TX_SRC_NETWORK_TCP_SOCKET_H_
 #define OPENCBDC_TX_SRC_NETWORK_TCP_SOCKET_H_
 
+#include "frame_reader.hpp"
 #include "socket.hpp"
 #include "util/common/buffer.hpp"
 #include "util/serialization/buffer_serializer.hpp"
 #include "util/serialization/util.hpp"
 
 #include <atomic>
+#include <sys/uio.h>
 
 namespace cbdc::network {
     /// \brief Wrapper for a TCP socket.
     ///
-    /// Manages a raw UNIX TCP socket. Handles sending and receiving discrete
-    /// packets by providing a protocol for determining packet boundaries.
-    /// Sends the size of the packet before the packet data. When receiving,
-    /// reads the packet size and returns a discrete packet once the expected
-    /// size is read in full.
+    /// Manages a raw UNIX TCP socket, or a Unix domain stream socket for
+    /// endpoints with the \ref unix_scheme prefix, which avoids the TCP/IP
+    /// stack for components on the same host. Handles sending and receiving
+    /// discrete packets by providing a protocol for determining packet
+    /// boundaries. Sends the size of the packet before the packet data. When
+    /// receiving, reads the packet size and returns a discrete packet once
+    /// the expected size is read in full.
     class tcp_socket : public socket {
       public:
         /// Constructs an empty, unconnected TCP socket.
@@ -46,7 +50,9 @@ namespace cbdc::network {
         auto connect(const ip_address& remote_address,
                      port_number_t remote_port) -> bool;
 
-        /// Sends the given packet to the remote host.
+        /// Sends the given packet to the remote host. Writes the size prefix
+        /// and the packet data together, in a single system call unless the
+        /// socket accepts only part of the packet.
         /// \param pkt the packet to send.
         /// \return true if the packet was sent successfully.
         [[nodiscard]] auto send(const buffer& pkt) const -> bool;
@@ -62,10 +68,58 @@ namespace cbdc::network {
 
         /// Attempts to receive a packet from the remote host
         /// this function will block until there is data ready to receive or an
-        /// error occurs.
+        /// error occurs. Reads ahead into an internal buffer, so bytes of
+        /// following packets may be consumed from the socket; packets must
+        /// therefore only be read from the socket with this method.
         /// \param pkt the packet to receive into
         /// \return true if a packet was received successfully.
-        [[nodiscard]] auto receive(buffer& pkt) const -> bool;
+        [[nodiscard]] auto receive(buffer& pkt) -> bool;
+
+        /// Reads up to the given number of bytes that are available without
+        /// blocking. For use with non-blocking sockets.
+        /// \param data destination for the bytes read.
+        /// \param len maximum number of bytes to read.
+        /// \return number of bytes read, zero if the read would block, or
+        ///         std::nullopt if the connection closed or failed.
+        [[nodiscard]] auto read_some(void* data, size_t len) const
+            -> std::optional<size_t>;
+
+        /// Writes as many of the given bytes as possible without blocking.
+        /// For use with non-blocking sockets.
+        /// \param data bytes to write.
+        /// \param len number of bytes to write.
+        /// \return number of bytes written, zero if the write would block, or
+        ///         std::nullopt if the connection failed.
+        [[nodiscard]] auto write_some(const void* data, size_t len) const
+            -> std::optional<size_t>;
+
+        /// Writes as many bytes as possible from the given sequence of
+        /// buffers, in order, without blocking. For use with non-blocking
+        /// sockets.
+        /// \param iov buffers to write.
+        /// \param iovcnt number of buffers. At most IOV_MAX.
+        /// \return number of bytes written, zero if the write would block, or
+        ///         std::nullopt if the connection failed.
+        [[nodiscard]] auto write_some(const iovec* iov, size_t iovcnt) const
+            -> std::optional<size_t>;
+
+        /// Enables or disables TCP_CORK on the socket. While corked, the
+        /// kernel only sends full segments, so a sequence of small writes
+        /// leaves the host as few segments as possible. Uncorking sends any
+        /// partial segment immediately. Does nothing for Unix domain
+        /// sockets.
+        /// \param cork true to cork the socket, false to uncork it.
+        /// \return true if the option was set successfully.
+        auto set_cork(bool cork) -> bool;
+
+        /// Enables or disables TCP_NODELAY on the socket. With the option
+        /// set, the kernel sends small writes immediately instead of
+        /// holding them until earlier data is acknowledged. Suitable for
+        /// senders which already coalesce their own writes. Does nothing for
+        /// Unix domain sockets, which never delay writes.
+        /// \param nodelay true to disable Nagle's algorithm.
+        /// \return true if the option was set successfully.
+        auto set_nodelay(bool nodelay) -> bool;
 
         /// Closes the connection with the remote host and unblocks
         /// any blocking calls to this socket.
@@ -88,6 +142,7 @@ namespace cbdc::network {
         std::optional<ip_address> m_addr{};
         port_number_t m_port{};
         std::atomic_bool m_connected{false};
+        frame_reader m_reader;
     };
 }
 
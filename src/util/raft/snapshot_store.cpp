@@ -0,0 +1,290 @@
+// Copyright (c) 2021 MIT Digital Currency Initiative,
+//                    Federal Reserve Bank of Boston
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "snapshot_store.hpp"
+
+#include "util/serialization/format.hpp"
+#include "util/serialization/istream_serializer.hpp"
+#include "util/serialization/ostream_serializer.hpp"
+
+#include <charconv>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace cbdc::raft {
+    namespace {
+        /// Returns the log index a snapshot file is named after, or
+        /// std::nullopt if the name is not a log index.
+        auto parse_index(const std::string& name) -> std::optional<uint64_t> {
+            uint64_t idx{};
+            const auto* end = name.data() + name.size();
+            auto [ptr, ec] = std::from_chars(name.data(), end, idx);
+            if(ec != std::errc() || ptr != end || name.empty()) {
+                return std::nullopt;
+            }
+            return idx;
+        }
+    }
+
+    snapshot_store::snapshot_store(std::string dir,
+                                   std::shared_ptr<logging::log> logger)
+        : m_dir(std::move(dir)),
+          m_logger(std::move(logger)) {
+        auto err = std::error_code();
+        std::filesystem::create_directory(m_dir, err);
+        if(err) {
+            m_logger->fatal("Failed to create snapshot directory", m_dir);
+        }
+
+        uint64_t max_idx{0};
+        for(const auto& p : std::filesystem::directory_iterator(m_dir, err)) {
+            // Skips the temporary files and anything else which is not a
+            // snapshot.
+            auto idx = parse_index(p.path().filename().generic_string());
+            if(!idx.has_value()) {
+                continue;
+            }
+            max_idx = std::max(max_idx, idx.value());
+        }
+        if(err) {
+            m_logger->fatal("Failed to list snapshot directory", m_dir);
+        }
+        if(max_idx != 0) {
+            m_snapshot = read_metadata(max_idx);
+            if(!m_snapshot) {
+                m_logger->fatal("Failed to read snapshot", max_idx);
+            }
+        }
+    }
+
+    snapshot_store::~snapshot_store() {
+        if(m_write_thread.joinable()) {
+            m_write_thread.join();
+        }
+    }
+
+    auto snapshot_store::write(nuraft::snapshot& s,
+                               const state_func& write_state) -> bool {
+        const auto idx = s.get_last_log_idx();
+        const auto tmp_path = get_tmp_path(m_tmp_file);
+        auto snp_buf = s.serialize();
+        {
+            auto ss = std::ofstream(tmp_path,
+                                    std::ios::out | std::ios::trunc
+                                        | std::ios::binary);
+            auto ser = cbdc::ostream_serializer(ss);
+            ser << static_cast<uint64_t>(snp_buf->size());
+            ser.write(snp_buf->data_begin(), snp_buf->size());
+            auto ok = ser && write_state(ser);
+            ss.close();
+            if(!ok || !ss.good()) {
+                m_logger->error("Failed to write snapshot", idx);
+                return false;
+            }
+        }
+
+        if(!publish(tmp_path, nuraft::snapshot::deserialize(*snp_buf))) {
+            return false;
+        }
+        m_logger->info("Created snapshot", idx);
+        return true;
+    }
+
+    void snapshot_store::write_async(
+        nuraft::snapshot& s,
+        state_func write_state,
+        nuraft::async_result<bool>::handler_type when_done) {
+        // NuRaft does not request another snapshot until when_done is
+        // called, so the previous writer has already finished.
+        if(m_write_thread.joinable()) {
+            m_write_thread.join();
+        }
+        auto snp = nuraft::snapshot::deserialize(*s.serialize());
+        m_write_thread = std::thread([this,
+                                      snp = std::move(snp),
+                                      write_state = std::move(write_state),
+                                      when_done = std::move(when_done)]() {
+            nuraft::ptr<std::exception> except(nullptr);
+            bool ret = write(*snp, write_state);
+            when_done(ret, except);
+        });
+    }
+
+    auto snapshot_store::read(nuraft::snapshot& s,
+                              const state_func& read_state) const -> bool {
+        auto ss = std::ifstream(get_snapshot_path(s.get_last_log_idx()),
+                                std::ios::in | std::ios::binary);
+        if(!ss.good()) {
+            return false;
+        }
+        auto deser = cbdc::istream_serializer(ss);
+        auto snp_sz = uint64_t();
+        if(!(deser >> snp_sz)) {
+            return false;
+        }
+        deser.advance_cursor(snp_sz);
+        if(!deser || !read_state(deser)) {
+            m_logger->error("Failed to read snapshot", s.get_last_log_idx());
+            return false;
+        }
+        return true;
+    }
+
+    auto snapshot_store::last_snapshot() -> nuraft::ptr<nuraft::snapshot> {
+        std::shared_lock<std::shared_mutex> l(m_mut);
+        return m_snapshot;
+    }
+
+    auto snapshot_store::read_object(nuraft::snapshot& s,
+                                     void*& user_snp_ctx,
+                                     nuraft::ulong obj_id,
+                                     nuraft::ptr<nuraft::buffer>& data_out,
+                                     bool& is_last_obj) const -> int {
+        if(user_snp_ctx == nullptr) {
+            // Keep the file open across chunks so the snapshot remains
+            // readable even if a newer snapshot replaces it meanwhile.
+            auto ss = std::make_unique<std::ifstream>(
+                get_snapshot_path(s.get_last_log_idx()),
+                std::ios::in | std::ios::binary);
+            if(!ss->good()) {
+                // Requested snapshot doesn't exist anymore, not fatal
+                return -1;
+            }
+            user_snp_ctx = ss.release();
+        }
+
+        auto& ss = *static_cast<std::ifstream*>(user_snp_ctx);
+        ss.clear();
+        ss.seekg(static_cast<std::streamoff>(obj_id * m_chunk_size));
+        auto read_vec = std::vector<char>(m_chunk_size);
+        ss.read(read_vec.data(),
+                static_cast<std::streamsize>(read_vec.size()));
+        const auto n = static_cast<size_t>(ss.gcount());
+        if(ss.bad() || (n == 0 && obj_id != 0)) {
+            m_logger->error("Failed to read snapshot chunk",
+                            s.get_last_log_idx(),
+                            obj_id);
+            return -1;
+        }
+        auto buf = nuraft::buffer::alloc(n);
+        std::memcpy(buf->data_begin(), read_vec.data(), n);
+        data_out = std::move(buf);
+        is_last_obj = n < m_chunk_size
+                   || ss.peek() == std::ifstream::traits_type::eof();
+
+        return 0;
+    }
+
+    void snapshot_store::save_object(nuraft::snapshot& s,
+                                     nuraft::ulong& obj_id,
+                                     nuraft::buffer& data,
+                                     bool is_first_obj,
+                                     bool is_last_obj) {
+        const auto recv_path = get_tmp_path(m_recv_file);
+        auto mode = std::ios::out | std::ios::binary;
+        if(is_first_obj) {
+            mode |= std::ios::trunc;
+        } else {
+            mode |= std::ios::in;
+        }
+        auto ss = std::ofstream(recv_path, mode);
+        // Chunks may be resent, so write each at its offset rather than
+        // appending.
+        ss.seekp(static_cast<std::streamoff>(obj_id * m_chunk_size));
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+        ss.write(reinterpret_cast<const char*>(data.data_begin()),
+                 static_cast<std::streamsize>(data.size()));
+        ss.close();
+        if(!ss.good()) {
+            m_logger->fatal("Failed to save snapshot chunk",
+                            s.get_last_log_idx(),
+                            obj_id);
+        }
+
+        if(is_last_obj) {
+            auto snp = nuraft::snapshot::deserialize(*s.serialize());
+            if(!publish(recv_path, std::move(snp))) {
+                m_logger->fatal("Failed to save received snapshot",
+                                s.get_last_log_idx());
+            }
+        }
+
+        obj_id++;
+    }
+
+    void snapshot_store::free_context(void*& user_snp_ctx) {
+        // NOLINTNEXTLINE(cppcoreguidelines-owning-memory)
+        delete static_cast<std::ifstream*>(user_snp_ctx);
+        user_snp_ctx = nullptr;
+    }
+
+    auto snapshot_store::get_snapshot_path(uint64_t idx) const
+        -> std::string {
+        return m_dir + "/" + std::to_string(idx);
+    }
+
+    auto snapshot_store::get_tmp_path(const std::string& name) const
+        -> std::string {
+        return m_dir + "/" + name;
+    }
+
+    auto snapshot_store::read_metadata(uint64_t idx) const
+        -> nuraft::ptr<nuraft::snapshot> {
+        const auto path = get_snapshot_path(idx);
+        auto ss = std::ifstream(path, std::ios::in | std::ios::binary);
+        auto deser = cbdc::istream_serializer(ss);
+        auto snp_sz = uint64_t();
+        if(!(deser >> snp_sz)) {
+            return nullptr;
+        }
+        auto snp_buf = nuraft::buffer::alloc(snp_sz);
+        if(!deser.read(snp_buf->data_begin(), snp_buf->size())) {
+            return nullptr;
+        }
+        auto snp = nuraft::snapshot::deserialize(*snp_buf);
+        auto err = std::error_code();
+        auto sz = std::filesystem::file_size(path, err);
+        if(!err) {
+            snp->set_size(sz);
+        }
+        return snp;
+    }
+
+    auto snapshot_store::publish(const std::string& from,
+                                 nuraft::ptr<nuraft::snapshot> snp) -> bool {
+        const auto idx = snp->get_last_log_idx();
+        const auto path = get_snapshot_path(idx);
+        std::unique_lock<std::shared_mutex> l(m_mut);
+        auto err = std::error_code();
+        std::filesystem::rename(from, path, err);
+        if(err) {
+            m_logger->error("Failed to move snapshot into place", idx);
+            return false;
+        }
+        auto sz = std::filesystem::file_size(path, err);
+        if(!err) {
+            snp->set_size(sz);
+        }
+        if(m_snapshot && m_snapshot->get_last_log_idx() > idx) {
+            return true;
+        }
+        m_snapshot = std::move(snp);
+
+        for(const auto& p : std::filesystem::directory_iterator(m_dir, err)) {
+            auto file_idx
+                = parse_index(p.path().filename().generic_string());
+            if(!file_idx.has_value() || file_idx.value() >= idx) {
+                continue;
+            }
+            std::filesystem::remove(p, err);
+            if(err) {
+                m_logger->warn("Failed to remove old snapshot",
+                               file_idx.value());
+            }
+        }
+        return true;
+    }
+}
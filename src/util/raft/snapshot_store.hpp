@@ -0,0 +1,144 @@
+// Copyright (c) 2021 MIT Digital Currency Initiative,
+//                    Federal Reserve Bank of Boston
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef OPENCBDC_TX_SRC_RAFT_SNAPSHOT_STORE_H_
+#define OPENCBDC_TX_SRC_RAFT_SNAPSHOT_STORE_H_
+
+#include "util/common/logging.hpp"
+#include "util/serialization/serializer.hpp"
+
+#include <functional>
+#include <libnuraft/nuraft.hxx>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+
+namespace cbdc::raft {
+    /// \brief Stores raft state machine snapshots on disk.
+    ///
+    /// Each snapshot is a file in the snapshot directory named after the
+    /// log index it was taken at. The file contains the NuRaft snapshot
+    /// metadata followed by the state serialized by the state machine. Only
+    /// the newest snapshot is kept. Snapshots are sent to followers as
+    /// fixed-size chunks of the file, using NuRaft's logical snapshot
+    /// objects, so the state is never held in memory as a single buffer.
+    class snapshot_store {
+      public:
+        /// Function which serializes or deserializes state machine state.
+        using state_func = std::function<bool(serializer&)>;
+
+        /// Constructor. Creates the snapshot directory if it doesn't exist
+        /// and loads the metadata of the newest snapshot.
+        /// \param dir path to directory in which to store snapshots.
+        /// \param logger log instance.
+        snapshot_store(std::string dir, std::shared_ptr<logging::log> logger);
+
+        /// Waits for any snapshot being written in the background.
+        ~snapshot_store();
+
+        snapshot_store(const snapshot_store&) = delete;
+        auto operator=(const snapshot_store&) -> snapshot_store& = delete;
+        snapshot_store(snapshot_store&&) = delete;
+        auto operator=(snapshot_store&&) -> snapshot_store& = delete;
+
+        /// Writes a snapshot and makes it the newest, removing older
+        /// snapshots.
+        /// \param s snapshot metadata.
+        /// \param write_state function which serializes the state machine
+        ///                    state.
+        /// \return true if the snapshot was written successfully.
+        [[nodiscard]] auto write(nuraft::snapshot& s,
+                                 const state_func& write_state) -> bool;
+
+        /// Writes a snapshot on a background thread, as in \ref write.
+        /// Waits for the previous background write to finish first.
+        /// \param s snapshot metadata.
+        /// \param write_state function which serializes a copy of the state
+        ///                    machine state taken before calling this
+        ///                    method.
+        /// \param when_done function to call with the result once the
+        ///                  snapshot is written.
+        void write_async(nuraft::snapshot& s,
+                         state_func write_state,
+                         nuraft::async_result<bool>::handler_type when_done);
+
+        /// Reads the state stored in the snapshot with the given metadata.
+        /// \param s snapshot metadata.
+        /// \param read_state function which deserializes the state machine
+        ///                   state.
+        /// \return true if the snapshot exists and read_state succeeded.
+        [[nodiscard]] auto read(nuraft::snapshot& s,
+                                const state_func& read_state) const -> bool;
+
+        /// Returns the metadata of the newest snapshot.
+        /// \return snapshot metadata, or nullptr if there is no snapshot.
+        [[nodiscard]] auto last_snapshot() -> nuraft::ptr<nuraft::snapshot>;
+
+        /// Reads one chunk of the given snapshot for sending to a follower.
+        /// \param s metadata of snapshot to read.
+        /// \param user_snp_ctx snapshot context, initially nullptr. Must be
+        ///                     passed to all successive calls for the same
+        ///                     snapshot and freed with \ref free_context.
+        /// \param obj_id index of the chunk to read.
+        /// \param data_out buffer in which to write the chunk.
+        /// \param is_last_obj set to true if this is the last chunk.
+        /// \return 0 if the chunk was read successfully, -1 if the snapshot
+        ///         no longer exists.
+        [[nodiscard]] auto read_object(nuraft::snapshot& s,
+                                       void*& user_snp_ctx,
+                                       nuraft::ulong obj_id,
+                                       nuraft::ptr<nuraft::buffer>& data_out,
+                                       bool& is_last_obj) const -> int;
+
+        /// Saves a chunk of a snapshot received from the leader. Makes the
+        /// snapshot the newest once the last chunk is saved.
+        /// \param s metadata of snapshot being received.
+        /// \param obj_id index of the chunk. Set to the index of the next
+        ///               chunk to request.
+        /// \param data chunk to save.
+        /// \param is_first_obj true if this is the first chunk.
+        /// \param is_last_obj true if this is the last chunk.
+        void save_object(nuraft::snapshot& s,
+                         nuraft::ulong& obj_id,
+                         nuraft::buffer& data,
+                         bool is_first_obj,
+                         bool is_last_obj);
+
+        /// Releases a snapshot context created by \ref read_object.
+        /// \param user_snp_ctx snapshot context to free.
+        static void free_context(void*& user_snp_ctx);
+
+      private:
+        [[nodiscard]] auto get_snapshot_path(uint64_t idx) const
+            -> std::string;
+
+        [[nodiscard]] auto get_tmp_path(const std::string& name) const
+            -> std::string;
+
+        /// Reads the metadata of the snapshot with the given log index.
+        [[nodiscard]] auto read_metadata(uint64_t idx) const
+            -> nuraft::ptr<nuraft::snapshot>;
+
+        /// Moves a completed snapshot file into place and makes it the
+        /// newest snapshot if it is newer than the current one.
+        [[nodiscard]] auto publish(const std::string& from,
+                                   nuraft::ptr<nuraft::snapshot> snp) -> bool;
+
+        static constexpr auto m_tmp_file = "tmp";
+        static constexpr auto m_recv_file = "recv";
+        /// Size of the snapshot chunks sent to followers.
+        static constexpr size_t m_chunk_size = 4 << 20;
+
+        std::string m_dir;
+        std::shared_ptr<logging::log> m_logger;
+
+        nuraft::ptr<nuraft::snapshot> m_snapshot{};
+        std::shared_mutex m_mut{};
+
+        std::thread m_write_thread{};
+    };
+}
+
+#endif // OPENCBDC_TX_SRC_RAFT_SNAPSHOT_STORE_H_
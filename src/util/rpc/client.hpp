@@ -83,10 +83,41 @@ namespace cbdc::rpc {
                                         return;
                                     }
                                     resp_cb(std::move(resp.value().m_payload));
-                                });
+                                },
+                                std::chrono::milliseconds::zero());
             return ret;
         }
 
+        /// Issues an asynchronous request with a timeout and registers the
+        /// given callback to handle the response. Unlike the overload
+        /// without a timeout, calls the callback with std::nullopt if no
+        /// response arrives before the timeout, or if the client is
+        /// destroyed first. Thread safe.
+        /// \param request_payload payload for the RPC.
+        /// \param response_callback function for the request handler to call
+        ///                          when the response is available or the
+        ///                          request fails.
+        /// \param timeout timeout in milliseconds. Zero indicates the call
+        ///                should not timeout.
+        /// \return true if the request was sent successfully.
+        auto call(Request request_payload,
+                  response_callback_type response_callback,
+                  std::chrono::milliseconds timeout) -> bool {
+            auto [request_buf, request_id]
+                = make_request(std::move(request_payload));
+            return call_raw(std::move(request_buf),
+                            request_id,
+                            [resp_cb = std::move(response_callback)](
+                                std::optional<response_type> resp) {
+                                if(!resp.has_value()) {
+                                    resp_cb(std::nullopt);
+                                    return;
+                                }
+                                resp_cb(std::move(resp.value().m_payload));
+                            },
+                            timeout);
+        }
+
       protected:
         /// Deserializes a response object from the given buffer.
         /// \param response_buf buffer containing an RPC response.
@@ -117,9 +148,21 @@ namespace cbdc::rpc {
                               std::chrono::milliseconds timeout)
             -> std::optional<response_type> = 0;
 
+        /// Subclasses must override this function to define the logic for
+        /// call() to transmit a serialized RPC request and register a
+        /// callback for the serialized response.
+        /// \param request_buf serialized request object.
+        /// \param request_id identifier to match requests with responses.
+        /// \param response_callback function to call with the response, or
+        ///                          with std::nullopt if the request fails
+        ///                          or times out after being sent.
+        /// \param timeout timeout in milliseconds. Zero indicates the call
+        ///                should not timeout.
+        /// \return true if the request was sent successfully.
         virtual auto call_raw(cbdc::buffer request_buf,
                               request_id_type request_id,
-                              raw_callback_type response_callback) -> bool
+                              raw_callback_type response_callback,
+                              std::chrono::milliseconds timeout) -> bool
             = 0;
 
         auto make_request(Request request_payload)
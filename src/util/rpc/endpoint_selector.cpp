@@ -0,0 +1,139 @@
+// Copyright (c) 2021 MIT Digital Currency Initiative,
+//                    Federal Reserve Bank of Boston
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "endpoint_selector.hpp"
+
+#include <algorithm>
+
+namespace cbdc::rpc {
+    namespace {
+        auto seed() -> std::default_random_engine::result_type {
+            auto r = std::random_device();
+            return r();
+        }
+    }
+
+    random_selector::random_selector() : m_rnd(seed()) {}
+
+    auto random_selector::select(
+        const std::vector<endpoint_stats>& /* stats */,
+        const std::vector<size_t>& candidates) -> std::optional<size_t> {
+        if(candidates.empty()) {
+            return std::nullopt;
+        }
+        auto dist
+            = std::uniform_int_distribution<size_t>(0, candidates.size() - 1);
+        return candidates[dist(m_rnd)];
+    }
+
+    least_outstanding_selector::least_outstanding_selector()
+        : m_rnd(seed()) {}
+
+    auto least_outstanding_selector::select(
+        const std::vector<endpoint_stats>& stats,
+        const std::vector<size_t>& candidates) -> std::optional<size_t> {
+        if(candidates.empty()) {
+            return std::nullopt;
+        }
+        // Start at a random candidate so ties are spread across endpoints.
+        auto dist
+            = std::uniform_int_distribution<size_t>(0, candidates.size() - 1);
+        const auto offset = dist(m_rnd);
+        auto best = candidates[offset];
+        for(size_t i = 1; i < candidates.size(); i++) {
+            const auto idx = candidates[(i + offset) % candidates.size()];
+            if(stats[idx].m_in_flight < stats[best].m_in_flight) {
+                best = idx;
+            }
+        }
+        return best;
+    }
+
+    ewma_latency_selector::ewma_latency_selector() : m_rnd(seed()) {}
+
+    auto ewma_latency_selector::select(
+        const std::vector<endpoint_stats>& stats,
+        const std::vector<size_t>& candidates) -> std::optional<size_t> {
+        if(candidates.empty()) {
+            return std::nullopt;
+        }
+        if(candidates.size() == 1) {
+            return candidates.front();
+        }
+        auto dist
+            = std::uniform_int_distribution<size_t>(0, candidates.size() - 1);
+        const auto a = dist(m_rnd);
+        // Second choice distinct from the first.
+        auto b = std::uniform_int_distribution<size_t>(0, candidates.size()
+                                                              - 2)(m_rnd);
+        if(b >= a) {
+            b++;
+        }
+        const auto first = candidates[a];
+        const auto second = candidates[b];
+        // An endpoint which has not yet responded is assumed to be as fast
+        // as the other endpoint, or both are given the same unit latency,
+        // so it is tried but still pays for its outstanding requests.
+        auto latency = [&](size_t idx, size_t other) {
+            if(stats[idx].m_responses != 0) {
+                return static_cast<double>(stats[idx].m_latency.count());
+            }
+            if(stats[other].m_responses != 0) {
+                return static_cast<double>(stats[other].m_latency.count());
+            }
+            return 1.0;
+        };
+        auto cost = [&](size_t idx, size_t other) {
+            return latency(idx, other)
+                 * static_cast<double>(stats[idx].m_in_flight + 1);
+        };
+        return cost(second, first) < cost(first, second) ? second : first;
+    }
+
+    auto sticky_leader_selector::select(
+        const std::vector<endpoint_stats>& stats,
+        const std::vector<size_t>& candidates) -> std::optional<size_t> {
+        if(candidates.empty()) {
+            return std::nullopt;
+        }
+        if(m_leader.has_value()) {
+            const auto leader = m_leader.value();
+            const auto available = std::binary_search(candidates.begin(),
+                                                      candidates.end(),
+                                                      leader);
+            if(available && stats[leader].m_timeouts == m_leader_timeouts) {
+                return leader;
+            }
+        }
+        // Fail over to the next candidate after the previous leader.
+        auto next = candidates.front();
+        if(m_leader.has_value()) {
+            auto it = std::upper_bound(candidates.begin(),
+                                       candidates.end(),
+                                       m_leader.value());
+            if(it != candidates.end()) {
+                next = *it;
+            }
+        }
+        m_leader = next;
+        m_leader_timeouts = stats[next].m_timeouts;
+        return next;
+    }
+
+    auto make_endpoint_selector(selection_policy policy)
+        -> std::unique_ptr<endpoint_selector> {
+        switch(policy) {
+            case selection_policy::least_outstanding:
+                return std::make_unique<least_outstanding_selector>();
+            case selection_policy::ewma_latency:
+                return std::make_unique<ewma_latency_selector>();
+            case selection_policy::sticky_leader:
+                return std::make_unique<sticky_leader_selector>();
+            case selection_policy::random:
+                break;
+        }
+        return std::make_unique<random_selector>();
+    }
+}
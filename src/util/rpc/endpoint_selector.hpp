@@ -0,0 +1,131 @@
+// Copyright (c) 2021 MIT Digital Currency Initiative,
+//                    Federal Reserve Bank of Boston
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef OPENCBDC_TX_SRC_RPC_ENDPOINT_SELECTOR_H_
+#define OPENCBDC_TX_SRC_RPC_ENDPOINT_SELECTOR_H_
+
+#include "selection_policy.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <random>
+#include <vector>
+
+namespace cbdc::rpc {
+    /// Request and response statistics for one server endpoint of a
+    /// \ref tcp_client.
+    struct endpoint_stats {
+        /// Number of requests sent to the endpoint.
+        uint64_t m_requests{0};
+        /// Number of responses received from the endpoint.
+        uint64_t m_responses{0};
+        /// Number of requests to the endpoint which timed out.
+        uint64_t m_timeouts{0};
+        /// Number of requests sent to the endpoint awaiting a response.
+        size_t m_in_flight{0};
+        /// Exponentially weighted moving average of the time between
+        /// sending a request and receiving its response.
+        std::chrono::nanoseconds m_latency{0};
+        /// Largest time between sending a request and receiving its
+        /// response.
+        std::chrono::nanoseconds m_max_latency{0};
+    };
+
+    /// Chooses the server endpoint for each request from the statistics of
+    /// the endpoints. Not thread-safe.
+    class endpoint_selector {
+      public:
+        endpoint_selector() = default;
+        virtual ~endpoint_selector() = default;
+
+        endpoint_selector(const endpoint_selector&) = delete;
+        auto operator=(const endpoint_selector&)
+            -> endpoint_selector& = delete;
+        endpoint_selector(endpoint_selector&&) = delete;
+        auto operator=(endpoint_selector&&) -> endpoint_selector& = delete;
+
+        /// Chooses an endpoint.
+        /// \param stats statistics of every endpoint.
+        /// \param candidates ascending indices into stats of the endpoints
+        ///                   which may be chosen, for example those which
+        ///                   are connected.
+        /// \return index of the chosen endpoint, or std::nullopt if there
+        ///         are no candidates.
+        virtual auto select(const std::vector<endpoint_stats>& stats,
+                            const std::vector<size_t>& candidates)
+            -> std::optional<size_t> = 0;
+    };
+
+    /// Chooses endpoints uniformly at random.
+    class random_selector : public endpoint_selector {
+      public:
+        random_selector();
+
+        auto select(const std::vector<endpoint_stats>& stats,
+                    const std::vector<size_t>& candidates)
+            -> std::optional<size_t> override;
+
+      private:
+        std::default_random_engine m_rnd;
+    };
+
+    /// Chooses the endpoint with the fewest requests awaiting a response,
+    /// breaking ties at random.
+    class least_outstanding_selector : public endpoint_selector {
+      public:
+        least_outstanding_selector();
+
+        auto select(const std::vector<endpoint_stats>& stats,
+                    const std::vector<size_t>& candidates)
+            -> std::optional<size_t> override;
+
+      private:
+        std::default_random_engine m_rnd;
+    };
+
+    /// Chooses two endpoints at random and picks the one with the lower
+    /// moving average latency multiplied by one more than its requests
+    /// awaiting a response. Sampling two endpoints rather than taking the
+    /// cheapest overall stops every client herding onto the same endpoint
+    /// while its statistics are stale. An endpoint which has not yet
+    /// responded is assumed to be as fast as the other sampled endpoint,
+    /// so each is tried without attracting every request.
+    class ewma_latency_selector : public endpoint_selector {
+      public:
+        ewma_latency_selector();
+
+        auto select(const std::vector<endpoint_stats>& stats,
+                    const std::vector<size_t>& candidates)
+            -> std::optional<size_t> override;
+
+      private:
+        std::default_random_engine m_rnd;
+    };
+
+    /// Keeps choosing the same endpoint until it is no longer a candidate
+    /// or a request to it times out, then moves to the next candidate in
+    /// order. Suits clusters where one replica, such as the raft leader,
+    /// serves requests more cheaply than the others.
+    class sticky_leader_selector : public endpoint_selector {
+      public:
+        auto select(const std::vector<endpoint_stats>& stats,
+                    const std::vector<size_t>& candidates)
+            -> std::optional<size_t> override;
+
+      private:
+        std::optional<size_t> m_leader;
+        uint64_t m_leader_timeouts{0};
+    };
+
+    /// Constructs a selector implementing the given policy.
+    /// \param policy selection policy.
+    /// \return selector.
+    auto make_endpoint_selector(selection_policy policy)
+        -> std::unique_ptr<endpoint_selector>;
+}
+
+#endif // OPENCBDC_TX_SRC_RPC_ENDPOINT_SELECTOR_H_
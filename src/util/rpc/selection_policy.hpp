@@ -0,0 +1,27 @@
+// Copyright (c) 2021 MIT Digital Currency Initiative,
+//                    Federal Reserve Bank of Boston
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef OPENCBDC_TX_SRC_RPC_SELECTION_POLICY_H_
+#define OPENCBDC_TX_SRC_RPC_SELECTION_POLICY_H_
+
+namespace cbdc::rpc {
+    /// Policy for choosing which of several equivalent server endpoints
+    /// receives a request.
+    enum class selection_policy {
+        /// Any endpoint, uniformly at random.
+        random,
+        /// The endpoint with the fewest requests awaiting a response.
+        least_outstanding,
+        /// The cheaper of two random endpoints, where the cost is the
+        /// moving average latency scaled by the requests awaiting a
+        /// response.
+        ewma_latency,
+        /// The same endpoint as the previous request until it disconnects
+        /// or a request to it times out, then the next endpoint in order.
+        sticky_leader
+    };
+}
+
+#endif // OPENCBDC_TX_SRC_RPC_SELECTION_POLICY_H_
@@ -7,25 +7,54 @@
 #define OPENCBDC_TX_SRC_RPC_TCP_CLIENT_H_
 
 #include "client.hpp"
+#include "endpoint_selector.hpp"
+#include "util/common/timing_wheel.hpp"
 #include "util/common/variant_overloaded.hpp"
 #include "util/network/connection_manager.hpp"
 
+#include <condition_variable>
 #include <future>
 #include <unordered_map>
 
 namespace cbdc::rpc {
     /// Implements an RPC client over TCP sockets. Accepts multiple server
     /// endpoints for failover purposes.
+    ///
+    /// Requests are multiplexed over the connections and matched to their
+    /// responses by request ID. Each request is sent to the connected
+    /// endpoint chosen by an \ref endpoint_selector from the measured
+    /// latency and outstanding requests of each endpoint. Optionally limits
+    /// the number of requests awaiting a response, blocking callers until
+    /// earlier requests complete. Asynchronous requests with a timeout are
+    /// expired by a timer thread using a \ref timing_wheel.
     /// \see cbdc::rpc::tcp_server
     /// \tparam Request type for requests.
     /// \tparam Response type for responses.
     template<typename Request, typename Response>
     class tcp_client : public client<Request, Response> {
       public:
+        /// Granularity of the timeouts of asynchronous requests.
+        static constexpr auto timeout_tick = std::chrono::milliseconds(10);
+        /// Number of slots in the timing wheel. Timeouts shorter than the
+        /// number of slots times the tick expire in one revolution.
+        static constexpr size_t timeout_slots = 1024;
+
         /// Constructor.
         /// \param server_endpoints RPC server endpoints to which to connect.
-        explicit tcp_client(std::vector<network::endpoint_t> server_endpoints)
-            : m_server_endpoints(std::move(server_endpoints)) {}
+        /// \param max_in_flight maximum number of requests awaiting a
+        ///                      response, or zero for no limit. Response
+        ///                      callbacks are called on the client's
+        ///                      handler thread, so must not issue requests
+        ///                      which could block on a full window.
+        /// \param policy policy for choosing the endpoint for each request.
+        explicit tcp_client(
+            std::vector<network::endpoint_t> server_endpoints,
+            size_t max_in_flight = 0,
+            selection_policy policy = selection_policy::random)
+            : m_server_endpoints(std::move(server_endpoints)),
+              m_max_in_flight(max_in_flight),
+              m_endpoint_stats(m_server_endpoints.size()),
+              m_selector(make_endpoint_selector(policy)) {}
 
         tcp_client(tcp_client&&) = delete;
         auto operator=(tcp_client&&) -> tcp_client& = delete;
@@ -36,23 +65,32 @@ namespace cbdc::rpc {
             typename client<Request, Response>::response_type;
 
         /// Destructor. Disconnects from the RPC servers and stops the response
-        /// handler thread.
+        /// handler and timer threads.
         ~tcp_client() override {
+            {
+                std::unique_lock<std::mutex> l(m_responses_mut);
+                m_running = false;
+            }
+            m_window_cv.notify_all();
+            m_timer_cv.notify_all();
+            if(m_timer_thread.joinable()) {
+                m_timer_thread.join();
+            }
             m_net.close();
             if(m_handler_thread.joinable()) {
                 m_handler_thread.join();
             }
             {
                 std::unique_lock<std::mutex> l(m_responses_mut);
-                for(auto& [request_id, action] : m_responses) {
-                    set_response_value(action, std::nullopt);
+                for(auto& [request_id, req] : m_responses) {
+                    set_response_value(req.m_action, std::nullopt);
                 }
                 m_responses.clear();
             }
         }
 
         /// Initializes the client. Connects to the server endpoints and
-        /// starts the response handler thread.
+        /// starts the response handler and timer threads.
         /// \return false if there is only one endpoint and connecting failed.
         ///         Otherwise true.
         [[nodiscard]] auto init() -> bool {
@@ -66,13 +104,35 @@ namespace cbdc::rpc {
                     return response_handler(std::move(msg));
                 });
 
+            m_timer_thread = std::thread([&]() {
+                expire_requests();
+            });
+
             return true;
         }
 
+        /// Returns the request and response statistics of each server
+        /// endpoint.
+        /// \return statistics, in the order of the endpoints passed to the
+        ///         constructor.
+        [[nodiscard]] auto get_endpoint_stats()
+            -> std::vector<endpoint_stats> {
+            std::unique_lock<std::mutex> l(m_responses_mut);
+            return m_endpoint_stats;
+        }
+
+        /// Returns the number of requests awaiting a response.
+        /// \return request count.
+        [[nodiscard]] auto in_flight() -> size_t {
+            std::unique_lock<std::mutex> l(m_responses_mut);
+            return m_responses.size();
+        }
+
       private:
         network::connection_manager m_net;
         std::vector<network::endpoint_t> m_server_endpoints;
         std::thread m_handler_thread;
+        std::thread m_timer_thread;
 
         using raw_callback_type =
             typename client<Request, Response>::raw_callback_type;
@@ -80,20 +140,93 @@ namespace cbdc::rpc {
         using promise_type = std::promise<std::optional<response_type>>;
         using response_action_type
             = std::variant<promise_type, raw_callback_type>;
+        using clock_type = timing_wheel<request_id_type>::clock_type;
+
+        struct pending_request {
+            response_action_type m_action;
+            clock_type::time_point m_sent;
+            network::peer_id_t m_peer_id;
+        };
 
         std::mutex m_responses_mut;
-        std::unordered_map<request_id_type, response_action_type> m_responses;
+        std::unordered_map<request_id_type, pending_request> m_responses;
+        size_t m_max_in_flight;
+        std::condition_variable m_window_cv;
+        timing_wheel<request_id_type> m_deadlines{timeout_tick,
+                                                  timeout_slots};
+        std::condition_variable m_timer_cv;
+        std::vector<endpoint_stats> m_endpoint_stats;
+        bool m_running{true};
+        std::unique_ptr<endpoint_selector> m_selector;
+
+        /// Weight of each new sample in the moving average latency.
+        static constexpr auto latency_weight = 8;
+
+        /// Returns the connected endpoint chosen by the selector. Must be
+        /// called with m_responses_mut held.
+        auto select_endpoint() -> std::optional<network::peer_id_t> {
+            // The network assigns peer IDs to the endpoints in order.
+            auto candidates = std::vector<size_t>();
+            candidates.reserve(m_server_endpoints.size());
+            for(size_t i = 0; i < m_server_endpoints.size(); i++) {
+                if(m_net.connected(i)) {
+                    candidates.push_back(i);
+                }
+            }
+            return m_selector->select(m_endpoint_stats, candidates);
+        }
 
         auto send_request(cbdc::buffer request_buf,
                           request_id_type request_id,
-                          response_action_type response_action) -> bool {
+                          response_action_type response_action,
+                          std::chrono::milliseconds timeout) -> bool {
+            auto peer_id = std::optional<network::peer_id_t>();
             {
                 std::unique_lock<std::mutex> l(m_responses_mut);
+                m_window_cv.wait(l, [&]() {
+                    return !m_running || m_max_in_flight == 0
+                        || m_responses.size() < m_max_in_flight;
+                });
+                if(!m_running) {
+                    return false;
+                }
+                peer_id = select_endpoint();
+                if(!peer_id.has_value()) {
+                    return false;
+                }
                 assert(m_responses.find(request_id) == m_responses.end());
-                m_responses[request_id] = std::move(response_action);
+                const auto now = clock_type::now();
+                m_responses.emplace(request_id,
+                                    pending_request{std::move(response_action),
+                                                    now,
+                                                    peer_id.value()});
+                auto& stats = m_endpoint_stats[peer_id.value()];
+                stats.m_requests++;
+                stats.m_in_flight++;
+                if(timeout != std::chrono::milliseconds::zero()) {
+                    if(m_deadlines.empty()) {
+                        m_timer_cv.notify_one();
+                    }
+                    m_deadlines.schedule(request_id, now + timeout);
+                }
             }
-            auto pkt = std::make_shared<buffer>(std::move(request_buf));
-            return m_net.send_to_one(pkt);
+            auto pkt = share_buffer(std::move(request_buf));
+            return m_net.send(pkt, peer_id.value());
+        }
+
+        /// Removes the given request from the table. Must be called with
+        /// m_responses_mut held.
+        auto extract(request_id_type request_id)
+            -> std::optional<pending_request> {
+            auto it = m_responses.find(request_id);
+            if(it == m_responses.end()) {
+                return std::nullopt;
+            }
+            auto req = std::move(it->second);
+            m_responses.erase(it);
+            m_endpoint_stats[req.m_peer_id].m_in_flight--;
+            m_window_cv.notify_one();
+            return req;
         }
 
         void set_response_value(response_action_type& response_action,
@@ -116,15 +249,16 @@ namespace cbdc::rpc {
 
             if(!send_request(std::move(request_buf),
                              request_id,
-                             std::move(response_promise))) {
-                set_response(request_id, std::nullopt);
+                             std::move(response_promise),
+                             std::chrono::milliseconds::zero())) {
+                fail_request(request_id, false);
                 return std::nullopt;
             }
 
             if(timeout != std::chrono::milliseconds::zero()) {
                 auto res = response_future.wait_for(timeout);
                 if(res == std::future_status::timeout) {
-                    set_response(request_id, std::nullopt);
+                    fail_request(request_id, true);
                     return std::nullopt;
                 }
             }
@@ -136,34 +270,96 @@ namespace cbdc::rpc {
             -> std::optional<buffer> {
             auto resp
                 = client<Request, Response>::deserialize_response(*msg.m_pkt);
-            if(resp.has_value()) {
-                set_response(resp.value().m_header.m_request_id,
-                             std::move(resp.value()));
+            if(!resp.has_value()) {
+                return std::nullopt;
+            }
+            auto req = [&]() {
+                std::unique_lock<std::mutex> l(m_responses_mut);
+                auto r = extract(resp.value().m_header.m_request_id);
+                if(r.has_value()) {
+                    record_latency(m_endpoint_stats[r->m_peer_id],
+                                   clock_type::now() - r->m_sent);
+                }
+                return r;
+            }();
+            if(req.has_value()) {
+                set_response_value(req->m_action, std::move(resp.value()));
             }
             return std::nullopt;
         }
 
-        void set_response(request_id_type request_id,
-                          std::optional<response_type> value) {
-            auto response_node = [&]() {
+        static void record_latency(endpoint_stats& stats,
+                                   clock_type::duration latency) {
+            const auto sample
+                = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    latency);
+            stats.m_responses++;
+            if(stats.m_responses == 1) {
+                stats.m_latency = sample;
+            } else {
+                stats.m_latency += (sample - stats.m_latency) / latency_weight;
+            }
+            stats.m_max_latency = std::max(stats.m_max_latency, sample);
+        }
+
+        void fail_request(request_id_type request_id, bool timed_out) {
+            auto req = [&]() {
                 std::unique_lock<std::mutex> l(m_responses_mut);
-                return m_responses.extract(request_id);
+                auto r = extract(request_id);
+                if(r.has_value() && timed_out) {
+                    m_endpoint_stats[r->m_peer_id].m_timeouts++;
+                }
+                return r;
             }();
+            if(req.has_value()) {
+                set_response_value(req->m_action, std::nullopt);
+            }
+        }
 
-            if(!response_node.empty()) {
-                set_response_value(response_node.mapped(), std::move(value));
+        /// Timer thread body. Fails asynchronous requests whose timeouts
+        /// have passed.
+        void expire_requests() {
+            std::unique_lock<std::mutex> l(m_responses_mut);
+            while(m_running) {
+                if(m_deadlines.empty()) {
+                    m_timer_cv.wait(l, [&]() {
+                        return !m_running || !m_deadlines.empty();
+                    });
+                    continue;
+                }
+                m_timer_cv.wait_for(l, m_deadlines.tick());
+                auto expired = std::vector<pending_request>();
+                for(auto request_id : m_deadlines.advance(clock_type::now())) {
+                    // Requests which already completed are no longer in the
+                    // table.
+                    auto r = extract(request_id);
+                    if(r.has_value()) {
+                        m_endpoint_stats[r->m_peer_id].m_timeouts++;
+                        expired.push_back(std::move(r.value()));
+                    }
+                }
+                if(expired.empty()) {
+                    continue;
+                }
+                l.unlock();
+                for(auto& r : expired) {
+                    set_response_value(r.m_action, std::nullopt);
+                }
+                l.lock();
             }
         }
 
         auto call_raw(cbdc::buffer request_buf,
                       request_id_type request_id,
-                      raw_callback_type response_callback) -> bool override {
+                      raw_callback_type response_callback,
+                      std::chrono::milliseconds timeout) -> bool override {
             if(!send_request(std::move(request_buf),
                              request_id,
-                             std::move(response_callback))) {
+                             std::move(response_callback),
+                             timeout)) {
                 {
                     std::unique_lock<std::mutex> l(m_responses_mut);
-                    m_responses.erase(request_id);
+                    extract(request_id);
                 }
                 return false;
             }
@@ -53,8 +53,8 @@ namespace cbdc::rpc {
                             std::move(*msg.m_pkt),
                             [&, peer_id = msg.m_peer_id, net = m_net](
                                 cbdc::buffer resp) {
-                                auto resp_ptr = std::make_shared<cbdc::buffer>(
-                                    std::move(resp));
+                                auto resp_ptr
+                                    = share_buffer(std::move(resp));
                                 net->send(resp_ptr, peer_id);
                             });
                     } else {
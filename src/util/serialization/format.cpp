@@ -5,7 +5,32 @@
 
 #include "format.hpp"
 
+#include <cstring>
+
 namespace cbdc {
+    namespace {
+        /// Maximum number of bytes in a LEB128-encoded 64-bit value.
+        constexpr size_t max_varint_size = 10;
+        /// Number of value bits in each LEB128 byte.
+        constexpr unsigned varint_bits = 7;
+        /// Mask of the value bits in each LEB128 byte.
+        constexpr uint8_t varint_mask = 0x7f;
+        /// Bit set on every LEB128 byte except the last.
+        constexpr uint8_t varint_continue = 0x80;
+
+        /// Adds the value bits of the i-th LEB128 byte to val.
+        /// \return false if the byte is the tenth and holds more than the
+        ///         final bit of a 64-bit value, or does not end the value.
+        auto add_varint_byte(uint64_t& val, size_t i, uint8_t byte) -> bool {
+            if(i == max_varint_size - 1 && byte > 1) {
+                return false;
+            }
+            val |= static_cast<uint64_t>(byte & varint_mask)
+                << (varint_bits * i);
+            return true;
+        }
+    }
+
     auto operator<<(serializer& packet, std::byte b) -> serializer& {
         packet << static_cast<uint8_t>(b);
         return packet;
@@ -22,16 +47,80 @@ namespace cbdc {
     }
 
     auto operator<<(serializer& ser, const buffer& b) -> serializer& {
-        ser << static_cast<uint64_t>(b.size());
+        write_varint(ser, static_cast<uint64_t>(b.size()));
         ser.write(b.data(), b.size());
         return ser;
     }
 
     auto operator>>(serializer& deser, buffer& b) -> serializer& {
         uint64_t sz{};
-        deser >> sz;
+        read_varint(deser, sz);
         b.extend(sz);
         deser.read(b.data(), sz);
         return deser;
     }
+
+    auto write_varint(serializer& ser, uint64_t val) -> serializer& {
+        if(ser.get_wire_format() == wire_format::fixed) {
+            return ser << val;
+        }
+        std::array<uint8_t, max_varint_size> bytes{};
+        size_t n{0};
+        while(val > varint_mask) {
+            bytes[n++] = static_cast<uint8_t>(val | varint_continue);
+            val >>= varint_bits;
+        }
+        bytes[n++] = static_cast<uint8_t>(val);
+        ser.write(bytes.data(), n);
+        return ser;
+    }
+
+    auto read_varint(serializer& deser, uint64_t& val) -> serializer& {
+        if(deser.get_wire_format() == wire_format::fixed) {
+            return deser >> val;
+        }
+        uint64_t ret{0};
+        for(size_t i{0}; i < max_varint_size; i++) {
+            uint8_t byte{};
+            if(!(deser >> byte)) {
+                return deser;
+            }
+            if(!add_varint_byte(ret, i, byte)) {
+                break;
+            }
+            if((byte & varint_continue) == 0) {
+                val = ret;
+                return deser;
+            }
+        }
+        // The interface has no way to mark a serializer invalid directly, so
+        // consume the rest of the malformed input until a read fails.
+        uint8_t byte{};
+        while(deser >> byte) {}
+        return deser;
+    }
+
+    auto decode_varint(const unsigned char* data,
+                       size_t len,
+                       wire_format fmt,
+                       uint64_t& val) -> size_t {
+        if(fmt == wire_format::fixed) {
+            if(len < sizeof(val)) {
+                return 0;
+            }
+            std::memcpy(&val, data, sizeof(val));
+            return sizeof(val);
+        }
+        uint64_t ret{0};
+        for(size_t i{0}; i < std::min(len, max_varint_size); i++) {
+            if(!add_varint_byte(ret, i, data[i])) {
+                return 0;
+            }
+            if((data[i] & varint_continue) == 0) {
+                val = ret;
+                return i + 1;
+            }
+        }
+        return 0;
+    }
 }
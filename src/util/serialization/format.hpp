@@ -9,6 +9,7 @@
 #include "serializer.hpp"
 #include "util/common/buffer.hpp"
 #include "util/common/config.hpp"
+#include "util/common/flat_hash_set.hpp"
 #include "util/common/variant_overloaded.hpp"
 
 #include <algorithm>
@@ -37,8 +38,8 @@ namespace cbdc {
 
     /// \brief Serializes a raw byte buffer.
     ///
-    /// Writes the size of the buffer as a 64-bit uint, followed by the actual
-    /// buffer data.
+    /// Writes the size of the buffer with \ref write_varint, followed by the
+    /// actual buffer data.
     ///
     /// \see \ref cbdc::operator>>(serializer&, buffer&)
     auto operator<<(serializer& ser, const buffer& b) -> serializer&;
@@ -46,6 +47,35 @@ namespace cbdc {
     /// \brief Deserializes a raw byte buffer.
     auto operator>>(serializer& deser, buffer& b) -> serializer&;
 
+    /// \brief Serializes a length, index or height.
+    ///
+    /// Writes a 64-bit uint in \ref wire_format::fixed, or an unsigned
+    /// LEB128 varint of one to ten bytes in \ref wire_format::compact.
+    ///
+    /// \see \ref cbdc::read_varint(serializer&, uint64_t&)
+    auto write_varint(serializer& ser, uint64_t val) -> serializer&;
+
+    /// \brief Deserializes a length, index or height.
+    ///
+    /// A compact varint longer than ten bytes, or which overflows 64 bits,
+    /// leaves the serializer invalid.
+    ///
+    /// \see \ref cbdc::write_varint(serializer&, uint64_t)
+    auto read_varint(serializer& deser, uint64_t& val) -> serializer&;
+
+    /// Decodes a length, index or height written by \ref write_varint from
+    /// raw bytes, for parsers which do not use a serializer.
+    /// \param data pointer to the encoded value.
+    /// \param len number of bytes available from data.
+    /// \param fmt wire format the value was written in.
+    /// \param val set to the decoded value.
+    /// \return number of bytes consumed, or zero if the bytes do not start
+    ///         with a well-formed value.
+    auto decode_varint(const unsigned char* data,
+                       size_t len,
+                       wire_format fmt,
+                       uint64_t& val) -> size_t;
+
     /// Serializes nothing if `T` is an empty type.
     /// \tparam T an empty type
     /// \param s the serializer (to which nothing will be written)
@@ -178,17 +208,44 @@ namespace cbdc {
         return deser;
     }
 
+    /// Indicates whether a contiguous sequence of `T` serializes to the
+    /// same bytes as its in-memory representation, so it can be written with
+    /// a single call. True for integral types other than `bool`,
+    /// and for arrays of integral types such as \ref hash_t.
+    template<typename T>
+    struct is_bulk_serializable
+        : std::bool_constant<std::is_integral_v<T>
+                             && !std::is_same_v<T, bool>> {};
+
+    /// \see \ref is_bulk_serializable
+    template<typename T, size_t len>
+    struct is_bulk_serializable<std::array<T, len>>
+        : std::bool_constant<std::is_integral_v<T>> {};
+
+    /// \see \ref is_bulk_serializable
+    template<typename T>
+    inline constexpr bool is_bulk_serializable_v
+        = is_bulk_serializable<T>::value;
+
     /// Serializes the count of elements in the vector, and then each element
-    /// in-order.
+    /// in-order. Vectors of \ref is_bulk_serializable elements are written
+    /// with a single call.
     ///
     /// \see \ref cbdc::operator<<(serializer&, T)
     template<typename T>
     auto operator<<(serializer& packet, const std::vector<T>& vec)
         -> serializer& {
-        const auto len = static_cast<uint64_t>(vec.size());
-        packet << len;
-        for(uint64_t i = 0; i < len; i++) {
-            packet << static_cast<T>(vec[i]);
+        write_varint(packet, static_cast<uint64_t>(vec.size()));
+        if constexpr(is_bulk_serializable_v<T>) {
+            packet.write(vec.data(), sizeof(T) * vec.size());
+        } else if constexpr(std::is_same_v<T, bool>) {
+            for(bool val : vec) {
+                packet << val;
+            }
+        } else {
+            for(const auto& val : vec) {
+                packet << val;
+            }
         }
         return packet;
     }
@@ -201,7 +258,7 @@ namespace cbdc {
                       "Vector element size too large");
 
         uint64_t len{};
-        if(!(packet >> len)) {
+        if(!read_varint(packet, len)) {
             return packet;
         }
 
@@ -232,18 +289,15 @@ namespace cbdc {
         return packet;
     }
 
-    /// Serializes the count of key-value pairs, and then each key and value,
-    /// statically-casted.
+    /// Serializes the count of key-value pairs, and then each key and value.
     /// \see \ref cbdc::operator<<(serializer&, T)
     template<typename K, typename V, typename... Ts>
     auto operator<<(serializer& ser,
                     const std::unordered_map<K, V, Ts...>& map)
         -> serializer& {
-        auto len = static_cast<uint64_t>(map.size());
-        ser << len;
+        write_varint(ser, static_cast<uint64_t>(map.size()));
         for(const auto& it : map) {
-            ser << static_cast<K>(it.first);
-            ser << static_cast<V>(it.second);
+            ser << it.first << it.second;
         }
         return ser;
     }
@@ -256,7 +310,7 @@ namespace cbdc {
         static_assert(sizeof(K) + sizeof(V) <= config::maximum_reservation,
                       "Unordered Map element size too large");
         auto len = uint64_t();
-        if(!(deser >> len)) {
+        if(!read_varint(deser, len)) {
             return deser;
         }
 
@@ -284,15 +338,14 @@ namespace cbdc {
         return deser;
     }
 
-    /// Serializes the count of items, and then each item statically-casted.
+    /// Serializes the count of items, and then each item.
     /// \see \ref cbdc::operator<<(serializer&, T)
     template<typename K, typename... Ts>
     auto operator<<(serializer& ser, const std::set<K, Ts...>& set)
         -> serializer& {
-        auto len = static_cast<uint64_t>(set.size());
-        ser << len;
+        write_varint(ser, static_cast<uint64_t>(set.size()));
         for(const auto& key : set) {
-            ser << static_cast<K>(key);
+            ser << key;
         }
         return ser;
     }
@@ -303,7 +356,7 @@ namespace cbdc {
     auto operator>>(serializer& deser, std::set<K, Ts...>& set)
         -> serializer& {
         auto len = uint64_t();
-        if(!(deser >> len)) {
+        if(!read_varint(deser, len)) {
             return deser;
         }
 
@@ -317,15 +370,14 @@ namespace cbdc {
         return deser;
     }
 
-    /// Serializes the count of items, and then each item statically-casted.
+    /// Serializes the count of items, and then each item.
     /// \see \ref cbdc::operator<<(serializer&, T)
     template<typename K, typename... Ts>
     auto operator<<(serializer& ser, const std::unordered_set<K, Ts...>& set)
         -> serializer& {
-        auto len = static_cast<uint64_t>(set.size());
-        ser << len;
+        write_varint(ser, static_cast<uint64_t>(set.size()));
         for(const auto& key : set) {
-            ser << static_cast<K>(key);
+            ser << key;
         }
         return ser;
     }
@@ -338,7 +390,7 @@ namespace cbdc {
         static_assert(sizeof(K) <= config::maximum_reservation,
                       "Unordered Set element size too large");
         auto len = uint64_t();
-        if(!(deser >> len)) {
+        if(!read_varint(deser, len)) {
             return deser;
         }
 
@@ -358,6 +410,47 @@ namespace cbdc {
         return deser;
     }
 
+    /// Serializes the count of items, and then each item.
+    /// \see \ref cbdc::operator<<(serializer&, T)
+    template<typename K, typename... Ts>
+    auto operator<<(serializer& ser, const flat_hash_set<K, Ts...>& set)
+        -> serializer& {
+        write_varint(ser, static_cast<uint64_t>(set.size()));
+        for(const auto& key : set) {
+            ser << key;
+        }
+        return ser;
+    }
+
+    /// Deserializes a flat hash set of items.
+    /// \see \ref cbdc::operator<<(serializer&, const flat_hash_set<K, Ts...>&)
+    template<typename K, typename... Ts>
+    auto operator>>(serializer& deser, flat_hash_set<K, Ts...>& set)
+        -> serializer& {
+        static_assert(sizeof(K) <= config::maximum_reservation,
+                      "Flat Hash Set element size too large");
+        auto len = uint64_t();
+        if(!read_varint(deser, len)) {
+            return deser;
+        }
+
+        uint64_t allocated = 0;
+        while(allocated < len) {
+            allocated = std::min(
+                len,
+                allocated + config::maximum_reservation / sizeof(K));
+            set.reserve(allocated);
+            while(set.size() < allocated) {
+                auto key = K();
+                if(!(deser >> key)) {
+                    return deser;
+                }
+                set.emplace(key);
+            }
+        }
+        return deser;
+    }
+
     /// Serializes the variant index of the value, and then the value itself.
     /// \see \ref cbdc::operator<<(serializer&, T)
     template<typename... Ts>
@@ -7,8 +7,22 @@
 #define OPENCBDC_TX_SRC_SERIALIZATION_SERIALIZER_H_
 
 #include <cstddef>
+#include <cstdint>
 
 namespace cbdc {
+    /// \brief Versioned encoding of lengths, indices and heights.
+    ///
+    /// The value of each format is its version number. All components
+    /// exchanging messages must use the same format.
+    enum class wire_format : uint8_t {
+        /// Fixed-width 64-bit integers. Used for everything stored on disk
+        /// or hashed.
+        fixed = 0,
+        /// LEB128 variable-length integers, using one byte for values below
+        /// 128.
+        compact = 1,
+    };
+
     /// Interface for serializing objects into and out of raw bytes
     /// representations.
     class serializer {
@@ -53,8 +67,24 @@ namespace cbdc {
         ///         from the buffer into the destination.
         virtual auto read(void* data, size_t len) -> bool = 0;
 
+        /// Sets the encoding of lengths, indices and heights. Defaults to
+        /// \ref wire_format::fixed.
+        /// \param fmt wire format to use.
+        void set_wire_format(wire_format fmt) {
+            m_wire_format = fmt;
+        }
+
+        /// Returns the encoding of lengths, indices and heights.
+        /// \return wire format in use.
+        [[nodiscard]] auto get_wire_format() const -> wire_format {
+            return m_wire_format;
+        }
+
       protected:
         serializer() = default;
+
+      private:
+        wire_format m_wire_format{wire_format::fixed};
     };
 }
 
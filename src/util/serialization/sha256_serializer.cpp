@@ -0,0 +1,49 @@
+// Copyright (c) 2021 MIT Digital Currency Initiative,
+//                    Federal Reserve Bank of Boston
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "sha256_serializer.hpp"
+
+#include <algorithm>
+#include <array>
+
+namespace cbdc {
+    sha256_serializer::operator bool() const {
+        return true;
+    }
+
+    void sha256_serializer::advance_cursor(size_t len) {
+        static constexpr auto zeros = std::array<unsigned char, 64>{};
+        while(len > 0) {
+            auto n = std::min(len, zeros.size());
+            m_sha.Write(zeros.data(), n);
+            len -= n;
+        }
+    }
+
+    void sha256_serializer::reset() {
+        m_sha.Reset();
+    }
+
+    auto sha256_serializer::end_of_buffer() const -> bool {
+        return false;
+    }
+
+    auto sha256_serializer::write(const void* data, size_t len) -> bool {
+        m_sha.Write(static_cast<const unsigned char*>(data), len);
+        return true;
+    }
+
+    auto sha256_serializer::read(void* /* data */, size_t /* len */)
+        -> bool {
+        return false;
+    }
+
+    auto sha256_serializer::finalize() -> hash_t {
+        auto ret = hash_t();
+        m_sha.Finalize(ret.data());
+        m_sha.Reset();
+        return ret;
+    }
+}
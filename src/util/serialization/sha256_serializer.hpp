@@ -0,0 +1,73 @@
+// Copyright (c) 2021 MIT Digital Currency Initiative,
+//                    Federal Reserve Bank of Boston
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef OPENCBDC_TX_SRC_SERIALIZATION_SHA256_SERIALIZER_H_
+#define OPENCBDC_TX_SRC_SERIALIZATION_SHA256_SERIALIZER_H_
+
+#include "crypto/sha256.h"
+#include "serializer.hpp"
+#include "util/common/hash.hpp"
+
+namespace cbdc {
+    /// Serializer which feeds the serialized bytes directly into a SHA256
+    /// hasher rather than a buffer. Allows calculating the hash of an
+    /// object's serialized form without allocating a temporary buffer.
+    /// Deserialization is not supported and always fails to read any data.
+    class sha256_serializer final : public serializer {
+      public:
+        sha256_serializer() = default;
+
+        /// Indicates whether the last serialization operation succeeded.
+        /// Serialization always succeeds for SHA256 serializer.
+        /// \return true.
+        explicit operator bool() const final;
+
+        /// Hashes the given number of zero bytes.
+        /// \param len number of bytes.
+        void advance_cursor(size_t len) final;
+
+        /// Resets the hasher to its initial state, discarding any data
+        /// written so far.
+        void reset() final;
+
+        /// SHA256 serializer has no underlying buffer so this method always
+        /// returns false.
+        /// \return false.
+        [[nodiscard]] auto end_of_buffer() const -> bool final;
+
+        /// Adds the given data to the hash.
+        /// \param data pointer to the data to hash.
+        /// \param len number of bytes to hash.
+        /// \return true.
+        auto write(const void* data, size_t len) -> bool final;
+
+        /// Read is not implemented for SHA256 serializer.
+        /// \return false.
+        auto read(void* data, size_t len) -> bool final;
+
+        /// Returns the hash of the data written since construction or the
+        /// last reset, and resets the hasher.
+        /// \return SHA256 hash of the serialized data.
+        [[nodiscard]] auto finalize() -> hash_t;
+
+      private:
+        CSHA256 m_sha;
+    };
+
+    /// Calculates the SHA256 hash of the given object's serialized form
+    /// without allocating a buffer. Equivalent to hashing the result of
+    /// \ref make_buffer. \see \ref sha256_serializer.
+    /// \tparam T type of object.
+    /// \param obj object to hash.
+    /// \return SHA256 hash of the serialized object.
+    template<typename T>
+    auto serialized_hash(const T& obj) -> hash_t {
+        auto ser = sha256_serializer();
+        ser << obj;
+        return ser.finalize();
+    }
+}
+
+#endif // OPENCBDC_TX_SRC_SERIALIZATION_SHA256_SERIALIZER_H_
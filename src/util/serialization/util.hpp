@@ -16,10 +16,13 @@ namespace cbdc {
     /// serialized using \ref serializer. \see \ref size_serializer.
     /// \tparam T type of object.
     /// \param obj object to serialize.
+    /// \param fmt wire format of lengths, indices and heights.
     /// \return serialized size in bytes.
     template<typename T>
-    auto serialized_size(const T& obj) -> size_t {
+    auto serialized_size(const T& obj, wire_format fmt = wire_format::fixed)
+        -> size_t {
         auto ser = size_serializer();
+        ser.set_wire_format(fmt);
         ser << obj;
         return ser.size();
     }
@@ -28,14 +31,17 @@ namespace cbdc {
     /// \tparam T type of object to serialize.
     /// \tparam B type of buffer to return, must be cbdc::buffer for this
     ///         template to be enabled.
+    /// \param obj object to serialize.
+    /// \param fmt wire format of lengths, indices and heights.
     /// \return a serialized buffer of the object.
     template<typename T, typename B = buffer>
-    auto make_buffer(const T& obj)
+    auto make_buffer(const T& obj, wire_format fmt = wire_format::fixed)
         -> std::enable_if_t<std::is_same_v<B, buffer>, cbdc::buffer> {
-        auto sz = serialized_size(obj);
+        auto sz = serialized_size(obj, fmt);
         auto pkt = cbdc::buffer();
         pkt.extend(sz);
         auto ser = cbdc::buffer_serializer(pkt);
+        ser.set_wire_format(fmt);
         ser << obj;
         return pkt;
     }
@@ -43,13 +49,18 @@ namespace cbdc {
     /// Serialize object into std::shared_ptr<cbdc::buffer> using a
     /// cbdc::buffer_serializer.
     /// \tparam T type of object to serialize.
+    /// \param obj object to serialize.
+    /// \param fmt wire format of lengths, indices and heights.
     /// \return a shared_ptr to a serialized buffer of the object.
     template<typename T>
-    auto make_shared_buffer(const T& obj) -> std::shared_ptr<cbdc::buffer> {
-        auto sz = serialized_size(obj);
-        auto buf = std::make_shared<cbdc::buffer>();
+    auto make_shared_buffer(const T& obj,
+                            wire_format fmt = wire_format::fixed)
+        -> std::shared_ptr<cbdc::buffer> {
+        auto sz = serialized_size(obj, fmt);
+        auto buf = share_buffer(cbdc::buffer());
         buf->extend(sz);
         auto ser = cbdc::buffer_serializer(*buf);
+        ser.set_wire_format(fmt);
         ser << obj;
         return buf;
     }
@@ -57,11 +68,14 @@ namespace cbdc {
     /// Deserialize object of given type from a cbdc::buffer.
     /// \tparam T type of object to deserialize from the buffer.
     /// \param buf buffer from which to deserialize the object.
+    /// \param fmt wire format the buffer was serialized with.
     /// \return deserialized object, or std::nullopt if the deserialization
     ///         failed.
     template<typename T>
-    auto from_buffer(cbdc::buffer& buf) -> std::optional<T> {
+    auto from_buffer(cbdc::buffer& buf, wire_format fmt = wire_format::fixed)
+        -> std::optional<T> {
         auto deser = cbdc::buffer_serializer(buf);
+        deser.set_wire_format(fmt);
         T ret{};
         if(!(deser >> ret)) {
             return std::nullopt;
@@ -20,6 +20,7 @@ class atomizer_end_to_end_test : public ::testing::Test {
   protected:
     void SetUp() override {
         cbdc::test::load_config(m_end_to_end_cfg_path, m_opts);
+        configure(m_opts);
 
         m_block_wait_interval = std::chrono::milliseconds(3000);
 
@@ -90,6 +91,9 @@ class atomizer_end_to_end_test : public ::testing::Test {
         std::filesystem::remove("tp_samples.txt");
     }
 
+    /// Adjusts the loaded options before any component starts.
+    virtual void configure(cbdc::config::options& /* opts */) {}
+
     void reload_sender() {
         m_sender = nullptr;
         m_sender = std::make_unique<cbdc::atomizer_client>(
@@ -279,3 +283,32 @@ TEST_F(atomizer_end_to_end_test, invalid_transaction) {
     ASSERT_EQ(res_uhs_states[3].status(),
               cbdc::watchtower::search_status::no_history);
 }
+
+class atomizer_end_to_end_compact_test : public atomizer_end_to_end_test {
+  protected:
+    void configure(cbdc::config::options& opts) override {
+        opts.m_wire_format = cbdc::wire_format::compact;
+    }
+};
+
+TEST_F(atomizer_end_to_end_compact_test, complete_transaction) {
+    auto addr = m_receiver->new_address();
+
+    auto [tx, res] = m_sender->send(33, addr);
+    ASSERT_TRUE(tx.has_value());
+    ASSERT_TRUE(res.has_value());
+    ASSERT_FALSE(res->m_tx_error.has_value());
+    ASSERT_EQ(res->m_tx_status, cbdc::sentinel::tx_status::pending);
+    auto in = m_sender->export_send_inputs(tx.value(), addr);
+    ASSERT_EQ(in.size(), 1UL);
+
+    std::this_thread::sleep_for(m_block_wait_interval);
+    m_sender->sync();
+    ASSERT_EQ(m_sender->balance(), 67UL);
+    ASSERT_EQ(m_sender->pending_tx_count(), 0UL);
+
+    m_receiver->import_send_input(in[0]);
+    m_receiver->sync();
+    ASSERT_EQ(m_receiver->balance(), 33UL);
+    ASSERT_EQ(m_receiver->pending_input_count(), 0UL);
+}
@@ -0,0 +1,98 @@
+// Copyright (c) 2021 MIT Digital Currency Initiative,
+//                    Federal Reserve Bank of Boston
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "uhs/atomizer/atomizer/block_view.hpp"
+#include "uhs/atomizer/atomizer/format.hpp"
+#include "uhs/transaction/messages.hpp"
+#include "util.hpp"
+
+#include <gtest/gtest.h>
+
+class block_view_test : public ::testing::Test {
+  protected:
+    void SetUp() override {
+        m_blk.m_height = 7;
+        m_blk.m_transactions.push_back(
+            cbdc::test::simple_tx({'a'}, {{'b'}, {'c'}}, {{'d'}}));
+        m_blk.m_transactions.push_back(
+            cbdc::test::simple_tx({'e'}, {}, {{'f'}, {'g'}, {'h'}}));
+        m_blk.m_transactions.back().m_attestations.emplace(
+            cbdc::pubkey_t{'i'},
+            cbdc::signature_t{'j'});
+        m_buf = cbdc::make_buffer(m_blk);
+    }
+
+    cbdc::atomizer::block m_blk;
+    cbdc::buffer m_buf;
+};
+
+TEST_F(block_view_test, parse) {
+    auto view = cbdc::atomizer::block_view::parse(m_buf);
+    ASSERT_TRUE(view.has_value());
+    EXPECT_EQ(view->height(), m_blk.m_height);
+    ASSERT_EQ(view->size(), m_blk.m_transactions.size());
+
+    size_t i{0};
+    for(const auto& tx : *view) {
+        const auto& expected = m_blk.m_transactions[i];
+        EXPECT_EQ(tx.id(), expected.m_id);
+        EXPECT_EQ(tx.inputs().size(), expected.m_inputs.size());
+        EXPECT_EQ(tx.uhs_outputs().size(), expected.m_uhs_outputs.size());
+        EXPECT_EQ(tx.attestation_count(), expected.m_attestations.size());
+        i++;
+    }
+    EXPECT_EQ(i, m_blk.m_transactions.size());
+
+    auto copy = view->to_block();
+    EXPECT_EQ(copy, m_blk);
+    ASSERT_EQ(copy.m_transactions.size(), m_blk.m_transactions.size());
+    for(size_t j{0}; j < copy.m_transactions.size(); j++) {
+        EXPECT_EQ(copy.m_transactions[j].m_inputs,
+                  m_blk.m_transactions[j].m_inputs);
+        EXPECT_EQ(copy.m_transactions[j].m_uhs_outputs,
+                  m_blk.m_transactions[j].m_uhs_outputs);
+        EXPECT_EQ(copy.m_transactions[j].m_attestations,
+                  m_blk.m_transactions[j].m_attestations);
+    }
+}
+
+TEST_F(block_view_test, empty_block) {
+    auto blk = cbdc::atomizer::block();
+    blk.m_height = 3;
+    auto buf = cbdc::make_buffer(blk);
+    auto view = cbdc::atomizer::block_view::parse(buf);
+    ASSERT_TRUE(view.has_value());
+    EXPECT_EQ(view->height(), 3U);
+    EXPECT_EQ(view->size(), 0U);
+    EXPECT_EQ(view->begin(), view->end());
+}
+
+TEST_F(block_view_test, truncated) {
+    auto buf = cbdc::buffer();
+    buf.append(m_buf.data(), m_buf.size() - 1);
+    EXPECT_FALSE(cbdc::atomizer::block_view::parse(buf).has_value());
+
+    buf.clear();
+    buf.append(m_buf.data(), sizeof(uint64_t));
+    EXPECT_FALSE(cbdc::atomizer::block_view::parse(buf).has_value());
+}
+
+TEST_F(block_view_test, compact_format) {
+    auto buf = cbdc::make_buffer(m_blk, cbdc::wire_format::compact);
+    EXPECT_LT(buf.size(), m_buf.size());
+
+    auto view
+        = cbdc::atomizer::block_view::parse(buf, cbdc::wire_format::compact);
+    ASSERT_TRUE(view.has_value());
+    EXPECT_EQ(view->height(), m_blk.m_height);
+    EXPECT_EQ(view->size(), m_blk.m_transactions.size());
+    EXPECT_EQ(view->to_block(), m_blk);
+
+    auto blk = cbdc::from_buffer<cbdc::atomizer::block>(
+        buf,
+        cbdc::wire_format::compact);
+    ASSERT_TRUE(blk.has_value());
+    EXPECT_EQ(blk.value(), m_blk);
+}
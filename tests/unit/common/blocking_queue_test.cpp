@@ -0,0 +1,35 @@
+// Copyright (c) 2021 MIT Digital Currency Initiative,
+//                    Federal Reserve Bank of Boston
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "util/common/blocking_queue.hpp"
+
+#include <gtest/gtest.h>
+#include <thread>
+
+TEST(blocking_queue_test, pop_all) {
+    auto q = cbdc::blocking_queue<int>();
+    for(int i{0}; i < 5; i++) {
+        q.push(i);
+    }
+
+    auto items = std::vector<int>();
+    ASSERT_TRUE(q.pop_all(items, 3));
+    ASSERT_EQ(items, std::vector<int>({0, 1, 2}));
+
+    // The rest of the queue is still available without blocking
+    ASSERT_TRUE(q.pop_all(items, 3));
+    ASSERT_EQ(items, std::vector<int>({0, 1, 2, 3, 4}));
+}
+
+TEST(blocking_queue_test, pop_all_clear) {
+    auto q = cbdc::blocking_queue<int>();
+    auto t = std::thread([&]() {
+        auto items = std::vector<int>();
+        ASSERT_FALSE(q.pop_all(items, 3));
+        ASSERT_TRUE(items.empty());
+    });
+    q.clear();
+    t.join();
+}
@@ -0,0 +1,102 @@
+// Copyright (c) 2021 MIT Digital Currency Initiative,
+//                    Federal Reserve Bank of Boston
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "util/common/buffer.hpp"
+#include "util/common/buffer_pool.hpp"
+
+#include <cstring>
+#include <gtest/gtest.h>
+#include <thread>
+
+TEST(buffer_pool_test, reuses_size_class) {
+    auto pool = cbdc::buffer_pool();
+    auto* a = pool.allocate(100);
+    pool.deallocate(a, 100);
+
+    // Any size in the same class reuses the block.
+    auto* b = pool.allocate(cbdc::buffer_pool::min_class_size * 2);
+    EXPECT_EQ(a, b);
+    auto* c = pool.allocate(100);
+    EXPECT_NE(b, c);
+
+    auto s = pool.get_stats();
+    EXPECT_EQ(s.m_allocated, 2UL);
+    EXPECT_EQ(s.m_cached_bytes, 0UL);
+
+    pool.deallocate(b, cbdc::buffer_pool::min_class_size * 2);
+    pool.deallocate(c, 100);
+    EXPECT_EQ(pool.get_stats().m_cached_bytes,
+              cbdc::buffer_pool::min_class_size * 4);
+}
+
+TEST(buffer_pool_test, large_allocations_bypass_pool) {
+    auto pool = cbdc::buffer_pool();
+    static constexpr auto len = cbdc::buffer_pool::max_class_size + 1;
+    auto* a = pool.allocate(len);
+    std::memset(a, 0, len);
+    pool.deallocate(a, len);
+    auto s = pool.get_stats();
+    EXPECT_EQ(s.m_allocated, 0UL);
+    EXPECT_EQ(s.m_cached_bytes, 0UL);
+}
+
+TEST(buffer_pool_test, free_list_is_bounded) {
+    auto pool = cbdc::buffer_pool();
+    static constexpr auto len = cbdc::buffer_pool::max_class_size;
+    static constexpr auto n
+        = cbdc::buffer_pool::max_cached_bytes / len + 2;
+    auto blocks = std::vector<void*>();
+    for(size_t i = 0; i < n; i++) {
+        blocks.push_back(pool.allocate(len));
+    }
+    for(auto* b : blocks) {
+        pool.deallocate(b, len);
+    }
+    EXPECT_EQ(pool.get_stats().m_cached_bytes,
+              cbdc::buffer_pool::max_cached_bytes);
+}
+
+TEST(buffer_pool_test, buffers_recycle_storage) {
+    auto& pool = cbdc::buffer_pool::get();
+    static constexpr auto len = 1000;
+    static constexpr auto n_bufs = 10;
+    auto fill = [](int val) {
+        auto buf = cbdc::share_buffer(cbdc::buffer());
+        buf->extend(len);
+        std::memset(buf->data(), val, buf->size());
+    };
+    fill(0);
+    const auto before = pool.get_stats();
+    for(int i = 0; i < n_bufs; i++) {
+        fill(i);
+    }
+    const auto after = pool.get_stats();
+    // The buffer data and the shared pointer control block are both
+    // reused.
+    EXPECT_EQ(after.m_allocated, before.m_allocated);
+}
+
+TEST(buffer_pool_test, recycles_across_threads) {
+    auto& pool = cbdc::buffer_pool::get();
+    static constexpr size_t len = 256;
+    static constexpr size_t n_blocks = 1000;
+    static constexpr size_t n_rounds = 10;
+    const auto before = pool.get_stats();
+    for(size_t i = 0; i < n_rounds; i++) {
+        auto blocks = std::vector<void*>();
+        for(size_t j = 0; j < n_blocks; j++) {
+            blocks.push_back(pool.allocate(len));
+        }
+        // Free the blocks on another thread, as when a packet received by
+        // the reactor is handled by a worker.
+        std::thread([&]() {
+            for(auto* b : blocks) {
+                pool.deallocate(b, len);
+            }
+        }).join();
+    }
+    const auto after = pool.get_stats();
+    EXPECT_LT(after.m_allocated - before.m_allocated, 2 * n_blocks);
+}
@@ -0,0 +1,149 @@
+// Copyright (c) 2021 MIT Digital Currency Initiative,
+//                    Federal Reserve Bank of Boston
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "util/common/flat_hash_set.hpp"
+#include "util/common/hash.hpp"
+#include "util/common/hashmap.hpp"
+#include "util/serialization/buffer_serializer.hpp"
+#include "util/serialization/format.hpp"
+
+#include <gtest/gtest.h>
+#include <random>
+#include <unordered_set>
+
+class flat_hash_set_test : public ::testing::Test {
+  protected:
+    void SetUp() override {
+        auto rnd = std::uniform_int_distribution<uint64_t>();
+        for(size_t i{0}; i < m_count; i++) {
+            auto h = cbdc::hash_t();
+            for(size_t j{0}; j < cbdc::hash_size / sizeof(uint64_t); j++) {
+                const auto val = rnd(m_engine);
+                std::memcpy(&h[j * sizeof(val)], &val, sizeof(val));
+            }
+            // Pin the leading byte as in a locking shard's UHS
+            h[0] = 0;
+            m_hashes.push_back(h);
+        }
+    }
+
+    static constexpr size_t m_count{10000};
+    std::default_random_engine m_engine;
+    std::vector<cbdc::hash_t> m_hashes;
+    cbdc::flat_hash_set<cbdc::hash_t, cbdc::hashing::null> m_set;
+};
+
+TEST_F(flat_hash_set_test, insert_find) {
+    for(const auto& h : m_hashes) {
+        auto [it, inserted] = m_set.insert(h);
+        ASSERT_TRUE(inserted);
+        ASSERT_EQ(*it, h);
+    }
+    ASSERT_EQ(m_set.size(), m_count);
+
+    for(const auto& h : m_hashes) {
+        auto it = m_set.find(h);
+        ASSERT_NE(it, m_set.end());
+        ASSERT_EQ(*it, h);
+        auto [dup_it, inserted] = m_set.emplace(h);
+        ASSERT_FALSE(inserted);
+        ASSERT_EQ(dup_it, it);
+    }
+    ASSERT_EQ(m_set.size(), m_count);
+
+    auto missing = cbdc::hash_t();
+    missing[1] = 1;
+    ASSERT_EQ(m_set.find(missing), m_set.end());
+    ASSERT_FALSE(m_set.contains(missing));
+}
+
+TEST_F(flat_hash_set_test, erase) {
+    for(const auto& h : m_hashes) {
+        m_set.insert(h);
+    }
+
+    for(size_t i{0}; i < m_count; i += 2) {
+        ASSERT_EQ(m_set.erase(m_hashes[i]), 1U);
+        ASSERT_EQ(m_set.erase(m_hashes[i]), 0U);
+    }
+    ASSERT_EQ(m_set.size(), m_count / 2);
+
+    for(size_t i{0}; i < m_count; i++) {
+        ASSERT_EQ(m_set.contains(m_hashes[i]), i % 2 == 1);
+    }
+
+    m_set.erase(m_set.find(m_hashes[1]));
+    ASSERT_FALSE(m_set.contains(m_hashes[1]));
+    ASSERT_EQ(m_set.size(), m_count / 2 - 1);
+}
+
+TEST_F(flat_hash_set_test, churn) {
+    // Repeated insert/erase cycles at a fixed size must reuse tombstones
+    // rather than grow the table without bound.
+    static constexpr size_t window = 1000;
+    for(size_t i{0}; i < window; i++) {
+        m_set.insert(m_hashes[i]);
+    }
+    const auto cap = m_set.bucket_count();
+    for(size_t i{window}; i < m_count; i++) {
+        ASSERT_EQ(m_set.erase(m_hashes[i - window]), 1U);
+        ASSERT_TRUE(m_set.insert(m_hashes[i]).second);
+        ASSERT_EQ(m_set.size(), window);
+    }
+    ASSERT_EQ(m_set.bucket_count(), cap);
+    for(size_t i{m_count - window}; i < m_count; i++) {
+        ASSERT_TRUE(m_set.contains(m_hashes[i]));
+    }
+}
+
+TEST_F(flat_hash_set_test, iterate) {
+    for(const auto& h : m_hashes) {
+        m_set.insert(h);
+    }
+    auto seen = std::unordered_set<cbdc::hash_t, cbdc::hashing::null>();
+    for(const auto& h : m_set) {
+        ASSERT_TRUE(seen.insert(h).second);
+    }
+    ASSERT_EQ(seen.size(), m_count);
+
+    m_set.clear();
+    ASSERT_TRUE(m_set.empty());
+    ASSERT_EQ(m_set.begin(), m_set.end());
+    ASSERT_FALSE(m_set.contains(m_hashes[0]));
+}
+
+TEST_F(flat_hash_set_test, reserve) {
+    m_set.reserve(m_count);
+    const auto cap = m_set.bucket_count();
+    ASSERT_GE(cap, m_count);
+    for(const auto& h : m_hashes) {
+        m_set.insert(h);
+    }
+    ASSERT_EQ(m_set.bucket_count(), cap);
+}
+
+TEST_F(flat_hash_set_test, serialization) {
+    for(const auto& h : m_hashes) {
+        m_set.insert(h);
+    }
+
+    auto buf = cbdc::buffer();
+    auto ser = cbdc::buffer_serializer(buf);
+    ser << m_set;
+
+    // The wire format matches std::unordered_set
+    auto deser = cbdc::buffer_serializer(buf);
+    auto std_set = std::unordered_set<cbdc::hash_t, cbdc::hashing::null>();
+    ASSERT_TRUE(deser >> std_set);
+    ASSERT_EQ(std_set.size(), m_count);
+
+    deser.reset();
+    auto set = cbdc::flat_hash_set<cbdc::hash_t, cbdc::hashing::null>();
+    ASSERT_TRUE(deser >> set);
+    ASSERT_EQ(set.size(), m_count);
+    for(const auto& h : m_hashes) {
+        ASSERT_TRUE(set.contains(h));
+    }
+}
@@ -0,0 +1,83 @@
+// Copyright (c) 2021 MIT Digital Currency Initiative,
+//                    Federal Reserve Bank of Boston
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "util/common/thread_pool.hpp"
+
+#include <atomic>
+#include <future>
+#include <gtest/gtest.h>
+
+TEST(thread_pool_test, push) {
+    auto pool = cbdc::thread_pool(2);
+    ASSERT_EQ(pool.size(), 2U);
+    auto p = std::promise<int>();
+    auto f = p.get_future();
+    pool.push([&]() {
+        p.set_value(1);
+    });
+    ASSERT_EQ(f.get(), 1);
+}
+
+TEST(thread_pool_test, parallel_for) {
+    static constexpr size_t count = 1001;
+    for(size_t n_threads : {0, 1, 4}) {
+        auto pool = cbdc::thread_pool(n_threads);
+        auto calls = std::vector<std::atomic<size_t>>(count);
+        pool.parallel_for(count, [&](size_t i) {
+            calls[i]++;
+        });
+        for(const auto& c : calls) {
+            ASSERT_EQ(c, 1U);
+        }
+    }
+}
+
+TEST(thread_pool_test, parallel_for_small) {
+    auto pool = cbdc::thread_pool(4);
+    pool.parallel_for(0, [&](size_t /* i */) {
+        FAIL();
+    });
+    auto calls = std::atomic<size_t>();
+    pool.parallel_for(2, [&](size_t /* i */) {
+        calls++;
+    });
+    ASSERT_EQ(calls, 2U);
+}
+
+TEST(thread_pool_test, bounded_queue) {
+    auto pool = cbdc::thread_pool(1, 1);
+    auto release = std::promise<void>();
+    auto released = release.get_future().share();
+    auto started = std::promise<void>();
+    pool.push([&, released]() {
+        started.set_value();
+        released.wait();
+    });
+    started.get_future().wait();
+    ASSERT_EQ(pool.busy(), 1U);
+
+    // The worker is busy so the next task waits in the queue
+    auto calls = std::atomic<size_t>();
+    pool.push([&]() {
+        calls++;
+    });
+    ASSERT_EQ(pool.queue_depth(), 1U);
+
+    // The queue is full so pushing blocks until the worker is released
+    auto pushed = std::async(std::launch::async, [&]() {
+        pool.push([&]() {
+            calls++;
+        });
+    });
+    ASSERT_EQ(pushed.wait_for(std::chrono::milliseconds(100)),
+              std::future_status::timeout);
+    release.set_value();
+    pushed.wait();
+
+    pool.wait_idle();
+    ASSERT_EQ(calls, 2U);
+    ASSERT_EQ(pool.busy(), 0U);
+    ASSERT_EQ(pool.queue_depth(), 0U);
+}
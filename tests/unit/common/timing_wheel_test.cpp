@@ -0,0 +1,75 @@
+// Copyright (c) 2021 MIT Digital Currency Initiative,
+//                    Federal Reserve Bank of Boston
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "util/common/timing_wheel.hpp"
+
+#include <algorithm>
+#include <gtest/gtest.h>
+
+class timing_wheel_test : public ::testing::Test {
+  protected:
+    using wheel_type = cbdc::timing_wheel<int>;
+    static constexpr auto tick = std::chrono::milliseconds(10);
+    static constexpr size_t n_slots = 8;
+
+    wheel_type::clock_type::time_point m_start{
+        wheel_type::clock_type::now()};
+    wheel_type m_wheel{tick, n_slots, m_start};
+
+    static auto sorted(std::vector<int> keys) -> std::vector<int> {
+        std::sort(keys.begin(), keys.end());
+        return keys;
+    }
+};
+
+TEST_F(timing_wheel_test, expires_in_deadline_order) {
+    m_wheel.schedule(1, m_start + tick);
+    m_wheel.schedule(2, m_start + 3 * tick);
+    m_wheel.schedule(3, m_start + 2 * tick);
+    EXPECT_EQ(m_wheel.size(), 3UL);
+
+    EXPECT_TRUE(m_wheel.advance(m_start + tick / 2).empty());
+    EXPECT_EQ(m_wheel.advance(m_start + tick), std::vector<int>{1});
+    EXPECT_EQ(m_wheel.advance(m_start + 2 * tick), std::vector<int>{3});
+    EXPECT_EQ(m_wheel.advance(m_start + 3 * tick), std::vector<int>{2});
+    EXPECT_TRUE(m_wheel.empty());
+}
+
+TEST_F(timing_wheel_test, never_expires_early) {
+    // Rounded up to the second tick.
+    m_wheel.schedule(1, m_start + tick + tick / 2);
+    EXPECT_TRUE(m_wheel.advance(m_start + tick).empty());
+    EXPECT_EQ(m_wheel.advance(m_start + 2 * tick), std::vector<int>{1});
+
+    // Deadlines already passed expire on the next tick.
+    m_wheel.schedule(2, m_start);
+    EXPECT_EQ(m_wheel.advance(m_start + 3 * tick), std::vector<int>{2});
+}
+
+TEST_F(timing_wheel_test, deadlines_beyond_one_revolution) {
+    // Same slot as the first key, one and two revolutions later.
+    m_wheel.schedule(1, m_start + tick);
+    m_wheel.schedule(2, m_start + (n_slots + 1) * tick);
+    m_wheel.schedule(3, m_start + (2 * n_slots + 1) * tick);
+
+    EXPECT_EQ(m_wheel.advance(m_start + tick), std::vector<int>{1});
+    EXPECT_TRUE(m_wheel.advance(m_start + n_slots * tick).empty());
+    EXPECT_EQ(m_wheel.advance(m_start + (n_slots + 1) * tick),
+              std::vector<int>{2});
+    EXPECT_EQ(m_wheel.size(), 1UL);
+}
+
+TEST_F(timing_wheel_test, advance_past_many_revolutions) {
+    for(int i = 0; i < 100; i++) {
+        m_wheel.schedule(i, m_start + (i + 1) * tick);
+    }
+    auto expired = m_wheel.advance(m_start + 50 * tick);
+    EXPECT_EQ(expired.size(), 50UL);
+    EXPECT_EQ(sorted(expired).back(), 49);
+    expired = m_wheel.advance(m_start + 1000 * tick);
+    EXPECT_EQ(expired.size(), 50UL);
+    EXPECT_EQ(sorted(expired).front(), 50);
+    EXPECT_TRUE(m_wheel.empty());
+}
@@ -29,6 +29,7 @@ class config_validation_test : public ::testing::Test {
 
         m_example_config = "archiver0_endpoint=\"127.0.0.1:5558\"\n"
                            "archiver0_db=\"ex_db\"\n"
+                           "sentinel0_endpoint=\"unix:/run/cbdc/s0.sock\"\n"
                            "window_size=40000\n"
                            "shard0_loglevel=\"WARN\"\n"
                            "loadgen_invalid_tx_rate=13.00\n";
@@ -106,6 +107,12 @@ TEST_F(config_validation_test, parsing_validation) {
     EXPECT_EQ(host, "127.0.0.1");
     EXPECT_EQ(port, 5558);
 
+    auto unix_endpoint = ex.get_endpoint("sentinel0_endpoint");
+    ASSERT_TRUE(unix_endpoint.has_value());
+    EXPECT_EQ(unix_endpoint->first, "unix:/run/cbdc/s0.sock");
+    EXPECT_EQ(cbdc::network::unix_socket_path(unix_endpoint->first),
+              "/run/cbdc/s0.sock");
+
     auto db = ex.get_string("archiver0_db");
     EXPECT_TRUE(db.has_value());
     EXPECT_EQ(db.value(), "ex_db");
@@ -0,0 +1,46 @@
+// Copyright (c) 2021 MIT Digital Currency Initiative,
+//                    Federal Reserve Bank of Boston
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "uhs/twophase/coordinator/batch_sizer.hpp"
+
+#include <gtest/gtest.h>
+
+using namespace std::chrono_literals;
+
+TEST(batch_sizer_test, disabled) {
+    auto sizer = cbdc::coordinator::batch_sizer(100, 0us);
+    ASSERT_EQ(sizer.limit(), 100U);
+    sizer.record(100, 10s);
+    ASSERT_EQ(sizer.limit(), 100U);
+}
+
+TEST(batch_sizer_test, shrink_and_grow) {
+    static constexpr size_t max_size{320};
+    auto sizer = cbdc::coordinator::batch_sizer(max_size, 1000us);
+
+    // Slow dtxs shrink the limit, but never below one
+    for(size_t i{0}; i < 100; i++) {
+        sizer.record(sizer.limit(), 5000us);
+    }
+    ASSERT_EQ(sizer.limit(), 1U);
+
+    // Fast dtxs grow the limit once the average drops below the target
+    auto prev = sizer.limit();
+    for(size_t i{0}; i < 10; i++) {
+        sizer.record(sizer.limit(), 100us);
+    }
+    ASSERT_GT(sizer.limit(), prev);
+
+    // The limit doesn't grow when batches aren't filling up
+    prev = sizer.limit();
+    sizer.record(0, 100us);
+    ASSERT_EQ(sizer.limit(), prev);
+
+    // Nor beyond the maximum size
+    for(size_t i{0}; i < 100; i++) {
+        sizer.record(sizer.limit(), 100us);
+    }
+    ASSERT_EQ(sizer.limit(), max_size);
+}
@@ -0,0 +1,149 @@
+// Copyright (c) 2021 MIT Digital Currency Initiative,
+//                    Federal Reserve Bank of Boston
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "uhs/transaction/messages.hpp"
+#include "uhs/twophase/coordinator/format.hpp"
+#include "util.hpp"
+#include "util/raft/serialization.hpp"
+#include "util/serialization/util.hpp"
+
+#include <filesystem>
+#include <future>
+#include <gtest/gtest.h>
+
+class coordinator_state_machine_test : public ::testing::Test {
+  protected:
+    void SetUp() override {
+        m_sm = make_state_machine(m_snapshot_dir);
+    }
+
+    void TearDown() override {
+        m_sm.reset();
+        std::filesystem::remove_all(m_snapshot_dir);
+        std::filesystem::remove_all(m_follower_snapshot_dir);
+    }
+
+    auto make_state_machine(const std::string& snapshot_dir)
+        -> std::shared_ptr<cbdc::coordinator::state_machine> {
+        return std::make_shared<cbdc::coordinator::state_machine>(
+            m_logger,
+            snapshot_dir);
+    }
+
+    /// Commits the given command as the next raft log entry.
+    static auto commit(cbdc::coordinator::state_machine& sm,
+                       const cbdc::coordinator::controller::sm_command& c)
+        -> nuraft::ptr<nuraft::buffer> {
+        auto buf = nuraft::buffer::alloc(cbdc::serialized_size(c));
+        auto ser = cbdc::nuraft_serializer(*buf);
+        ser << c;
+        return sm.commit(sm.last_commit_index() + 1, *buf);
+    }
+
+    /// Returns the dtxs the given state machine is tracking.
+    static auto get_state(cbdc::coordinator::state_machine& sm)
+        -> cbdc::coordinator::controller::coordinator_state {
+        auto buf = commit(
+            sm,
+            {{cbdc::coordinator::state_machine::command::get}});
+        auto deser = cbdc::nuraft_serializer(*buf);
+        auto ret = cbdc::coordinator::controller::coordinator_state();
+        EXPECT_TRUE(deser >> ret);
+        return ret;
+    }
+
+    /// Creates a snapshot at the last committed index and waits for the
+    /// snapshot to be written.
+    auto create_snapshot() -> nuraft::ptr<nuraft::snapshot> {
+        auto snp = nuraft::cs_new<nuraft::snapshot>(
+            m_sm->last_commit_index(),
+            1,
+            nuraft::cs_new<nuraft::cluster_config>());
+        auto done = std::promise<bool>();
+        nuraft::async_result<bool>::handler_type when_done
+            = [&](bool& res, nuraft::ptr<std::exception>& /* err */) {
+                  done.set_value(res);
+              };
+        m_sm->create_snapshot(*snp, when_done);
+        EXPECT_TRUE(done.get_future().get());
+        return snp;
+    }
+
+    static constexpr auto m_snapshot_dir = "coordinator_snps_test_0";
+    static constexpr auto m_follower_snapshot_dir = "coordinator_snps_test_1";
+
+    std::shared_ptr<cbdc::logging::log> m_logger{
+        std::make_shared<cbdc::logging::log>(
+            cbdc::logging::log_level::warn)};
+    std::shared_ptr<cbdc::coordinator::state_machine> m_sm;
+
+    cbdc::test::compact_transaction m_tx{
+        cbdc::test::simple_tx({'a', 'b', 'c'},
+                              {{'d', 'e', 'f'}, {'g', 'h', 'i'}},
+                              {{'x', 'y', 'z'}, {'z', 'z', 'z'}})};
+};
+
+TEST_F(coordinator_state_machine_test, snapshot_round_trip) {
+    ASSERT_EQ(m_sm->last_snapshot(), nullptr);
+
+    using cbdc::coordinator::state_machine;
+    using controller = cbdc::coordinator::controller;
+    const auto prepared_id = cbdc::hash_t{'a'};
+    const auto committed_id = cbdc::hash_t{'b'};
+    const auto discarded_id = cbdc::hash_t{'c'};
+    const auto done_id = cbdc::hash_t{'d'};
+    for(const auto& id : {prepared_id, committed_id, discarded_id, done_id}) {
+        commit(*m_sm,
+               {{state_machine::command::prepare, id},
+                controller::prepare_tx{m_tx}});
+    }
+    auto commit_data = controller::commit_tx{{true}, {{0}}};
+    for(const auto& id : {committed_id, discarded_id, done_id}) {
+        commit(*m_sm, {{state_machine::command::commit, id}, commit_data});
+    }
+    for(const auto& id : {discarded_id, done_id}) {
+        commit(*m_sm, {{state_machine::command::discard, id}});
+    }
+    commit(*m_sm, {{state_machine::command::done, done_id}});
+
+    const auto expected = get_state(*m_sm);
+    ASSERT_EQ(expected.m_prepare_txs.size(), 1U);
+    ASSERT_EQ(expected.m_commit_txs.size(), 1U);
+    ASSERT_EQ(expected.m_discard_txs.size(), 1U);
+
+    auto snp = create_snapshot();
+    ASSERT_EQ(m_sm->last_snapshot()->get_last_log_idx(),
+              snp->get_last_log_idx());
+
+    auto follower = make_state_machine(m_follower_snapshot_dir);
+    void* ctx{nullptr};
+    auto is_last = false;
+    nuraft::ulong obj_id{0};
+    while(!is_last) {
+        nuraft::ptr<nuraft::buffer> data;
+        ASSERT_EQ(m_sm->read_logical_snp_obj(*snp, ctx, obj_id, data, is_last),
+                  0);
+        follower->save_logical_snp_obj(*snp,
+                                       obj_id,
+                                       *data,
+                                       obj_id == 0,
+                                       is_last);
+    }
+    m_sm->free_user_snp_ctx(ctx);
+    ASSERT_TRUE(follower->apply_snapshot(*snp));
+    ASSERT_EQ(follower->last_commit_index(), snp->get_last_log_idx());
+    ASSERT_EQ(get_state(*follower), expected);
+
+    // The restored dtxs can continue through the remaining phases
+    commit(*follower,
+           {{state_machine::command::commit, prepared_id}, commit_data});
+    commit(*follower, {{state_machine::command::done, discarded_id}});
+
+    // A restarted state machine restores the newest snapshot from disk
+    m_sm.reset();
+    m_sm = make_state_machine(m_snapshot_dir);
+    ASSERT_EQ(m_sm->last_commit_index(), snp->get_last_log_idx());
+    ASSERT_EQ(get_state(*m_sm), expected);
+}
@@ -0,0 +1,173 @@
+// Copyright (c) 2021 MIT Digital Currency Initiative,
+//                    Federal Reserve Bank of Boston
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "uhs/twophase/locking_shard/client.hpp"
+#include "uhs/twophase/locking_shard/format.hpp"
+#include "util/rpc/async_server.hpp"
+#include "util/rpc/tcp_server.hpp"
+#include "util/serialization/format.hpp"
+
+#include <future>
+#include <gtest/gtest.h>
+
+class locking_shard_client_test : public ::testing::Test {
+  protected:
+    using request = cbdc::locking_shard::rpc::request;
+    using response = cbdc::locking_shard::rpc::response;
+    using callback_type = std::function<void(std::optional<response>)>;
+
+    void SetUp() override {
+        m_server.register_handler_callback(
+            [&](request req, callback_type cb) -> bool {
+                return handle(std::move(req), std::move(cb));
+            });
+        ASSERT_TRUE(m_server.init());
+        ASSERT_TRUE(m_client.init());
+    }
+
+    /// Responds to lock requests by locking every transaction, and holds
+    /// apply requests without responding unless m_hold_applies is false.
+    auto handle(request req, callback_type cb) -> bool {
+        return std::visit(
+            cbdc::overloaded{
+                [&](cbdc::locking_shard::rpc::lock_params& p) {
+                    cb(cbdc::locking_shard::rpc::lock_response(p.size(),
+                                                               true));
+                    return true;
+                },
+                [&](cbdc::locking_shard::rpc::apply_params& /* p */) {
+                    std::unique_lock<std::mutex> l(m_held_mut);
+                    if(!m_hold_applies) {
+                        l.unlock();
+                        cb(cbdc::locking_shard::rpc::apply_response());
+                        return true;
+                    }
+                    m_held.emplace_back(std::move(cb));
+                    return true;
+                },
+                [&](cbdc::locking_shard::rpc::discard_params& /* p */) {
+                    cb(cbdc::locking_shard::rpc::discard_response());
+                    return true;
+                },
+                [&](cbdc::locking_shard::rpc::discard_batch_params& p) {
+                    {
+                        std::unique_lock<std::mutex> l(m_held_mut);
+                        m_discarded.emplace_back(req.m_dtx_id);
+                        m_discarded.insert(m_discarded.end(),
+                                           p.begin(),
+                                           p.end());
+                    }
+                    cb(cbdc::locking_shard::rpc::discard_response());
+                    return true;
+                }},
+            req.m_params);
+    }
+
+    cbdc::network::endpoint_t m_endpoint{cbdc::network::localhost, 55555};
+    cbdc::rpc::async_tcp_server<request, response> m_server{m_endpoint};
+    cbdc::logging::log m_logger{cbdc::logging::log_level::warn};
+    cbdc::locking_shard::rpc::client m_client{{m_endpoint},
+                                              {0, 255},
+                                              m_logger};
+
+    std::mutex m_held_mut;
+    std::vector<callback_type> m_held;
+    bool m_hold_applies{true};
+    std::vector<cbdc::hash_t> m_discarded;
+};
+
+TEST_F(locking_shard_client_test, async_requests) {
+    auto lock_res = std::promise<std::optional<std::vector<bool>>>();
+    auto txs = std::vector<cbdc::locking_shard::tx>(3);
+    m_client.lock_outputs(std::move(txs),
+                          cbdc::hash_t{'a'},
+                          [&](std::optional<std::vector<bool>> res) {
+                              lock_res.set_value(std::move(res));
+                          });
+    auto lock_fut = lock_res.get_future();
+    ASSERT_EQ(lock_fut.wait_for(std::chrono::seconds(1)),
+              std::future_status::ready);
+    ASSERT_EQ(lock_fut.get(), std::vector<bool>({true, true, true}));
+
+    auto discard_res = std::promise<bool>();
+    m_client.discard_dtx(cbdc::hash_t{'a'}, [&](bool res) {
+        discard_res.set_value(res);
+    });
+    auto discard_fut = discard_res.get_future();
+    ASSERT_EQ(discard_fut.wait_for(std::chrono::seconds(1)),
+              std::future_status::ready);
+    ASSERT_TRUE(discard_fut.get());
+}
+
+TEST_F(locking_shard_client_test, discard_group) {
+    auto dtx_ids = std::vector<cbdc::hash_t>{{'a'}, {'b'}, {'c'}};
+    auto discard_res = std::promise<bool>();
+    m_client.discard_dtxs(dtx_ids, [&](bool res) {
+        discard_res.set_value(res);
+    });
+    auto discard_fut = discard_res.get_future();
+    ASSERT_EQ(discard_fut.wait_for(std::chrono::seconds(1)),
+              std::future_status::ready);
+    ASSERT_TRUE(discard_fut.get());
+
+    // The whole group arrives in a single request
+    std::unique_lock<std::mutex> l(m_held_mut);
+    ASSERT_EQ(m_discarded, dtx_ids);
+}
+
+TEST_F(locking_shard_client_test, retries_lost_response) {
+    auto apply_res = std::promise<bool>();
+    m_client.apply_outputs({true}, cbdc::hash_t{'a'}, [&](bool res) {
+        apply_res.set_value(res);
+    });
+    auto apply_fut = apply_res.get_future();
+    ASSERT_EQ(apply_fut.wait_for(std::chrono::milliseconds(100)),
+              std::future_status::timeout);
+
+    // The first attempt is never answered, so the client times it out and
+    // the retry succeeds
+    {
+        std::unique_lock<std::mutex> l(m_held_mut);
+        ASSERT_EQ(m_held.size(), 1U);
+        m_hold_applies = false;
+    }
+    ASSERT_EQ(apply_fut.wait_for(std::chrono::seconds(10)),
+              std::future_status::ready);
+    ASSERT_TRUE(apply_fut.get());
+
+    std::unique_lock<std::mutex> l(m_held_mut);
+    for(auto& cb : m_held) {
+        cb(std::nullopt);
+    }
+}
+
+TEST_F(locking_shard_client_test, stop_fails_pending) {
+    auto apply_res = std::promise<bool>();
+    m_client.apply_outputs({true}, cbdc::hash_t{'a'}, [&](bool res) {
+        apply_res.set_value(res);
+    });
+    auto apply_fut = apply_res.get_future();
+    ASSERT_EQ(apply_fut.wait_for(std::chrono::milliseconds(100)),
+              std::future_status::timeout);
+
+    // The shard never responds, so stopping the client fails the request
+    m_client.stop();
+    ASSERT_EQ(apply_fut.wait_for(std::chrono::seconds(1)),
+              std::future_status::ready);
+    ASSERT_FALSE(apply_fut.get());
+
+    // Requests after stopping fail immediately
+    auto discard_called = false;
+    m_client.discard_dtx(cbdc::hash_t{'a'}, [&](bool res) {
+        ASSERT_FALSE(res);
+        discard_called = true;
+    });
+    ASSERT_TRUE(discard_called);
+
+    std::unique_lock<std::mutex> l(m_held_mut);
+    for(auto& cb : m_held) {
+        cb(std::nullopt);
+    }
+}
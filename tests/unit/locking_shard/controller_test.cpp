@@ -21,6 +21,7 @@ class locking_shard_test : public ::testing::Test {
         std::filesystem::remove_all("shard0_raft_log_0");
         std::filesystem::remove("shard0_raft_config_0.dat");
         std::filesystem::remove("shard0_raft_state_0.dat");
+        std::filesystem::remove_all("shard0_snps_0");
     }
 
     static constexpr auto cfg_path = "locking_shard.cfg";
@@ -55,6 +55,21 @@ TEST_F(locking_shard_format_test, discard_request) {
     req.m_dtx_id = {'b'};
     req.m_params = cbdc::locking_shard::rpc::discard_params();
     ASSERT_TRUE(m_ser << req);
+    // Discard requests in the Raft log hold only the dtx ID and the
+    // variant index
+    ASSERT_EQ(m_target_packet.size(), sizeof(cbdc::hash_t) + 1);
+
+    auto deser_req = cbdc::locking_shard::rpc::request();
+    ASSERT_TRUE(m_deser >> deser_req);
+    ASSERT_EQ(req, deser_req);
+}
+
+TEST_F(locking_shard_format_test, discard_batch_request) {
+    auto req = cbdc::locking_shard::rpc::request();
+    req.m_dtx_id = {'b'};
+    req.m_params = cbdc::locking_shard::rpc::discard_batch_params(
+        {{'c'}, {'d'}});
+    ASSERT_TRUE(m_ser << req);
 
     auto deser_req = cbdc::locking_shard::rpc::request();
     ASSERT_TRUE(m_deser >> deser_req);
@@ -0,0 +1,306 @@
+// Copyright (c) 2021 MIT Digital Currency Initiative,
+//                    Federal Reserve Bank of Boston
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "uhs/twophase/locking_shard/format.hpp"
+#include "uhs/twophase/locking_shard/locking_shard.hpp"
+#include "util/common/keys.hpp"
+#include "util/serialization/util.hpp"
+
+#include <atomic>
+#include <gtest/gtest.h>
+#include <random>
+#include <secp256k1.h>
+#include <thread>
+
+class locking_shard_test : public ::testing::Test {
+  protected:
+    void SetUp() override {
+        m_opts.m_attestation_threshold = 0;
+        m_shard = std::make_unique<cbdc::locking_shard::locking_shard>(
+            std::make_pair(0, 255),
+            m_logger,
+            m_cache_size,
+            "",
+            m_opts);
+    }
+
+    /// Returns a unique random UHS ID.
+    auto make_id() -> cbdc::hash_t {
+        auto ret = cbdc::hash_t();
+        for(size_t i{0}; i < cbdc::hash_size / sizeof(uint64_t); i++) {
+            const auto val = m_engine();
+            std::memcpy(&ret[i * sizeof(val)], &val, sizeof(val));
+        }
+        return ret;
+    }
+
+    /// Makes a transaction spending the given input into the given output.
+    static auto make_tx(const cbdc::hash_t& id,
+                        std::optional<cbdc::hash_t> input,
+                        const cbdc::hash_t& output)
+        -> cbdc::locking_shard::tx {
+        auto ret = cbdc::locking_shard::tx();
+        ret.m_tx.m_id = id;
+        if(input.has_value()) {
+            ret.m_tx.m_inputs.push_back(input.value());
+        }
+        ret.m_tx.m_uhs_outputs.push_back(output);
+        return ret;
+    }
+
+    static constexpr size_t m_cache_size{100000};
+    static constexpr size_t m_threads{8};
+    static constexpr size_t m_batches{50};
+    static constexpr size_t m_batch_size{100};
+
+    std::mt19937_64 m_engine;
+    cbdc::config::options m_opts{};
+    std::shared_ptr<cbdc::logging::log> m_logger{
+        std::make_shared<cbdc::logging::log>(
+            cbdc::logging::log_level::warn)};
+    std::unique_ptr<cbdc::locking_shard::locking_shard> m_shard;
+};
+
+TEST_F(locking_shard_test, concurrent_dtxs) {
+    // Each thread mints outputs in one dtx, then spends them in another.
+    // The dtxs of different threads run concurrently and never conflict.
+    auto minted = std::vector<std::vector<cbdc::hash_t>>(m_threads);
+    auto spent = std::vector<std::vector<cbdc::hash_t>>(m_threads);
+    auto dtx_ids = std::vector<std::vector<cbdc::hash_t>>(m_threads);
+    for(size_t t{0}; t < m_threads; t++) {
+        for(size_t i{0}; i < m_batches * m_batch_size; i++) {
+            minted[t].push_back(make_id());
+            spent[t].push_back(make_id());
+        }
+        for(size_t b{0}; b < 2 * m_batches; b++) {
+            dtx_ids[t].push_back(make_id());
+        }
+    }
+
+    auto failures = std::atomic<size_t>{0};
+    auto run_dtx = [&](std::vector<cbdc::locking_shard::tx>&& txs,
+                       const cbdc::hash_t& dtx_id) {
+        auto res = m_shard->lock_outputs(std::move(txs), dtx_id);
+        if(!res.has_value()) {
+            failures++;
+            return;
+        }
+        for(auto r : *res) {
+            if(!r) {
+                failures++;
+            }
+        }
+        if(!m_shard->apply_outputs(std::move(*res), dtx_id)
+           || !m_shard->discard_dtx(dtx_id)) {
+            failures++;
+        }
+    };
+
+    auto threads = std::vector<std::thread>();
+    for(size_t t{0}; t < m_threads; t++) {
+        threads.emplace_back([&, t]() {
+            for(size_t b{0}; b < m_batches; b++) {
+                auto mint = std::vector<cbdc::locking_shard::tx>();
+                auto spend = std::vector<cbdc::locking_shard::tx>();
+                for(size_t i{0}; i < m_batch_size; i++) {
+                    const auto idx = b * m_batch_size + i;
+                    mint.push_back(
+                        make_tx(minted[t][idx], std::nullopt, minted[t][idx]));
+                    spend.push_back(
+                        make_tx(spent[t][idx], minted[t][idx], spent[t][idx]));
+                }
+                run_dtx(std::move(mint), dtx_ids[t][2 * b]);
+                run_dtx(std::move(spend), dtx_ids[t][2 * b + 1]);
+            }
+        });
+    }
+    for(auto& t : threads) {
+        t.join();
+    }
+    ASSERT_EQ(failures, 0U);
+
+    for(size_t t{0}; t < m_threads; t++) {
+        for(size_t i{0}; i < m_batches * m_batch_size; i++) {
+            ASSERT_FALSE(m_shard->check_unspent(minted[t][i]).value());
+            ASSERT_TRUE(m_shard->check_unspent(spent[t][i]).value());
+        }
+    }
+}
+
+TEST_F(locking_shard_test, concurrent_double_spend) {
+    // Every thread tries to spend the same outputs in its own dtx. Exactly
+    // one spend of each output may succeed.
+    auto outputs = std::vector<cbdc::hash_t>();
+    auto mint = std::vector<cbdc::locking_shard::tx>();
+    for(size_t i{0}; i < m_batch_size; i++) {
+        outputs.push_back(make_id());
+        mint.push_back(make_tx(outputs.back(), std::nullopt, outputs.back()));
+    }
+    const auto mint_id = make_id();
+    auto mint_res = m_shard->lock_outputs(std::move(mint), mint_id);
+    ASSERT_TRUE(mint_res.has_value());
+    ASSERT_TRUE(m_shard->apply_outputs(std::move(*mint_res), mint_id));
+
+    auto spends = std::vector<std::vector<cbdc::locking_shard::tx>>();
+    auto dtx_ids = std::vector<cbdc::hash_t>();
+    for(size_t t{0}; t < m_threads; t++) {
+        auto txs = std::vector<cbdc::locking_shard::tx>();
+        for(const auto& out : outputs) {
+            auto new_out = make_id();
+            txs.push_back(make_tx(new_out, out, new_out));
+        }
+        spends.push_back(std::move(txs));
+        dtx_ids.push_back(make_id());
+    }
+
+    auto successes = std::vector<std::atomic<size_t>>(m_batch_size);
+    auto threads = std::vector<std::thread>();
+    for(size_t t{0}; t < m_threads; t++) {
+        threads.emplace_back([&, t]() {
+            auto res
+                = m_shard->lock_outputs(std::move(spends[t]), dtx_ids[t]);
+            ASSERT_TRUE(res.has_value());
+            for(size_t i{0}; i < res->size(); i++) {
+                if((*res)[i]) {
+                    successes[i]++;
+                }
+            }
+            ASSERT_TRUE(m_shard->apply_outputs(std::move(*res), dtx_ids[t]));
+        });
+    }
+    for(auto& t : threads) {
+        t.join();
+    }
+
+    for(size_t i{0}; i < m_batch_size; i++) {
+        ASSERT_EQ(successes[i], 1U);
+        ASSERT_FALSE(m_shard->check_unspent(outputs[i]).value());
+    }
+}
+
+TEST_F(locking_shard_test, repeated_lock_is_idempotent) {
+    const auto out = make_id();
+    const auto dtx_id = make_id();
+    auto mint = std::vector<cbdc::locking_shard::tx>{
+        make_tx(out, std::nullopt, out)};
+    auto res = m_shard->lock_outputs(std::vector(mint), dtx_id);
+    ASSERT_TRUE(res.has_value());
+    auto res2 = m_shard->lock_outputs(std::vector(mint), dtx_id);
+    ASSERT_EQ(res, res2);
+    ASSERT_TRUE(m_shard->apply_outputs(std::move(*res), dtx_id));
+    ASSERT_TRUE(m_shard->apply_outputs({true}, dtx_id));
+    ASSERT_TRUE(m_shard->check_unspent(out).value());
+}
+
+TEST_F(locking_shard_test, batch_attestations) {
+    auto secp = std::unique_ptr<secp256k1_context,
+                                decltype(&secp256k1_context_destroy)>(
+        secp256k1_context_create(SECP256K1_CONTEXT_SIGN
+                                 | SECP256K1_CONTEXT_VERIFY),
+        &secp256k1_context_destroy);
+    auto priv = cbdc::hash_from_hex(
+        "0000000000000001000000000000000000000000000000000000000000000000");
+    m_opts.m_sentinel_public_keys.insert(
+        cbdc::pubkey_from_privkey(priv, secp.get()));
+    m_opts.m_attestation_threshold = 1;
+    m_shard = std::make_unique<cbdc::locking_shard::locking_shard>(
+        std::make_pair(0, 255),
+        m_logger,
+        m_cache_size,
+        "",
+        m_opts);
+
+    // Every third transaction is not attested
+    auto txs = std::vector<cbdc::locking_shard::tx>();
+    for(size_t i{0}; i < m_batch_size; i++) {
+        auto out = make_id();
+        auto t = make_tx(out, std::nullopt, out);
+        if(i % 3 != 0) {
+            t.m_tx.m_attestations.insert(t.m_tx.sign(secp.get(), priv));
+        }
+        txs.push_back(std::move(t));
+    }
+    const auto dtx_id = make_id();
+    auto res = m_shard->lock_outputs(std::vector(txs), dtx_id);
+    ASSERT_TRUE(res.has_value());
+    ASSERT_EQ(res->size(), m_batch_size);
+    for(size_t i{0}; i < m_batch_size; i++) {
+        ASSERT_EQ((*res)[i], i % 3 != 0);
+    }
+
+    ASSERT_TRUE(m_shard->apply_outputs(std::move(*res), dtx_id));
+    for(size_t i{0}; i < m_batch_size; i++) {
+        ASSERT_EQ(m_shard->check_unspent(txs[i].m_tx.m_uhs_outputs[0]),
+                  i % 3 != 0);
+    }
+}
+
+TEST_F(locking_shard_test, snapshot_unaffected_by_later_dtxs) {
+    // Mint an output, and lock it for spending in a second dtx.
+    const auto out = make_id();
+    const auto mint_id = make_id();
+    ASSERT_TRUE(m_shard->apply_outputs(
+        m_shard->lock_outputs({make_tx(out, std::nullopt, out)}, mint_id)
+            .value(),
+        mint_id));
+    const auto spend_out = make_id();
+    const auto spend_id = make_id();
+    auto spend = std::vector<cbdc::locking_shard::tx>{
+        make_tx(spend_out, out, spend_out)};
+    auto res = m_shard->lock_outputs(std::vector(spend), spend_id);
+    ASSERT_TRUE(res.has_value());
+    ASSERT_TRUE((*res)[0]);
+
+    auto snp = m_shard->get_snapshot();
+    auto buf = cbdc::make_buffer(snp);
+
+    // Completing the spend after the snapshot must not change it.
+    ASSERT_TRUE(m_shard->apply_outputs(std::move(*res), spend_id));
+    ASSERT_FALSE(m_shard->check_unspent(out).value());
+    ASSERT_EQ(cbdc::make_buffer(snp), buf);
+
+    // Restoring the snapshot returns the shard to the locked state, from
+    // which the spend can be applied again.
+    auto state
+        = cbdc::from_buffer<cbdc::locking_shard::locking_shard::state>(buf);
+    ASSERT_TRUE(state.has_value());
+    auto restored = cbdc::locking_shard::locking_shard(std::make_pair(0, 255),
+                                                       m_logger,
+                                                       m_cache_size,
+                                                       "",
+                                                       m_opts);
+    restored.set_state(std::move(state.value()));
+    ASSERT_TRUE(restored.check_unspent(out).value());
+    ASSERT_FALSE(restored.check_unspent(spend_out).value());
+    ASSERT_TRUE(restored.apply_outputs({true}, spend_id));
+    ASSERT_FALSE(restored.check_unspent(out).value());
+    ASSERT_TRUE(restored.check_unspent(spend_out).value());
+}
+
+TEST_F(locking_shard_test, snapshot_write_releases_partitions) {
+    const auto out = make_id();
+    const auto dtx_id = make_id();
+    auto res = m_shard->lock_outputs({make_tx(out, std::nullopt, out)},
+                                     dtx_id);
+    ASSERT_TRUE(res.has_value());
+
+    // Held like the state machine holds it for the background write
+    auto snp = std::make_shared<cbdc::locking_shard::locking_shard::snapshot>(
+        m_shard->get_snapshot());
+    auto buf = cbdc::make_buffer(*snp);
+
+    // Consuming the snapshot writes the same bytes and drops its references
+    // as it goes, so the shard no longer copies partitions it modifies.
+    auto consumed = cbdc::buffer();
+    auto ser = cbdc::buffer_serializer(consumed);
+    ASSERT_TRUE(ser << std::move(*snp));
+    ASSERT_EQ(consumed, buf);
+    for(size_t i{0}; i < snp->m_uhs.size(); i++) {
+        ASSERT_EQ(snp->m_uhs[i], nullptr);
+        ASSERT_EQ(snp->m_locked[i], nullptr);
+    }
+    ASSERT_EQ(snp->m_prepared_dtxs.size(), 1UL);
+    ASSERT_EQ(snp->m_prepared_dtxs[0].second, nullptr);
+}
@@ -0,0 +1,189 @@
+// Copyright (c) 2021 MIT Digital Currency Initiative,
+//                    Federal Reserve Bank of Boston
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "uhs/twophase/locking_shard/format.hpp"
+#include "uhs/twophase/locking_shard/state_machine.hpp"
+#include "util/raft/util.hpp"
+#include "util/rpc/format.hpp"
+#include "util/serialization/format.hpp"
+
+#include <filesystem>
+#include <future>
+#include <gtest/gtest.h>
+#include <random>
+
+class locking_shard_state_machine_test : public ::testing::Test {
+  protected:
+    void SetUp() override {
+        m_opts.m_attestation_threshold = 0;
+        m_sm = make_state_machine(m_snapshot_dir);
+    }
+
+    void TearDown() override {
+        m_sm.reset();
+        std::filesystem::remove_all(m_snapshot_dir);
+        std::filesystem::remove_all(m_follower_snapshot_dir);
+    }
+
+    auto make_state_machine(const std::string& snapshot_dir)
+        -> std::shared_ptr<cbdc::locking_shard::state_machine> {
+        return std::make_shared<cbdc::locking_shard::state_machine>(
+            std::make_pair(0, 255),
+            m_logger,
+            m_cache_size,
+            "",
+            m_opts,
+            snapshot_dir);
+    }
+
+    /// Returns a unique random hash.
+    auto make_id() -> cbdc::hash_t {
+        auto ret = cbdc::hash_t();
+        for(size_t i{0}; i < cbdc::hash_size / sizeof(uint64_t); i++) {
+            const auto val = m_engine();
+            std::memcpy(&ret[i * sizeof(val)], &val, sizeof(val));
+        }
+        return ret;
+    }
+
+    /// Commits the given request as the next raft log entry.
+    void commit(cbdc::locking_shard::rpc::request req) {
+        using rpc_request
+            = cbdc::rpc::request<cbdc::locking_shard::rpc::request>;
+        auto buf = cbdc::make_buffer<rpc_request, nuraft::ptr<nuraft::buffer>>(
+            rpc_request{{m_request_id++}, std::move(req)});
+        ASSERT_NE(m_sm->commit(m_sm->last_commit_index() + 1, *buf),
+                  nullptr);
+    }
+
+    /// Creates a snapshot at the last committed index and waits for the
+    /// snapshot to be written.
+    auto create_snapshot() -> nuraft::ptr<nuraft::snapshot> {
+        auto snp = nuraft::cs_new<nuraft::snapshot>(
+            m_sm->last_commit_index(),
+            1,
+            nuraft::cs_new<nuraft::cluster_config>());
+        auto done = std::promise<bool>();
+        nuraft::async_result<bool>::handler_type when_done
+            = [&](bool& res, nuraft::ptr<std::exception>& /* err */) {
+                  done.set_value(res);
+              };
+        m_sm->create_snapshot(*snp, when_done);
+        EXPECT_TRUE(done.get_future().get());
+        return snp;
+    }
+
+    static constexpr size_t m_cache_size{1000};
+    // Enough outputs for the snapshot to span several objects
+    static constexpr size_t m_output_count{300000};
+    static constexpr auto m_snapshot_dir = "locking_shard_snps_test_0";
+    static constexpr auto m_follower_snapshot_dir
+        = "locking_shard_snps_test_1";
+
+    std::mt19937_64 m_engine;
+    uint64_t m_request_id{0};
+    cbdc::config::options m_opts{};
+    std::shared_ptr<cbdc::logging::log> m_logger{
+        std::make_shared<cbdc::logging::log>(
+            cbdc::logging::log_level::warn)};
+    std::shared_ptr<cbdc::locking_shard::state_machine> m_sm;
+};
+
+TEST_F(locking_shard_state_machine_test, snapshot_round_trip) {
+    ASSERT_EQ(m_sm->last_snapshot(), nullptr);
+
+    // Mint outputs and apply them
+    auto outputs = std::vector<cbdc::hash_t>();
+    auto mint = cbdc::locking_shard::rpc::lock_params();
+    for(size_t i{0}; i < m_output_count; i++) {
+        auto t = cbdc::locking_shard::tx();
+        t.m_tx.m_id = make_id();
+        t.m_tx.m_uhs_outputs.push_back(t.m_tx.m_id);
+        outputs.push_back(t.m_tx.m_id);
+        mint.push_back(std::move(t));
+    }
+    const auto mint_id = make_id();
+    commit({mint_id, mint});
+    commit({mint_id, cbdc::locking_shard::rpc::apply_params(
+                         m_output_count,
+                         true)});
+
+    // Leave a second dtx locked but not applied
+    auto spend = cbdc::locking_shard::tx();
+    spend.m_tx.m_id = make_id();
+    spend.m_tx.m_inputs.push_back(outputs[0]);
+    spend.m_tx.m_uhs_outputs.push_back(make_id());
+    const auto spend_id = make_id();
+    commit({spend_id, cbdc::locking_shard::rpc::lock_params{spend}});
+
+    auto snp = create_snapshot();
+    ASSERT_NE(m_sm->last_snapshot(), nullptr);
+    ASSERT_EQ(m_sm->last_snapshot()->get_last_log_idx(),
+              snp->get_last_log_idx());
+
+    // Stream the snapshot to a follower object by object
+    auto follower = make_state_machine(m_follower_snapshot_dir);
+    void* ctx{nullptr};
+    auto is_last = false;
+    nuraft::ulong obj_id{0};
+    size_t objs{0};
+    while(!is_last) {
+        nuraft::ptr<nuraft::buffer> data;
+        ASSERT_EQ(m_sm->read_logical_snp_obj(*snp, ctx, obj_id, data, is_last),
+                  0);
+        auto next_id = obj_id;
+        follower->save_logical_snp_obj(*snp,
+                                       next_id,
+                                       *data,
+                                       obj_id == 0,
+                                       is_last);
+        ASSERT_EQ(next_id, obj_id + 1);
+        obj_id = next_id;
+        objs++;
+    }
+    m_sm->free_user_snp_ctx(ctx);
+    ASSERT_EQ(ctx, nullptr);
+    ASSERT_GT(objs, 1U);
+
+    ASSERT_TRUE(follower->apply_snapshot(*snp));
+    ASSERT_EQ(follower->last_commit_index(), snp->get_last_log_idx());
+    auto check_state = [&](cbdc::locking_shard::state_machine& sm) {
+        auto shard = sm.get_shard_instance();
+        for(const auto& out : outputs) {
+            ASSERT_TRUE(shard->check_unspent(out).value());
+        }
+        ASSERT_TRUE(shard->check_tx_id(outputs.back()).value());
+        // The locked input can still be applied after restoring
+        ASSERT_TRUE(shard->apply_outputs({true}, spend_id));
+        ASSERT_FALSE(shard->check_unspent(outputs[0]).value());
+        ASSERT_TRUE(
+            shard->check_unspent(spend.m_tx.m_uhs_outputs[0]).value());
+    };
+    check_state(*follower);
+
+    // A restarted state machine restores the newest snapshot from disk
+    m_sm.reset();
+    m_sm = make_state_machine(m_snapshot_dir);
+    ASSERT_NE(m_sm->last_snapshot(), nullptr);
+    ASSERT_EQ(m_sm->last_commit_index(), snp->get_last_log_idx());
+    check_state(*m_sm);
+}
+
+TEST_F(locking_shard_state_machine_test, prune_old_snapshots) {
+    const auto dtx_id = make_id();
+    commit({dtx_id, cbdc::locking_shard::rpc::discard_params()});
+    auto first = create_snapshot();
+    commit({dtx_id, cbdc::locking_shard::rpc::discard_params()});
+    auto second = create_snapshot();
+    ASSERT_EQ(m_sm->last_snapshot()->get_last_log_idx(),
+              second->get_last_log_idx());
+
+    // The older snapshot can no longer be sent to followers
+    void* ctx{nullptr};
+    nuraft::ptr<nuraft::buffer> data;
+    auto is_last = false;
+    ASSERT_NE(m_sm->read_logical_snp_obj(*first, ctx, 0, data, is_last), 0);
+    ASSERT_EQ(ctx, nullptr);
+}
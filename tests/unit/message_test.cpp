@@ -13,6 +13,7 @@
 #include "uhs/twophase/coordinator/format.hpp"
 #include "util.hpp"
 #include "util/serialization/format.hpp"
+#include "util/serialization/util.hpp"
 
 #include <gtest/gtest.h>
 
@@ -109,6 +110,28 @@ TEST_F(PacketIOTest, ctx_notify_request) {
     ASSERT_EQ(tx_notify, result_tx_notify);
 }
 
+TEST_F(PacketIOTest, ctx_notify_request_compact) {
+    cbdc::atomizer::tx_notify_request tx_notify;
+    tx_notify.m_attestations = {0, 1, 300};
+    tx_notify.m_block_height = 1000;
+    tx_notify.m_tx.m_inputs.push_back({'a', 'x', 'o', 'p'});
+    tx_notify.m_tx.m_uhs_outputs.push_back({'t', 'a', 'f', 'm'});
+    tx_notify.m_tx.m_id = {'p', 'l', 'k', 'e'};
+
+    m_ser.set_wire_format(cbdc::wire_format::compact);
+    m_deser.set_wire_format(cbdc::wire_format::compact);
+    m_ser << tx_notify;
+    ASSERT_EQ(m_target_packet.size(),
+              cbdc::serialized_size(tx_notify, cbdc::wire_format::compact));
+
+    cbdc::atomizer::tx_notify_request result_tx_notify;
+    m_deser >> result_tx_notify;
+
+    ASSERT_TRUE(m_deser);
+    ASSERT_EQ(tx_notify, result_tx_notify);
+    ASSERT_EQ(tx_notify.m_attestations, result_tx_notify.m_attestations);
+}
+
 TEST_F(PacketIOTest, block) {
     cbdc::transaction::compact_tx tx0;
     tx0.m_inputs.push_back({'a', 'x', 'o', 'p'});
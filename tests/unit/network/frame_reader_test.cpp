@@ -0,0 +1,118 @@
+// Copyright (c) 2021 MIT Digital Currency Initiative,
+//                    Federal Reserve Bank of Boston
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "util/network/frame_reader.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <gtest/gtest.h>
+#include <limits>
+
+class frame_reader_test : public ::testing::Test {
+  protected:
+    /// Appends a size-prefixed packet with the given size to the stream.
+    auto add_packet(size_t size) -> cbdc::buffer {
+        auto pkt = cbdc::buffer();
+        for(size_t i{0}; i < size; i++) {
+            auto c = static_cast<unsigned char>(m_packets.size() + i);
+            pkt.append(&c, 1);
+        }
+        const auto sz = static_cast<uint64_t>(size);
+        m_stream.append(&sz, sizeof(sz));
+        m_stream.append(pkt.data(), pkt.size());
+        m_packets.push_back(pkt);
+        return pkt;
+    }
+
+    /// Reads from the stream, returning at most m_max_read bytes per call,
+    /// or std::nullopt once the stream is exhausted and m_close is set.
+    auto read_some(void* data, size_t len) -> std::optional<size_t> {
+        m_reads++;
+        m_largest_request = std::max(m_largest_request, len);
+        const auto avail = m_stream.size() - m_pos;
+        if(avail == 0) {
+            if(m_close) {
+                return std::nullopt;
+            }
+            return 0;
+        }
+        const auto n = std::min({len, avail, m_max_read});
+        std::memcpy(data, m_stream.data_at(m_pos), n);
+        m_pos += n;
+        return n;
+    }
+
+    /// Reads every available packet from the stream.
+    auto read_all(cbdc::network::frame_reader& reader)
+        -> std::vector<cbdc::buffer> {
+        auto ret = std::vector<cbdc::buffer>();
+        auto pkt = cbdc::buffer();
+        auto fn = [&](void* data, size_t len) {
+            return read_some(data, len);
+        };
+        while(reader.read(fn, pkt)
+              == cbdc::network::frame_reader::result::packet) {
+            ret.push_back(pkt);
+        }
+        return ret;
+    }
+
+    cbdc::buffer m_stream;
+    size_t m_pos{0};
+    size_t m_max_read{std::numeric_limits<size_t>::max()};
+    bool m_close{false};
+    size_t m_reads{0};
+    size_t m_largest_request{0};
+    std::vector<cbdc::buffer> m_packets;
+};
+
+TEST_F(frame_reader_test, small_packets_single_read) {
+    for(size_t i{0}; i < 100; i++) {
+        add_packet(i % 10);
+    }
+    auto reader = cbdc::network::frame_reader();
+    EXPECT_EQ(read_all(reader), m_packets);
+    // One read for all the packets, then one which would block.
+    EXPECT_EQ(m_reads, 2UL);
+}
+
+TEST_F(frame_reader_test, fragmented_stream) {
+    add_packet(5);
+    add_packet(0);
+    add_packet(40);
+    add_packet(0);
+    m_max_read = 1;
+    auto reader = cbdc::network::frame_reader(16);
+    EXPECT_EQ(read_all(reader), m_packets);
+}
+
+TEST_F(frame_reader_test, large_packet_bypasses_chunk) {
+    static constexpr size_t chunk_size = 16;
+    add_packet(3);
+    const auto big = add_packet(1000);
+    add_packet(2);
+    auto reader = cbdc::network::frame_reader(chunk_size);
+    EXPECT_EQ(read_all(reader), m_packets);
+    // The remainder of the large packet was requested in a single read
+    // rather than chunk by chunk.
+    EXPECT_GT(m_largest_request, chunk_size);
+    EXPECT_LT(m_reads, big.size() / chunk_size);
+}
+
+TEST_F(frame_reader_test, closed_mid_packet) {
+    add_packet(10);
+    m_stream.extend(4);
+    m_close = true;
+    auto reader = cbdc::network::frame_reader();
+    auto pkt = cbdc::buffer();
+    auto fn = [&](void* data, size_t len) {
+        return read_some(data, len);
+    };
+    ASSERT_EQ(reader.read(fn, pkt),
+              cbdc::network::frame_reader::result::packet);
+    EXPECT_EQ(pkt, m_packets[0]);
+    EXPECT_EQ(reader.read(fn, pkt),
+              cbdc::network::frame_reader::result::closed);
+}
@@ -7,7 +7,10 @@
 #include "util/network/connection_manager.hpp"
 #include "util/serialization/buffer_serializer.hpp"
 
+#include <filesystem>
 #include <gtest/gtest.h>
+#include <map>
+#include <set>
 
 class NetworkTest : public ::testing::Test {
   protected:
@@ -84,6 +87,86 @@ TEST_F(NetworkTest, client_server) {
     server->join();
 }
 
+TEST_F(NetworkTest, client_server_unix_domain) {
+    auto server_ep = cbdc::network::endpoint_t{
+        std::string(cbdc::network::unix_scheme) + "network_test.sock",
+        0};
+    auto server = m_blocking_net->start_server(
+        server_ep,
+        [](cbdc::network::message_t&& pkt) -> std::optional<cbdc::buffer> {
+            uint32_t req{};
+            auto deser = cbdc::buffer_serializer(*pkt.m_pkt);
+            deser >> req;
+            cbdc::buffer res{};
+            auto ser = cbdc::buffer_serializer(res);
+            ser << (req * 2);
+            return res;
+        });
+
+    ASSERT_TRUE(server.has_value());
+
+    auto sc = cbdc::test::simple_client<uint32_t>();
+    ASSERT_TRUE(sc.connect({server_ep}));
+    ASSERT_EQ(sc.get(22), 44);
+
+    m_blocking_net->close();
+    server->join();
+    EXPECT_FALSE(std::filesystem::exists("network_test.sock"));
+}
+
+TEST_F(NetworkTest, multi_worker_handler) {
+    cbdc::network::endpoint_t server_ep{cbdc::network::localhost, 30002};
+    static constexpr size_t n_workers = 4;
+    static constexpr size_t n_clients = 3;
+    static constexpr uint32_t n_pkts = 200;
+
+    std::mutex mut;
+    std::map<cbdc::network::peer_id_t, uint32_t> next_seq;
+    std::set<std::thread::id> threads;
+    bool in_order{true};
+    auto server = m_blocking_net->start_server(
+        server_ep,
+        [&](cbdc::network::message_t&& pkt) -> std::optional<cbdc::buffer> {
+            auto seq = cbdc::from_buffer<uint32_t>(*pkt.m_pkt);
+            {
+                std::unique_lock<std::mutex> l(mut);
+                in_order = in_order && seq == next_seq[pkt.m_peer_id];
+                next_seq[pkt.m_peer_id]++;
+                threads.insert(std::this_thread::get_id());
+            }
+            return cbdc::make_buffer(seq.value() * 2);
+        },
+        n_workers);
+    ASSERT_TRUE(server.has_value());
+
+    auto clients = std::vector<std::unique_ptr<cbdc::network::tcp_socket>>();
+    for(size_t i = 0; i < n_clients; i++) {
+        auto& sock = clients.emplace_back(
+            std::make_unique<cbdc::network::tcp_socket>());
+        ASSERT_TRUE(sock->connect(server_ep));
+    }
+    for(uint32_t seq = 0; seq < n_pkts; seq++) {
+        for(auto& sock : clients) {
+            ASSERT_TRUE(sock->send(seq));
+        }
+    }
+    for(auto& sock : clients) {
+        for(uint32_t seq = 0; seq < n_pkts; seq++) {
+            auto pkt = cbdc::buffer();
+            ASSERT_TRUE(sock->receive(pkt));
+            EXPECT_EQ(cbdc::from_buffer<uint32_t>(pkt), seq * 2);
+        }
+    }
+
+    m_blocking_net->close();
+    server->join();
+
+    EXPECT_TRUE(in_order);
+    EXPECT_EQ(next_seq.size(), n_clients);
+    // Each client hashed to a different worker.
+    EXPECT_EQ(threads.size(), n_clients);
+}
+
 TEST_F(NetworkTest, reset_net) {
     static constexpr auto listen_port = 30001;
     ASSERT_TRUE(m_blocking_net->listen(cbdc::network::localhost, listen_port));
@@ -106,3 +189,228 @@ TEST_F(NetworkTest, reset_net) {
     m_blocking_net->close();
     listener.join();
 }
+
+TEST_F(NetworkTest, large_packet) {
+    static constexpr auto listen_port = 30001;
+    ASSERT_TRUE(m_blocking_net->listen(cbdc::network::localhost, listen_port));
+    auto listener = m_blocking_net->start_server_listener();
+
+    auto sock = std::make_unique<cbdc::network::tcp_socket>();
+    ASSERT_TRUE(sock->connect(cbdc::network::localhost, listen_port));
+    auto client_net = cbdc::network::connection_manager();
+    auto peer_id = client_net.add(std::move(sock));
+
+    // Larger than the socket buffers, so the send completes across several
+    // writable events.
+    static constexpr auto pkt_size = 16 * 1024 * 1024;
+    auto pkt = std::make_shared<cbdc::buffer>();
+    pkt->extend(pkt_size);
+    for(size_t i = 0; i < pkt->size(); i++) {
+        static_cast<unsigned char*>(pkt->data())[i]
+            = static_cast<unsigned char>(i);
+    }
+    client_net.send(pkt, peer_id);
+    client_net.send(std::make_shared<cbdc::buffer>(), peer_id);
+
+    auto pkts = std::vector<cbdc::network::message_t>();
+    while(pkts.size() < 2) {
+        for(auto&& p : m_blocking_net->handle_messages()) {
+            pkts.push_back(std::move(p));
+        }
+    }
+    ASSERT_EQ(pkts.size(), 2UL);
+    ASSERT_TRUE(pkts[0].m_pkt);
+    EXPECT_EQ(*pkts[0].m_pkt, *pkt);
+    ASSERT_TRUE(pkts[1].m_pkt);
+    EXPECT_EQ(pkts[1].m_pkt->size(), 0UL);
+
+    m_blocking_net->close();
+    client_net.close();
+    listener.join();
+}
+
+TEST_F(NetworkTest, burst_preserves_order) {
+    static constexpr auto listen_port = 30001;
+    ASSERT_TRUE(m_blocking_net->listen(cbdc::network::localhost, listen_port));
+    auto listener = m_blocking_net->start_server_listener();
+
+    auto sock = std::make_unique<cbdc::network::tcp_socket>();
+    ASSERT_TRUE(sock->connect(cbdc::network::localhost, listen_port));
+    auto client_net = cbdc::network::connection_manager();
+    auto peer_id = client_net.add(std::move(sock));
+
+    // Fill the socket buffers first so the small packets queue up behind
+    // the large one and are written in batches.
+    static constexpr auto big_size = 8 * 1024 * 1024;
+    auto big = std::make_shared<cbdc::buffer>();
+    big->extend(big_size);
+    client_net.send(big, peer_id);
+
+    static constexpr uint32_t n_pkts = 1000;
+    for(uint32_t i = 0; i < n_pkts; i++) {
+        client_net.send(cbdc::make_shared_buffer(i), peer_id);
+    }
+
+    auto pkts = std::vector<cbdc::network::message_t>();
+    while(pkts.size() < n_pkts + 1) {
+        for(auto&& p : m_blocking_net->handle_messages()) {
+            pkts.push_back(std::move(p));
+        }
+    }
+    ASSERT_EQ(pkts.size(), n_pkts + 1);
+    EXPECT_EQ(pkts[0].m_pkt->size(), big->size());
+    for(uint32_t i = 0; i < n_pkts; i++) {
+        auto val = cbdc::from_buffer<uint32_t>(*pkts[i + 1].m_pkt);
+        ASSERT_TRUE(val.has_value());
+        EXPECT_EQ(val.value(), i);
+    }
+
+    m_blocking_net->close();
+    client_net.close();
+    listener.join();
+}
+
+TEST_F(NetworkTest, thread_count_independent_of_peers) {
+    auto thread_count = []() {
+        size_t count{0};
+        for([[maybe_unused]] const auto& t :
+            std::filesystem::directory_iterator("/proc/self/task")) {
+            count++;
+        }
+        return count;
+    };
+
+    static constexpr auto listen_port = 30001;
+    ASSERT_TRUE(m_blocking_net->listen(cbdc::network::localhost, listen_port));
+    auto listener = m_blocking_net->start_server_listener();
+    auto client_net = cbdc::network::connection_manager();
+    const auto initial_threads = thread_count();
+
+    static constexpr size_t n_peers = 64;
+    auto peer_ids = std::vector<cbdc::network::peer_id_t>();
+    for(size_t i = 0; i < n_peers; i++) {
+        auto sock = std::make_unique<cbdc::network::tcp_socket>();
+        ASSERT_TRUE(sock->connect(cbdc::network::localhost, listen_port));
+        peer_ids.push_back(client_net.add(std::move(sock)));
+    }
+    for(auto peer_id : peer_ids) {
+        client_net.send(std::make_shared<cbdc::buffer>(), peer_id);
+    }
+
+    size_t received{0};
+    while(received < n_peers) {
+        received += m_blocking_net->handle_messages().size();
+    }
+    EXPECT_EQ(received, n_peers);
+    EXPECT_EQ(m_blocking_net->peer_count(), n_peers);
+    EXPECT_EQ(thread_count(), initial_threads);
+
+    m_blocking_net->close();
+    client_net.close();
+    listener.join();
+}
+
+class SendQueueTest : public ::testing::Test {
+  protected:
+    static constexpr auto listen_port = 30002;
+
+    void SetUp() override {
+        ASSERT_TRUE(m_listener.listen(cbdc::network::localhost, listen_port));
+        auto sock = std::make_unique<cbdc::network::tcp_socket>();
+        std::thread accept_thr([&]() {
+            ASSERT_TRUE(m_listener.accept(m_server));
+        });
+        ASSERT_TRUE(sock->connect(cbdc::network::localhost, listen_port));
+        accept_thr.join();
+        m_peer_id = m_net.add(std::move(sock), false);
+
+        // Larger than the socket buffers, so the packet stays at the front
+        // of the queue until the server reads it.
+        static constexpr auto big_size = 16 * 1024 * 1024;
+        m_big = std::make_shared<cbdc::buffer>();
+        m_big->extend(big_size);
+    }
+
+    void TearDown() override {
+        m_net.close();
+        m_server.disconnect();
+        m_listener.close();
+    }
+
+    auto stats() -> cbdc::network::send_queue_stats {
+        auto s = m_net.get_send_queue_stats(m_peer_id);
+        EXPECT_TRUE(s.has_value());
+        return s.value_or(cbdc::network::send_queue_stats{});
+    }
+
+    cbdc::network::tcp_listener m_listener;
+    cbdc::network::tcp_socket m_server;
+    cbdc::network::connection_manager m_net;
+    cbdc::network::peer_id_t m_peer_id{};
+    std::shared_ptr<cbdc::buffer> m_big;
+};
+
+TEST_F(SendQueueTest, drop_oldest) {
+    m_net.set_send_queue_limits(
+        {0, 4, cbdc::network::overflow_policy::drop_oldest});
+    ASSERT_TRUE(m_net.send(m_big, m_peer_id));
+
+    static constexpr uint32_t n_pkts = 100;
+    for(uint32_t i = 0; i < n_pkts; i++) {
+        ASSERT_TRUE(m_net.send(cbdc::make_shared_buffer(i), m_peer_id));
+    }
+    auto s = stats();
+    EXPECT_EQ(s.m_messages, 4UL);
+    EXPECT_EQ(s.m_dropped, n_pkts - 3);
+
+    // The partially written packet is kept, followed by the newest packets.
+    auto pkt = cbdc::buffer();
+    ASSERT_TRUE(m_server.receive(pkt));
+    EXPECT_EQ(pkt.size(), m_big->size());
+    for(uint32_t i = n_pkts - 3; i < n_pkts; i++) {
+        ASSERT_TRUE(m_server.receive(pkt));
+        auto val = cbdc::from_buffer<uint32_t>(pkt);
+        ASSERT_TRUE(val.has_value());
+        EXPECT_EQ(val.value(), i);
+    }
+}
+
+TEST_F(SendQueueTest, disconnect) {
+    m_net.set_send_queue_limits(
+        {0, 1, cbdc::network::overflow_policy::disconnect});
+    ASSERT_TRUE(m_net.send(m_big, m_peer_id));
+    EXPECT_FALSE(m_net.send(std::make_shared<cbdc::buffer>(), m_peer_id));
+
+    auto s = stats();
+    EXPECT_EQ(s.m_disconnects, 1UL);
+    EXPECT_EQ(s.m_dropped, 1UL);
+    EXPECT_FALSE(m_net.connected(m_peer_id));
+    EXPECT_FALSE(m_net.send(std::make_shared<cbdc::buffer>(), m_peer_id));
+}
+
+TEST_F(SendQueueTest, block) {
+    m_net.set_send_queue_limits(
+        {m_big->size(), 0, cbdc::network::overflow_policy::block});
+    ASSERT_TRUE(m_net.send(m_big, m_peer_id));
+
+    auto sent = std::atomic_bool{false};
+    auto send_thr = std::thread([&]() {
+        EXPECT_TRUE(m_net.send(cbdc::make_shared_buffer(uint32_t{7}),
+                               m_peer_id));
+        sent = true;
+    });
+    while(stats().m_blocked == 0) {
+        std::this_thread::yield();
+    }
+    EXPECT_FALSE(sent);
+
+    // Reading the large packet makes room for the blocked sender.
+    auto pkt = cbdc::buffer();
+    ASSERT_TRUE(m_server.receive(pkt));
+    EXPECT_EQ(pkt.size(), m_big->size());
+    ASSERT_TRUE(m_server.receive(pkt));
+    EXPECT_EQ(cbdc::from_buffer<uint32_t>(pkt), uint32_t{7});
+    send_thr.join();
+    EXPECT_TRUE(sent);
+    EXPECT_EQ(stats().m_messages, 0UL);
+}
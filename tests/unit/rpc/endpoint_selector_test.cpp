@@ -0,0 +1,156 @@
+// Copyright (c) 2021 MIT Digital Currency Initiative,
+//                    Federal Reserve Bank of Boston
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "util/rpc/endpoint_selector.hpp"
+
+#include <gtest/gtest.h>
+#include <set>
+
+using namespace std::chrono_literals;
+
+class endpoint_selector_test : public ::testing::Test {
+  protected:
+    static constexpr size_t n_endpoints = 4;
+    static constexpr size_t n_trials = 200;
+
+    std::vector<cbdc::rpc::endpoint_stats> m_stats{n_endpoints};
+    std::vector<size_t> m_all{0, 1, 2, 3};
+};
+
+TEST_F(endpoint_selector_test, no_candidates) {
+    for(auto policy : {cbdc::rpc::selection_policy::random,
+                       cbdc::rpc::selection_policy::least_outstanding,
+                       cbdc::rpc::selection_policy::ewma_latency,
+                       cbdc::rpc::selection_policy::sticky_leader}) {
+        auto sel = cbdc::rpc::make_endpoint_selector(policy);
+        EXPECT_FALSE(sel->select(m_stats, {}).has_value());
+        auto res = sel->select(m_stats, {2});
+        ASSERT_TRUE(res.has_value());
+        EXPECT_EQ(res.value(), 2U);
+    }
+}
+
+TEST_F(endpoint_selector_test, random_spreads) {
+    auto sel = cbdc::rpc::make_endpoint_selector(
+        cbdc::rpc::selection_policy::random);
+    auto seen = std::set<size_t>();
+    for(size_t i = 0; i < n_trials; i++) {
+        auto res = sel->select(m_stats, {1, 3});
+        ASSERT_TRUE(res.has_value());
+        seen.insert(res.value());
+    }
+    EXPECT_EQ(seen, (std::set<size_t>{1, 3}));
+}
+
+TEST_F(endpoint_selector_test, least_outstanding) {
+    auto sel = cbdc::rpc::make_endpoint_selector(
+        cbdc::rpc::selection_policy::least_outstanding);
+    m_stats[0].m_in_flight = 3;
+    m_stats[1].m_in_flight = 1;
+    m_stats[2].m_in_flight = 5;
+    m_stats[3].m_in_flight = 1;
+    auto seen = std::set<size_t>();
+    for(size_t i = 0; i < n_trials; i++) {
+        auto res = sel->select(m_stats, m_all);
+        ASSERT_TRUE(res.has_value());
+        seen.insert(res.value());
+    }
+    // Ties are broken at random.
+    EXPECT_EQ(seen, (std::set<size_t>{1, 3}));
+
+    auto res = sel->select(m_stats, {0, 2});
+    ASSERT_TRUE(res.has_value());
+    EXPECT_EQ(res.value(), 0U);
+}
+
+TEST_F(endpoint_selector_test, ewma_latency) {
+    auto sel = cbdc::rpc::make_endpoint_selector(
+        cbdc::rpc::selection_policy::ewma_latency);
+    for(auto& s : m_stats) {
+        s.m_responses = 10;
+        s.m_latency = 10ms;
+    }
+    m_stats[2].m_latency = 1ms;
+
+    // With two candidates both are always sampled.
+    for(size_t i = 0; i < n_trials; i++) {
+        auto res = sel->select(m_stats, {1, 2});
+        ASSERT_TRUE(res.has_value());
+        EXPECT_EQ(res.value(), 2U);
+    }
+
+    // The slowest endpoint loses every comparison.
+    m_stats[0].m_latency = 100ms;
+    size_t fastest{0};
+    for(size_t i = 0; i < n_trials; i++) {
+        auto res = sel->select(m_stats, m_all);
+        ASSERT_TRUE(res.has_value());
+        EXPECT_NE(res.value(), 0U);
+        if(res.value() == 2) {
+            fastest++;
+        }
+    }
+    // The fastest endpoint is sampled in half of the trials.
+    EXPECT_GT(fastest, n_trials / 4);
+
+    // Outstanding requests raise the cost of the fastest endpoint.
+    m_stats[2].m_in_flight = 20;
+    auto res = sel->select(m_stats, {1, 2});
+    ASSERT_TRUE(res.has_value());
+    EXPECT_EQ(res.value(), 1U);
+
+    // Endpoints without responses are tried.
+    m_stats[3].m_responses = 0;
+    m_stats[3].m_latency = 0ms;
+    res = sel->select(m_stats, {2, 3});
+    ASSERT_TRUE(res.has_value());
+    EXPECT_EQ(res.value(), 3U);
+
+    // Until their outstanding requests make them the more expensive choice.
+    m_stats[3].m_in_flight = 30;
+    res = sel->select(m_stats, {1, 3});
+    ASSERT_TRUE(res.has_value());
+    EXPECT_EQ(res.value(), 1U);
+
+    // Endpoints which have both not responded compare by outstanding
+    // requests.
+    m_stats[1].m_responses = 0;
+    m_stats[1].m_in_flight = 2;
+    res = sel->select(m_stats, {1, 3});
+    ASSERT_TRUE(res.has_value());
+    EXPECT_EQ(res.value(), 1U);
+}
+
+TEST_F(endpoint_selector_test, sticky_leader) {
+    auto sel = cbdc::rpc::make_endpoint_selector(
+        cbdc::rpc::selection_policy::sticky_leader);
+    auto res = sel->select(m_stats, m_all);
+    ASSERT_TRUE(res.has_value());
+    EXPECT_EQ(res.value(), 0U);
+
+    m_stats[0].m_in_flight = 10;
+    res = sel->select(m_stats, m_all);
+    ASSERT_TRUE(res.has_value());
+    EXPECT_EQ(res.value(), 0U);
+
+    // A timeout moves to the next endpoint.
+    m_stats[0].m_timeouts++;
+    res = sel->select(m_stats, m_all);
+    ASSERT_TRUE(res.has_value());
+    EXPECT_EQ(res.value(), 1U);
+
+    // So does disconnecting, skipping endpoints which are not candidates.
+    res = sel->select(m_stats, {0, 3});
+    ASSERT_TRUE(res.has_value());
+    EXPECT_EQ(res.value(), 3U);
+
+    // Wraps around after the last endpoint.
+    res = sel->select(m_stats, {0, 1, 2});
+    ASSERT_TRUE(res.has_value());
+    EXPECT_EQ(res.value(), 0U);
+    res = sel->select(m_stats, m_all);
+    ASSERT_TRUE(res.has_value());
+    EXPECT_EQ(res.value(), 0U);
+}
@@ -263,3 +263,113 @@ TEST(tcp_rpc_test, async_error_test) {
     status = done_fut.wait_for(std::chrono::milliseconds(100));
     ASSERT_EQ(status, std::future_status::ready);
 }
+
+TEST(tcp_rpc_test, async_timeout_test) {
+    using request = int64_t;
+    using response = int64_t;
+
+    // Accept the connection but never respond.
+    auto ep = cbdc::network::endpoint_t{cbdc::network::localhost, 55555};
+    auto server = cbdc::network::tcp_listener();
+    ASSERT_TRUE(server.listen(ep.first, ep.second));
+
+    auto client = cbdc::rpc::tcp_client<request, response>({ep});
+    ASSERT_TRUE(client.init());
+    auto sock = cbdc::network::tcp_socket();
+    ASSERT_TRUE(server.accept(sock));
+
+    auto done = std::promise<std::optional<response>>();
+    auto done_fut = done.get_future();
+    auto success = client.call(
+        request{1},
+        [&](std::optional<response> resp) {
+            done.set_value(resp);
+        },
+        std::chrono::milliseconds(50));
+    ASSERT_TRUE(success);
+    EXPECT_EQ(client.in_flight(), 1UL);
+    auto status = done_fut.wait_for(std::chrono::seconds(2));
+    ASSERT_EQ(status, std::future_status::ready);
+    EXPECT_FALSE(done_fut.get().has_value());
+    EXPECT_EQ(client.in_flight(), 0UL);
+
+    auto stats = client.get_endpoint_stats();
+    ASSERT_EQ(stats.size(), 1UL);
+    EXPECT_EQ(stats[0].m_requests, 1UL);
+    EXPECT_EQ(stats[0].m_timeouts, 1UL);
+    EXPECT_EQ(stats[0].m_responses, 0UL);
+}
+
+TEST(tcp_rpc_test, in_flight_window_test) {
+    using request = int64_t;
+    using response = int64_t;
+
+    auto ep = cbdc::network::endpoint_t{cbdc::network::localhost, 55555};
+    auto server = cbdc::rpc::async_tcp_server<request, response>(ep);
+    auto mut = std::mutex();
+    auto pending = std::vector<std::function<void(std::optional<response>)>>();
+    server.register_handler_callback(
+        [&](request req,
+            std::function<void(std::optional<response>)> cb) -> bool {
+            std::unique_lock<std::mutex> l(mut);
+            pending.push_back([cb = std::move(cb), req](
+                                  std::optional<response> /* resp */) {
+                cb(req);
+            });
+            return true;
+        });
+    ASSERT_TRUE(server.init());
+
+    static constexpr size_t window = 2;
+    auto client = cbdc::rpc::tcp_client<request, response>({ep}, window);
+    ASSERT_TRUE(client.init());
+
+    auto responses = std::atomic<size_t>{0};
+    auto cb = [&](std::optional<response> resp) {
+        ASSERT_TRUE(resp.has_value());
+        responses++;
+    };
+    ASSERT_TRUE(client.call(request{0}, cb));
+    ASSERT_TRUE(client.call(request{1}, cb));
+
+    // The window is full, so the third call blocks until a response.
+    auto sent = std::atomic_bool{false};
+    auto t = std::thread([&]() {
+        EXPECT_TRUE(client.call(request{2}, cb));
+        sent = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_FALSE(sent);
+    EXPECT_EQ(client.in_flight(), window);
+
+    auto respond = [&]() {
+        while(true) {
+            std::unique_lock<std::mutex> l(mut);
+            if(!pending.empty()) {
+                auto fn = std::move(pending.front());
+                pending.erase(pending.begin());
+                l.unlock();
+                fn(std::nullopt);
+                return;
+            }
+            l.unlock();
+            std::this_thread::yield();
+        }
+    };
+    respond();
+    t.join();
+    EXPECT_TRUE(sent);
+    respond();
+    respond();
+    while(responses < 3) {
+        std::this_thread::yield();
+    }
+
+    auto stats = client.get_endpoint_stats();
+    ASSERT_EQ(stats.size(), 1UL);
+    EXPECT_EQ(stats[0].m_requests, 3UL);
+    EXPECT_EQ(stats[0].m_responses, 3UL);
+    EXPECT_EQ(stats[0].m_in_flight, 0UL);
+    EXPECT_GT(stats[0].m_latency.count(), 0);
+    EXPECT_GE(stats[0].m_max_latency, stats[0].m_latency);
+}
@@ -156,6 +156,147 @@ TEST_F(format_test, wellformed_vectors_roundtrip) {
     }
 }
 
+TEST_F(format_test, bulk_vectors_match_per_element_format) {
+    std::vector<cbdc::hash_t> v0{{'a', 'b', 'c'}, {'d', 'e', 'f'}};
+    ser << v0;
+    EXPECT_TRUE(ser);
+
+    auto expected = cbdc::buffer();
+    auto expected_ser = cbdc::buffer_serializer(expected);
+    expected_ser << static_cast<uint64_t>(v0.size());
+    for(const auto& h : v0) {
+        expected_ser << h;
+    }
+    EXPECT_EQ(buf, expected);
+
+    std::vector<cbdc::hash_t> r0{};
+    deser >> r0;
+    EXPECT_TRUE(deser);
+    EXPECT_EQ(r0, v0);
+    ser.reset();
+    deser.reset();
+
+    std::vector<bool> v1{true, false, true};
+    ser << v1;
+    EXPECT_TRUE(ser);
+
+    std::vector<bool> r1{};
+    deser >> r1;
+    EXPECT_TRUE(deser);
+    EXPECT_EQ(r1, v1);
+}
+
+TEST_F(format_test, compact_varints_roundtrip) {
+    ser.set_wire_format(cbdc::wire_format::compact);
+    deser.set_wire_format(cbdc::wire_format::compact);
+
+    const auto values = std::vector<std::pair<uint64_t, size_t>>{
+        {0, 1},
+        {127, 1},
+        {128, 2},
+        {16383, 2},
+        {16384, 3},
+        {uint64_t{1} << 32U, 5},
+        {std::numeric_limits<uint64_t>::max(), 10}};
+    size_t total{0};
+    for(const auto& [val, sz] : values) {
+        cbdc::write_varint(ser, val);
+        EXPECT_TRUE(ser);
+        total += sz;
+        EXPECT_EQ(buf.size(), total);
+    }
+
+    size_t pos{0};
+    for(const auto& [val, sz] : values) {
+        uint64_t r{};
+        cbdc::read_varint(deser, r);
+        EXPECT_TRUE(deser);
+        EXPECT_EQ(r, val);
+
+        uint64_t d{};
+        EXPECT_EQ(cbdc::decode_varint(buf.c_ptr() + pos,
+                                      buf.size() - pos,
+                                      cbdc::wire_format::compact,
+                                      d),
+                  sz);
+        EXPECT_EQ(d, val);
+        pos += sz;
+    }
+}
+
+TEST_F(format_test, compact_containers_roundtrip) {
+    ser.set_wire_format(cbdc::wire_format::compact);
+    deser.set_wire_format(cbdc::wire_format::compact);
+
+    std::vector<cbdc::hash_t> v0{{'a'}, {'b'}, {'c'}};
+    std::unordered_map<uint64_t, bool> m0{{1, true}, {2, false}};
+    auto b0 = cbdc::buffer();
+    b0.append("abc", 3);
+    ser << v0 << m0 << b0;
+    EXPECT_TRUE(ser);
+
+    auto sz = cbdc::size_serializer();
+    sz.set_wire_format(cbdc::wire_format::compact);
+    sz << v0 << m0 << b0;
+    EXPECT_EQ(sz.size(), buf.size());
+    EXPECT_EQ(buf.size(),
+              1 + v0.size() * sizeof(cbdc::hash_t) + 1
+                  + m0.size() * (sizeof(uint64_t) + sizeof(bool)) + 1
+                  + b0.size());
+
+    std::vector<cbdc::hash_t> v1{};
+    std::unordered_map<uint64_t, bool> m1{};
+    auto b1 = cbdc::buffer();
+    deser >> v1 >> m1 >> b1;
+    EXPECT_TRUE(deser);
+    EXPECT_EQ(v1, v0);
+    EXPECT_EQ(m1, m0);
+    EXPECT_EQ(b1, b0);
+}
+
+TEST_F(format_test, malformed_compact_varints_are_rejected) {
+    deser.set_wire_format(cbdc::wire_format::compact);
+    static constexpr uint8_t continue_byte = 0x80;
+
+    // Eleven bytes: longer than any 64-bit value.
+    for(size_t i{0}; i < 10; i++) {
+        ser << continue_byte;
+    }
+    ser << uint8_t{1};
+    uint64_t r{};
+    cbdc::read_varint(deser, r);
+    EXPECT_FALSE(deser);
+    EXPECT_EQ(cbdc::decode_varint(buf.c_ptr(),
+                                  buf.size(),
+                                  cbdc::wire_format::compact,
+                                  r),
+              0UL);
+
+    // Ten bytes, the last holding more than the final bit.
+    buf.clear();
+    ser.reset();
+    deser.reset();
+    for(size_t i{0}; i < 9; i++) {
+        ser << continue_byte;
+    }
+    ser << uint8_t{2};
+    cbdc::read_varint(deser, r);
+    EXPECT_FALSE(deser);
+
+    // Truncated.
+    buf.clear();
+    ser.reset();
+    deser.reset();
+    ser << continue_byte;
+    cbdc::read_varint(deser, r);
+    EXPECT_FALSE(deser);
+    EXPECT_EQ(cbdc::decode_varint(buf.c_ptr(),
+                                  buf.size(),
+                                  cbdc::wire_format::compact,
+                                  r),
+              0UL);
+}
+
 TEST_F(format_test, malformed_vectors_cannot_roundtrip) {
     std::vector<uint64_t> r0{};
 
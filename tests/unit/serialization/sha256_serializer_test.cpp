@@ -0,0 +1,89 @@
+// Copyright (c) 2021 MIT Digital Currency Initiative,
+//                    Federal Reserve Bank of Boston
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "crypto/sha256.h"
+#include "uhs/transaction/messages.hpp"
+#include "util.hpp"
+#include "util/serialization/sha256_serializer.hpp"
+#include "util/serialization/util.hpp"
+
+#include <cstring>
+#include <gtest/gtest.h>
+
+class sha256_serializer_test : public ::testing::Test {
+  protected:
+    void SetUp() override {
+        auto inp = cbdc::transaction::input();
+        inp.m_prevout.m_tx_id = {'a', 'b', 'c'};
+        inp.m_prevout.m_index = 1;
+        inp.m_prevout_data.m_value = 10;
+        m_full_tx.m_inputs.push_back(inp);
+        auto out = cbdc::transaction::output();
+        out.m_witness_program_commitment = {'d', 'e', 'f'};
+        out.m_value = 10;
+        m_full_tx.m_outputs = {out, out};
+        m_tx.m_attestations.emplace(cbdc::pubkey_t{'x'},
+                                    cbdc::signature_t{'y'});
+    }
+
+    /// Hashes the contents of the given buffer.
+    static auto hash_buffer(const cbdc::buffer& buf) -> cbdc::hash_t {
+        auto sha = CSHA256();
+        sha.Write(buf.c_ptr(), buf.size());
+        auto ret = cbdc::hash_t();
+        sha.Finalize(ret.data());
+        return ret;
+    }
+
+    cbdc::transaction::full_tx m_full_tx{};
+    cbdc::test::compact_transaction m_tx{
+        cbdc::test::simple_tx({'a', 'b', 'c'},
+                              {{'d', 'e', 'f'}, {'g', 'h', 'i'}},
+                              {{'x', 'y', 'z'}, {'z', 'z', 'z'}})};
+};
+
+TEST_F(sha256_serializer_test, matches_buffer_hash) {
+    ASSERT_EQ(cbdc::serialized_hash(m_full_tx),
+              hash_buffer(cbdc::make_buffer(m_full_tx)));
+    ASSERT_EQ(cbdc::serialized_hash(m_tx),
+              hash_buffer(cbdc::make_buffer(m_tx)));
+
+    auto ser = cbdc::sha256_serializer();
+    ASSERT_TRUE(ser << m_full_tx.m_inputs << m_full_tx.m_outputs);
+    ASSERT_FALSE(ser.end_of_buffer());
+    auto buf = cbdc::buffer();
+    for(const auto& part : {cbdc::make_buffer(m_full_tx.m_inputs),
+                            cbdc::make_buffer(m_full_tx.m_outputs)}) {
+        buf.append(part.data(), part.size());
+    }
+    ASSERT_EQ(ser.finalize(), hash_buffer(buf));
+    ASSERT_EQ(cbdc::transaction::tx_id(m_full_tx), hash_buffer(buf));
+}
+
+TEST_F(sha256_serializer_test, compact_tx_hash) {
+    // The compact transaction hash excludes the attestations
+    auto ctx = cbdc::transaction::compact_tx(m_tx);
+    ctx.m_attestations.clear();
+    ASSERT_EQ(m_tx.hash(), hash_buffer(cbdc::make_buffer(ctx)));
+}
+
+TEST_F(sha256_serializer_test, advance_reset) {
+    auto ser = cbdc::sha256_serializer();
+    ser.advance_cursor(100);
+    auto zeros = cbdc::buffer();
+    zeros.extend(100);
+    std::memset(zeros.data(), 0, zeros.size());
+    ASSERT_EQ(ser.finalize(), hash_buffer(zeros));
+
+    // Finalizing resets the hasher
+    ASSERT_EQ(ser.finalize(), hash_buffer(cbdc::buffer()));
+
+    ser << m_tx;
+    ser.reset();
+    ASSERT_EQ(ser.finalize(), hash_buffer(cbdc::buffer()));
+
+    uint64_t data{};
+    ASSERT_FALSE(ser.read(&data, sizeof(data)));
+}
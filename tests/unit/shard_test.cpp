@@ -149,3 +149,29 @@ TEST_F(shard_test, digest_block_valid) {
 
     ASSERT_EQ(invalid_got, invalid_want);
 }
+
+TEST_F(shard_test, digest_block_view) {
+    cbdc::atomizer::block b2;
+    b2.m_height = 2;
+    b2.m_transactions.push_back(
+        cbdc::test::simple_tx({'c'}, {{3}, {4}}, {{7}, {8}}));
+    auto buf = cbdc::make_buffer(b2);
+    auto view = cbdc::atomizer::block_view::parse(buf);
+    ASSERT_TRUE(view.has_value());
+    ASSERT_TRUE(m_shard.digest_block(view.value()));
+    ASSERT_EQ(m_shard.best_block_height(), 2U);
+    ASSERT_FALSE(m_shard.digest_block(view.value()));
+
+    cbdc::transaction::compact_tx ctx{};
+    ctx.m_id = {'a'};
+    ctx.m_inputs = {{3}, {5}, {7}, {8}};
+    ctx.m_uhs_outputs = {{'x'}};
+    auto res = m_shard.digest_transaction(ctx);
+    ASSERT_TRUE(std::holds_alternative<cbdc::watchtower::tx_error>(res));
+    auto got = std::get<cbdc::watchtower::tx_error>(res);
+
+    cbdc::watchtower::tx_error want{
+        {'a'},
+        cbdc::watchtower::tx_error_inputs_dne{{{3}}}};
+    ASSERT_EQ(got, want);
+}
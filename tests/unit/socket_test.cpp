@@ -7,9 +7,15 @@
 #include "util/network/tcp_listener.hpp"
 
 #include <array>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
 #include <gtest/gtest.h>
 #include <mutex>
+#include <sys/socket.h>
+#include <sys/un.h>
 #include <thread>
+#include <unistd.h>
 
 class SocketTest : public ::testing::Test {};
 
@@ -42,6 +48,109 @@ TEST_F(SocketTest, ListenConnectBasic) {
     ASSERT_EQ(recv_pkt, pkt);
 }
 
+TEST_F(SocketTest, unix_domain) {
+    const auto path = std::string("socket_test.sock");
+    const auto addr = cbdc::network::unix_scheme + path;
+
+    auto listener = cbdc::network::tcp_listener();
+    ASSERT_TRUE(listener.listen(addr, 0));
+
+    auto conn_sock = cbdc::network::tcp_socket();
+    ASSERT_TRUE(conn_sock.connect({addr, 0}));
+    auto sock = cbdc::network::tcp_socket();
+    ASSERT_TRUE(listener.accept(sock));
+
+    // TCP options are skipped rather than failing.
+    EXPECT_TRUE(conn_sock.set_nodelay(true));
+    EXPECT_TRUE(sock.set_cork(true));
+    EXPECT_TRUE(sock.set_cork(false));
+
+    auto pkt = cbdc::buffer();
+    static constexpr auto pkt_sz = 32;
+    std::array<unsigned char, pkt_sz> data{0, 1, 2, 3};
+    pkt.append(data.data(), data.size());
+    ASSERT_TRUE(conn_sock.send(pkt));
+    auto recv_pkt = cbdc::buffer();
+    ASSERT_TRUE(sock.receive(recv_pkt));
+    ASSERT_EQ(recv_pkt, pkt);
+
+    ASSERT_TRUE(sock.send(pkt));
+    ASSERT_TRUE(conn_sock.receive(recv_pkt));
+    ASSERT_EQ(recv_pkt, pkt);
+
+    listener.close();
+    EXPECT_FALSE(std::filesystem::exists(path));
+}
+
+TEST_F(SocketTest, unix_domain_existing_path) {
+    const auto path = std::string("socket_test_existing.sock");
+    const auto addr = cbdc::network::unix_scheme + path;
+
+    // Files other than sockets are left alone.
+    std::ofstream(path).put('x');
+    auto listener = cbdc::network::tcp_listener();
+    ASSERT_FALSE(listener.listen(addr, 0));
+    ASSERT_TRUE(std::filesystem::is_regular_file(path));
+    std::filesystem::remove(path);
+
+    // A socket left by a process which stopped listening is replaced.
+    {
+        auto fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        ASSERT_NE(fd, -1);
+        auto sa = sockaddr_un{};
+        sa.sun_family = AF_UNIX;
+        std::memcpy(&sa.sun_path[0], path.c_str(), path.size() + 1);
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+        auto* sa_ptr = reinterpret_cast<sockaddr*>(&sa);
+        ASSERT_EQ(::bind(fd, sa_ptr, sizeof(sa)), 0);
+        ::close(fd);
+    }
+    ASSERT_TRUE(listener.listen(addr, 0));
+
+    // The socket of a live listener is not taken over.
+    auto other = cbdc::network::tcp_listener();
+    ASSERT_FALSE(other.listen(addr, 0));
+    other.close();
+    auto conn_sock = cbdc::network::tcp_socket();
+    ASSERT_TRUE(conn_sock.connect(addr, 0));
+
+    // Closing does not remove a file which replaced the listener's socket.
+    std::filesystem::remove(path);
+    std::ofstream(path).put('x');
+    listener.close();
+    ASSERT_TRUE(std::filesystem::exists(path));
+    std::filesystem::remove(path);
+}
+
+TEST_F(SocketTest, unix_domain_abstract) {
+    const auto addr = std::string(cbdc::network::unix_scheme)
+                    + "@opencbdc_socket_test";
+    auto listener = cbdc::network::tcp_listener();
+    ASSERT_TRUE(listener.listen(addr, 0));
+
+    auto conn_sock = cbdc::network::tcp_socket();
+    ASSERT_TRUE(conn_sock.connect(addr, 0));
+    auto sock = cbdc::network::tcp_socket();
+    ASSERT_TRUE(listener.accept(sock));
+
+    auto pkt = cbdc::buffer();
+    pkt.append("abc", 3);
+    ASSERT_TRUE(conn_sock.send(pkt));
+    auto recv_pkt = cbdc::buffer();
+    ASSERT_TRUE(sock.receive(recv_pkt));
+    ASSERT_EQ(recv_pkt, pkt);
+
+    listener.close();
+    conn_sock.disconnect();
+    ASSERT_FALSE(conn_sock.connect(addr, 0));
+
+    // Paths which do not fit in a socket address are rejected.
+    ASSERT_FALSE(
+        listener.listen(cbdc::network::unix_scheme + std::string(200, 'a'),
+                        0));
+    ASSERT_FALSE(listener.listen(cbdc::network::unix_scheme, 0));
+}
+
 TEST_F(SocketTest, selector_connect) {
     auto s = cbdc::network::socket_selector();
     ASSERT_TRUE(s.init());
@@ -3,6 +3,8 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include "uhs/transaction/compact_tx_view.hpp"
+#include "uhs/transaction/messages.hpp"
 #include "uhs/transaction/transaction.hpp"
 
 #include <gtest/gtest.h>
@@ -39,3 +41,91 @@ TEST(CTransaction, input_from_output_out_of_bounds) {
     auto result = cbdc::transaction::input_from_output(tx, 1);
     ASSERT_FALSE(result);
 }
+
+TEST(CTransaction, make_compact_txs) {
+    // Use the multi-buffer SHA256 implementation, if available
+    SHA256AutoDetect();
+
+    auto txs = std::vector<cbdc::transaction::full_tx>();
+    for(unsigned char i = 0; i < 20; i++) {
+        auto tx = cbdc::transaction::full_tx();
+        // Runs of transactions with the same number of inputs and outputs
+        const auto n_inputs = i / 3;
+        const auto n_outputs = i / 4;
+        for(unsigned char j = 0; j < n_inputs; j++) {
+            auto inp = cbdc::transaction::input();
+            inp.m_prevout.m_tx_id = {i, j, 'a'};
+            inp.m_prevout.m_index = j;
+            inp.m_prevout_data.m_witness_program_commitment = {i, j, 'b'};
+            inp.m_prevout_data.m_value = j;
+            tx.m_inputs.push_back(inp);
+        }
+        for(unsigned char j = 0; j < n_outputs; j++) {
+            auto out = cbdc::transaction::output();
+            out.m_witness_program_commitment = {i, j, 'c'};
+            out.m_value = j;
+            tx.m_outputs.push_back(out);
+        }
+        txs.push_back(tx);
+    }
+
+    const auto ctxs = cbdc::transaction::make_compact_txs(txs);
+    ASSERT_EQ(ctxs.size(), txs.size());
+    for(size_t i = 0; i < txs.size(); i++) {
+        const auto id = cbdc::transaction::tx_id(txs[i]);
+        ASSERT_EQ(ctxs[i].m_id, id);
+        ASSERT_EQ(ctxs[i].m_inputs.size(), txs[i].m_inputs.size());
+        for(size_t j = 0; j < txs[i].m_inputs.size(); j++) {
+            ASSERT_EQ(ctxs[i].m_inputs[j], txs[i].m_inputs[j].hash());
+        }
+        ASSERT_EQ(ctxs[i].m_uhs_outputs.size(), txs[i].m_outputs.size());
+        for(size_t j = 0; j < txs[i].m_outputs.size(); j++) {
+            ASSERT_EQ(ctxs[i].m_uhs_outputs[j],
+                      cbdc::transaction::uhs_id_from_output(
+                          id,
+                          j,
+                          txs[i].m_outputs[j]));
+        }
+
+        const auto ctx = cbdc::transaction::compact_tx(txs[i]);
+        ASSERT_EQ(ctx.m_inputs, ctxs[i].m_inputs);
+        ASSERT_EQ(ctx.m_uhs_outputs, ctxs[i].m_uhs_outputs);
+    }
+
+    ASSERT_TRUE(cbdc::transaction::make_compact_txs({}).empty());
+}
+
+TEST(CTransaction, compact_tx_view) {
+    auto ctx = cbdc::transaction::compact_tx();
+    ctx.m_id = {'a'};
+    ctx.m_inputs = {{'b'}, {'c'}};
+    ctx.m_uhs_outputs = {{'d'}};
+    ctx.m_attestations.emplace(cbdc::pubkey_t{'e'}, cbdc::signature_t{'f'});
+    auto buf = cbdc::make_buffer(ctx);
+
+    auto view = cbdc::transaction::compact_tx_view::parse(buf.c_ptr(),
+                                                          buf.size());
+    ASSERT_TRUE(view.has_value());
+    EXPECT_EQ(view->size(), buf.size());
+    EXPECT_EQ(view->id(), ctx.m_id);
+    ASSERT_EQ(view->inputs().size(), ctx.m_inputs.size());
+    EXPECT_EQ(view->inputs()[1], ctx.m_inputs[1]);
+    EXPECT_EQ(std::vector<cbdc::hash_t>(view->uhs_outputs().begin(),
+                                        view->uhs_outputs().end()),
+              ctx.m_uhs_outputs);
+    ASSERT_EQ(view->attestation_count(), 1U);
+    EXPECT_EQ(view->attestation(0),
+              cbdc::transaction::sentinel_attestation(
+                  *ctx.m_attestations.begin()));
+
+    auto copy = view->to_compact_tx();
+    EXPECT_EQ(copy.m_id, ctx.m_id);
+    EXPECT_EQ(copy.m_inputs, ctx.m_inputs);
+    EXPECT_EQ(copy.m_uhs_outputs, ctx.m_uhs_outputs);
+    EXPECT_EQ(copy.m_attestations, ctx.m_attestations);
+
+    for(size_t len{0}; len < buf.size(); len++) {
+        EXPECT_FALSE(
+            cbdc::transaction::compact_tx_view::parse(buf.c_ptr(), len));
+    }
+}
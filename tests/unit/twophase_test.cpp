@@ -88,6 +88,47 @@ TEST_F(TwoPhaseTest, test_two_shards) {
     }
 }
 
+TEST_F(TwoPhaseTest, test_commit_then_discard) {
+    auto logger = std::make_shared<cbdc::logging::log>(
+        cbdc::logging::log_level::debug);
+    auto shard = std::make_shared<cbdc::locking_shard::locking_shard>(
+        std::make_pair(0, 255),
+        logger,
+        10000000,
+        "",
+        m_opts);
+    auto shards = std::vector<std::shared_ptr<cbdc::locking_shard::interface>>(
+        {shard});
+
+    auto tx = cbdc::transaction::compact_tx();
+    tx.m_id = {'a'};
+    tx.m_uhs_outputs.push_back({'b'});
+
+    auto coordinator
+        = cbdc::coordinator::distributed_tx(cbdc::hash_t(), shards, logger);
+    coordinator.add_tx(tx);
+    auto discarded = false;
+    coordinator.set_discard_cb([&](const cbdc::hash_t& /* dtx_id */) {
+        discarded = true;
+        return true;
+    });
+
+    // The results are final once the commit phase completes
+    auto res = coordinator.execute_commit();
+    ASSERT_TRUE(res.has_value());
+    ASSERT_EQ(res->size(), 1U);
+    ASSERT_TRUE((*res)[0]);
+    ASSERT_EQ(coordinator.get_state(),
+              cbdc::coordinator::distributed_tx::dtx_state::discard);
+    ASSERT_FALSE(discarded);
+    ASSERT_TRUE(shard->check_unspent(tx.m_uhs_outputs[0]).value());
+
+    ASSERT_TRUE(coordinator.execute_discard());
+    ASSERT_TRUE(discarded);
+    ASSERT_EQ(coordinator.get_state(),
+              cbdc::coordinator::distributed_tx::dtx_state::done);
+}
+
 TEST_F(TwoPhaseTest, test_one_shard_random) {
     auto logger = std::make_shared<cbdc::logging::log>(
         cbdc::logging::log_level::debug);
@@ -48,6 +48,26 @@ TEST_F(WalletTxValidationTest, valid) {
     ASSERT_FALSE(err.has_value());
 }
 
+TEST_F(WalletTxValidationTest, validate_tx) {
+    auto res = cbdc::transaction::validation::validate_tx(m_valid_tx);
+    ASSERT_FALSE(res.m_error.has_value());
+    auto expected = cbdc::transaction::compact_tx(m_valid_tx);
+    ASSERT_EQ(res.m_tx.m_id, expected.m_id);
+    ASSERT_EQ(res.m_tx.m_inputs, expected.m_inputs);
+    ASSERT_EQ(res.m_tx.m_uhs_outputs, expected.m_uhs_outputs);
+
+    m_valid_tx.m_outputs[0].m_value++;
+    res = cbdc::transaction::validation::validate_tx(m_valid_tx);
+    ASSERT_TRUE(res.m_error.has_value());
+    ASSERT_EQ(res.m_error.value(),
+              cbdc::transaction::validation::tx_error(
+                  cbdc::transaction::validation::tx_error_code::
+                      asymmetric_values));
+    ASSERT_EQ(res.m_tx.m_id, cbdc::transaction::tx_id(m_valid_tx));
+    ASSERT_TRUE(res.m_tx.m_inputs.empty());
+    ASSERT_TRUE(res.m_tx.m_uhs_outputs.empty());
+}
+
 TEST_F(WalletTxValidationTest, no_inputs) {
     m_valid_tx.m_inputs.clear();
 
@@ -336,3 +356,37 @@ TEST_F(WalletTxValidationTest, sign_verify_compact) {
     ASSERT_FALSE(
         cbdc::transaction::validation::check_attestations(ctx, m_pubkeys, 2));
 }
+
+TEST_F(WalletTxValidationTest, check_attestations_batch) {
+    auto valid = cbdc::transaction::compact_tx(m_valid_tx);
+    valid.m_attestations.insert(valid.sign(m_secp.get(), m_priv0));
+    valid.m_attestations.insert(valid.sign(m_secp.get(), m_priv1));
+
+    auto too_few = cbdc::transaction::compact_tx(m_valid_tx);
+    too_few.m_attestations.insert(too_few.sign(m_secp.get(), m_priv0));
+
+    // Attestations signing a different transaction
+    auto bad_sig = cbdc::transaction::compact_tx(m_valid_tx_multi_inp);
+    bad_sig.m_attestations = valid.m_attestations;
+
+    auto pool = cbdc::thread_pool(2);
+    auto res = cbdc::transaction::validation::check_attestations(
+        {valid, too_few, bad_sig, valid},
+        m_pubkeys,
+        2,
+        pool);
+    ASSERT_EQ(res, (std::vector<bool>{true, false, false, true}));
+
+    res = cbdc::transaction::validation::check_attestations({},
+                                                            m_pubkeys,
+                                                            2,
+                                                            pool);
+    ASSERT_TRUE(res.empty());
+
+    m_pubkeys.clear();
+    res = cbdc::transaction::validation::check_attestations({valid},
+                                                            m_pubkeys,
+                                                            2,
+                                                            pool);
+    ASSERT_EQ(res, std::vector<bool>{false});
+}
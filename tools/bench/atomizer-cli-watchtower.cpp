@@ -262,7 +262,8 @@ auto main(int argc, char** argv) -> int {
                         auto resend_pkt
                             = send_tx_to_atomizer(tx, best_watchtower_height);
                         if(!atomizer_network.send_to_one(
-                               cbdc::atomizer::request{resend_pkt})) {
+                               cbdc::atomizer::request{resend_pkt},
+                               cfg.m_wire_format)) {
                             log->error("Failed to resend tx to atomizer.");
                         }
                         rebroadcast++;
@@ -326,7 +327,8 @@ auto main(int argc, char** argv) -> int {
             if(!bwc.init()) {
                 log->warn("Failed to connect to watchtower.");
             }
-            if(atomizer_network.send_to_one(cbdc::atomizer::request{msg})) {
+            if(atomizer_network.send_to_one(cbdc::atomizer::request{msg},
+                                            cfg.m_wire_format)) {
                 log->info("Sent mint TX to atomizer. ID:",
                           cbdc::to_string(cbdc::transaction::tx_id(mint_tx)),
                           "h:",
@@ -506,7 +508,8 @@ auto main(int argc, char** argv) -> int {
                 = send_tx_to_atomizer(cbdc::transaction::compact_tx(pay_tx),
                                       best_height);
             if(!atomizer_network.send_to_one(
-                   cbdc::atomizer::request{send_pkt})) {
+                   cbdc::atomizer::request{send_pkt},
+                   cfg.m_wire_format)) {
                 log->info("Failed to send pay tx to atomizer. ID:",
                           cbdc::to_string(cbdc::transaction::tx_id(pay_tx)),
                           "h:",
@@ -9,6 +9,7 @@
 #include "uhs/transaction/wallet.hpp"
 #include "uhs/twophase/coordinator/client.hpp"
 #include "uhs/twophase/locking_shard/status_client.hpp"
+#include "util/common/blocking_queue.hpp"
 #include "util/common/config.hpp"
 #include "util/common/logging.hpp"
 #include "util/network/connection_manager.hpp"
@@ -119,7 +120,8 @@ auto main(int argc, char** argv) -> int {
     auto status_client = cbdc::locking_shard::rpc::status_client(
         cfg.m_locking_shard_readonly_endpoints,
         cfg.m_shard_ranges,
-        lookup_timeout);
+        lookup_timeout,
+        cfg.m_endpoint_selection_policy);
     if(!status_client.init()) {
         logger->warn("Failed to connect to shard read-only endpoints");
     }
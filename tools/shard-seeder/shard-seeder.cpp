@@ -22,6 +22,8 @@ static constexpr int leveldb_buffer_size
     = 16 * 1024 * 1024; // 16MB can hold ~ 500K UHS_IDs
 static constexpr int write_batch_size
     = 450000; // well within the write buffer size
+static constexpr size_t seed_batch_size
+    = 1024; // transactions converted to compact form at once
 
 auto get_2pc_uhs_key(const cbdc::hash_t& uhs_id) -> std::string {
     auto ret = std::string();
@@ -31,6 +33,27 @@ auto get_2pc_uhs_key(const cbdc::hash_t& uhs_id) -> std::string {
     return ret;
 }
 
+/// Calls fn with the UHS ID of the output of each seeded transaction,
+/// converting the transactions to compact form in batches so the IDs are
+/// hashed together.
+template<typename F>
+void for_each_seeded_output(cbdc::transaction::full_tx tx,
+                            size_t num_utxos,
+                            F&& fn) {
+    auto txs = std::vector<cbdc::transaction::full_tx>();
+    for(size_t from = 0; from < num_utxos; from += seed_batch_size) {
+        const auto to = std::min(num_utxos, from + seed_batch_size);
+        txs.clear();
+        for(size_t tx_idx = from; tx_idx != to; tx_idx++) {
+            tx.m_inputs[0].m_prevout.m_index = tx_idx;
+            txs.push_back(tx);
+        }
+        for(const auto& ctx : cbdc::transaction::make_compact_txs(txs)) {
+            fn(ctx.m_uhs_outputs[0]);
+        }
+    }
+}
+
 auto main(int argc, char** argv) -> int {
     auto args = cbdc::config::get_args(argc, argv);
     auto logger = cbdc::logging::log(cbdc::logging::log_level::info);
@@ -48,6 +71,9 @@ auto main(int argc, char** argv) -> int {
     }
     auto cfg = std::get<cbdc::config::options>(cfg_or_err);
 
+    std::string sha2_impl(SHA256AutoDetect());
+    logger.info("using sha2: ", sha2_impl);
+
     auto start = std::chrono::system_clock::now();
 
     auto unique_ranges
@@ -126,12 +152,14 @@ auto main(int argc, char** argv) -> int {
                     auto tx = wal.create_seeded_transaction(0).value();
                     auto batch_size = 0;
                     leveldb::WriteBatch batch;
-                    for(size_t tx_idx = 0; tx_idx != num_utxos; tx_idx++) {
-                        tx.m_inputs[0].m_prevout.m_index = tx_idx;
-                        cbdc::transaction::compact_tx ctx(tx);
-                        const cbdc::hash_t& output_hash = ctx.m_uhs_outputs[0];
-                        if(output_hash[0] >= shard_start
-                           && output_hash[0] <= shard_end) {
+                    for_each_seeded_output(
+                        tx,
+                        num_utxos,
+                        [&](const cbdc::hash_t& output_hash) {
+                            if(output_hash[0] < shard_start
+                               || output_hash[0] > shard_end) {
+                                return;
+                            }
                             std::array<char, sizeof(output_hash)> hash_arr{};
                             std::memcpy(hash_arr.data(),
                                         output_hash.data(),
@@ -145,8 +173,7 @@ auto main(int argc, char** argv) -> int {
                                 batch.Clear();
                                 batch_size = 0;
                             }
-                        }
-                    }
+                        });
                     if(batch_size > 0) {
                         db->Write(wopt, &batch);
                     }
@@ -159,16 +186,16 @@ auto main(int argc, char** argv) -> int {
                     auto ser = cbdc::ostream_serializer(out);
                     ser << count;
                     auto tx = wal.create_seeded_transaction(0).value();
-                    for(size_t tx_idx = 0; tx_idx != num_utxos; tx_idx++) {
-                        tx.m_inputs[0].m_prevout.m_index = tx_idx;
-                        cbdc::transaction::compact_tx ctx(tx);
-                        const cbdc::hash_t& output_hash = ctx.m_uhs_outputs[0];
-                        if(output_hash[0] >= shard_start
-                           && output_hash[0] <= shard_end) {
-                            ser << output_hash;
-                            count++;
-                        }
-                    }
+                    for_each_seeded_output(
+                        tx,
+                        num_utxos,
+                        [&](const cbdc::hash_t& output_hash) {
+                            if(output_hash[0] >= shard_start
+                               && output_hash[0] <= shard_end) {
+                                ser << output_hash;
+                                count++;
+                            }
+                        });
                     ser.reset();
                     ser << count;
                 }